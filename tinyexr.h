@@ -215,8 +215,8 @@ extern "C" {
 #define TINYEXR_COMPRESSIONTYPE_PXR24 (5)
 #define TINYEXR_COMPRESSIONTYPE_B44 (6)
 #define TINYEXR_COMPRESSIONTYPE_B44A (7)
-#define TINYEXR_COMPRESSIONTYPE_DWAA (8)   // Not yet supported
-#define TINYEXR_COMPRESSIONTYPE_DWAB (9)   // Not yet supported
+#define TINYEXR_COMPRESSIONTYPE_DWAA (8)   // requires C++11
+#define TINYEXR_COMPRESSIONTYPE_DWAB (9)   // requires C++11
 #define TINYEXR_COMPRESSIONTYPE_ZFP (128)  // TinyEXR extension
 
 #define TINYEXR_ZFP_COMPRESSIONTYPE_RATE (0)
@@ -331,6 +331,16 @@ typedef struct TEXRHeader {
   // use EXRSetNameAttr for setting value;
   // max 255 character allowed - excluding terminating zero
   char name[256];
+
+  // Number of threads used to load/save this image when TINYEXR_USE_THREAD
+  // is enabled. 0(default) uses hardware_concurrency() (capped by
+  // TINYEXR_MAX_THREADS), 1 runs on the calling thread only.
+  int num_threads;
+
+  // Channels to decode. Filled with 1 by ParseEXRHeaderFrom(Memory|File),
+  // then users can set entries to 0 to skip channels when loading: their
+  // `images[c]` (or tile images) are left NULL. NULL decodes every channel.
+  int *channel_mask;
 } EXRHeader;
 
 typedef struct TEXRMultiPartHeader {
@@ -460,6 +470,26 @@ extern int EXRNumLevels(const EXRImage* exr_image);
 // Initialize EXRHeader struct
 extern void InitEXRHeader(EXRHeader *exr_header);
 
+// Task dispatch for multi-threaded loading/saving(TINYEXR_USE_THREAD).
+// TinyEXR splits the work of one call into `num_tasks` tasks which pull
+// chunks from a shared queue, so they may run with any degree of
+// concurrency. A dispatcher must call `task(i, task_userdata)` once for every
+// i in [0, num_tasks) and return after all calls have finished.
+typedef void (*EXRTaskFunc)(int task_index, void *task_userdata);
+typedef void (*EXRParallelForFunc)(void *userdata, int num_tasks,
+                                   EXRTaskFunc task, void *task_userdata);
+
+// Run TinyEXR's tasks on the application's thread pool. Pass NULL to use the
+// built-in pool, whose threads are created on first use and kept for later
+// calls. Has no effect unless TINYEXR_USE_THREAD is enabled.
+extern void EXRSetParallelFor(EXRParallelForFunc func, void *userdata);
+
+// Join the built-in pool's worker threads. They are never joined at exit, so
+// call this before unloading a DLL/shared object that contains TinyEXR. Must
+// not be called while a load or save is running; later calls start new
+// workers. Has no effect unless TINYEXR_USE_THREAD is enabled.
+extern void EXRShutdownThreadPool(void);
+
 // Set name attribute of EXRHeader struct (it makes a copy)
 extern void EXRSetNameAttr(EXRHeader *exr_header, const char* name);
 
@@ -756,9 +786,21 @@ extern const char* EXRGetSpectralUnits(const EXRHeader *exr_header);
 
 #if TINYEXR_USE_THREAD
 #include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <thread>
 #endif
 
+// RGBA interleave for LoadEXR(). Scalar unless TINYEXR_ENABLE_SIMD is set.
+#include "tinyexr_simd.hh"
+
+// Native deflate compressor for ZIP writes (replaces mz_compress) and the
+// PIZ Huffman decoder.
+#include "tinyexr_huffman.hh"
+
+// DWAA/DWAB decoder
+#include "tinyexr_dwa.hh"
+
 #else  // __cplusplus > 199711L
 #define TINYEXR_HAS_CXX11 (0)
 #endif  // __cplusplus > 199711L
@@ -866,6 +908,164 @@ static void SetErrorMessage(const std::string &msg, const char **err) {
   }
 }
 
+#if TINYEXR_HAS_CXX11 && (TINYEXR_USE_THREAD > 0)
+// Worker threads shared by all loads and saves, created on demand and kept
+// until EXRShutdownThreadPool(). The calling thread runs tasks of its own
+// job too, so concurrent calls from several threads always make progress.
+class ThreadPool {
+ public:
+  ThreadPool() : stop_(false) {}
+
+  // Join all workers; the next Run() starts new ones
+  void Shutdown() {
+    std::vector<std::thread> threads;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+      threads.swap(threads_);
+    }
+    wake_.notify_all();
+    for (size_t i = 0; i < threads.size(); i++) {
+      threads[i].join();
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = false;
+  }
+
+  void Run(int num_tasks, EXRTaskFunc task, void *userdata) {
+    Job job;
+    job.task = task;
+    job.userdata = userdata;
+    job.num_tasks = num_tasks;
+    job.next = 0;
+    job.remaining = num_tasks;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (int(threads_.size()) < num_tasks - 1) {
+      threads_.push_back(std::thread(&ThreadPool::WorkerLoop, this));
+    }
+    jobs_.push_back(&job);
+    wake_.notify_all();
+
+    RunTasks(&job, lock);
+    while (job.remaining > 0) {
+      done_.wait(lock);
+    }
+  }
+
+ private:
+  struct Job {
+    EXRTaskFunc task;
+    void *userdata;
+    int num_tasks;
+    int next;       // next task to hand out
+    int remaining;  // tasks not finished yet
+  };
+
+  // Run tasks of `job` until all are handed out. `lock` is held on entry and
+  // exit; a job leaves the queue once its last task has been taken.
+  void RunTasks(Job *job, std::unique_lock<std::mutex> &lock) {
+    while (job->next < job->num_tasks) {
+      int task_index = job->next++;
+      if (job->next == job->num_tasks) {
+        jobs_.erase(std::find(jobs_.begin(), jobs_.end(), job));
+      }
+      lock.unlock();
+      job->task(task_index, job->userdata);
+      lock.lock();
+      if (--job->remaining == 0) {
+        done_.notify_all();
+        return;
+      }
+    }
+  }
+
+  void WorkerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+      while (!stop_ && jobs_.empty()) {
+        wake_.wait(lock);
+      }
+      if (stop_) {
+        return;
+      }
+      RunTasks(jobs_.front(), lock);
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable wake_;  // job queued or stop
+  std::condition_variable done_;  // a job finished
+  std::vector<Job *> jobs_;
+  std::vector<std::thread> threads_;
+  bool stop_;
+};
+
+// Intentionally leaked: joining workers from a static destructor can
+// deadlock under the Windows loader lock and may outlive other statics.
+static ThreadPool &GetThreadPool() {
+  static ThreadPool *pool = new ThreadPool();
+  return *pool;
+}
+
+// Dispatcher installed with EXRSetParallelFor()
+struct ParallelForHook {
+  std::mutex mutex;
+  EXRParallelForFunc func;
+  void *userdata;
+};
+
+static ParallelForHook &GetParallelForHook() {
+  static ParallelForHook hook;  // zero-initialized
+  return hook;
+}
+
+// Number of tasks for `num_items` chunks: the per-call request, or
+// hardware_concurrency() capped by TINYEXR_MAX_THREADS when it is 0
+static int GetNumThreads(int requested, int num_items) {
+  int num_threads = requested;
+  if (num_threads <= 0) {
+    num_threads = std::max(1, int(std::thread::hardware_concurrency()));
+#if (TINYEXR_MAX_THREADS > 0)
+    num_threads = std::min(num_threads, TINYEXR_MAX_THREADS);
+#endif
+  }
+  return std::max(1, std::min(num_threads, num_items));
+}
+
+template <typename F>
+static void RunParallelTask(int task_index, void *userdata) {
+  (*static_cast<F *>(userdata))(task_index);
+}
+
+// Run func(i) for i in [0, num_tasks) on the installed dispatcher or the
+// built-in pool
+template <typename F>
+static void ParallelFor(int num_tasks, F &func) {
+  if (num_tasks <= 1) {
+    for (int i = 0; i < num_tasks; i++) {
+      func(i);
+    }
+    return;
+  }
+
+  ParallelForHook &hook = GetParallelForHook();
+  EXRParallelForFunc dispatch;
+  void *dispatch_userdata;
+  {
+    std::lock_guard<std::mutex> lock(hook.mutex);
+    dispatch = hook.func;
+    dispatch_userdata = hook.userdata;
+  }
+
+  if (dispatch) {
+    dispatch(dispatch_userdata, num_tasks, RunParallelTask<F>, &func);
+  } else {
+    GetThreadPool().Run(num_tasks, RunParallelTask<F>, &func);
+  }
+}
+#endif
+
 #if 0
 static void SetWarningMessage(const std::string &msg, const char **warn) {
   if (warn) {
@@ -1501,7 +1701,21 @@ static bool CompressZip(unsigned char *dst,
     }
   }
 
-#if defined(TINYEXR_USE_MINIZ) && (TINYEXR_USE_MINIZ==1)
+#if defined(TINYEXR_USE_MINIZ) && (TINYEXR_USE_MINIZ==1) && TINYEXR_HAS_CXX11
+  //
+  // Compress the data with the native deflate encoder at mz_compress()'s
+  // default level. compressedSize holds the capacity of dst
+  // (mz_compressBound(), which exceeds deflate_zlib_bound()).
+  //
+
+  size_t outSize = tinyexr::huffman::deflate_zlib(
+      &tmpBuf.at(0), src_size, dst, static_cast<size_t>(compressedSize), 6);
+  if (outSize == 0) {
+    return false;
+  }
+
+  compressedSize = outSize;
+#elif defined(TINYEXR_USE_MINIZ) && (TINYEXR_USE_MINIZ==1)
   //
   // Compress the data using miniz
   //
@@ -2591,6 +2805,9 @@ static void hufPackEncTable(
   *pcode = p;
 }
 
+#if !TINYEXR_HAS_CXX11
+// C++11 builds decode with tinyexr::huffman::huf_uncompress().
+
 //
 // Unpack an encoding table packed by hufPackEncTable():
 //
@@ -2774,6 +2991,8 @@ static void hufFreeDecTable(HufDec *hdecod)  // io: Decoding table
   }
 }
 
+#endif  // !TINYEXR_HAS_CXX11
+
 //
 // ENCODING
 //
@@ -2847,6 +3066,7 @@ static int hufEncode            // return: output size (in bits)
   return (out - outStart) * 8 + lc;
 }
 
+#if !TINYEXR_HAS_CXX11
 //
 // DECODING
 //
@@ -3042,6 +3262,8 @@ static bool hufDecode(const long long *hcode,  // i : encoding table
   return true;
 }
 
+#endif  // !TINYEXR_HAS_CXX11
+
 static void countFrequencies(std::vector<long long> &freq,
                              const unsigned short data[/*n*/], int n) {
   for (int i = 0; i < HUF_ENCSIZE; ++i) freq[i] = 0;
@@ -3058,12 +3280,14 @@ static void writeUInt(char buf[4], unsigned int i) {
   b[3] = i >> 24;
 }
 
+#if !TINYEXR_HAS_CXX11
 static unsigned int readUInt(const char buf[4]) {
   const unsigned char *b = (const unsigned char *)buf;
 
   return (b[0] & 0x000000ff) | ((b[1] << 8) & 0x0000ff00) |
          ((b[2] << 16) & 0x00ff0000) | ((b[3] << 24) & 0xff000000);
 }
+#endif  // !TINYEXR_HAS_CXX11
 
 //
 // EXTERNAL INTERFACE
@@ -3107,6 +3331,15 @@ static bool hufUncompress(const char compressed[], int nCompressed,
     return false;
   }
 
+#if TINYEXR_HAS_CXX11
+  if (nCompressed < 0) return false;
+
+  // Table-driven decoder shared with the V2/V3 PIZ paths
+  return tinyexr::huffman::huf_uncompress(
+      reinterpret_cast<const unsigned char *>(compressed),
+      static_cast<size_t>(nCompressed), raw->data(), raw->size());
+#else
+
   int im = readUInt(compressed);
   int iM = readUInt(compressed + 4);
   // int tableLength = readUInt (compressed + 8);
@@ -3156,6 +3389,7 @@ static bool hufUncompress(const char compressed[], int nCompressed,
   }
 
   return true;
+#endif
 }
 
 //
@@ -3435,7 +3669,9 @@ static bool DecompressPiz(unsigned char *outPtr, const unsigned char *inPtr,
   }
 
   std::vector<unsigned short> tmpBuffer(tmpBufSizeInBytes / sizeof(unsigned short));
-  hufUncompress(reinterpret_cast<const char *>(ptr), length, &tmpBuffer);
+  if (!hufUncompress(reinterpret_cast<const char *>(ptr), length, &tmpBuffer)) {
+    return false;
+  }
 
   //
   // Wavelet decoding
@@ -3637,6 +3873,73 @@ static bool DecompressPxr24(unsigned char *outPtr, size_t outBufSize,
   return true;
 }
 
+// ============================================================================
+// DWAA/DWAB compression
+// ============================================================================
+
+#if TINYEXR_HAS_CXX11
+// Lossy DCT (RGB/Y), RLE (alpha) and zlib channels; see tinyexr_dwa.hh.
+// Produces the same scanline layout as ZIP. `line_no` is the chunk's first
+// line relative to the data window.
+static bool DecompressDwa(unsigned char *outPtr, size_t outBufSize,
+                          const unsigned char *inPtr, size_t inLen,
+                          int data_width, int line_no, int num_lines,
+                          size_t num_channels,
+                          const EXRChannelInfo *channels) {
+  std::vector<tinyexr::dwa::ChannelInfo> info(num_channels);
+  for (size_t c = 0; c < num_channels; c++) {
+    info[c].name = channels[c].name;
+    info[c].pixel_type = channels[c].pixel_type;
+    info[c].x_sampling = channels[c].x_sampling > 0 ? channels[c].x_sampling : 1;
+    info[c].y_sampling = channels[c].y_sampling > 0 ? channels[c].y_sampling : 1;
+    info[c].p_linear = channels[c].p_linear != 0;
+  }
+  return tinyexr::dwa::Decompress(outPtr, outBufSize, inPtr, inLen, info.data(),
+                                  static_cast<int>(num_channels), 0, line_no,
+                                  data_width, num_lines);
+}
+
+// Inverse of DecompressDwa. `level` is the dwaCompressionLevel attribute.
+// The writer stores every channel at full resolution in its requested type.
+static bool CompressDwa(std::vector<unsigned char> &out,
+                        const unsigned char *inPtr, size_t inLen,
+                        int data_width, int line_no, int num_lines,
+                        const std::vector<ChannelInfo> &channels,
+                        float level) {
+  std::vector<tinyexr::dwa::ChannelInfo> info(channels.size());
+  for (size_t c = 0; c < channels.size(); c++) {
+    info[c].name = channels[c].name.c_str();
+    info[c].pixel_type = channels[c].requested_pixel_type;
+    info[c].x_sampling = 1;
+    info[c].y_sampling = 1;
+    info[c].p_linear = channels[c].p_linear != 0;
+  }
+  return tinyexr::dwa::Compress(inPtr, inLen, info.data(),
+                                static_cast<int>(channels.size()), 0, line_no,
+                                data_width, num_lines, level, 6, &out);
+}
+
+// dwaCompressionLevel from the custom attributes, or the OpenEXR default
+// when it is absent, not a float, negative or non-finite
+static float FindDwaCompressionLevel(const EXRAttribute *attributes,
+                                     int num_attributes) {
+  for (int i = 0; i < num_attributes; i++) {
+    if ((strcmp(attributes[i].name, "dwaCompressionLevel") == 0) &&
+        (strcmp(attributes[i].type, "float") == 0) &&
+        (attributes[i].size == 4)) {
+      float level;
+      memcpy(&level, attributes[i].value, sizeof(float));
+      tinyexr::swap4(&level);
+      if ((level >= 0.0f) && std::isfinite(level)) {
+        return level;
+      }
+      break;
+    }
+  }
+  return tinyexr::dwa::DEFAULT_COMPRESSION_LEVEL;
+}
+#endif  // TINYEXR_HAS_CXX11
+
 // ============================================================================
 // B44/B44A decompression
 // ============================================================================
@@ -4850,6 +5153,9 @@ static bool DecodePixelData(/* out */ unsigned char **out_images,
     //   pixel sample data for channel n for scanline 1
     //   ...
     for (size_t c = 0; c < static_cast<size_t>(num_channels); c++) {
+      if (out_images[c] == NULL) {
+        continue;  // masked out by `channel_mask`
+      }
       if (channels[c].pixel_type == TINYEXR_PIXELTYPE_HALF) {
         for (size_t v = 0; v < static_cast<size_t>(num_lines); v++) {
           const unsigned short *line_ptr = reinterpret_cast<unsigned short *>(
@@ -4988,6 +5294,9 @@ static bool DecodePixelData(/* out */ unsigned char **out_images,
     //   pixel sample data for channel n for scanline 1
     //   ...
     for (size_t c = 0; c < static_cast<size_t>(num_channels); c++) {
+      if (out_images[c] == NULL) {
+        continue;  // masked out by `channel_mask`
+      }
       if (channels[c].pixel_type == TINYEXR_PIXELTYPE_HALF) {
         for (size_t v = 0; v < static_cast<size_t>(num_lines); v++) {
           const unsigned short *line_ptr = reinterpret_cast<unsigned short *>(
@@ -5124,6 +5433,9 @@ static bool DecodePixelData(/* out */ unsigned char **out_images,
     //   pixel sample data for channel n for scanline 1
     //   ...
     for (size_t c = 0; c < static_cast<size_t>(num_channels); c++) {
+      if (out_images[c] == NULL) {
+        continue;  // masked out by `channel_mask`
+      }
       if (channels[c].pixel_type == TINYEXR_PIXELTYPE_HALF) {
         for (size_t v = 0; v < static_cast<size_t>(num_lines); v++) {
           const unsigned short *line_ptr = reinterpret_cast<unsigned short *>(
@@ -5262,6 +5574,9 @@ static bool DecodePixelData(/* out */ unsigned char **out_images,
     //   pixel sample data for channel n for scanline 1
     //   ...
     for (size_t c = 0; c < static_cast<size_t>(num_channels); c++) {
+      if (out_images[c] == NULL) {
+        continue;  // masked out by `channel_mask`
+      }
       TINYEXR_CHECK_AND_RETURN_C(channels[c].pixel_type == TINYEXR_PIXELTYPE_FLOAT, false);
       if (channels[c].pixel_type == TINYEXR_PIXELTYPE_FLOAT) {
         TINYEXR_CHECK_AND_RETURN_C(requested_pixel_types[c] == TINYEXR_PIXELTYPE_FLOAT, false);
@@ -5299,22 +5614,41 @@ static bool DecodePixelData(/* out */ unsigned char **out_images,
     (void)num_channels;
     return false;
 #endif
-  } else if (compression_type == TINYEXR_COMPRESSIONTYPE_PXR24) {
+  } else if (compression_type == TINYEXR_COMPRESSIONTYPE_PXR24 ||
+             compression_type == TINYEXR_COMPRESSIONTYPE_DWAA ||
+             compression_type == TINYEXR_COMPRESSIONTYPE_DWAB) {
     // PXR24 compression: Use true PXR24 decompression
     // PXR24 truncates FLOAT to 24-bits, HALF/UINT pass through unchanged
+    // DWAA/DWAB decode to the same uncompressed scanline layout
     std::vector<unsigned char> outBuf(static_cast<size_t>(width) *
                                       static_cast<size_t>(num_lines) *
                                       pixel_data_size);
 
-    if (!tinyexr::DecompressPxr24(
-            reinterpret_cast<unsigned char *>(&outBuf.at(0)), outBuf.size(),
-            data_ptr, static_cast<size_t>(data_len),
-            width, num_lines, static_cast<size_t>(num_channels), channels)) {
+    if (compression_type == TINYEXR_COMPRESSIONTYPE_PXR24) {
+      if (!tinyexr::DecompressPxr24(
+              reinterpret_cast<unsigned char *>(&outBuf.at(0)), outBuf.size(),
+              data_ptr, static_cast<size_t>(data_len),
+              width, num_lines, static_cast<size_t>(num_channels), channels)) {
+        return false;
+      }
+    } else {
+#if TINYEXR_HAS_CXX11
+      if (!tinyexr::DecompressDwa(
+              reinterpret_cast<unsigned char *>(&outBuf.at(0)), outBuf.size(),
+              data_ptr, static_cast<size_t>(data_len), width, line_no,
+              num_lines, static_cast<size_t>(num_channels), channels)) {
+        return false;
+      }
+#else
       return false;
+#endif
     }
 
     // Process decompressed data (same as ZIP path)
     for (size_t c = 0; c < static_cast<size_t>(num_channels); c++) {
+      if (out_images[c] == NULL) {
+        continue;  // masked out by `channel_mask`
+      }
       if (channels[c].pixel_type == TINYEXR_PIXELTYPE_HALF) {
         for (size_t v = 0; v < static_cast<size_t>(num_lines); v++) {
           const unsigned short *line_ptr = reinterpret_cast<unsigned short *>(
@@ -5433,6 +5767,9 @@ static bool DecodePixelData(/* out */ unsigned char **out_images,
 
     // Process decompressed data - B44 returns data organized per channel
     for (size_t c = 0; c < static_cast<size_t>(num_channels); c++) {
+      if (out_images[c] == NULL) {
+        continue;  // masked out by `channel_mask`
+      }
       size_t ch_offset = c * static_cast<size_t>(width) * num_lines *
                          ((channels[c].pixel_type == TINYEXR_PIXELTYPE_HALF) ? 2 : 4);
 
@@ -5529,6 +5866,9 @@ static bool DecodePixelData(/* out */ unsigned char **out_images,
     }
   } else if (compression_type == TINYEXR_COMPRESSIONTYPE_NONE) {
     for (size_t c = 0; c < num_channels; c++) {
+      if (out_images[c] == NULL) {
+        continue;  // masked out by `channel_mask`
+      }
       for (size_t v = 0; v < static_cast<size_t>(num_lines); v++) {
         if (channels[c].pixel_type == TINYEXR_PIXELTYPE_HALF) {
           const unsigned short *line_ptr =
@@ -5717,9 +6057,11 @@ static bool ComputeChannelLayout(std::vector<size_t> *channel_offset_list,
 }
 
 // TODO: Simply return nullptr when failed to allocate?
+// Channels masked out by `channel_mask`(may be NULL) are left NULL.
 static unsigned char **AllocateImage(int num_channels,
                                      const EXRChannelInfo *channels,
                                      const int *requested_pixel_types,
+                                     const int *channel_mask,
                                      int data_width, int data_height, bool *success) {
   unsigned char **images =
       reinterpret_cast<unsigned char **>(static_cast<float **>(
@@ -5732,6 +6074,9 @@ static unsigned char **AllocateImage(int num_channels,
   bool valid = true;
 
   for (size_t c = 0; c < static_cast<size_t>(num_channels); c++) {
+    if (channel_mask && !channel_mask[c]) {
+      continue;
+    }
     size_t data_len =
         static_cast<size_t>(data_width) * static_cast<size_t>(data_height);
     if (channels[c].pixel_type == TINYEXR_PIXELTYPE_HALF) {
@@ -5959,6 +6304,18 @@ static int ParseEXRHeader(HeaderInfo *info, bool *empty_header,
         ok = true;
       }
 
+      if (data[0] == TINYEXR_COMPRESSIONTYPE_DWAA ||
+          data[0] == TINYEXR_COMPRESSIONTYPE_DWAB) {
+#if TINYEXR_HAS_CXX11
+        ok = true;
+#else
+        if (err) {
+          (*err) = "DWAA/DWAB compression requires C++11.";
+        }
+        return TINYEXR_ERROR_UNSUPPORTED_FORMAT;
+#endif
+      }
+
       if (!ok) {
         if (err) {
           (*err) = "Unknown compression type.";
@@ -6258,6 +6615,13 @@ static bool ConvertHeader(EXRHeader *exr_header, const HeaderInfo &info, std::st
     exr_header->requested_pixel_types[c] = info.channels[c].pixel_type;
   }
 
+  // Decode all channels by default
+  exr_header->channel_mask = static_cast<int *>(
+      malloc(sizeof(int) * static_cast<size_t>(exr_header->num_channels)));
+  for (size_t c = 0; c < static_cast<size_t>(exr_header->num_channels); c++) {
+    exr_header->channel_mask[c] = 1;
+  }
+
   exr_header->num_custom_attributes = static_cast<int>(info.attributes.size());
 
   if (exr_header->num_custom_attributes > 0) {
@@ -6328,11 +6692,37 @@ static int LevelSize(int toplevel_size, int level, int tile_rounding_mode) {
   return std::max(level_size, 1);
 }
 
+// Interleaved RGBA float framebuffer that LoadEXR() decodes tiles straight
+// into, instead of allocating an EXRTile(and its channel images) per tile.
+// Only level 0 is decoded.
+struct RGBATarget {
+  float *rgba;      // width * height * 4, in data window coordinates.
+  int channels[4];  // Source channel for R, G, B and A. -1 = constant 1.0.
+};
+
+// Scatters a decoded tile(one plane per RGBA channel, `tile_stride` floats
+// per row) into the RGBA framebuffer.
+static void InterleaveTileToRGBA(const RGBATarget &target, int image_width,
+                                 const float *const planes[4],
+                                 size_t tile_stride, int x0, int y0,
+                                 int tile_width, int tile_height) {
+  for (int j = 0; j < tile_height; j++) {
+    const size_t src = static_cast<size_t>(j) * tile_stride;
+    float *dst = target.rgba + 4 * (static_cast<size_t>(y0 + j) *
+                                        static_cast<size_t>(image_width) +
+                                    static_cast<size_t>(x0));
+    simd::interleave_rgba_float(planes[0] + src, planes[1] + src,
+                                planes[2] + src, planes[3] + src, dst,
+                                static_cast<size_t>(tile_width));
+  }
+}
+
 static int DecodeTiledLevel(EXRImage* exr_image, const EXRHeader* exr_header,
   const OffsetData& offset_data,
   const std::vector<size_t>& channel_offset_list,
   int pixel_data_size,
   const unsigned char* head, const size_t size,
+  const RGBATarget* rgba_target,
   std::string* err) {
   int num_channels = exr_header->num_channels;
 
@@ -6372,42 +6762,84 @@ static int DecodeTiledLevel(EXRImage* exr_image, const EXRHeader* exr_header,
     err_code = TINYEXR_ERROR_INVALID_DATA;
   }
 #endif
-  exr_image->tiles = static_cast<EXRTile*>(
-    calloc(static_cast<size_t>(num_tiles), sizeof(EXRTile)));
+  if (!rgba_target) {
+    exr_image->tiles = static_cast<EXRTile*>(
+      calloc(static_cast<size_t>(num_tiles), sizeof(EXRTile)));
+  }
+
+  // RGBA mode: each worker decodes into its own 4-plane tile buffer, which
+  // is reused for every tile it processes.
+  const size_t tile_pixels = static_cast<size_t>(exr_header->tile_size_x) *
+                             static_cast<size_t>(exr_header->tile_size_y);
 
 #if TINYEXR_HAS_CXX11 && (TINYEXR_USE_THREAD > 0)
-  std::vector<std::thread> workers;
   std::atomic<int> tile_count(0);
 
-  int num_threads = std::max(1, int(std::thread::hardware_concurrency()));
-#if (TINYEXR_MAX_THREADS > 0)
-  num_threads = std::min(num_threads,TINYEXR_MAX_THREADS);
-#endif
-  if (num_threads > int(num_tiles)) {
-    num_threads = int(num_tiles);
-  }
-  for (int t = 0; t < num_threads; t++) {
-    workers.emplace_back(std::thread([&]()
+  int num_threads = tinyexr::GetNumThreads(exr_header->num_threads, num_tiles);
+  auto worker = [&](int)
       {
+        std::vector<float> tile_planes;
+        std::vector<unsigned char *> tile_images;
         int tile_idx = 0;
         while ((tile_idx = tile_count++) < num_tiles) {
 
 #else
 #if TINYEXR_USE_OPENMP
+  const size_t max_omp_threads = static_cast<size_t>(omp_get_max_threads());
+  std::vector<std::vector<float> > thread_tile_planes(max_omp_threads);
+  std::vector<std::vector<unsigned char *> > thread_tile_images(
+      max_omp_threads);
 #pragma omp parallel for
+#else
+  std::vector<float> tile_planes;
+  std::vector<unsigned char *> tile_images;
 #endif
   for (int tile_idx = 0; tile_idx < num_tiles; tile_idx++) {
-#endif
-    // Allocate memory for each tile.
-    bool alloc_success = false;
-    exr_image->tiles[tile_idx].images = tinyexr::AllocateImage(
-      num_channels, exr_header->channels,
-      exr_header->requested_pixel_types, exr_header->tile_size_x,
-      exr_header->tile_size_y, &alloc_success);
-
-    if (!alloc_success) {
-      error_flag |= EF_INVALID_DATA;
-      continue;
+#if TINYEXR_USE_OPENMP
+    std::vector<float> &tile_planes =
+        thread_tile_planes[size_t(omp_get_thread_num())];
+    std::vector<unsigned char *> &tile_images =
+        thread_tile_images[size_t(omp_get_thread_num())];
+#endif
+#endif
+    unsigned char **images = NULL;
+    const float *planes[4] = {NULL, NULL, NULL, NULL};
+    if (rgba_target) {
+      if (tile_planes.empty()) {
+        tile_planes.resize(4 * tile_pixels);
+        // Constant alpha when the target has no A channel.
+        std::fill(tile_planes.begin() + std::ptrdiff_t(3 * tile_pixels),
+                  tile_planes.end(), 1.0f);
+        tile_images.resize(size_t(num_channels));
+      }
+      std::fill(tile_images.begin(), tile_images.end(),
+                static_cast<unsigned char *>(NULL));
+      for (size_t k = 0; k < 4; k++) {
+        int c = rgba_target->channels[k];
+        if (c < 0) {
+          planes[k] = &tile_planes[3 * tile_pixels];
+          continue;
+        }
+        if (!tile_images[size_t(c)]) {
+          tile_images[size_t(c)] =
+              reinterpret_cast<unsigned char *>(&tile_planes[k * tile_pixels]);
+        }
+        planes[k] = reinterpret_cast<const float *>(tile_images[size_t(c)]);
+      }
+      images = &tile_images.at(0);
+    } else {
+      // Allocate memory for each tile.
+      bool alloc_success = false;
+      exr_image->tiles[tile_idx].images = tinyexr::AllocateImage(
+        num_channels, exr_header->channels,
+        exr_header->requested_pixel_types, exr_header->channel_mask,
+        exr_header->tile_size_x, exr_header->tile_size_y, &alloc_success);
+
+      if (!alloc_success) {
+        error_flag |= EF_INVALID_DATA;
+        continue;
+      }
+      images = exr_image->tiles[tile_idx].images;
     }
 
     int x_tile = tile_idx % num_x_tiles;
@@ -6444,6 +6876,11 @@ static int DecodeTiledLevel(EXRImage* exr_image, const EXRHeader* exr_header,
       error_flag |= EF_INVALID_DATA;
       continue;
     }
+    if (rgba_target && (tile_coordinates[0] < 0 || tile_coordinates[1] < 0)) {
+      // Would be written outside of the RGBA framebuffer.
+      error_flag |= EF_INVALID_DATA;
+      continue;
+    }
 
     int data_len;
     memcpy(&data_len, data_ptr + 16,
@@ -6458,10 +6895,10 @@ static int DecodeTiledLevel(EXRImage* exr_image, const EXRHeader* exr_header,
 
     // Move to data addr: 20 = 16 + 4;
     data_ptr += 20;
+    int tile_width = 0;
+    int tile_height = 0;
     bool ret = tinyexr::DecodeTiledPixelData(
-      exr_image->tiles[tile_idx].images,
-      &(exr_image->tiles[tile_idx].width),
-      &(exr_image->tiles[tile_idx].height),
+      images, &tile_width, &tile_height,
       exr_header->requested_pixel_types, data_ptr,
       static_cast<size_t>(data_len), exr_header->compression_type,
       exr_image->width, exr_image->height,
@@ -6477,6 +6914,20 @@ static int DecodeTiledLevel(EXRImage* exr_image, const EXRHeader* exr_header,
       error_flag |= EF_FAILED_TO_DECODE;
     }
 
+    if (rgba_target) {
+      if (ret) {
+        tinyexr::InterleaveTileToRGBA(
+            *rgba_target, exr_image->width, planes,
+            static_cast<size_t>(exr_header->tile_size_x),
+            tile_coordinates[0] * exr_header->tile_size_x,
+            tile_coordinates[1] * exr_header->tile_size_y, tile_width,
+            tile_height);
+      }
+      continue;
+    }
+
+    exr_image->tiles[tile_idx].width = tile_width;
+    exr_image->tiles[tile_idx].height = tile_height;
     exr_image->tiles[tile_idx].offset_x = tile_coordinates[0];
     exr_image->tiles[tile_idx].offset_y = tile_coordinates[1];
     exr_image->tiles[tile_idx].level_x = tile_coordinates[2];
@@ -6484,12 +6935,8 @@ static int DecodeTiledLevel(EXRImage* exr_image, const EXRHeader* exr_header,
 
 #if TINYEXR_HAS_CXX11 && (TINYEXR_USE_THREAD > 0)
   }
-        }));
-    }  // num_thread loop
-
-    for (auto& t : workers) {
-      t.join();
-    }
+        };
+  tinyexr::ParallelFor(num_threads, worker);
 
 #else
   } // parallel for
@@ -6497,7 +6944,7 @@ static int DecodeTiledLevel(EXRImage* exr_image, const EXRHeader* exr_header,
 
   // Even in the event of an error, the reserved memory may be freed.
   exr_image->num_channels = num_channels;
-  exr_image->num_tiles = static_cast<int>(num_tiles);
+  exr_image->num_tiles = rgba_target ? 0 : static_cast<int>(num_tiles);
 
   if (error_flag)  err_code = TINYEXR_ERROR_INVALID_DATA;
   if (err) {
@@ -6511,9 +6958,11 @@ static int DecodeTiledLevel(EXRImage* exr_image, const EXRHeader* exr_header,
   return err_code;
 }
 
+// `rgba_target`(may be NULL) is only used for tiled images. See RGBATarget.
 static int DecodeChunk(EXRImage *exr_image, const EXRHeader *exr_header,
                        const OffsetData& offset_data,
                        const unsigned char *head, const size_t size,
+                       const RGBATarget *rgba_target,
                        std::string *err) {
   int num_channels = exr_header->num_channels;
 
@@ -6529,6 +6978,10 @@ static int DecodeChunk(EXRImage *exr_image, const EXRHeader *exr_header,
   } else if (exr_header->compression_type == TINYEXR_COMPRESSIONTYPE_B44 ||
              exr_header->compression_type == TINYEXR_COMPRESSIONTYPE_B44A) {
     num_scanline_blocks = 32;
+  } else if (exr_header->compression_type == TINYEXR_COMPRESSIONTYPE_DWAA) {
+    num_scanline_blocks = 32;
+  } else if (exr_header->compression_type == TINYEXR_COMPRESSIONTYPE_DWAB) {
+    num_scanline_blocks = 256;
   }
 
 #if TINYEXR_USE_ZFP
@@ -6635,6 +7088,16 @@ static int DecodeChunk(EXRImage *exr_image, const EXRHeader *exr_header,
       }
       return TINYEXR_ERROR_INVALID_HEADER;
     }
+    if (rgba_target) {
+      // Only level 0 ends up in the RGBA framebuffer.
+      exr_image->width = int(data_width);
+      exr_image->height = int(data_height);
+      exr_image->level_x = 0;
+      exr_image->level_y = 0;
+      return DecodeTiledLevel(exr_image, exr_header, offset_data,
+                              channel_offset_list, pixel_data_size, head,
+                              size, rgba_target, err);
+    }
     if (exr_header->tile_level_mode != TINYEXR_TILE_RIPMAP_LEVELS) {
       EXRImage* level_image = NULL;
       for (int level = 0; level < offset_data.num_x_levels; ++level) {
@@ -6666,7 +7129,7 @@ static int DecodeChunk(EXRImage *exr_image, const EXRHeader *exr_header,
           channel_offset_list,
           pixel_data_size,
           head, size,
-          err);
+          NULL, err);
         if (ret != TINYEXR_SUCCESS) return ret;
       }
     } else {
@@ -6701,7 +7164,7 @@ static int DecodeChunk(EXRImage *exr_image, const EXRHeader *exr_header,
             channel_offset_list,
             pixel_data_size,
             head, size,
-            err);
+            NULL, err);
           if (ret != TINYEXR_SUCCESS) return ret;
         }
     }
@@ -6726,7 +7189,8 @@ static int DecodeChunk(EXRImage *exr_image, const EXRHeader *exr_header,
     bool alloc_success = false;
     exr_image->images = tinyexr::AllocateImage(
         num_channels, exr_header->channels, exr_header->requested_pixel_types,
-        int(data_width), int(data_height), &alloc_success);
+        exr_header->channel_mask, int(data_width), int(data_height),
+        &alloc_success);
 
     if (!alloc_success) {
       if (err) {
@@ -6740,18 +7204,10 @@ static int DecodeChunk(EXRImage *exr_image, const EXRHeader *exr_header,
     }
 
 #if TINYEXR_HAS_CXX11 && (TINYEXR_USE_THREAD > 0)
-    std::vector<std::thread> workers;
     std::atomic<int> y_count(0);
 
-    int num_threads = std::max(1, int(std::thread::hardware_concurrency()));
-#if (TINYEXR_MAX_THREADS > 0)
-    num_threads = std::min(num_threads,TINYEXR_MAX_THREADS);
-#endif
-    if (num_threads > int(num_blocks)) {
-      num_threads = int(num_blocks);
-    }
-    for (int t = 0; t < num_threads; t++) {
-      workers.emplace_back(std::thread([&]() {
+    int num_threads = tinyexr::GetNumThreads(exr_header->num_threads, int(num_blocks));
+    auto worker = [&](int) {
         int y = 0;
         while ((y = y_count++) < int(num_blocks)) {
 
@@ -6845,12 +7301,8 @@ static int DecodeChunk(EXRImage *exr_image, const EXRHeader *exr_header,
 
 #if TINYEXR_HAS_CXX11 && (TINYEXR_USE_THREAD > 0)
         }
-      }));
-    }
-
-    for (auto &t : workers) {
-      t.join();
-    }
+      };
+    tinyexr::ParallelFor(num_threads, worker);
 #else
     }  // omp parallel
 #endif
@@ -7356,7 +7808,7 @@ static int ReadOffsets(OffsetData& offset_data,
 static int DecodeEXRImage(EXRImage *exr_image, const EXRHeader *exr_header,
                           const unsigned char *head,
                           const unsigned char *marker, const size_t size,
-                          const char **err) {
+                          const RGBATarget *rgba_target, const char **err) {
   if (exr_image == NULL || exr_header == NULL || head == NULL ||
       marker == NULL || (size <= tinyexr::kEXRVersionSize)) {
     tinyexr::SetErrorMessage("Invalid argument for DecodeEXRImage().", err);
@@ -7375,6 +7827,10 @@ static int DecodeEXRImage(EXRImage *exr_image, const EXRHeader *exr_header,
   } else if (exr_header->compression_type == TINYEXR_COMPRESSIONTYPE_B44 ||
              exr_header->compression_type == TINYEXR_COMPRESSIONTYPE_B44A) {
     num_scanline_blocks = 32;
+  } else if (exr_header->compression_type == TINYEXR_COMPRESSIONTYPE_DWAA) {
+    num_scanline_blocks = 32;
+  } else if (exr_header->compression_type == TINYEXR_COMPRESSIONTYPE_DWAB) {
+    num_scanline_blocks = 256;
   }
 
   if (exr_header->data_window.max_x < exr_header->data_window.min_x ||
@@ -7521,7 +7977,8 @@ static int DecodeEXRImage(EXRImage *exr_image, const EXRHeader *exr_header,
 
   {
     std::string e;
-    int ret = DecodeChunk(exr_image, exr_header, offset_data, head, size, &e);
+    int ret = DecodeChunk(exr_image, exr_header, offset_data, head, size,
+                          rgba_target, &e);
 
     if (ret != TINYEXR_SUCCESS) {
       if (!e.empty()) {
@@ -7602,48 +8059,255 @@ static void ChannelsInLayer(const EXRHeader &exr_header,
 
 }  // namespace tinyexr
 
-int EXRLayers(const char *filename, const char **layer_names[], int *num_layers,
-              const char **err) {
-  EXRVersion exr_version;
-  EXRHeader exr_header;
-  InitEXRHeader(&exr_header);
+// Represents a read-only file mapped to an address space in memory.
+// If no memory-mapping API is available, falls back to allocating a buffer
+// with a copy of the file's data.
+struct MemoryMappedFile {
+  unsigned char *data;  // To the start of the file's data.
+  size_t size;          // The size of the file in bytes.
+#ifdef TINYEXR_USE_WIN32_MMAP
+  HANDLE windows_file;
+  HANDLE windows_file_mapping;
+#elif defined(TINYEXR_USE_POSIX_MMAP)
+  int posix_descriptor;
+#endif
 
-  {
-    int ret = ParseEXRVersionFromFile(&exr_version, filename);
-    if (ret != TINYEXR_SUCCESS) {
-      tinyexr::SetErrorMessage("Invalid EXR header.", err);
-      return ret;
+  // MemoryMappedFile's constructor tries to map memory to a file.
+  // If this succeeds, valid() will return true and all fields
+  // are usable; otherwise, valid() will return false.
+  MemoryMappedFile(const char *filename) {
+    data = NULL;
+    size = 0;
+#ifdef TINYEXR_USE_WIN32_MMAP
+    windows_file_mapping = NULL;
+    windows_file =
+        CreateFileW(tinyexr::UTF8ToWchar(filename).c_str(),  // lpFileName
+                    GENERIC_READ,                            // dwDesiredAccess
+                    FILE_SHARE_READ,                         // dwShareMode
+                    NULL,                     // lpSecurityAttributes
+                    OPEN_EXISTING,            // dwCreationDisposition
+                    FILE_ATTRIBUTE_READONLY,  // dwFlagsAndAttributes
+                    NULL);                    // hTemplateFile
+    if (windows_file == INVALID_HANDLE_VALUE) {
+      return;
     }
 
-    if (exr_version.multipart || exr_version.non_image) {
-      tinyexr::SetErrorMessage(
-          "Loading multipart or DeepImage is not supported  in LoadEXR() API",
-          err);
-      return TINYEXR_ERROR_INVALID_DATA;  // @fixme.
+    windows_file_mapping = CreateFileMapping(windows_file,  // hFile
+                                             NULL,  // lpFileMappingAttributes
+                                             PAGE_READONLY,  // flProtect
+                                             0,      // dwMaximumSizeHigh
+                                             0,      // dwMaximumSizeLow
+                                             NULL);  // lpName
+    if (windows_file_mapping == NULL) {
+      return;
     }
-  }
-
-  int ret = ParseEXRHeaderFromFile(&exr_header, &exr_version, filename, err);
-  if (ret != TINYEXR_SUCCESS) {
-    FreeEXRHeader(&exr_header);
-    return ret;
-  }
-
-  std::vector<std::string> layer_vec;
-  tinyexr::GetLayers(exr_header, layer_vec);
 
-  (*num_layers) = int(layer_vec.size());
-  (*layer_names) = static_cast<const char **>(
-      malloc(sizeof(const char *) * static_cast<size_t>(layer_vec.size())));
-  for (size_t c = 0; c < static_cast<size_t>(layer_vec.size()); c++) {
-#ifdef _MSC_VER
-    (*layer_names)[c] = _strdup(layer_vec[c].c_str());
-#else
-    (*layer_names)[c] = strdup(layer_vec[c].c_str());
-#endif
-  }
+    data = reinterpret_cast<unsigned char *>(
+        MapViewOfFile(windows_file_mapping,  // hFileMappingObject
+                      FILE_MAP_READ,         // dwDesiredAccess
+                      0,                     // dwFileOffsetHigh
+                      0,                     // dwFileOffsetLow
+                      0));                   // dwNumberOfBytesToMap
+    if (!data) {
+      return;
+    }
 
-  FreeEXRHeader(&exr_header);
+    LARGE_INTEGER windows_file_size = {};
+    if (!GetFileSizeEx(windows_file, &windows_file_size) ||
+        static_cast<ULONGLONG>(windows_file_size.QuadPart) >
+            std::numeric_limits<size_t>::max()) {
+      UnmapViewOfFile(data);
+      data = NULL;
+      return;
+    }
+    size = static_cast<size_t>(windows_file_size.QuadPart);
+#elif defined(TINYEXR_USE_POSIX_MMAP)
+    posix_descriptor = open(filename, O_RDONLY);
+    if (posix_descriptor == -1) {
+      return;
+    }
+
+    struct stat info;
+    if (fstat(posix_descriptor, &info) < 0) {
+      return;
+    }
+    // Make sure st_size is in the valid range for a size_t. The second case
+    // can only fail if a POSIX implementation defines off_t to be a larger
+    // type than size_t - for instance, compiling with _FILE_OFFSET_BITS=64
+    // on a 32-bit system. On current 64-bit systems, this check can never
+    // fail, so we turn off clang's Wtautological-type-limit-compare warning
+    // around this code.
+#ifdef __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wtautological-type-limit-compare"
+#endif
+    if (info.st_size < 0 ||
+        info.st_size > std::numeric_limits<ssize_t>::max()) {
+      return;
+    }
+#ifdef __clang__
+#pragma clang diagnostic pop
+#endif
+    size = static_cast<size_t>(info.st_size);
+
+    data = reinterpret_cast<unsigned char *>(
+        mmap(0, size, PROT_READ, MAP_SHARED, posix_descriptor, 0));
+    if (data == MAP_FAILED) {
+      data = nullptr;
+      return;
+    }
+#else
+    FILE *fp = fopen(filename, "rb");
+    if (!fp) {
+      return;
+    }
+
+    // Calling fseek(fp, 0, SEEK_END) isn't strictly-conforming C code, but
+    // since neither the WIN32 nor POSIX APIs are available in this branch, this
+    // is a reasonable fallback option.
+    if (fseek(fp, 0, SEEK_END) != 0) {
+      fclose(fp);
+      return;
+    }
+    const long ftell_result = ftell(fp);
+    if (ftell_result < 0) {
+      // Error from ftell
+      fclose(fp);
+      return;
+    }
+    size = static_cast<size_t>(ftell_result);
+    if (fseek(fp, 0, SEEK_SET) != 0) {
+      fclose(fp);
+      size = 0;
+      return;
+    }
+
+    data = reinterpret_cast<unsigned char *>(malloc(size));
+    if (!data) {
+      size = 0;
+      fclose(fp);
+      return;
+    }
+    size_t read_bytes = fread(data, 1, size, fp);
+    if (read_bytes != size) {
+      // TODO: Try to read data until reading `size` bytes.
+      fclose(fp);
+      size = 0; 
+      data = nullptr;
+      return;
+    }
+    fclose(fp);
+#endif
+  }
+
+  // MemoryMappedFile's destructor closes all its handles.
+  ~MemoryMappedFile() {
+#ifdef TINYEXR_USE_WIN32_MMAP
+    if (data) {
+      (void)UnmapViewOfFile(data);
+      data = NULL;
+    }
+
+    if (windows_file_mapping != NULL) {
+      (void)CloseHandle(windows_file_mapping);
+    }
+
+    if (windows_file != INVALID_HANDLE_VALUE) {
+      (void)CloseHandle(windows_file);
+    }
+#elif defined(TINYEXR_USE_POSIX_MMAP)
+    if (data) {
+      (void)munmap(data, size);
+      data = NULL;
+    }
+
+    if (posix_descriptor != -1) {
+      (void)close(posix_descriptor);
+    }
+#else
+    if (data) {
+      (void)free(data);
+    }
+    data = NULL;
+#endif
+  }
+
+  // A MemoryMappedFile cannot be copied or moved.
+  // Only check for this when compiling with C++11 or higher, since deleted
+  // function definitions were added then.
+#if TINYEXR_HAS_CXX11
+#ifdef __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wc++98-compat"
+#endif
+  MemoryMappedFile(const MemoryMappedFile &) = delete;
+  MemoryMappedFile &operator=(const MemoryMappedFile &) = delete;
+  MemoryMappedFile(MemoryMappedFile &&other) noexcept = delete;
+  MemoryMappedFile &operator=(MemoryMappedFile &&other) noexcept = delete;
+#ifdef __clang__
+#pragma clang diagnostic pop
+#endif
+#endif
+
+  // Returns whether this was successfully opened.
+  bool valid() const { return data; }
+};
+
+int EXRLayers(const char *filename, const char **layer_names[], int *num_layers,
+              const char **err) {
+  EXRVersion exr_version;
+  EXRHeader exr_header;
+  InitEXRHeader(&exr_header);
+
+  if (filename == NULL) {
+    tinyexr::SetErrorMessage("Invalid argument for EXRLayers()", err);
+    return TINYEXR_ERROR_INVALID_ARGUMENT;
+  }
+
+  // Map the file once and parse version and header from the same view.
+  MemoryMappedFile file(filename);
+  if (!file.valid()) {
+    tinyexr::SetErrorMessage("Cannot read file " + std::string(filename), err);
+    return TINYEXR_ERROR_CANT_OPEN_FILE;
+  }
+
+  {
+    int ret = ParseEXRVersionFromMemory(&exr_version, file.data, file.size);
+    if (ret != TINYEXR_SUCCESS) {
+      tinyexr::SetErrorMessage("Invalid EXR header.", err);
+      return ret;
+    }
+
+    if (exr_version.multipart || exr_version.non_image) {
+      tinyexr::SetErrorMessage(
+          "Loading multipart or DeepImage is not supported  in LoadEXR() API",
+          err);
+      return TINYEXR_ERROR_INVALID_DATA;  // @fixme.
+    }
+  }
+
+  int ret = ParseEXRHeaderFromMemory(&exr_header, &exr_version, file.data,
+                                     file.size, err);
+  if (ret != TINYEXR_SUCCESS) {
+    FreeEXRHeader(&exr_header);
+    return ret;
+  }
+
+  std::vector<std::string> layer_vec;
+  tinyexr::GetLayers(exr_header, layer_vec);
+
+  (*num_layers) = int(layer_vec.size());
+  (*layer_names) = static_cast<const char **>(
+      malloc(sizeof(const char *) * static_cast<size_t>(layer_vec.size())));
+  for (size_t c = 0; c < static_cast<size_t>(layer_vec.size()); c++) {
+#ifdef _MSC_VER
+    (*layer_names)[c] = _strdup(layer_vec[c].c_str());
+#else
+    (*layer_names)[c] = strdup(layer_vec[c].c_str());
+#endif
+  }
+
+  FreeEXRHeader(&exr_header);
   return TINYEXR_SUCCESS;
 }
 
@@ -7656,7 +8320,7 @@ int LoadEXR(float **out_rgba, int *width, int *height, const char *filename,
 int LoadEXRWithLayer(float **out_rgba, int *width, int *height,
                      const char *filename, const char *layername,
                      const char **err) {
-  if (out_rgba == NULL) {
+  if (out_rgba == NULL || filename == NULL) {
     tinyexr::SetErrorMessage("Invalid argument for LoadEXR()", err);
     return TINYEXR_ERROR_INVALID_ARGUMENT;
   }
@@ -7667,8 +8331,19 @@ int LoadEXRWithLayer(float **out_rgba, int *width, int *height,
   InitEXRHeader(&exr_header);
   InitEXRImage(&exr_image);
 
+  // Version, header and pixels are all read from this single mapping, so the
+  // file is opened (and mapped) only once per call.
+  MemoryMappedFile file(filename);
+  if (!file.valid()) {
+    std::stringstream ss;
+    ss << "Failed to open EXR file or read version info from EXR file. code("
+       << TINYEXR_ERROR_CANT_OPEN_FILE << ")";
+    tinyexr::SetErrorMessage(ss.str(), err);
+    return TINYEXR_ERROR_CANT_OPEN_FILE;
+  }
+
   {
-    int ret = ParseEXRVersionFromFile(&exr_version, filename);
+    int ret = ParseEXRVersionFromMemory(&exr_version, file.data, file.size);
     if (ret != TINYEXR_SUCCESS) {
       std::stringstream ss;
       ss << "Failed to open EXR file or read version info from EXR file. code("
@@ -7686,23 +8361,8 @@ int LoadEXRWithLayer(float **out_rgba, int *width, int *height,
   }
 
   {
-    int ret = ParseEXRHeaderFromFile(&exr_header, &exr_version, filename, err);
-    if (ret != TINYEXR_SUCCESS) {
-      FreeEXRHeader(&exr_header);
-      return ret;
-    }
-  }
-
-  // Read HALF channel as FLOAT.
-  for (int i = 0; i < exr_header.num_channels; i++) {
-    if (exr_header.pixel_types[i] == TINYEXR_PIXELTYPE_HALF) {
-      exr_header.requested_pixel_types[i] = TINYEXR_PIXELTYPE_FLOAT;
-    }
-  }
-
-  // TODO: Probably limit loading to layers (channels) selected by layer index
-  {
-    int ret = LoadEXRImageFromFile(&exr_image, &exr_header, filename, err);
+    int ret = ParseEXRHeaderFromMemory(&exr_header, &exr_version, file.data,
+                                       file.size, err);
     if (ret != TINYEXR_SUCCESS) {
       FreeEXRHeader(&exr_header);
       return ret;
@@ -7731,7 +8391,6 @@ int LoadEXRWithLayer(float **out_rgba, int *width, int *height,
       tinyexr::SetErrorMessage("Layer Not Found", err);
     }
     FreeEXRHeader(&exr_header);
-    FreeEXRImage(&exr_image);
     return TINYEXR_ERROR_LAYER_NOT_FOUND;
   }
 
@@ -7750,144 +8409,153 @@ int LoadEXRWithLayer(float **out_rgba, int *width, int *height,
     }
   }
 
-  if (channels.size() == 1) {
-    int chIdx = int(channels.front().index);
-    // Grayscale channel only.
+  if (channels.size() > 1) {
+    // Assume RGB(A)
 
-    (*out_rgba) = reinterpret_cast<float *>(
-        malloc(4 * sizeof(float) * static_cast<size_t>(exr_image.width) *
-               static_cast<size_t>(exr_image.height)));
+    if (idxR == -1) {
+      tinyexr::SetErrorMessage("R channel not found", err);
+      FreeEXRHeader(&exr_header);
+      return TINYEXR_ERROR_INVALID_DATA;
+    }
 
-    if (exr_header.tiled) {
-      const size_t tile_size_x = static_cast<size_t>(exr_header.tile_size_x);
-      const size_t tile_size_y = static_cast<size_t>(exr_header.tile_size_y);
-      for (int it = 0; it < exr_image.num_tiles; it++) {
-        for (size_t j = 0; j < tile_size_y; j++) {
-          for (size_t i = 0; i < tile_size_x; i++) {
-            const size_t ii =
-              static_cast<size_t>(exr_image.tiles[it].offset_x) * tile_size_x +
-              i;
-            const size_t jj =
-              static_cast<size_t>(exr_image.tiles[it].offset_y) * tile_size_y +
-              j;
-            const size_t idx = ii + jj * static_cast<size_t>(exr_image.width);
+    if (idxG == -1) {
+      tinyexr::SetErrorMessage("G channel not found", err);
+      FreeEXRHeader(&exr_header);
+      return TINYEXR_ERROR_INVALID_DATA;
+    }
 
-            // out of region check.
-            if (ii >= static_cast<size_t>(exr_image.width)) {
-              continue;
-            }
-            if (jj >= static_cast<size_t>(exr_image.height)) {
-              continue;
-            }
-            const size_t srcIdx = i + j * tile_size_x;
-            unsigned char **src = exr_image.tiles[it].images;
-            (*out_rgba)[4 * idx + 0] =
-                reinterpret_cast<float **>(src)[chIdx][srcIdx];
-            (*out_rgba)[4 * idx + 1] =
-                reinterpret_cast<float **>(src)[chIdx][srcIdx];
-            (*out_rgba)[4 * idx + 2] =
-                reinterpret_cast<float **>(src)[chIdx][srcIdx];
-            (*out_rgba)[4 * idx + 3] =
-                reinterpret_cast<float **>(src)[chIdx][srcIdx];
-          }
-        }
-      }
-    } else {
-      const size_t pixel_size = static_cast<size_t>(exr_image.width) *
-        static_cast<size_t>(exr_image.height);
-      for (size_t i = 0; i < pixel_size; i++) {
-        const float val =
-            reinterpret_cast<float **>(exr_image.images)[chIdx][i];
-        (*out_rgba)[4 * i + 0] = val;
-        (*out_rgba)[4 * i + 1] = val;
-        (*out_rgba)[4 * i + 2] = val;
-        (*out_rgba)[4 * i + 3] = val;
-      }
+    if (idxB == -1) {
+      tinyexr::SetErrorMessage("B channel not found", err);
+      FreeEXRHeader(&exr_header);
+      return TINYEXR_ERROR_INVALID_DATA;
     }
+  }
+
+  // Decode only the channels copied to RGBA below, reading HALF as FLOAT.
+  for (int i = 0; i < exr_header.num_channels; i++) {
+    exr_header.channel_mask[i] = 0;
+  }
+  if (channels.size() == 1) {
+    exr_header.channel_mask[channels.front().index] = 1;
   } else {
-    // Assume RGB(A)
+    exr_header.channel_mask[idxR] = 1;
+    exr_header.channel_mask[idxG] = 1;
+    exr_header.channel_mask[idxB] = 1;
+    if (idxA != -1) {
+      exr_header.channel_mask[idxA] = 1;
+    }
+  }
 
-    if (idxR == -1) {
-      tinyexr::SetErrorMessage("R channel not found", err);
+  for (int i = 0; i < exr_header.num_channels; i++) {
+    if (exr_header.pixel_types[i] == TINYEXR_PIXELTYPE_HALF) {
+      exr_header.requested_pixel_types[i] = TINYEXR_PIXELTYPE_FLOAT;
+    }
+  }
 
+  if (exr_header.tiled) {
+    // Decode tiles straight into `out_rgba`, without per-tile EXRTile images.
+    tinyexr::RGBATarget target;
+    if (channels.size() == 1) {
+      const int chIdx = int(channels.front().index);
+      target.channels[0] = target.channels[1] = chIdx;
+      target.channels[2] = target.channels[3] = chIdx;
+    } else {
+      target.channels[0] = idxR;
+      target.channels[1] = idxG;
+      target.channels[2] = idxB;
+      target.channels[3] = idxA;
+    }
+
+    const tinyexr::tinyexr_int64 data_width =
+        tinyexr::tinyexr_int64(exr_header.data_window.max_x) -
+        tinyexr::tinyexr_int64(exr_header.data_window.min_x) + 1;
+    const tinyexr::tinyexr_int64 data_height =
+        tinyexr::tinyexr_int64(exr_header.data_window.max_y) -
+        tinyexr::tinyexr_int64(exr_header.data_window.min_y) + 1;
+    if (data_width <= 0 || data_height <= 0 ||
+        data_width > TINYEXR_DIMENSION_THRESHOLD ||
+        data_height > TINYEXR_DIMENSION_THRESHOLD) {
+      tinyexr::SetErrorMessage("Invalid data window", err);
       FreeEXRHeader(&exr_header);
-      FreeEXRImage(&exr_image);
       return TINYEXR_ERROR_INVALID_DATA;
     }
 
-    if (idxG == -1) {
-      tinyexr::SetErrorMessage("G channel not found", err);
+    target.rgba = reinterpret_cast<float *>(
+        malloc(4 * sizeof(float) * static_cast<size_t>(data_width) *
+               static_cast<size_t>(data_height)));
+    if (!target.rgba) {
+      tinyexr::SetErrorMessage("Failed to allocate memory for RGBA image",
+                               err);
       FreeEXRHeader(&exr_header);
-      FreeEXRImage(&exr_image);
       return TINYEXR_ERROR_INVALID_DATA;
     }
 
-    if (idxB == -1) {
-      tinyexr::SetErrorMessage("B channel not found", err);
+    const unsigned char *marker =
+        file.data + exr_header.header_len + 8;  // +8 for magic and version.
+    int ret = tinyexr::DecodeEXRImage(&exr_image, &exr_header, file.data,
+                                      marker, file.size, &target, err);
+    if (ret != TINYEXR_SUCCESS) {
+      free(target.rgba);
       FreeEXRHeader(&exr_header);
-      FreeEXRImage(&exr_image);
-      return TINYEXR_ERROR_INVALID_DATA;
+      return ret;
+    }
+
+    (*out_rgba) = target.rgba;
+    (*width) = exr_image.width;
+    (*height) = exr_image.height;
+
+    FreeEXRHeader(&exr_header);
+    FreeEXRImage(&exr_image);
+
+    return TINYEXR_SUCCESS;
+  }
+
+  {
+    int ret = LoadEXRImageFromMemory(&exr_image, &exr_header, file.data,
+                                     file.size, err);
+    if (ret != TINYEXR_SUCCESS) {
+      FreeEXRHeader(&exr_header);
+      return ret;
     }
+  }
+
+  if (channels.size() == 1) {
+    int chIdx = int(channels.front().index);
+    // Grayscale channel only.
 
     (*out_rgba) = reinterpret_cast<float *>(
         malloc(4 * sizeof(float) * static_cast<size_t>(exr_image.width) *
                static_cast<size_t>(exr_image.height)));
-    if (exr_header.tiled) {
-      const size_t tile_size_x = static_cast<size_t>(exr_header.tile_size_x);
-      const size_t tile_size_y = static_cast<size_t>(exr_header.tile_size_y);
-      for (int it = 0; it < exr_image.num_tiles; it++) {
-        for (size_t j = 0; j < tile_size_y; j++) {
-          for (size_t i = 0; i < tile_size_x; i++) {
-            const size_t ii =
-                static_cast<size_t>(exr_image.tiles[it].offset_x) *
-                    tile_size_x +
-                i;
-            const size_t jj =
-                static_cast<size_t>(exr_image.tiles[it].offset_y) *
-                    tile_size_y +
-                j;
-            const size_t idx = ii + jj * static_cast<size_t>(exr_image.width);
 
-            // out of region check.
-            if (ii >= static_cast<size_t>(exr_image.width)) {
-              continue;
-            }
-            if (jj >= static_cast<size_t>(exr_image.height)) {
-              continue;
-            }
-            const size_t srcIdx = i + j * tile_size_x;
-            unsigned char **src = exr_image.tiles[it].images;
-            (*out_rgba)[4 * idx + 0] =
-                reinterpret_cast<float **>(src)[idxR][srcIdx];
-            (*out_rgba)[4 * idx + 1] =
-                reinterpret_cast<float **>(src)[idxG][srcIdx];
-            (*out_rgba)[4 * idx + 2] =
-                reinterpret_cast<float **>(src)[idxB][srcIdx];
-            if (idxA != -1) {
-              (*out_rgba)[4 * idx + 3] =
-                  reinterpret_cast<float **>(src)[idxA][srcIdx];
-            } else {
-              (*out_rgba)[4 * idx + 3] = 1.0;
-            }
-          }
-        }
-      }
-    } else {
-      const size_t pixel_size = static_cast<size_t>(exr_image.width) *
-        static_cast<size_t>(exr_image.height);
-      for (size_t i = 0; i < pixel_size; i++) {
-        (*out_rgba)[4 * i + 0] =
-            reinterpret_cast<float **>(exr_image.images)[idxR][i];
-        (*out_rgba)[4 * i + 1] =
-            reinterpret_cast<float **>(exr_image.images)[idxG][i];
-        (*out_rgba)[4 * i + 2] =
-            reinterpret_cast<float **>(exr_image.images)[idxB][i];
-        if (idxA != -1) {
-          (*out_rgba)[4 * i + 3] =
-              reinterpret_cast<float **>(exr_image.images)[idxA][i];
-        } else {
-          (*out_rgba)[4 * i + 3] = 1.0;
-        }
+    const size_t pixel_size = static_cast<size_t>(exr_image.width) *
+      static_cast<size_t>(exr_image.height);
+    for (size_t i = 0; i < pixel_size; i++) {
+      const float val =
+          reinterpret_cast<float **>(exr_image.images)[chIdx][i];
+      (*out_rgba)[4 * i + 0] = val;
+      (*out_rgba)[4 * i + 1] = val;
+      (*out_rgba)[4 * i + 2] = val;
+      (*out_rgba)[4 * i + 3] = val;
+    }
+  } else {
+    // Assume RGB(A)
+    (*out_rgba) = reinterpret_cast<float *>(
+        malloc(4 * sizeof(float) * static_cast<size_t>(exr_image.width) *
+               static_cast<size_t>(exr_image.height)));
+    const size_t pixel_size = static_cast<size_t>(exr_image.width) *
+      static_cast<size_t>(exr_image.height);
+    for (size_t i = 0; i < pixel_size; i++) {
+      (*out_rgba)[4 * i + 0] =
+          reinterpret_cast<float **>(exr_image.images)[idxR][i];
+      (*out_rgba)[4 * i + 1] =
+          reinterpret_cast<float **>(exr_image.images)[idxG][i];
+      (*out_rgba)[4 * i + 2] =
+          reinterpret_cast<float **>(exr_image.images)[idxB][i];
+      if (idxA != -1) {
+        (*out_rgba)[4 * i + 3] =
+            reinterpret_cast<float **>(exr_image.images)[idxA][i];
+      } else {
+        (*out_rgba)[4 * i + 3] = 1.0;
       }
     }
   }
@@ -8018,6 +8686,16 @@ int LoadEXRFromMemory(float **out_rgba, int *width, int *height,
     }
   }
 
+  // Only R, G, B and A are copied to RGBA below.
+  if (exr_header.num_channels > 1) {
+    for (int c = 0; c < exr_header.num_channels; c++) {
+      const char *name = exr_header.channels[c].name;
+      exr_header.channel_mask[c] =
+          (strcmp(name, "R") == 0 || strcmp(name, "G") == 0 ||
+           strcmp(name, "B") == 0 || strcmp(name, "A") == 0) ? 1 : 0;
+    }
+  }
+
   InitEXRImage(&exr_image);
   ret = LoadEXRImageFromMemory(&exr_image, &exr_header, memory, size, err);
   if (ret != TINYEXR_SUCCESS) {
@@ -8099,293 +8777,99 @@ int LoadEXRFromMemory(float **out_rgba, int *width, int *height,
       }
     }
 
-  } else {
-    // TODO(syoyo): Support non RGBA image.
-
-    if (idxR == -1) {
-      tinyexr::SetErrorMessage("R channel not found", err);
-
-      // @todo { free exr_image }
-      return TINYEXR_ERROR_INVALID_DATA;
-    }
-
-    if (idxG == -1) {
-      tinyexr::SetErrorMessage("G channel not found", err);
-      // @todo { free exr_image }
-      return TINYEXR_ERROR_INVALID_DATA;
-    }
-
-    if (idxB == -1) {
-      tinyexr::SetErrorMessage("B channel not found", err);
-      // @todo { free exr_image }
-      return TINYEXR_ERROR_INVALID_DATA;
-    }
-
-    (*out_rgba) = reinterpret_cast<float *>(
-        malloc(4 * sizeof(float) * static_cast<size_t>(exr_image.width) *
-               static_cast<size_t>(exr_image.height)));
-
-    if (exr_header.tiled) {
-      const size_t tile_size_x = static_cast<size_t>(exr_header.tile_size_x);
-      const size_t tile_size_y = static_cast<size_t>(exr_header.tile_size_y);
-      for (int it = 0; it < exr_image.num_tiles; it++) {
-        for (size_t j = 0; j < tile_size_y; j++)
-          for (size_t i = 0; i < tile_size_x; i++) {
-            const size_t ii =
-                static_cast<size_t>(exr_image.tiles[it].offset_x) *
-                    tile_size_x +
-                i;
-            const size_t jj =
-                static_cast<size_t>(exr_image.tiles[it].offset_y) *
-                    tile_size_y +
-                j;
-            const size_t idx = ii + jj * static_cast<size_t>(exr_image.width);
-
-            // out of region check.
-            if (ii >= static_cast<size_t>(exr_image.width)) {
-              continue;
-            }
-            if (jj >= static_cast<size_t>(exr_image.height)) {
-              continue;
-            }
-            const size_t srcIdx = i + j * tile_size_x;
-            unsigned char **src = exr_image.tiles[it].images;
-            (*out_rgba)[4 * idx + 0] =
-                reinterpret_cast<float **>(src)[idxR][srcIdx];
-            (*out_rgba)[4 * idx + 1] =
-                reinterpret_cast<float **>(src)[idxG][srcIdx];
-            (*out_rgba)[4 * idx + 2] =
-                reinterpret_cast<float **>(src)[idxB][srcIdx];
-            if (idxA != -1) {
-              (*out_rgba)[4 * idx + 3] =
-                  reinterpret_cast<float **>(src)[idxA][srcIdx];
-            } else {
-              (*out_rgba)[4 * idx + 3] = 1.0;
-            }
-          }
-      }
-    } else {
-      const size_t pixel_size = static_cast<size_t>(exr_image.width) *
-        static_cast<size_t>(exr_image.height);
-      for (size_t i = 0; i < pixel_size; i++) {
-        (*out_rgba)[4 * i + 0] =
-            reinterpret_cast<float **>(exr_image.images)[idxR][i];
-        (*out_rgba)[4 * i + 1] =
-            reinterpret_cast<float **>(exr_image.images)[idxG][i];
-        (*out_rgba)[4 * i + 2] =
-            reinterpret_cast<float **>(exr_image.images)[idxB][i];
-        if (idxA != -1) {
-          (*out_rgba)[4 * i + 3] =
-              reinterpret_cast<float **>(exr_image.images)[idxA][i];
-        } else {
-          (*out_rgba)[4 * i + 3] = 1.0;
-        }
-      }
-    }
-  }
-
-  (*width) = exr_image.width;
-  (*height) = exr_image.height;
-
-  FreeEXRHeader(&exr_header);
-  FreeEXRImage(&exr_image);
-
-  return TINYEXR_SUCCESS;
-}
-
-// Represents a read-only file mapped to an address space in memory.
-// If no memory-mapping API is available, falls back to allocating a buffer
-// with a copy of the file's data.
-struct MemoryMappedFile {
-  unsigned char *data;  // To the start of the file's data.
-  size_t size;          // The size of the file in bytes.
-#ifdef TINYEXR_USE_WIN32_MMAP
-  HANDLE windows_file;
-  HANDLE windows_file_mapping;
-#elif defined(TINYEXR_USE_POSIX_MMAP)
-  int posix_descriptor;
-#endif
-
-  // MemoryMappedFile's constructor tries to map memory to a file.
-  // If this succeeds, valid() will return true and all fields
-  // are usable; otherwise, valid() will return false.
-  MemoryMappedFile(const char *filename) {
-    data = NULL;
-    size = 0;
-#ifdef TINYEXR_USE_WIN32_MMAP
-    windows_file_mapping = NULL;
-    windows_file =
-        CreateFileW(tinyexr::UTF8ToWchar(filename).c_str(),  // lpFileName
-                    GENERIC_READ,                            // dwDesiredAccess
-                    FILE_SHARE_READ,                         // dwShareMode
-                    NULL,                     // lpSecurityAttributes
-                    OPEN_EXISTING,            // dwCreationDisposition
-                    FILE_ATTRIBUTE_READONLY,  // dwFlagsAndAttributes
-                    NULL);                    // hTemplateFile
-    if (windows_file == INVALID_HANDLE_VALUE) {
-      return;
-    }
-
-    windows_file_mapping = CreateFileMapping(windows_file,  // hFile
-                                             NULL,  // lpFileMappingAttributes
-                                             PAGE_READONLY,  // flProtect
-                                             0,      // dwMaximumSizeHigh
-                                             0,      // dwMaximumSizeLow
-                                             NULL);  // lpName
-    if (windows_file_mapping == NULL) {
-      return;
-    }
-
-    data = reinterpret_cast<unsigned char *>(
-        MapViewOfFile(windows_file_mapping,  // hFileMappingObject
-                      FILE_MAP_READ,         // dwDesiredAccess
-                      0,                     // dwFileOffsetHigh
-                      0,                     // dwFileOffsetLow
-                      0));                   // dwNumberOfBytesToMap
-    if (!data) {
-      return;
-    }
-
-    LARGE_INTEGER windows_file_size = {};
-    if (!GetFileSizeEx(windows_file, &windows_file_size) ||
-        static_cast<ULONGLONG>(windows_file_size.QuadPart) >
-            std::numeric_limits<size_t>::max()) {
-      UnmapViewOfFile(data);
-      data = NULL;
-      return;
-    }
-    size = static_cast<size_t>(windows_file_size.QuadPart);
-#elif defined(TINYEXR_USE_POSIX_MMAP)
-    posix_descriptor = open(filename, O_RDONLY);
-    if (posix_descriptor == -1) {
-      return;
-    }
-
-    struct stat info;
-    if (fstat(posix_descriptor, &info) < 0) {
-      return;
-    }
-    // Make sure st_size is in the valid range for a size_t. The second case
-    // can only fail if a POSIX implementation defines off_t to be a larger
-    // type than size_t - for instance, compiling with _FILE_OFFSET_BITS=64
-    // on a 32-bit system. On current 64-bit systems, this check can never
-    // fail, so we turn off clang's Wtautological-type-limit-compare warning
-    // around this code.
-#ifdef __clang__
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Wtautological-type-limit-compare"
-#endif
-    if (info.st_size < 0 ||
-        info.st_size > std::numeric_limits<ssize_t>::max()) {
-      return;
-    }
-#ifdef __clang__
-#pragma clang diagnostic pop
-#endif
-    size = static_cast<size_t>(info.st_size);
+  } else {
+    // TODO(syoyo): Support non RGBA image.
 
-    data = reinterpret_cast<unsigned char *>(
-        mmap(0, size, PROT_READ, MAP_SHARED, posix_descriptor, 0));
-    if (data == MAP_FAILED) {
-      data = nullptr;
-      return;
-    }
-#else
-    FILE *fp = fopen(filename, "rb");
-    if (!fp) {
-      return;
-    }
+    if (idxR == -1) {
+      tinyexr::SetErrorMessage("R channel not found", err);
 
-    // Calling fseek(fp, 0, SEEK_END) isn't strictly-conforming C code, but
-    // since neither the WIN32 nor POSIX APIs are available in this branch, this
-    // is a reasonable fallback option.
-    if (fseek(fp, 0, SEEK_END) != 0) {
-      fclose(fp);
-      return;
-    }
-    const long ftell_result = ftell(fp);
-    if (ftell_result < 0) {
-      // Error from ftell
-      fclose(fp);
-      return;
-    }
-    size = static_cast<size_t>(ftell_result);
-    if (fseek(fp, 0, SEEK_SET) != 0) {
-      fclose(fp);
-      size = 0;
-      return;
+      // @todo { free exr_image }
+      return TINYEXR_ERROR_INVALID_DATA;
     }
 
-    data = reinterpret_cast<unsigned char *>(malloc(size));
-    if (!data) {
-      size = 0;
-      fclose(fp);
-      return;
-    }
-    size_t read_bytes = fread(data, 1, size, fp);
-    if (read_bytes != size) {
-      // TODO: Try to read data until reading `size` bytes.
-      fclose(fp);
-      size = 0; 
-      data = nullptr;
-      return;
+    if (idxG == -1) {
+      tinyexr::SetErrorMessage("G channel not found", err);
+      // @todo { free exr_image }
+      return TINYEXR_ERROR_INVALID_DATA;
     }
-    fclose(fp);
-#endif
-  }
 
-  // MemoryMappedFile's destructor closes all its handles.
-  ~MemoryMappedFile() {
-#ifdef TINYEXR_USE_WIN32_MMAP
-    if (data) {
-      (void)UnmapViewOfFile(data);
-      data = NULL;
+    if (idxB == -1) {
+      tinyexr::SetErrorMessage("B channel not found", err);
+      // @todo { free exr_image }
+      return TINYEXR_ERROR_INVALID_DATA;
     }
 
-    if (windows_file_mapping != NULL) {
-      (void)CloseHandle(windows_file_mapping);
-    }
+    (*out_rgba) = reinterpret_cast<float *>(
+        malloc(4 * sizeof(float) * static_cast<size_t>(exr_image.width) *
+               static_cast<size_t>(exr_image.height)));
 
-    if (windows_file != INVALID_HANDLE_VALUE) {
-      (void)CloseHandle(windows_file);
-    }
-#elif defined(TINYEXR_USE_POSIX_MMAP)
-    if (data) {
-      (void)munmap(data, size);
-      data = NULL;
-    }
+    if (exr_header.tiled) {
+      const size_t tile_size_x = static_cast<size_t>(exr_header.tile_size_x);
+      const size_t tile_size_y = static_cast<size_t>(exr_header.tile_size_y);
+      for (int it = 0; it < exr_image.num_tiles; it++) {
+        for (size_t j = 0; j < tile_size_y; j++)
+          for (size_t i = 0; i < tile_size_x; i++) {
+            const size_t ii =
+                static_cast<size_t>(exr_image.tiles[it].offset_x) *
+                    tile_size_x +
+                i;
+            const size_t jj =
+                static_cast<size_t>(exr_image.tiles[it].offset_y) *
+                    tile_size_y +
+                j;
+            const size_t idx = ii + jj * static_cast<size_t>(exr_image.width);
 
-    if (posix_descriptor != -1) {
-      (void)close(posix_descriptor);
-    }
-#else
-    if (data) {
-      (void)free(data);
+            // out of region check.
+            if (ii >= static_cast<size_t>(exr_image.width)) {
+              continue;
+            }
+            if (jj >= static_cast<size_t>(exr_image.height)) {
+              continue;
+            }
+            const size_t srcIdx = i + j * tile_size_x;
+            unsigned char **src = exr_image.tiles[it].images;
+            (*out_rgba)[4 * idx + 0] =
+                reinterpret_cast<float **>(src)[idxR][srcIdx];
+            (*out_rgba)[4 * idx + 1] =
+                reinterpret_cast<float **>(src)[idxG][srcIdx];
+            (*out_rgba)[4 * idx + 2] =
+                reinterpret_cast<float **>(src)[idxB][srcIdx];
+            if (idxA != -1) {
+              (*out_rgba)[4 * idx + 3] =
+                  reinterpret_cast<float **>(src)[idxA][srcIdx];
+            } else {
+              (*out_rgba)[4 * idx + 3] = 1.0;
+            }
+          }
+      }
+    } else {
+      const size_t pixel_size = static_cast<size_t>(exr_image.width) *
+        static_cast<size_t>(exr_image.height);
+      for (size_t i = 0; i < pixel_size; i++) {
+        (*out_rgba)[4 * i + 0] =
+            reinterpret_cast<float **>(exr_image.images)[idxR][i];
+        (*out_rgba)[4 * i + 1] =
+            reinterpret_cast<float **>(exr_image.images)[idxG][i];
+        (*out_rgba)[4 * i + 2] =
+            reinterpret_cast<float **>(exr_image.images)[idxB][i];
+        if (idxA != -1) {
+          (*out_rgba)[4 * i + 3] =
+              reinterpret_cast<float **>(exr_image.images)[idxA][i];
+        } else {
+          (*out_rgba)[4 * i + 3] = 1.0;
+        }
+      }
     }
-    data = NULL;
-#endif
   }
 
-  // A MemoryMappedFile cannot be copied or moved.
-  // Only check for this when compiling with C++11 or higher, since deleted
-  // function definitions were added then.
-#if TINYEXR_HAS_CXX11
-#ifdef __clang__
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Wc++98-compat"
-#endif
-  MemoryMappedFile(const MemoryMappedFile &) = delete;
-  MemoryMappedFile &operator=(const MemoryMappedFile &) = delete;
-  MemoryMappedFile(MemoryMappedFile &&other) noexcept = delete;
-  MemoryMappedFile &operator=(MemoryMappedFile &&other) noexcept = delete;
-#ifdef __clang__
-#pragma clang diagnostic pop
-#endif
-#endif
+  (*width) = exr_image.width;
+  (*height) = exr_image.height;
 
-  // Returns whether this was successfully opened.
-  bool valid() const { return data; }
-};
+  FreeEXRHeader(&exr_header);
+  FreeEXRImage(&exr_image);
+
+  return TINYEXR_SUCCESS;
+}
 
 int LoadEXRImageFromFile(EXRImage *exr_image, const EXRHeader *exr_header,
                          const char *filename, const char **err) {
@@ -8430,7 +8914,7 @@ int LoadEXRImageFromMemory(EXRImage *exr_image, const EXRHeader *exr_header,
       memory + exr_header->header_len +
       8);  // +8 for magic number + version header.
   return tinyexr::DecodeEXRImage(exr_image, exr_header, head, marker, size,
-                                 err);
+                                 NULL, err);
 }
 
 namespace tinyexr
@@ -8456,7 +8940,7 @@ static bool EncodePixelData(/* out */ std::vector<unsigned char>& out_data,
                             const std::vector<ChannelInfo>& channels,
                             const std::vector<size_t>& channel_offset_list,
                             std::string *err,
-                            const void* compression_param = 0) // zfp compression param
+                            const void* compression_param = 0) // zfp param or dwa level
 {
   size_t buf_size = static_cast<size_t>(width) *
                   static_cast<size_t>(num_lines) *
@@ -8727,6 +9211,29 @@ static bool EncodePixelData(/* out */ std::vector<unsigned char>& out_data,
 
     out_data.insert(out_data.end(), block.begin(), block.end());
 
+  } else if (compression_type == TINYEXR_COMPRESSIONTYPE_DWAA ||
+             compression_type == TINYEXR_COMPRESSIONTYPE_DWAB) {
+#if TINYEXR_HAS_CXX11
+    const float* dwa_level = reinterpret_cast<const float*>(compression_param);
+    std::vector<unsigned char> block;
+
+    if (!tinyexr::CompressDwa(block, &buf.at(0), buf.size(), width, line_no,
+                              num_lines, channels,
+                              dwa_level ? *dwa_level
+                                        : tinyexr::dwa::DEFAULT_COMPRESSION_LEVEL)) {
+      if (err) {
+        (*err) += "DWA compression failed.\n";
+      }
+      return false;
+    }
+
+    out_data.insert(out_data.end(), block.begin(), block.end());
+#else
+    if (err) {
+      (*err) += "DWAA/DWAB compression requires C++11.\n";
+    }
+    return false;
+#endif
   } else {
     return false;
   }
@@ -8767,19 +9274,10 @@ static int EncodeTiledLevel(const EXRImage* level_image, const EXRHeader* exr_he
 #endif
 
 #if TINYEXR_HAS_CXX11 && (TINYEXR_USE_THREAD > 0)
-  std::vector<std::thread> workers;
   std::atomic<int> tile_count(0);
 
-  int num_threads = std::max(1, int(std::thread::hardware_concurrency()));
-#if (TINYEXR_MAX_THREADS > 0)
-  num_threads = std::min(num_threads,TINYEXR_MAX_THREADS);
-#endif
-  if (num_threads > int(num_tiles)) {
-    num_threads = int(num_tiles);
-  }
-
-  for (int t = 0; t < num_threads; t++) {
-    workers.emplace_back(std::thread([&]() {
+  int num_threads = tinyexr::GetNumThreads(exr_header->num_threads, num_tiles);
+  auto worker = [&](int) {
       int i = 0;
       while ((i = tile_count++) < num_tiles) {
 
@@ -8843,12 +9341,8 @@ static int EncodeTiledLevel(const EXRImage* level_image, const EXRHeader* exr_he
 
 #if TINYEXR_HAS_CXX11 && (TINYEXR_USE_THREAD > 0)
   }
-}));
-    }
-
-    for (auto &t : workers) {
-      t.join();
-    }
+};
+  tinyexr::ParallelFor(num_threads, worker);
 #else
     }  // omp parallel
 #endif
@@ -8875,6 +9369,10 @@ static int NumScanlines(int compression_type) {
   } else if (compression_type == TINYEXR_COMPRESSIONTYPE_B44 ||
              compression_type == TINYEXR_COMPRESSIONTYPE_B44A) {
     num_scanlines = 32;  // B44/B44A uses 32 scanlines per block
+  } else if (compression_type == TINYEXR_COMPRESSIONTYPE_DWAA) {
+    num_scanlines = 32;
+  } else if (compression_type == TINYEXR_COMPRESSIONTYPE_DWAB) {
+    num_scanlines = 256;
   }
   return num_scanlines;
 }
@@ -8939,6 +9437,15 @@ static int EncodeChunk(const EXRImage* exr_image, const EXRHeader* exr_header,
     compression_param = &zfp_compression_param;
   }
 #endif
+#if TINYEXR_HAS_CXX11
+  float dwa_level = 0.0f;
+  if (exr_header->compression_type == TINYEXR_COMPRESSIONTYPE_DWAA ||
+      exr_header->compression_type == TINYEXR_COMPRESSIONTYPE_DWAB) {
+    dwa_level = tinyexr::FindDwaCompressionLevel(
+      exr_header->custom_attributes, exr_header->num_custom_attributes);
+    compression_param = &dwa_level;
+  }
+#endif
 
   tinyexr_uint64 offset = chunk_offset;
   tinyexr_uint64 doffset = is_multipart ? 4u : 0u;
@@ -9024,15 +9531,10 @@ static int EncodeChunk(const EXRImage* exr_image, const EXRHeader* exr_header,
 
 #if TINYEXR_HAS_CXX11 && (TINYEXR_USE_THREAD > 0)
     std::atomic<bool> invalid_data(false);
-    std::vector<std::thread> workers;
     std::atomic<int> block_count(0);
 
-    int num_threads = std::min(std::max(1, int(std::thread::hardware_concurrency())), num_blocks);
-#if (TINYEXR_MAX_THREADS > 0)
-    num_threads = std::min(num_threads,TINYEXR_MAX_THREADS);
-#endif
-    for (int t = 0; t < num_threads; t++) {
-      workers.emplace_back(std::thread([&]() {
+    int num_threads = tinyexr::GetNumThreads(exr_header->num_threads, num_blocks);
+    auto worker = [&](int) {
         int i = 0;
         while ((i = block_count++) < num_blocks) {
 
@@ -9084,12 +9586,8 @@ static int EncodeChunk(const EXRImage* exr_image, const EXRHeader* exr_header,
       swap4(reinterpret_cast<int*>(&data_list[i][4]));
 #if TINYEXR_HAS_CXX11 && (TINYEXR_USE_THREAD > 0)
         }
-                                       }));
-    }
-
-    for (auto &t : workers) {
-      t.join();
-    }
+      };
+    tinyexr::ParallelFor(num_threads, worker);
 #else
     }  // omp parallel
 #endif
@@ -9136,6 +9634,13 @@ static size_t SaveEXRNPartImageToMemory(const EXRImage* exr_images,
                         err);
         return 0;
       }
+#endif
+#if !TINYEXR_HAS_CXX11
+      if (exr_headers[i]->compression_type == TINYEXR_COMPRESSIONTYPE_DWAA ||
+          exr_headers[i]->compression_type == TINYEXR_COMPRESSIONTYPE_DWAB) {
+        SetErrorMessage("DWAA/DWAB compression requires C++11", err);
+        return 0;
+      }
 #endif
       if (exr_headers[i]->compression_type == TINYEXR_COMPRESSIONTYPE_ZFP) {
 #if !TINYEXR_USE_ZFP
@@ -9529,6 +10034,14 @@ int SaveEXRImageToFile(const EXRImage *exr_image, const EXRHeader *exr_header,
   }
 #endif
 
+#if !TINYEXR_HAS_CXX11
+  if (exr_header->compression_type == TINYEXR_COMPRESSIONTYPE_DWAA ||
+      exr_header->compression_type == TINYEXR_COMPRESSIONTYPE_DWAB) {
+    tinyexr::SetErrorMessage("DWAA/DWAB compression requires C++11", err);
+    return TINYEXR_ERROR_UNSUPPORTED_FEATURE;
+  }
+#endif
+
   FILE *fp = NULL;
 #ifdef _WIN32
 #if defined(_MSC_VER) || (defined(MINGW_HAS_SECURE_API) && MINGW_HAS_SECURE_API) // MSVC, MinGW GCC, or Clang
@@ -10035,6 +10548,24 @@ void InitEXRHeader(EXRHeader *exr_header) {
   memset(exr_header, 0, sizeof(EXRHeader));
 }
 
+void EXRSetParallelFor(EXRParallelForFunc func, void *userdata) {
+#if TINYEXR_HAS_CXX11 && (TINYEXR_USE_THREAD > 0)
+  tinyexr::ParallelForHook &hook = tinyexr::GetParallelForHook();
+  std::lock_guard<std::mutex> lock(hook.mutex);
+  hook.func = func;
+  hook.userdata = userdata;
+#else
+  (void)func;
+  (void)userdata;
+#endif
+}
+
+void EXRShutdownThreadPool(void) {
+#if TINYEXR_HAS_CXX11 && (TINYEXR_USE_THREAD > 0)
+  tinyexr::GetThreadPool().Shutdown();
+#endif
+}
+
 int FreeEXRHeader(EXRHeader *exr_header) {
   if (exr_header == NULL) {
     return TINYEXR_ERROR_INVALID_ARGUMENT;
@@ -10052,6 +10583,10 @@ int FreeEXRHeader(EXRHeader *exr_header) {
     free(exr_header->requested_pixel_types);
   }
 
+  if (exr_header->channel_mask) {
+    free(exr_header->channel_mask);
+  }
+
   for (int i = 0; i < exr_header->num_custom_attributes; i++) {
     if (exr_header->custom_attributes[i].value) {
       free(exr_header->custom_attributes[i].value);
@@ -10518,7 +11053,7 @@ int LoadEXRMultipartImageFromMemory(EXRImage *exr_images,
 
     std::string e;
     int ret = tinyexr::DecodeChunk(&exr_images[i], exr_headers[i], offset_data,
-                                   memory, size, &e);
+                                   memory, size, NULL, &e);
     if (ret != TINYEXR_SUCCESS) {
       if (!e.empty()) {
         tinyexr::SetErrorMessage(e, err);
@@ -11190,26 +11725,12 @@ int EXRSetSpectralAttributes(EXRHeader *exr_header,
 
 // Check if file contains spectral data
 int IsSpectralEXR(const char *filename) {
-  EXRVersion version;
-  int ret = ParseEXRVersionFromFile(&version, filename);
-  if (ret != TINYEXR_SUCCESS) return ret;
-
-  const char *err = NULL;
-  EXRHeader header;
-  InitEXRHeader(&header);
-
-  ret = ParseEXRHeaderFromFile(&header, &version, filename, &err);
-  if (ret != TINYEXR_SUCCESS) {
-    if (err) FreeEXRErrorMessage(err);
-    return ret;
-  }
-
-  // Check for spectralLayoutVersion attribute
-  int is_spectral = (FindCustomAttribute(&header, "spectralLayoutVersion") != NULL);
+  if (filename == NULL) return TINYEXR_ERROR_INVALID_ARGUMENT;
 
-  FreeEXRHeader(&header);
+  MemoryMappedFile file(filename);
+  if (!file.valid()) return TINYEXR_ERROR_CANT_OPEN_FILE;
 
-  return is_spectral ? TINYEXR_SUCCESS : TINYEXR_ERROR_INVALID_DATA;
+  return IsSpectralEXRFromMemory(file.data, file.size);
 }
 
 // Check if memory contains spectral EXR data
@@ -12,6 +12,11 @@
  * - No exceptions, no RTTI
  * - Thread-safe error reporting
  *
+ * Create-info, request and data source structs must be zero-initialized
+ * (`= {0}` or memset) before their fields are set. Fields added in later
+ * versions are appended and treat 0/NULL as "not used", so code written
+ * against an older header keeps its behavior only if it zeroes the struct.
+ *
  * Copyright (c) 2024 TinyEXR authors
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -30,8 +35,11 @@ extern "C" {
  * Version
  * ============================================================================ */
 
+/* 3.1 appended fields to ExrDataSource (embedded in ExrDecoderCreateInfo),
+ * ExrSubmitInfo, the read requests and ExrWriteImageCreateInfo, so binaries
+ * built against 3.0 headers are rejected by exr_context_create. */
 #define TINYEXR_C_API_VERSION_MAJOR 3
-#define TINYEXR_C_API_VERSION_MINOR 0
+#define TINYEXR_C_API_VERSION_MINOR 1
 #define TINYEXR_C_API_VERSION_PATCH 0
 #define TINYEXR_C_API_VERSION \
     ((TINYEXR_C_API_VERSION_MAJOR << 22) | \
@@ -136,7 +144,7 @@ typedef enum ExrCompression {
     EXR_COMPRESSION_PXR24 = 5,     /* 24-bit float, 16 scanlines */
     EXR_COMPRESSION_B44 = 6,       /* Lossy 4x4 blocks, 32 scanlines */
     EXR_COMPRESSION_B44A = 7,      /* B44 with alpha, 32 scanlines */
-    EXR_COMPRESSION_DWAA = 8,      /* Lossy DCT, single scanline */
+    EXR_COMPRESSION_DWAA = 8,      /* Lossy DCT, 32 scanlines */
     EXR_COMPRESSION_DWAB = 9,      /* Lossy DCT, 256 scanlines */
 } ExrCompression;
 
@@ -215,6 +223,32 @@ typedef ExrResult (*ExrFetchCallback)(
     void* complete_userdata       /* Passed to on_complete */
 );
 
+/* One byte range of a batched fetch */
+typedef struct ExrFetchRange {
+    uint64_t offset;              /* Byte offset in file */
+    uint64_t size;                /* Bytes requested */
+    void* dst;                    /* Destination buffer (provided by TinyEXR) */
+} ExrFetchRange;
+
+/* Batched fetch callback - read several ranges in one call (synchronous).
+ * Ranges are sorted by offset and never overlap, so sources can turn them
+ * into a single vectored read (preadv, HTTP multi-range, ...). */
+typedef ExrResult (*ExrFetchBatchCallback)(
+    void* userdata,
+    const ExrFetchRange* ranges,
+    uint32_t range_count
+);
+
+/* Map callback - return a pointer to 'size' bytes at 'offset' already
+ * resident in memory, or NULL to fall back to fetch. The bytes must stay
+ * valid and unchanged while the source is in use; the decoder reads them in
+ * place instead of copying. */
+typedef const void* (*ExrMapCallback)(
+    void* userdata,
+    uint64_t offset,
+    uint64_t size
+);
+
 /* Cancel callback - called when pending fetch is no longer needed */
 typedef void (*ExrFetchCancel)(
     void* userdata,
@@ -228,14 +262,31 @@ typedef enum ExrDataSourceFlags {
     EXR_DATA_SOURCE_ASYNC = 0x0002,       /* Fetches are async */
     EXR_DATA_SOURCE_STREAMING = 0x0004,   /* Forward-only stream */
     EXR_DATA_SOURCE_SIZE_KNOWN = 0x0008,  /* total_size is valid */
+    EXR_DATA_SOURCE_CONCURRENT = 0x0010,  /* fetch may run on several threads at once */
+    EXR_DATA_SOURCE_COALESCE = 0x0020,    /* Merge the chunk reads of a submit into few large fetches */
+    EXR_DATA_SOURCE_BACKGROUND_IO = 0x0040, /* Async fetches complete on the source's own threads */
 } ExrDataSourceFlags;
 
+/* With EXR_DATA_SOURCE_COALESCE, each command buffer's chunk ranges are
+ * gathered before decoding, sorted, and merged whenever the gap between two
+ * ranges is at most coalesce_gap bytes (the gap is read and discarded). The
+ * merged ranges go to fetch_batch in one call, or to fetch one at a time
+ * when fetch_batch is NULL. Worth enabling for high-latency sources such as
+ * network or cloud storage; memory sources gain nothing from it.
+ *
+ * With EXR_DATA_SOURCE_BACKGROUND_IO (which implies EXR_DATA_SOURCE_ASYNC)
+ * a submit issues its chunk reads as async fetches up front and decodes each
+ * chunk as soon as its bytes arrive. Completions must not depend on the
+ * caller's thread: decoding threads block until the chunk they need is in. */
 typedef struct ExrDataSource {
     void* userdata;
     ExrFetchCallback fetch;       /* Required */
     ExrFetchCancel cancel;        /* Optional (may be NULL) */
     uint64_t total_size;          /* Total file size (0 if unknown) */
     uint32_t flags;               /* ExrDataSourceFlags */
+    ExrFetchBatchCallback fetch_batch;  /* Optional; called whenever non-NULL, so zero-init the source */
+    uint64_t coalesce_gap;        /* Max bytes skipped to merge two ranges (0 = adjacent only) */
+    ExrMapCallback map;           /* Optional; called whenever non-NULL, so zero-init the source */
 } ExrDataSource;
 
 /* Create data source from memory buffer (synchronous, zero-copy) */
@@ -245,6 +296,29 @@ ExrResult exr_data_source_from_memory(
     ExrDataSource* out_source
 );
 
+/* Create data source from a file, memory-mapped and read in place.
+ * Release with exr_data_source_close once no decoder uses it. */
+ExrResult exr_data_source_from_file(
+    const char* filename,
+    ExrDataSource* out_source
+);
+
+/* Create an asynchronous data source reading a file in the background.
+ * Up to queue_depth reads (0 = 32) are kept in flight, through io_uring on
+ * Linux and a small set of reader threads elsewhere. Fetches without a
+ * completion callback are read synchronously.
+ * Release with exr_data_source_close once no decoder uses it. */
+ExrResult exr_data_source_from_file_async(
+    const char* filename,
+    uint32_t queue_depth,
+    ExrDataSource* out_source
+);
+
+/* Release a source created by exr_data_source_from_file or
+ * exr_data_source_from_file_async (no-op otherwise). Pending reads are
+ * completed first. */
+void exr_data_source_close(ExrDataSource* source);
+
 /* ============================================================================
  * Data Sink (Async Write Callback API)
  * ============================================================================ */
@@ -319,6 +393,12 @@ typedef enum ExrContextFlags {
     EXR_CONTEXT_SIMD_DISABLED = 0x0008,      /* Disable SIMD optimizations */
 } ExrContextFlags;
 
+/* Threading: exr_submit() spreads the chunks of its command buffers over a
+ * worker pool owned by the context (max_threads - 1 workers plus the calling
+ * thread). The pool is started on first use. With EXR_CONTEXT_SINGLE_THREADED
+ * or max_threads == 1 everything runs on the caller. When threaded, the
+ * allocator must be thread-safe; data source fetches are serialized unless
+ * the source sets EXR_DATA_SOURCE_CONCURRENT. */
 typedef struct ExrContextCreateInfo {
     uint32_t api_version;                    /* TINYEXR_C_API_VERSION */
     const ExrAllocator* allocator;           /* NULL for default */
@@ -343,14 +423,19 @@ void exr_context_release(ExrContext ctx);
  * Memory Pool
  * ============================================================================ */
 
+/* Bump-allocated scratch memory for decoder temporaries. Each worker
+ * decoding a chunk checks out an arena and rewinds it afterwards; arenas
+ * grow on demand and exr_memory_pool_reset (run at every exr_submit of a
+ * decoder using the pool) folds that growth into a single block. */
 typedef enum ExrMemoryPoolFlags {
-    EXR_MEMORY_POOL_THREAD_LOCAL = 0x0001,   /* Thread-local pool */
+    EXR_MEMORY_POOL_THREAD_LOCAL = 0x0001,   /* One arena per worker (else one shared arena) */
     EXR_MEMORY_POOL_PERSISTENT = 0x0002,     /* Don't auto-shrink */
 } ExrMemoryPoolFlags;
 
 typedef struct ExrMemoryPoolCreateInfo {
-    size_t initial_size;          /* Initial pool size in bytes */
-    size_t max_size;              /* Maximum size (0 = unlimited) */
+    size_t initial_size;          /* Initial arena size in bytes */
+    size_t max_size;              /* Maximum size per arena (0 = unlimited);
+                                   * larger requests use the context allocator */
     uint32_t flags;               /* ExrMemoryPoolFlags */
 } ExrMemoryPoolCreateInfo;
 
@@ -362,6 +447,7 @@ ExrResult exr_memory_pool_create(
 
 void exr_memory_pool_destroy(ExrMemoryPool pool);
 void exr_memory_pool_reset(ExrMemoryPool pool);
+/* Peak bytes used since the last reset, summed over arenas */
 size_t exr_memory_pool_get_used(ExrMemoryPool pool);
 
 /* ============================================================================
@@ -369,7 +455,8 @@ size_t exr_memory_pool_get_used(ExrMemoryPool pool);
  * ============================================================================ */
 
 typedef enum ExrDecoderFlags {
-    EXR_DECODER_LAZY_LOAD = 0x0001,          /* Don't prefetch offset table */
+    EXR_DECODER_LAZY_LOAD = 0x0001,          /* Don't prefetch offset tables; fetch
+                                              * them in pages as chunks are read */
     EXR_DECODER_VALIDATE_CHUNKS = 0x0002,    /* Validate chunk boundaries */
     EXR_DECODER_ALLOW_TRUNCATED = 0x0004,    /* Accept truncated files */
 } ExrDecoderFlags;
@@ -391,7 +478,7 @@ void exr_decoder_destroy(ExrDecoder decoder);
 /* Parse EXR header (may suspend for async fetch) */
 ExrResult exr_decoder_parse_header(ExrDecoder decoder, ExrImage* out_image);
 
-/* Wait for all pending operations */
+/* Wait for all pending operations (including EXR_SUBMIT_ASYNC submits) */
 ExrResult exr_decoder_wait_idle(ExrDecoder decoder);
 
 /* ============================================================================
@@ -617,6 +704,40 @@ typedef struct ExrBuffer {
     size_t offset;                /* Offset for sub-buffer */
 } ExrBuffer;
 
+/* ============================================================================
+ * Framebuffer Slices
+ * ============================================================================ */
+
+/* Destination of one channel (modelled on OpenEXR's Imf::Slice).
+ *
+ * Pixel (x, y) of the requested level, counted from the top-left of its data
+ * window, is converted to `pixel_type` and written to
+ *
+ *     (uint8_t*)base + x * x_stride + y * y_stride
+ *
+ * Strides are in bytes and may be negative (e.g. bottom-up uploads), so a
+ * slice can point straight into a GPU staging buffer or a texture atlas.
+ * Several slices may share one interleaved buffer with different offsets.
+ *
+ * If `channel_name` is NULL or not a channel of the part, the pixels covered
+ * by the request are set to `fill_value` instead. */
+typedef struct ExrSlice {
+    const char* channel_name;     /* Source channel */
+    void* base;                   /* Address of pixel (0, 0) */
+    int64_t x_stride;             /* Bytes between horizontally adjacent pixels */
+    int64_t y_stride;             /* Bytes between scanlines */
+    uint32_t pixel_type;          /* ExrPixelType written to the slice */
+    double fill_value;            /* Written when the channel does not exist */
+} ExrSlice;
+
+/* Set of slices that receives decoded pixels in place of an ExrBuffer.
+ * Channels without a slice are not converted. The frame buffer and its
+ * slices must stay valid until the commands using them have completed. */
+typedef struct ExrFrameBuffer {
+    uint32_t slice_count;
+    const ExrSlice* slices;
+} ExrFrameBuffer;
+
 /* ============================================================================
  * Tile Request Commands
  * ============================================================================ */
@@ -631,6 +752,7 @@ typedef struct ExrTileRequest {
     uint32_t channels_mask;       /* Bitmask of channels (0 = all) */
     uint32_t output_pixel_type;   /* ExrPixelType for conversion */
     uint32_t output_layout;       /* ExrOutputLayout */
+    const ExrFrameBuffer* framebuffer; /* If set, used instead of output; zero-init the request */
 } ExrTileRequest;
 
 ExrResult exr_cmd_request_tile(ExrCommandBuffer cmd, const ExrTileRequest* request);
@@ -649,6 +771,7 @@ typedef struct ExrScanlineRequest {
     uint32_t channels_mask;
     uint32_t output_pixel_type;
     uint32_t output_layout;
+    const ExrFrameBuffer* framebuffer; /* If set, used instead of output; zero-init the request */
 } ExrScanlineRequest;
 
 ExrResult exr_cmd_request_scanlines(ExrCommandBuffer cmd,
@@ -754,6 +877,7 @@ typedef struct ExrFullImageRequest {
     uint32_t output_pixel_type;
     uint32_t output_layout;
     int32_t target_level;         /* Mipmap level to load */
+    const ExrFrameBuffer* framebuffer; /* If set, used instead of output; zero-init the request */
 } ExrFullImageRequest;
 
 ExrResult exr_cmd_request_full_image(ExrCommandBuffer cmd,
@@ -765,14 +889,34 @@ ExrResult exr_cmd_request_full_image(ExrCommandBuffer cmd,
 
 typedef void (*ExrSubmitComplete)(void* userdata, ExrResult result);
 
+typedef enum ExrSubmitFlags {
+    EXR_SUBMIT_ASYNC = 0x0001,    /* Return immediately, run on the worker pool */
+} ExrSubmitFlags;
+
 typedef struct ExrSubmitInfo {
     uint32_t command_buffer_count;
     const ExrCommandBuffer* command_buffers;
     ExrFence signal_fence;        /* Fence to signal on completion (may be NULL) */
     ExrSubmitComplete on_complete; /* Completion callback (may be NULL) */
     void* userdata;
+    uint32_t flags;               /* ExrSubmitFlags (zero-init the submit info) */
 } ExrSubmitInfo;
 
+/* Execute read commands.
+ *
+ * By default the call blocks until all commands have finished, then invokes
+ * on_complete and signals the fence (the fence is left unsignaled on failure).
+ *
+ * With EXR_SUBMIT_ASYNC the call returns EXR_SUCCESS once the work is queued.
+ * When it finishes, a worker thread invokes on_complete with the result and
+ * signals the fence whatever the outcome; exr_fence_wait() then returns that
+ * result. The command buffers and output buffers must stay valid until then.
+ * Use exr_decoder_wait_idle() to wait for all outstanding submits to finish
+ * executing. The submit stops counting as outstanding before on_complete
+ * runs, so the callback may call exr_decoder_wait_idle() or destroy the
+ * decoder; wait on the fence to know that on_complete has returned. If the
+ * context has no worker pool, the work completes before exr_submit returns
+ * (the fence is still signaled on failure). */
 ExrResult exr_submit(ExrDecoder decoder, const ExrSubmitInfo* submit_info);
 
 /* ============================================================================
@@ -794,10 +938,11 @@ ExrResult exr_fence_create(ExrContext ctx, const ExrFenceCreateInfo* create_info
                             ExrFence* out_fence);
 void exr_fence_destroy(ExrFence fence);
 
-/* Wait for fence to be signaled */
+/* Wait for fence to be signaled. Returns the result of the work that
+ * signaled it (EXR_SUCCESS unless an async submit failed). */
 ExrResult exr_fence_wait(ExrFence fence, uint64_t timeout_ns);
 
-/* Check if fence is signaled (non-blocking) */
+/* Check if fence is signaled (non-blocking); EXR_ERROR_NOT_READY if not */
 ExrResult exr_fence_get_status(ExrFence fence);
 
 /* Reset fence to unsignaled */
@@ -843,7 +988,9 @@ ExrResult exr_decoder_set_progress_callback(ExrDecoder decoder,
  * ============================================================================ */
 
 typedef enum ExrEncoderFlags {
-    EXR_ENCODER_PARALLEL = 0x0001,    /* Use parallel compression */
+    EXR_ENCODER_PARALLEL = 0x0001,    /* Compress chunks on the context thread pool;
+                                       * offset tables are written by
+                                       * exr_encoder_finalize */
 } ExrEncoderFlags;
 
 typedef struct ExrEncoderCreateInfo {
@@ -893,6 +1040,9 @@ typedef struct ExrWriteImageCreateInfo {
     const ExrBox2i* data_window;  /* NULL for default (0,0,w-1,h-1) */
     const ExrBox2i* display_window; /* NULL for same as data_window */
     const char* part_name;        /* Part name (required for multipart) */
+    float dwa_compression_level;  /* DWAA/DWAB quantization, 0 for default (45) */
+    /* Zero-initialize: an uninitialized dwa_compression_level is written as
+     * the file's dwaCompressionLevel attribute */
 } ExrWriteImageCreateInfo;
 
 typedef struct ExrWriteImage_T* ExrWriteImage;
@@ -984,7 +1134,9 @@ ExrResult exr_cmd_write_deep_tiles(ExrCommandBuffer cmd,
 /* Submit write commands */
 ExrResult exr_submit_write(ExrEncoder encoder, const ExrSubmitInfo* submit_info);
 
-/* Finalize encoding (write offset table, flush) */
+/* Finalize encoding (write offset table, flush).
+ * Required with EXR_ENCODER_PARALLEL, which defers offset tables until here;
+ * call it before destroying the write images. */
 ExrResult exr_encoder_finalize(ExrEncoder encoder);
 
 /* ============================================================================
@@ -1,6 +1,9 @@
 /* Feature test macros for POSIX functions (must be before any includes) */
 #if !defined(_WIN32)
-#define _POSIX_C_SOURCE 200112L
+#define _POSIX_C_SOURCE 200809L
+#endif
+#if defined(__linux__) && !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE  /* syscall() for io_uring */
 #endif
 
 /*
@@ -61,6 +64,19 @@
 #include <pthread.h>
 #include <time.h>
 #include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#if defined(__linux__) && !defined(TINYEXR_V3_NO_IO_URING) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define EXR_HAVE_IO_URING 1
+#endif
+#endif
+#endif
 #endif
 
 /* CPUID for x86 */
@@ -97,7 +113,7 @@
  * Version Information
  * ============================================================================ */
 
-static const char* g_version_string = "TinyEXR 3.0.0";
+static const char* g_version_string = "TinyEXR 3.1.0";
 
 void exr_get_version(int* major, int* minor, int* patch) {
     if (major) *major = TINYEXR_C_API_VERSION_MAJOR;
@@ -219,6 +235,54 @@ const ExrAllocator* exr_get_default_allocator(void) {
     return &g_default_allocator;
 }
 
+/* ============================================================================
+ * Threading Primitives
+ * ============================================================================ */
+
+#if defined(_WIN32)
+typedef CRITICAL_SECTION exr_mutex_t;
+typedef CONDITION_VARIABLE exr_cond_t;
+typedef HANDLE exr_thread_t;
+
+static void exr_mutex_init(exr_mutex_t* m) { InitializeCriticalSection(m); }
+static void exr_mutex_destroy(exr_mutex_t* m) { DeleteCriticalSection(m); }
+static void exr_mutex_lock(exr_mutex_t* m) { EnterCriticalSection(m); }
+static void exr_mutex_unlock(exr_mutex_t* m) { LeaveCriticalSection(m); }
+static void exr_cond_init(exr_cond_t* c) { InitializeConditionVariable(c); }
+static void exr_cond_destroy(exr_cond_t* c) { (void)c; }
+static void exr_cond_wait(exr_cond_t* c, exr_mutex_t* m) {
+    SleepConditionVariableCS(c, m, INFINITE);
+}
+static void exr_cond_broadcast(exr_cond_t* c) { WakeAllConditionVariable(c); }
+#else
+typedef pthread_mutex_t exr_mutex_t;
+typedef pthread_cond_t exr_cond_t;
+typedef pthread_t exr_thread_t;
+
+static void exr_mutex_init(exr_mutex_t* m) { pthread_mutex_init(m, NULL); }
+static void exr_mutex_destroy(exr_mutex_t* m) { pthread_mutex_destroy(m); }
+static void exr_mutex_lock(exr_mutex_t* m) { pthread_mutex_lock(m); }
+static void exr_mutex_unlock(exr_mutex_t* m) { pthread_mutex_unlock(m); }
+static void exr_cond_init(exr_cond_t* c) { pthread_cond_init(c, NULL); }
+static void exr_cond_destroy(exr_cond_t* c) { pthread_cond_destroy(c); }
+static void exr_cond_wait(exr_cond_t* c, exr_mutex_t* m) { pthread_cond_wait(c, m); }
+static void exr_cond_broadcast(exr_cond_t* c) { pthread_cond_broadcast(c); }
+#endif
+
+/* Number of logical processors (1 if unknown) */
+static uint32_t exr_hardware_concurrency(void) {
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (uint32_t)info.dwNumberOfProcessors : 1;
+#elif defined(_SC_NPROCESSORS_ONLN)
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (uint32_t)n : 1;
+#else
+    return 1;
+#endif
+}
+
 /* ============================================================================
  * Error Entry
  * ============================================================================ */
@@ -254,6 +318,14 @@ struct ExrContext_T {
     uint32_t flags;
     uint32_t max_threads;
 
+    /* Guards the error ring buffer and lazy thread pool creation */
+    exr_mutex_t lock;
+
+    /* Worker pool shared by all decoders/encoders of this context
+     * (created on first parallel submit, NULL when single-threaded) */
+    struct ExrThreadPool_T* thread_pool;
+    int thread_pool_initialized;
+
     /* Magic for validation */
     uint32_t magic;
 };
@@ -277,6 +349,9 @@ static void exr_context_add_error(ExrContext ctx, ExrResult code,
                                    uint64_t byte_pos) {
     if (!exr_context_is_valid(ctx)) return;
 
+    /* Errors may be reported concurrently from pool workers */
+    exr_mutex_lock(&ctx->lock);
+
     uint32_t index = ctx->error_index % EXR_MAX_ERRORS;
     ExrErrorEntry* entry = &ctx->errors[index];
 
@@ -302,12 +377,16 @@ static void exr_context_add_error(ExrContext ctx, ExrResult code,
         ctx->error_count++;
     }
 
+    /* Copy out before unlocking so the callback may query the context */
+    ExrErrorEntry reported = *entry;
+    exr_mutex_unlock(&ctx->lock);
+
     /* Call error callback if set */
     if (ctx->error_callback) {
         ExrErrorInfo info = {
             .code = code,
-            .message = entry->message,
-            .context = entry->context,
+            .message = reported.message,
+            .context = reported.context,
             .byte_position = byte_pos,
             .line_number = 0,
             .source_file = NULL
@@ -327,6 +406,252 @@ static void exr_context_add_error_fmt(ExrContext ctx, ExrResult code,
     exr_context_add_error(ctx, code, message, context_str, byte_pos);
 }
 
+/* ============================================================================
+ * Thread Pool
+ *
+ * A persistent set of workers per context. Work is expressed as parallel-for
+ * jobs over an index range; the submitting thread always participates, so a
+ * pool of N workers runs N + 1 items at once. Jobs may nest (a command fanning
+ * out into chunks): the newest job is served first and a waiting thread keeps
+ * claiming items of its own job, so nesting cannot deadlock.
+ * ============================================================================ */
+
+typedef void (*ExrParallelFunc)(void* userdata, uint32_t index);
+
+typedef struct ExrParallelJob {
+    ExrParallelFunc func;
+    void* userdata;
+    uint32_t count;
+    uint32_t next_index;           /* Next unclaimed item */
+    uint32_t pending;              /* Items not yet finished */
+    int detached;                  /* Heap job nobody waits on: freed when done */
+    struct ExrParallelJob* next;   /* Stack link (jobs with unclaimed items) */
+} ExrParallelJob;
+
+typedef struct ExrThreadPool_T {
+    ExrContext ctx;
+    exr_mutex_t mutex;
+    exr_cond_t work_cond;          /* New job pushed or shutdown */
+    exr_cond_t done_cond;          /* An item finished */
+    ExrParallelJob* jobs;
+    exr_thread_t* threads;
+    uint32_t num_threads;          /* Workers actually started */
+    uint32_t thread_capacity;
+    int shutdown;
+} ExrThreadPool;
+
+/* Claim the next item of a job (pool mutex held) */
+static uint32_t exr_thread_pool_claim(ExrThreadPool* pool, ExrParallelJob* job) {
+    uint32_t index = job->next_index++;
+    if (job->next_index == job->count) {
+        /* Fully claimed: unlink from the job stack */
+        ExrParallelJob** link = &pool->jobs;
+        while (*link && *link != job) link = &(*link)->next;
+        if (*link) *link = job->next;
+    }
+    return index;
+}
+
+/* Run one claimed item and account for it (pool mutex held on entry/exit) */
+static void exr_thread_pool_run(ExrThreadPool* pool, ExrParallelJob* job,
+                                uint32_t index) {
+    exr_mutex_unlock(&pool->mutex);
+    job->func(job->userdata, index);
+    exr_mutex_lock(&pool->mutex);
+    if (--job->pending == 0) {
+        if (job->detached) {
+            ExrContext ctx = pool->ctx;
+            ctx->allocator.free(ctx->allocator.userdata, job, sizeof(ExrParallelJob));
+        } else {
+            exr_cond_broadcast(&pool->done_cond);
+        }
+    }
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI exr_thread_pool_worker(LPVOID arg)
+#else
+static void* exr_thread_pool_worker(void* arg)
+#endif
+{
+    ExrThreadPool* pool = (ExrThreadPool*)arg;
+
+    exr_mutex_lock(&pool->mutex);
+    while (!pool->shutdown) {
+        ExrParallelJob* job = pool->jobs;
+        if (!job) {
+            exr_cond_wait(&pool->work_cond, &pool->mutex);
+            continue;
+        }
+        uint32_t index = exr_thread_pool_claim(pool, job);
+        exr_thread_pool_run(pool, job, index);
+    }
+    exr_mutex_unlock(&pool->mutex);
+
+#if defined(_WIN32)
+    return 0;
+#else
+    return NULL;
+#endif
+}
+
+static void exr_thread_pool_destroy(ExrThreadPool* pool) {
+    if (!pool) return;
+
+    ExrContext ctx = pool->ctx;
+
+    exr_mutex_lock(&pool->mutex);
+    pool->shutdown = 1;
+    exr_cond_broadcast(&pool->work_cond);
+    exr_mutex_unlock(&pool->mutex);
+
+    for (uint32_t i = 0; i < pool->num_threads; i++) {
+#if defined(_WIN32)
+        WaitForSingleObject(pool->threads[i], INFINITE);
+        CloseHandle(pool->threads[i]);
+#else
+        pthread_join(pool->threads[i], NULL);
+#endif
+    }
+
+    exr_cond_destroy(&pool->done_cond);
+    exr_cond_destroy(&pool->work_cond);
+    exr_mutex_destroy(&pool->mutex);
+
+    if (pool->threads) {
+        ctx->allocator.free(ctx->allocator.userdata, pool->threads,
+                            pool->thread_capacity * sizeof(exr_thread_t));
+    }
+    ctx->allocator.free(ctx->allocator.userdata, pool, sizeof(ExrThreadPool));
+}
+
+/* Create a pool with up to num_threads workers. Returns NULL if no worker
+ * could be started (e.g. threads unavailable on this platform). */
+static ExrThreadPool* exr_thread_pool_create(ExrContext ctx, uint32_t num_threads) {
+    ExrThreadPool* pool = (ExrThreadPool*)ctx->allocator.alloc(
+        ctx->allocator.userdata, sizeof(ExrThreadPool), EXR_DEFAULT_ALIGNMENT);
+    if (!pool) {
+        return NULL;
+    }
+    memset(pool, 0, sizeof(ExrThreadPool));
+    pool->ctx = ctx;
+
+    pool->threads = (exr_thread_t*)ctx->allocator.alloc(
+        ctx->allocator.userdata, num_threads * sizeof(exr_thread_t),
+        EXR_DEFAULT_ALIGNMENT);
+    if (!pool->threads) {
+        ctx->allocator.free(ctx->allocator.userdata, pool, sizeof(ExrThreadPool));
+        return NULL;
+    }
+    pool->thread_capacity = num_threads;
+
+    exr_mutex_init(&pool->mutex);
+    exr_cond_init(&pool->work_cond);
+    exr_cond_init(&pool->done_cond);
+
+    uint32_t started = 0;
+    for (; started < num_threads; started++) {
+#if defined(_WIN32)
+        HANDLE h = CreateThread(NULL, 0, exr_thread_pool_worker, pool, 0, NULL);
+        if (!h) break;
+        pool->threads[started] = h;
+#else
+        if (pthread_create(&pool->threads[started], NULL,
+                           exr_thread_pool_worker, pool) != 0) {
+            break;
+        }
+#endif
+    }
+
+    /* Run with however many workers could be started */
+    pool->num_threads = started;
+    if (started == 0) {
+        exr_thread_pool_destroy(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+/* Run func(userdata, i) for i in [0, count). Runs inline when pool is NULL;
+ * otherwise the calling thread works alongside the pool and returns once
+ * every item has finished. */
+static void exr_parallel_for(ExrThreadPool* pool, uint32_t count,
+                             ExrParallelFunc func, void* userdata) {
+    if (!pool || count <= 1) {
+        for (uint32_t i = 0; i < count; i++) {
+            func(userdata, i);
+        }
+        return;
+    }
+
+    ExrParallelJob job;
+    job.func = func;
+    job.userdata = userdata;
+    job.count = count;
+    job.next_index = 0;
+    job.pending = count;
+    job.detached = 0;
+
+    exr_mutex_lock(&pool->mutex);
+    job.next = pool->jobs;
+    pool->jobs = &job;
+    exr_cond_broadcast(&pool->work_cond);
+
+    while (job.next_index < job.count) {
+        uint32_t index = exr_thread_pool_claim(pool, &job);
+        exr_thread_pool_run(pool, &job, index);
+    }
+    while (job.pending > 0) {
+        exr_cond_wait(&pool->done_cond, &pool->mutex);
+    }
+    exr_mutex_unlock(&pool->mutex);
+}
+
+/* Queue func(userdata, 0) to run once on a worker without waiting for it */
+static ExrResult exr_thread_pool_enqueue(ExrThreadPool* pool,
+                                         ExrParallelFunc func, void* userdata) {
+    ExrContext ctx = pool->ctx;
+    ExrParallelJob* job = (ExrParallelJob*)ctx->allocator.alloc(
+        ctx->allocator.userdata, sizeof(ExrParallelJob), EXR_DEFAULT_ALIGNMENT);
+    if (!job) {
+        return EXR_ERROR_OUT_OF_MEMORY;
+    }
+    job->func = func;
+    job->userdata = userdata;
+    job->count = 1;
+    job->next_index = 0;
+    job->pending = 1;
+    job->detached = 1;
+
+    exr_mutex_lock(&pool->mutex);
+    job->next = pool->jobs;
+    pool->jobs = job;
+    exr_cond_broadcast(&pool->work_cond);
+    exr_mutex_unlock(&pool->mutex);
+    return EXR_SUCCESS;
+}
+
+/* Get (lazily creating) the context's worker pool. Returns NULL when the
+ * context is single-threaded, in which case work runs on the caller. */
+static ExrThreadPool* exr_context_get_thread_pool(ExrContext ctx) {
+    if (ctx->flags & EXR_CONTEXT_SINGLE_THREADED) {
+        return NULL;
+    }
+
+    exr_mutex_lock(&ctx->lock);
+    if (!ctx->thread_pool_initialized) {
+        uint32_t total = ctx->max_threads ? ctx->max_threads : exr_hardware_concurrency();
+        /* The submitting thread is one of the 'total' threads */
+        if (total > 1) {
+            ctx->thread_pool = exr_thread_pool_create(ctx, total - 1);
+        }
+        ctx->thread_pool_initialized = 1;
+    }
+    ExrThreadPool* pool = ctx->thread_pool;
+    exr_mutex_unlock(&ctx->lock);
+    return pool;
+}
+
 /* ============================================================================
  * Context Creation/Destruction
  * ============================================================================ */
@@ -344,9 +669,14 @@ ExrResult exr_context_create(const ExrContextCreateInfo* create_info,
 
     /* Check API version compatibility */
     uint32_t major = (create_info->api_version >> 22) & 0x3FF;
+    uint32_t minor = (create_info->api_version >> 12) & 0x3FF;
     if (major != TINYEXR_C_API_VERSION_MAJOR) {
         return EXR_ERROR_INVALID_VERSION;
     }
+    /* Struct layouts changed in 3.1 (appended create-info/request fields) */
+    if (minor < 1) {
+        return EXR_ERROR_INVALID_VERSION;
+    }
 
     /* Use provided allocator or default */
     const ExrAllocator* alloc = create_info->allocator;
@@ -373,6 +703,7 @@ ExrResult exr_context_create(const ExrContextCreateInfo* create_info,
     ctx->error_userdata = create_info->error_userdata;
     ctx->flags = create_info->flags;
     ctx->max_threads = create_info->max_threads;
+    exr_mutex_init(&ctx->lock);
 
     *out_ctx = ctx;
     return EXR_SUCCESS;
@@ -391,6 +722,11 @@ void exr_context_destroy(ExrContext ctx) {
     /* Invalidate magic before freeing */
     ctx->magic = 0;
 
+    /* Join workers before the allocator goes away */
+    exr_thread_pool_destroy(ctx->thread_pool);
+    ctx->thread_pool = NULL;
+    exr_mutex_destroy(&ctx->lock);
+
     /* Free context */
     ctx->allocator.free(ctx->allocator.userdata, ctx, sizeof(struct ExrContext_T));
 }
@@ -483,13 +819,40 @@ void exr_clear_errors(ExrContext ctx) {
 
 /* ============================================================================
  * Memory Pool Internal Structure
+ *
+ * A pool is a set of bump arenas. Decoder workers check an arena out for the
+ * duration of one chunk, allocate that chunk's temporaries from it, and rewind
+ * it when checking it back in, so steady-state decoding does no heap traffic.
+ * A shared pool has a single arena; EXR_MEMORY_POOL_THREAD_LOCAL creates one
+ * per concurrently running worker. Arenas grow by chaining blocks, and
+ * exr_memory_pool_reset folds the chain into one block sized to the peak.
  * ============================================================================ */
 
-struct ExrMemoryPool_T {
-    ExrContext ctx;
-    uint8_t* data;
+/* Block header; the block's memory follows, aligned to EXR_DEFAULT_ALIGNMENT */
+typedef struct ExrArenaBlock {
+    struct ExrArenaBlock* next;
     size_t size;
     size_t used;
+} ExrArenaBlock;
+
+#define EXR_ARENA_HEADER_SIZE \
+    ((sizeof(ExrArenaBlock) + EXR_DEFAULT_ALIGNMENT - 1) & ~(size_t)(EXR_DEFAULT_ALIGNMENT - 1))
+
+typedef struct ExrArena {
+    ExrArenaBlock* blocks;
+    ExrArenaBlock* current;       /* Block currently being bumped */
+    size_t total;                 /* Bytes in all blocks */
+    size_t in_use;                /* Bytes handed out since the last rewind */
+    size_t peak;                  /* Largest in_use since the last reset */
+    int busy;                     /* Checked out by a worker */
+    struct ExrArena* next;
+} ExrArena;
+
+struct ExrMemoryPool_T {
+    ExrContext ctx;
+    exr_mutex_t lock;             /* Guards arena checkout */
+    ExrArena* arenas;             /* First arena is created with the pool */
+    size_t initial_size;
     size_t max_size;
     uint32_t flags;
     uint32_t magic;
@@ -501,6 +864,147 @@ static int exr_memory_pool_is_valid(ExrMemoryPool pool) {
     return pool != NULL && pool->magic == EXR_MEMORY_POOL_MAGIC;
 }
 
+/* Append a block of at least 'size' usable bytes; NULL if over max_size */
+static ExrArenaBlock* exr_arena_add_block(ExrMemoryPool pool, ExrArena* arena, size_t size) {
+    ExrContext ctx = pool->ctx;
+    if (pool->max_size && arena->total + size > pool->max_size) {
+        return NULL;
+    }
+    ExrArenaBlock* block = (ExrArenaBlock*)ctx->allocator.alloc(
+        ctx->allocator.userdata, EXR_ARENA_HEADER_SIZE + size, EXR_DEFAULT_ALIGNMENT);
+    if (!block) return NULL;
+
+    block->next = NULL;
+    block->size = size;
+    block->used = 0;
+
+    ExrArenaBlock** link = &arena->blocks;
+    while (*link) link = &(*link)->next;
+    *link = block;
+    if (!arena->current) arena->current = block;
+    arena->total += size;
+    return block;
+}
+
+static void exr_arena_free_blocks(ExrMemoryPool pool, ExrArena* arena) {
+    ExrContext ctx = pool->ctx;
+    ExrArenaBlock* block = arena->blocks;
+    while (block) {
+        ExrArenaBlock* next = block->next;
+        ctx->allocator.free(ctx->allocator.userdata, block, EXR_ARENA_HEADER_SIZE + block->size);
+        block = next;
+    }
+    arena->blocks = NULL;
+    arena->current = NULL;
+    arena->total = 0;
+}
+
+/* Bump-allocate from the arena, chaining a new block when full.
+ * Returns NULL when the pool's max_size would be exceeded. */
+static void* exr_arena_alloc(ExrMemoryPool pool, ExrArena* arena, size_t size) {
+    size = (size + EXR_DEFAULT_ALIGNMENT - 1) & ~(size_t)(EXR_DEFAULT_ALIGNMENT - 1);
+    if (size == 0) size = EXR_DEFAULT_ALIGNMENT;
+
+    ExrArenaBlock* block = arena->current;
+    while (block && block->size - block->used < size) {
+        block = block->next;
+    }
+    if (!block) {
+        /* Grow geometrically so a cold arena settles after a few chunks */
+        size_t grow = arena->total > size ? arena->total : size;
+        block = exr_arena_add_block(pool, arena, grow);
+        if (!block && grow > size) {
+            block = exr_arena_add_block(pool, arena, size);
+        }
+        if (!block) return NULL;
+    }
+    arena->current = block;
+
+    void* ptr = (uint8_t*)block + EXR_ARENA_HEADER_SIZE + block->used;
+    block->used += size;
+    arena->in_use += size;
+    if (arena->in_use > arena->peak) arena->peak = arena->in_use;
+    return ptr;
+}
+
+static int exr_arena_owns(const ExrArena* arena, const void* ptr) {
+    const ExrArenaBlock* block;
+    for (block = arena->blocks; block; block = block->next) {
+        const uint8_t* data = (const uint8_t*)block + EXR_ARENA_HEADER_SIZE;
+        if ((const uint8_t*)ptr >= data && (const uint8_t*)ptr < data + block->size) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* Release everything allocated from the arena, keeping its blocks */
+static void exr_arena_rewind(ExrArena* arena) {
+    ExrArenaBlock* block;
+    for (block = arena->blocks; block; block = block->next) {
+        block->used = 0;
+    }
+    arena->current = arena->blocks;
+    arena->in_use = 0;
+}
+
+/* Rewind and fold a chained arena into a single block sized to its peak.
+ * Without EXR_MEMORY_POOL_PERSISTENT an oversized block is also shrunk. */
+static void exr_arena_reset(ExrMemoryPool pool, ExrArena* arena) {
+    size_t target = arena->peak > pool->initial_size ? arena->peak : pool->initial_size;
+    int chained = arena->blocks && arena->blocks->next;
+    int oversized = !(pool->flags & EXR_MEMORY_POOL_PERSISTENT) &&
+                    arena->peak > 0 && arena->total > target * 4;
+
+    exr_arena_rewind(arena);
+    if (chained || oversized) {
+        exr_arena_free_blocks(pool, arena);
+        if (target > 0) {
+            exr_arena_add_block(pool, arena, target);
+        }
+    }
+    arena->peak = 0;
+}
+
+static ExrArena* exr_arena_create(ExrMemoryPool pool) {
+    ExrContext ctx = pool->ctx;
+    ExrArena* arena = (ExrArena*)ctx->allocator.alloc(
+        ctx->allocator.userdata, sizeof(ExrArena), EXR_DEFAULT_ALIGNMENT);
+    if (!arena) return NULL;
+    memset(arena, 0, sizeof(ExrArena));
+    if (pool->initial_size > 0 && !exr_arena_add_block(pool, arena, pool->initial_size)) {
+        ctx->allocator.free(ctx->allocator.userdata, arena, sizeof(ExrArena));
+        return NULL;
+    }
+    arena->next = pool->arenas;
+    pool->arenas = arena;
+    return arena;
+}
+
+/* Check out an arena for the calling worker. Returns NULL when the shared
+ * arena is already in use (callers then fall back to the context allocator). */
+static ExrArena* exr_memory_pool_acquire(ExrMemoryPool pool) {
+    ExrArena* arena;
+
+    exr_mutex_lock(&pool->lock);
+    for (arena = pool->arenas; arena; arena = arena->next) {
+        if (!arena->busy) break;
+    }
+    if (!arena && (pool->flags & EXR_MEMORY_POOL_THREAD_LOCAL)) {
+        arena = exr_arena_create(pool);
+    }
+    if (arena) arena->busy = 1;
+    exr_mutex_unlock(&pool->lock);
+    return arena;
+}
+
+static void exr_memory_pool_release(ExrMemoryPool pool, ExrArena* arena) {
+    exr_arena_rewind(arena);
+    exr_mutex_lock(&pool->lock);
+    arena->busy = 0;
+    exr_mutex_unlock(&pool->lock);
+}
+
 ExrResult exr_memory_pool_create(ExrContext ctx,
                                   const ExrMemoryPoolCreateInfo* create_info,
                                   ExrMemoryPool* out_pool) {
@@ -527,26 +1031,20 @@ ExrResult exr_memory_pool_create(ExrContext ctx,
 
     memset(pool, 0, sizeof(struct ExrMemoryPool_T));
     pool->ctx = ctx;
+    pool->initial_size = create_info->initial_size;
     pool->max_size = create_info->max_size;
     pool->flags = create_info->flags;
     pool->magic = EXR_MEMORY_POOL_MAGIC;
 
-    /* Allocate initial buffer if requested */
-    if (create_info->initial_size > 0) {
-        pool->data = (uint8_t*)ctx->allocator.alloc(
-            ctx->allocator.userdata,
-            create_info->initial_size,
-            EXR_DEFAULT_ALIGNMENT
-        );
-        if (!pool->data) {
-            ctx->allocator.free(ctx->allocator.userdata, pool,
-                               sizeof(struct ExrMemoryPool_T));
-            exr_context_add_error(ctx, EXR_ERROR_OUT_OF_MEMORY,
-                                  "Failed to allocate pool buffer", NULL, 0);
-            return EXR_ERROR_OUT_OF_MEMORY;
-        }
-        pool->size = create_info->initial_size;
+    /* Create the first arena, with the initial buffer if requested */
+    if (!exr_arena_create(pool)) {
+        ctx->allocator.free(ctx->allocator.userdata, pool,
+                           sizeof(struct ExrMemoryPool_T));
+        exr_context_add_error(ctx, EXR_ERROR_OUT_OF_MEMORY,
+                              "Failed to allocate pool buffer", NULL, 0);
+        return EXR_ERROR_OUT_OF_MEMORY;
     }
+    exr_mutex_init(&pool->lock);
 
     exr_context_add_ref(ctx);
     *out_pool = pool;
@@ -559,9 +1057,14 @@ void exr_memory_pool_destroy(ExrMemoryPool pool) {
     ExrContext ctx = pool->ctx;
     pool->magic = 0;
 
-    if (pool->data) {
-        ctx->allocator.free(ctx->allocator.userdata, pool->data, pool->size);
+    ExrArena* arena = pool->arenas;
+    while (arena) {
+        ExrArena* next = arena->next;
+        exr_arena_free_blocks(pool, arena);
+        ctx->allocator.free(ctx->allocator.userdata, arena, sizeof(ExrArena));
+        arena = next;
     }
+    exr_mutex_destroy(&pool->lock);
     ctx->allocator.free(ctx->allocator.userdata, pool,
                         sizeof(struct ExrMemoryPool_T));
     exr_context_release(ctx);
@@ -569,12 +1072,95 @@ void exr_memory_pool_destroy(ExrMemoryPool pool) {
 
 void exr_memory_pool_reset(ExrMemoryPool pool) {
     if (!exr_memory_pool_is_valid(pool)) return;
-    pool->used = 0;
+
+    exr_mutex_lock(&pool->lock);
+    for (ExrArena* arena = pool->arenas; arena; arena = arena->next) {
+        /* Arenas in use by an in-flight submit are left alone */
+        if (!arena->busy) exr_arena_reset(pool, arena);
+    }
+    exr_mutex_unlock(&pool->lock);
 }
 
 size_t exr_memory_pool_get_used(ExrMemoryPool pool) {
     if (!exr_memory_pool_is_valid(pool)) return 0;
-    return pool->used;
+
+    size_t used = 0;
+    exr_mutex_lock(&pool->lock);
+    for (ExrArena* arena = pool->arenas; arena; arena = arena->next) {
+        used += arena->peak;
+    }
+    exr_mutex_unlock(&pool->lock);
+    return used;
+}
+
+/* ============================================================================
+ * Scratch Memory
+ *
+ * Per-chunk temporaries of the decoder. Allocations come from an arena of the
+ * decoder's scratch pool when one is available and from the context allocator
+ * otherwise; exr_scratch_free only returns heap blocks, arena memory is
+ * reclaimed in one step by exr_scratch_end. A scratch also carries the chunk
+ * bytes its submit prefetched, if any.
+ * ============================================================================ */
+
+/* A merged byte range fetched ahead of decoding (EXR_DATA_SOURCE_COALESCE or
+ * EXR_DATA_SOURCE_BACKGROUND_IO) */
+typedef struct ExrPrefetchSpan {
+    uint64_t offset;
+    uint64_t size;
+    uint8_t* data;
+    ExrResult status;                 /* EXR_WOULD_BLOCK while the read is in flight */
+    struct ExrChunkPrefetch* owner;
+} ExrPrefetchSpan;
+
+/* Chunk bytes of one command buffer; spans are sorted by offset. With
+ * background I/O the spans are read while the commands already decode,
+ * and readers wait on 'ready' for the span they need. */
+typedef struct ExrChunkPrefetch {
+    ExrPrefetchSpan* spans;
+    uint32_t num_spans;
+    uint8_t* buffer;
+    size_t buffer_size;
+    int async;
+    uint32_t pending;                 /* Reads still in flight (async only) */
+    exr_mutex_t lock;
+    exr_cond_t ready;
+} ExrChunkPrefetch;
+
+typedef struct ExrScratch {
+    ExrContext ctx;
+    ExrMemoryPool pool;
+    ExrArena* arena;
+    const ExrChunkPrefetch* prefetch;  /* Serves chunk fetches (may be NULL) */
+} ExrScratch;
+
+static void exr_scratch_begin(ExrScratch* scratch, ExrContext ctx, ExrMemoryPool pool) {
+    scratch->ctx = ctx;
+    scratch->prefetch = NULL;
+    scratch->pool = exr_memory_pool_is_valid(pool) ? pool : NULL;
+    scratch->arena = scratch->pool ? exr_memory_pool_acquire(scratch->pool) : NULL;
+}
+
+static void exr_scratch_end(ExrScratch* scratch) {
+    if (scratch->arena) {
+        exr_memory_pool_release(scratch->pool, scratch->arena);
+        scratch->arena = NULL;
+    }
+}
+
+static void* exr_scratch_alloc(ExrScratch* scratch, size_t size) {
+    if (scratch->arena) {
+        void* ptr = exr_arena_alloc(scratch->pool, scratch->arena, size);
+        if (ptr) return ptr;
+    }
+    return scratch->ctx->allocator.alloc(scratch->ctx->allocator.userdata, size,
+                                         EXR_DEFAULT_ALIGNMENT);
+}
+
+static void exr_scratch_free(ExrScratch* scratch, void* ptr, size_t size) {
+    if (!ptr) return;
+    if (scratch->arena && exr_arena_owns(scratch->arena, ptr)) return;
+    scratch->ctx->allocator.free(scratch->ctx->allocator.userdata, ptr, size);
 }
 
 /* ============================================================================
@@ -609,6 +1195,14 @@ static ExrResult memory_source_fetch(void* userdata, uint64_t offset, uint64_t s
     return EXR_SUCCESS;
 }
 
+static const void* memory_source_map(void* userdata, uint64_t offset, uint64_t size) {
+    ExrMemorySourceData* src = (ExrMemorySourceData*)userdata;
+    if (offset > src->size || size > src->size - offset) {
+        return NULL;
+    }
+    return src->data + offset;
+}
+
 /* Note: This allocates a small structure on the heap. The caller must
  * ensure it lives as long as the data source is in use. For simplicity,
  * we use a static buffer for single-threaded use. For proper thread-safe
@@ -628,69 +1222,758 @@ ExrResult exr_data_source_from_memory(const void* data, size_t size,
     out_source->fetch = memory_source_fetch;
     out_source->cancel = NULL;
     out_source->total_size = size;
-    out_source->flags = EXR_DATA_SOURCE_SEEKABLE | EXR_DATA_SOURCE_SIZE_KNOWN;
+    out_source->flags = EXR_DATA_SOURCE_SEEKABLE | EXR_DATA_SOURCE_SIZE_KNOWN |
+                        EXR_DATA_SOURCE_CONCURRENT;
+    out_source->fetch_batch = NULL;
+    out_source->coalesce_gap = 0;
+    out_source->map = memory_source_map;
 
     return EXR_SUCCESS;
 }
 
 /* ============================================================================
- * Decoder Internal Structure
+ * Data Source from File
+ *
+ * The file is mapped read-only once and its handles closed right away (the
+ * mapping keeps the file alive). Fetches copy out of the mapping; the map
+ * callback lets the decoder read chunks in place.
  * ============================================================================ */
 
-typedef enum ExrDecoderState {
-    EXR_DECODER_STATE_CREATED = 0,
-    EXR_DECODER_STATE_PARSING_HEADER,
-    EXR_DECODER_STATE_HEADER_PARSED,
-    EXR_DECODER_STATE_LOADING,
-    EXR_DECODER_STATE_ERROR,
-} ExrDecoderState;
-
-/* Parsing phases for async state machine (forward declaration) */
-typedef enum ExrParsePhase {
-    EXR_PHASE_IDLE = 0,
-    EXR_PHASE_VERSION,             /* Reading magic + version bytes */
-    EXR_PHASE_ATTRIBUTE_NAME,      /* Reading attribute name */
-    EXR_PHASE_ATTRIBUTE_DATA,      /* Reading attribute value */
-    EXR_PHASE_END_OF_HEADER,       /* Checking for header terminator */
-    EXR_PHASE_OFFSET_TABLE,        /* Reading chunk offset table */
-    EXR_PHASE_CHUNK_HEADER,        /* Reading chunk header (y + size) */
-    EXR_PHASE_CHUNK_DATA,          /* Reading compressed chunk data */
-} ExrParsePhase;
+/* Same callback as memory sources; a distinct function so that
+ * exr_data_source_close can recognize file sources */
+static ExrResult file_source_fetch(void* userdata, uint64_t offset, uint64_t size,
+                                   void* dst, ExrFetchComplete on_complete,
+                                   void* complete_userdata) {
+    return memory_source_fetch(userdata, offset, size, dst, on_complete,
+                               complete_userdata);
+}
 
-/* Forward declaration for suspend state */
-struct ExrSuspendState_T;
-typedef struct ExrSuspendState_T* ExrSuspendState_Internal;
+static ExrResult file_source_map_file(const char* filename, ExrMemorySourceData* view) {
+#if defined(_WIN32)
+    /* Paths are UTF-8 */
+    HANDLE file = INVALID_HANDLE_VALUE;
+    int wide_len = MultiByteToWideChar(CP_UTF8, 0, filename, -1, NULL, 0);
+    wchar_t* wide_name = wide_len > 0 ?
+        (wchar_t*)malloc((size_t)wide_len * sizeof(wchar_t)) : NULL;
+    if (wide_name) {
+        MultiByteToWideChar(CP_UTF8, 0, filename, -1, wide_name, wide_len);
+        file = CreateFileW(wide_name, GENERIC_READ, FILE_SHARE_READ, NULL,
+                           OPEN_EXISTING, FILE_ATTRIBUTE_READONLY, NULL);
+        free(wide_name);
+    }
+    if (file == INVALID_HANDLE_VALUE) {
+        return EXR_ERROR_IO;
+    }
+
+    LARGE_INTEGER file_size;
+    HANDLE mapping = NULL;
+    void* data = NULL;
+    if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0 &&
+        (ULONGLONG)file_size.QuadPart <= (ULONGLONG)SIZE_MAX) {
+        mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping) {
+            data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+        }
+    }
+    CloseHandle(file);
+    if (!data) {
+        return EXR_ERROR_IO;
+    }
 
-struct ExrDecoder_T {
-    ExrContext ctx;
-    ExrDataSource source;
-    ExrMemoryPool scratch_pool;
-    uint32_t flags;
-    ExrDecoderState state;
+    view->data = (const uint8_t*)data;
+    view->size = (size_t)file_size.QuadPart;
+#else
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return EXR_ERROR_IO;
+    }
 
-    /* Parsing state */
-    uint64_t current_offset;
-    uint8_t* read_buffer;
-    size_t read_buffer_size;
+    struct stat info;
+    void* data = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0 &&
+        (uint64_t)info.st_size <= (uint64_t)SIZE_MAX) {
+        data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (data == MAP_FAILED) {
+        return EXR_ERROR_IO;
+    }
 
-    /* Async state for suspend/resume */
-    ExrSuspendState suspend_state;
-    ExrParsePhase current_phase;
-    uint32_t current_part_index;
-    uint32_t current_chunk_index;
+    view->data = (const uint8_t*)data;
+    view->size = (size_t)info.st_size;
+#endif
+    return EXR_SUCCESS;
+}
 
-    /* Parsed image */
-    ExrImage image;
+ExrResult exr_data_source_from_file(const char* filename, ExrDataSource* out_source) {
+    if (!filename || !out_source) {
+        return EXR_ERROR_INVALID_ARGUMENT;
+    }
 
-    /* Progress */
-    ExrProgressCallback progress_callback;
-    void* progress_userdata;
-    int32_t progress_interval_ms;
+    ExrMemorySourceData* view = (ExrMemorySourceData*)malloc(sizeof(ExrMemorySourceData));
+    if (!view) {
+        return EXR_ERROR_OUT_OF_MEMORY;
+    }
 
-    uint32_t magic;
-};
+    ExrResult result = file_source_map_file(filename, view);
+    if (EXR_FAILED(result)) {
+        free(view);
+        return result;
+    }
 
-#define EXR_DECODER_MAGIC 0x44454352  /* 'DECR' */
+    out_source->userdata = view;
+    out_source->fetch = file_source_fetch;
+    out_source->cancel = NULL;
+    out_source->total_size = view->size;
+    out_source->flags = EXR_DATA_SOURCE_SEEKABLE | EXR_DATA_SOURCE_SIZE_KNOWN |
+                        EXR_DATA_SOURCE_CONCURRENT;
+    out_source->fetch_batch = NULL;
+    out_source->coalesce_gap = 0;
+    out_source->map = memory_source_map;
+
+    return EXR_SUCCESS;
+}
+
+/* ============================================================================
+ * Asynchronous Data Source from File
+ *
+ * Fetches with a completion callback are queued and completed on threads
+ * owned by the source, up to queue_depth at a time, so a submit can keep many
+ * chunk reads in flight (EXR_DATA_SOURCE_BACKGROUND_IO). On Linux the reads
+ * go through an io_uring with one reaper thread; elsewhere, or when the ring
+ * cannot be set up, a small set of threads issues positional reads.
+ * Fetches without a callback are read synchronously on the calling thread.
+ * ============================================================================ */
+
+#define EXR_ASYNC_FILE_DEFAULT_DEPTH 32
+#define EXR_ASYNC_FILE_MAX_THREADS 8
+#define EXR_ASYNC_FILE_MAX_READ ((uint64_t)1 << 30)  /* Per read call */
+
+#if defined(_WIN32)
+typedef HANDLE exr_file_t;
+#else
+typedef int exr_file_t;
+#endif
+
+typedef struct ExrFileRequest {
+    uint64_t offset;
+    uint64_t size;
+    uint64_t done;                 /* Bytes read so far */
+    uint8_t* dst;
+    ExrFetchComplete on_complete;
+    void* complete_userdata;
+    struct ExrFileRequest* next;
+} ExrFileRequest;
+
+#if defined(EXR_HAVE_IO_URING)
+typedef struct ExrIoUring {
+    int fd;
+    uint32_t entries;
+    uint8_t* sq_ring;
+    size_t sq_ring_size;
+    uint8_t* cq_ring;
+    size_t cq_ring_size;
+    struct io_uring_sqe* sqes;
+    size_t sqes_size;
+    uint32_t* sq_head;
+    uint32_t* sq_tail;
+    uint32_t* sq_mask;
+    uint32_t* sq_array;
+    uint32_t* cq_head;
+    uint32_t* cq_tail;
+    uint32_t* cq_mask;
+    struct io_uring_cqe* cqes;
+} ExrIoUring;
+#endif
+
+typedef struct ExrAsyncFileSource {
+    exr_file_t file;
+    uint64_t size;
+
+    exr_mutex_t lock;
+    exr_cond_t cond;               /* Request queued, slot freed or shutdown */
+    ExrFileRequest* queue_head;    /* Queued, not yet issued */
+    ExrFileRequest* queue_tail;
+    uint32_t in_flight;            /* Issued, not yet completed */
+    uint32_t queue_depth;
+    int shutdown;
+
+    exr_thread_t* threads;
+    uint32_t num_threads;
+
+#if defined(EXR_HAVE_IO_URING)
+    ExrIoUring ring;
+    int use_ring;
+#endif
+} ExrAsyncFileSource;
+
+/* Positional read of exactly size bytes; safe to call from several threads */
+static ExrResult exr_file_read_at(exr_file_t file, uint64_t offset, void* dst, uint64_t size) {
+    uint8_t* out = (uint8_t*)dst;
+    while (size > 0) {
+        uint64_t request = size < EXR_ASYNC_FILE_MAX_READ ? size : EXR_ASYNC_FILE_MAX_READ;
+#if defined(_WIN32)
+        OVERLAPPED overlapped;
+        DWORD read = 0;
+        memset(&overlapped, 0, sizeof(overlapped));
+        overlapped.Offset = (DWORD)(offset & 0xFFFFFFFFu);
+        overlapped.OffsetHigh = (DWORD)(offset >> 32);
+        if (!ReadFile(file, out, (DWORD)request, &read, &overlapped) || read == 0) {
+            return EXR_ERROR_IO;
+        }
+#else
+        ssize_t read = pread(file, out, (size_t)request, (off_t)offset);
+        if (read < 0 && errno == EINTR) continue;
+        if (read <= 0) {
+            return EXR_ERROR_IO;
+        }
+#endif
+        out += read;
+        offset += (uint64_t)read;
+        size -= (uint64_t)read;
+    }
+    return EXR_SUCCESS;
+}
+
+static void exr_file_request_finish(ExrFileRequest* request, ExrResult result) {
+    request->on_complete(request->complete_userdata, result,
+                         EXR_SUCCEEDED(result) ? (size_t)request->size : 0);
+    free(request);
+}
+
+/* Pop the next queued request (lock held) */
+static ExrFileRequest* exr_async_file_pop(ExrAsyncFileSource* src) {
+    ExrFileRequest* request = src->queue_head;
+    if (request) {
+        src->queue_head = request->next;
+        if (!src->queue_head) src->queue_tail = NULL;
+        request->next = NULL;
+    }
+    return request;
+}
+
+#if defined(EXR_HAVE_IO_URING)
+
+static int exr_io_uring_enter(int fd, uint32_t to_submit, uint32_t min_complete,
+                              uint32_t flags) {
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags,
+                        NULL, 0);
+}
+
+static void exr_io_uring_destroy(ExrIoUring* ring) {
+    if (ring->sqes) munmap(ring->sqes, ring->sqes_size);
+    if (ring->cq_ring && ring->cq_ring != ring->sq_ring) {
+        munmap(ring->cq_ring, ring->cq_ring_size);
+    }
+    if (ring->sq_ring) munmap(ring->sq_ring, ring->sq_ring_size);
+    if (ring->fd >= 0) close(ring->fd);
+    memset(ring, 0, sizeof(ExrIoUring));
+    ring->fd = -1;
+}
+
+/* Set up a ring with room for 'entries' reads. Returns 0 when io_uring is
+ * unavailable (old kernel, seccomp, ...). */
+static int exr_io_uring_init(ExrIoUring* ring, uint32_t entries) {
+    struct io_uring_params params;
+    memset(ring, 0, sizeof(ExrIoUring));
+    memset(&params, 0, sizeof(params));
+
+    ring->fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    if (ring->fd < 0) {
+        return 0;
+    }
+    ring->entries = params.sq_entries;
+
+    ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (ring->cq_ring_size > ring->sq_ring_size) ring->sq_ring_size = ring->cq_ring_size;
+        ring->cq_ring_size = ring->sq_ring_size;
+    }
+
+    void* sq = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                    ring->fd, IORING_OFF_SQ_RING);
+    if (sq == MAP_FAILED) {
+        exr_io_uring_destroy(ring);
+        return 0;
+    }
+    ring->sq_ring = (uint8_t*)sq;
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        ring->cq_ring = ring->sq_ring;
+    } else {
+        void* cq = mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                        ring->fd, IORING_OFF_CQ_RING);
+        if (cq == MAP_FAILED) {
+            exr_io_uring_destroy(ring);
+            return 0;
+        }
+        ring->cq_ring = (uint8_t*)cq;
+    }
+
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    void* sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                      ring->fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        exr_io_uring_destroy(ring);
+        return 0;
+    }
+    ring->sqes = (struct io_uring_sqe*)sqes;
+
+    ring->sq_head = (uint32_t*)(ring->sq_ring + params.sq_off.head);
+    ring->sq_tail = (uint32_t*)(ring->sq_ring + params.sq_off.tail);
+    ring->sq_mask = (uint32_t*)(ring->sq_ring + params.sq_off.ring_mask);
+    ring->sq_array = (uint32_t*)(ring->sq_ring + params.sq_off.array);
+    ring->cq_head = (uint32_t*)(ring->cq_ring + params.cq_off.head);
+    ring->cq_tail = (uint32_t*)(ring->cq_ring + params.cq_off.tail);
+    ring->cq_mask = (uint32_t*)(ring->cq_ring + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe*)(ring->cq_ring + params.cq_off.cqes);
+    return 1;
+}
+
+/* Queue one SQE (lock held). A NULL request is the reaper's wake-up NOP. */
+static void exr_io_uring_push(ExrAsyncFileSource* src, ExrFileRequest* request) {
+    ExrIoUring* ring = &src->ring;
+    uint32_t tail = *ring->sq_tail;
+    uint32_t index = tail & *ring->sq_mask;
+    struct io_uring_sqe* sqe = &ring->sqes[index];
+
+    memset(sqe, 0, sizeof(*sqe));
+    if (request) {
+        uint64_t remaining = request->size - request->done;
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = src->file;
+        sqe->off = request->offset + request->done;
+        sqe->addr = (uint64_t)(uintptr_t)(request->dst + request->done);
+        sqe->len = (uint32_t)(remaining < EXR_ASYNC_FILE_MAX_READ ?
+                              remaining : EXR_ASYNC_FILE_MAX_READ);
+    } else {
+        sqe->opcode = IORING_OP_NOP;
+    }
+    sqe->user_data = (uint64_t)(uintptr_t)request;
+
+    ring->sq_array[index] = index;
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    src->in_flight++;
+}
+
+/* Issue queued requests while ring slots are free (lock held) */
+static void exr_io_uring_issue(ExrAsyncFileSource* src) {
+    uint32_t count = 0;
+    while (src->queue_head && src->in_flight < src->queue_depth) {
+        exr_io_uring_push(src, exr_async_file_pop(src));
+        count++;
+    }
+    if (count > 0) {
+        exr_io_uring_enter(src->ring.fd, count, 0, 0);
+    }
+}
+
+/* Reaper: wait for completions, finish or continue requests, refill the ring */
+#if defined(_WIN32)
+static DWORD WINAPI exr_io_uring_reaper(LPVOID arg)
+#else
+static void* exr_io_uring_reaper(void* arg)
+#endif
+{
+    ExrAsyncFileSource* src = (ExrAsyncFileSource*)arg;
+    ExrIoUring* ring = &src->ring;
+    int running = 1;
+
+    while (running) {
+        if (exr_io_uring_enter(ring->fd, 0, 1, IORING_ENTER_GETEVENTS) < 0 &&
+            errno != EINTR) {
+            break;
+        }
+
+        uint32_t head = *ring->cq_head;
+        uint32_t tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+        for (; head != tail; head++) {
+            struct io_uring_cqe* cqe = &ring->cqes[head & *ring->cq_mask];
+            ExrFileRequest* request = (ExrFileRequest*)(uintptr_t)cqe->user_data;
+            int res = cqe->res;
+            __atomic_store_n(ring->cq_head, head + 1, __ATOMIC_RELEASE);
+
+            exr_mutex_lock(&src->lock);
+            src->in_flight--;
+            exr_mutex_unlock(&src->lock);
+
+            if (!request) {
+                running = 0;  /* Shutdown NOP; everything else has completed */
+                continue;
+            }
+
+            ExrResult result = EXR_SUCCESS;
+            if (res > 0) {
+                request->done += (uint64_t)res;
+                if (request->done < request->size) {
+                    /* Short read: queue the remainder */
+                    exr_mutex_lock(&src->lock);
+                    request->next = NULL;
+                    if (src->queue_tail) src->queue_tail->next = request;
+                    else src->queue_head = request;
+                    src->queue_tail = request;
+                    exr_mutex_unlock(&src->lock);
+                    continue;
+                }
+            } else if (res == -EINVAL || res == -EOPNOTSUPP || res == -EAGAIN ||
+                       res == -EINTR) {
+                /* IORING_OP_READ unsupported by this kernel, or transient */
+                result = exr_file_read_at(src->file, request->offset + request->done,
+                                          request->dst + request->done,
+                                          request->size - request->done);
+            } else {
+                result = EXR_ERROR_IO;
+            }
+            exr_file_request_finish(request, result);
+        }
+
+        exr_mutex_lock(&src->lock);
+        exr_io_uring_issue(src);
+        exr_cond_broadcast(&src->cond);
+        exr_mutex_unlock(&src->lock);
+    }
+
+#if defined(_WIN32)
+    return 0;
+#else
+    return NULL;
+#endif
+}
+
+#endif /* EXR_HAVE_IO_URING */
+
+/* Read worker for sources without an io_uring */
+#if defined(_WIN32)
+static DWORD WINAPI exr_async_file_worker(LPVOID arg)
+#else
+static void* exr_async_file_worker(void* arg)
+#endif
+{
+    ExrAsyncFileSource* src = (ExrAsyncFileSource*)arg;
+
+    exr_mutex_lock(&src->lock);
+    for (;;) {
+        ExrFileRequest* request = exr_async_file_pop(src);
+        if (!request) {
+            if (src->shutdown) break;
+            exr_cond_wait(&src->cond, &src->lock);
+            continue;
+        }
+        src->in_flight++;
+        exr_mutex_unlock(&src->lock);
+
+        ExrResult result = exr_file_read_at(src->file, request->offset, request->dst,
+                                            request->size);
+        exr_file_request_finish(request, result);
+
+        exr_mutex_lock(&src->lock);
+        src->in_flight--;
+        exr_cond_broadcast(&src->cond);
+    }
+    exr_mutex_unlock(&src->lock);
+
+#if defined(_WIN32)
+    return 0;
+#else
+    return NULL;
+#endif
+}
+
+static ExrResult async_file_source_fetch(void* userdata, uint64_t offset, uint64_t size,
+                                         void* dst, ExrFetchComplete on_complete,
+                                         void* complete_userdata) {
+    ExrAsyncFileSource* src = (ExrAsyncFileSource*)userdata;
+
+    /* Same bounds behavior as memory sources: reads are clamped to the file */
+    if (offset >= src->size) {
+        return EXR_ERROR_OUT_OF_BOUNDS;
+    }
+    if (size > src->size - offset) {
+        size = src->size - offset;
+    }
+
+    if (!on_complete || size == 0) {
+        return exr_file_read_at(src->file, offset, dst, size);
+    }
+
+    ExrFileRequest* request = (ExrFileRequest*)malloc(sizeof(ExrFileRequest));
+    if (!request) {
+        return EXR_ERROR_OUT_OF_MEMORY;
+    }
+    request->offset = offset;
+    request->size = size;
+    request->done = 0;
+    request->dst = (uint8_t*)dst;
+    request->on_complete = on_complete;
+    request->complete_userdata = complete_userdata;
+    request->next = NULL;
+
+    exr_mutex_lock(&src->lock);
+    if (src->queue_tail) src->queue_tail->next = request;
+    else src->queue_head = request;
+    src->queue_tail = request;
+#if defined(EXR_HAVE_IO_URING)
+    if (src->use_ring) {
+        exr_io_uring_issue(src);
+    } else
+#endif
+    {
+        exr_cond_broadcast(&src->cond);
+    }
+    exr_mutex_unlock(&src->lock);
+
+    return EXR_WOULD_BLOCK;
+}
+
+static void async_file_source_destroy(ExrAsyncFileSource* src) {
+    /* Let queued and in-flight reads finish, then stop the threads */
+    exr_mutex_lock(&src->lock);
+    src->shutdown = 1;
+    exr_cond_broadcast(&src->cond);
+#if defined(EXR_HAVE_IO_URING)
+    if (src->use_ring) {
+        while (src->queue_head || src->in_flight > 0) {
+            exr_cond_wait(&src->cond, &src->lock);
+        }
+        exr_io_uring_push(src, NULL);
+        exr_io_uring_enter(src->ring.fd, 1, 0, 0);
+    }
+#endif
+    exr_mutex_unlock(&src->lock);
+
+    for (uint32_t i = 0; i < src->num_threads; i++) {
+#if defined(_WIN32)
+        WaitForSingleObject(src->threads[i], INFINITE);
+        CloseHandle(src->threads[i]);
+#else
+        pthread_join(src->threads[i], NULL);
+#endif
+    }
+    free(src->threads);
+
+#if defined(EXR_HAVE_IO_URING)
+    if (src->use_ring) {
+        exr_io_uring_destroy(&src->ring);
+    }
+#endif
+
+#if defined(_WIN32)
+    CloseHandle(src->file);
+#else
+    close(src->file);
+#endif
+    exr_cond_destroy(&src->cond);
+    exr_mutex_destroy(&src->lock);
+    free(src);
+}
+
+static int async_file_source_start_thread(ExrAsyncFileSource* src,
+#if defined(_WIN32)
+                                          LPTHREAD_START_ROUTINE func
+#else
+                                          void* (*func)(void*)
+#endif
+                                          ) {
+#if defined(_WIN32)
+    HANDLE h = CreateThread(NULL, 0, func, src, 0, NULL);
+    if (!h) return 0;
+    src->threads[src->num_threads++] = h;
+#else
+    if (pthread_create(&src->threads[src->num_threads], NULL, func, src) != 0) {
+        return 0;
+    }
+    src->num_threads++;
+#endif
+    return 1;
+}
+
+ExrResult exr_data_source_from_file_async(const char* filename, uint32_t queue_depth,
+                                          ExrDataSource* out_source) {
+    if (!filename || !out_source) {
+        return EXR_ERROR_INVALID_ARGUMENT;
+    }
+    if (queue_depth == 0) {
+        queue_depth = EXR_ASYNC_FILE_DEFAULT_DEPTH;
+    }
+
+    ExrAsyncFileSource* src = (ExrAsyncFileSource*)malloc(sizeof(ExrAsyncFileSource));
+    if (!src) {
+        return EXR_ERROR_OUT_OF_MEMORY;
+    }
+    memset(src, 0, sizeof(ExrAsyncFileSource));
+    src->queue_depth = queue_depth;
+
+#if defined(_WIN32)
+    /* Paths are UTF-8 */
+    src->file = INVALID_HANDLE_VALUE;
+    int wide_len = MultiByteToWideChar(CP_UTF8, 0, filename, -1, NULL, 0);
+    wchar_t* wide_name = wide_len > 0 ?
+        (wchar_t*)malloc((size_t)wide_len * sizeof(wchar_t)) : NULL;
+    if (wide_name) {
+        MultiByteToWideChar(CP_UTF8, 0, filename, -1, wide_name, wide_len);
+        src->file = CreateFileW(wide_name, GENERIC_READ, FILE_SHARE_READ, NULL,
+                                OPEN_EXISTING, FILE_ATTRIBUTE_READONLY, NULL);
+        free(wide_name);
+    }
+    LARGE_INTEGER file_size;
+    if (src->file == INVALID_HANDLE_VALUE || !GetFileSizeEx(src->file, &file_size) ||
+        file_size.QuadPart <= 0) {
+        if (src->file != INVALID_HANDLE_VALUE) CloseHandle(src->file);
+        free(src);
+        return EXR_ERROR_IO;
+    }
+    src->size = (uint64_t)file_size.QuadPart;
+#else
+    src->file = open(filename, O_RDONLY);
+    struct stat info;
+    if (src->file < 0 || fstat(src->file, &info) != 0 || info.st_size <= 0) {
+        if (src->file >= 0) close(src->file);
+        free(src);
+        return EXR_ERROR_IO;
+    }
+    src->size = (uint64_t)info.st_size;
+#endif
+
+    exr_mutex_init(&src->lock);
+    exr_cond_init(&src->cond);
+
+    uint32_t max_threads = queue_depth < EXR_ASYNC_FILE_MAX_THREADS ?
+                           queue_depth : EXR_ASYNC_FILE_MAX_THREADS;
+    src->threads = (exr_thread_t*)malloc(max_threads * sizeof(exr_thread_t));
+    if (!src->threads) {
+        async_file_source_destroy(src);
+        return EXR_ERROR_OUT_OF_MEMORY;
+    }
+
+#if defined(EXR_HAVE_IO_URING)
+    if (exr_io_uring_init(&src->ring, queue_depth)) {
+        if (src->ring.entries < src->queue_depth) src->queue_depth = src->ring.entries;
+        src->use_ring = async_file_source_start_thread(src, exr_io_uring_reaper);
+        if (!src->use_ring) {
+            exr_io_uring_destroy(&src->ring);
+        }
+    }
+    if (!src->use_ring)
+#endif
+    {
+        while (src->num_threads < max_threads &&
+               async_file_source_start_thread(src, exr_async_file_worker)) {
+        }
+    }
+
+    if (src->num_threads == 0) {
+        async_file_source_destroy(src);
+        return EXR_ERROR_IO;
+    }
+
+    out_source->userdata = src;
+    out_source->fetch = async_file_source_fetch;
+    out_source->cancel = NULL;
+    out_source->total_size = src->size;
+    out_source->flags = EXR_DATA_SOURCE_SEEKABLE | EXR_DATA_SOURCE_SIZE_KNOWN |
+                        EXR_DATA_SOURCE_CONCURRENT | EXR_DATA_SOURCE_ASYNC |
+                        EXR_DATA_SOURCE_BACKGROUND_IO;
+    out_source->fetch_batch = NULL;
+    out_source->coalesce_gap = 0;
+    out_source->map = NULL;
+
+    return EXR_SUCCESS;
+}
+
+void exr_data_source_close(ExrDataSource* source) {
+    if (!source || !source->userdata) {
+        return;
+    }
+    if (source->fetch == async_file_source_fetch) {
+        async_file_source_destroy((ExrAsyncFileSource*)source->userdata);
+        source->userdata = NULL;
+        return;
+    }
+    if (source->fetch != file_source_fetch) {
+        return;
+    }
+
+    ExrMemorySourceData* view = (ExrMemorySourceData*)source->userdata;
+#if defined(_WIN32)
+    UnmapViewOfFile((LPCVOID)view->data);
+#else
+    munmap((void*)view->data, view->size);
+#endif
+    free(view);
+    source->userdata = NULL;
+}
+
+/* ============================================================================
+ * Decoder Internal Structure
+ * ============================================================================ */
+
+typedef enum ExrDecoderState {
+    EXR_DECODER_STATE_CREATED = 0,
+    EXR_DECODER_STATE_PARSING_HEADER,
+    EXR_DECODER_STATE_HEADER_PARSED,
+    EXR_DECODER_STATE_LOADING,
+    EXR_DECODER_STATE_ERROR,
+} ExrDecoderState;
+
+/* Parsing phases for async state machine (forward declaration) */
+typedef enum ExrParsePhase {
+    EXR_PHASE_IDLE = 0,
+    EXR_PHASE_VERSION,             /* Reading magic + version bytes */
+    EXR_PHASE_ATTRIBUTE_NAME,      /* Reading attribute name */
+    EXR_PHASE_ATTRIBUTE_DATA,      /* Reading attribute value */
+    EXR_PHASE_END_OF_HEADER,       /* Checking for header terminator */
+    EXR_PHASE_OFFSET_TABLE,        /* Reading chunk offset table */
+    EXR_PHASE_CHUNK_HEADER,        /* Reading chunk header (y + size) */
+    EXR_PHASE_CHUNK_DATA,          /* Reading compressed chunk data */
+} ExrParsePhase;
+
+/* Forward declaration for suspend state */
+struct ExrSuspendState_T;
+typedef struct ExrSuspendState_T* ExrSuspendState_Internal;
+
+struct ExrDecoder_T {
+    ExrContext ctx;
+    ExrDataSource source;
+    ExrMemoryPool scratch_pool;
+    uint32_t flags;
+    ExrDecoderState state;
+
+    /* Serializes source fetches from pool workers */
+    exr_mutex_t fetch_lock;
+
+    /* Guards on-demand offset table pages (EXR_DECODER_LAZY_LOAD) */
+    exr_mutex_t offsets_lock;
+
+    /* Outstanding EXR_SUBMIT_ASYNC submits */
+    exr_mutex_t submit_lock;
+    exr_cond_t idle_cond;
+    uint32_t pending_submits;
+
+    /* Parsing state */
+    uint64_t current_offset;
+    uint8_t* read_buffer;
+    size_t read_buffer_size;
+
+    /* Async state for suspend/resume */
+    ExrSuspendState suspend_state;
+    ExrParsePhase current_phase;
+    uint32_t current_part_index;
+    uint32_t current_chunk_index;
+
+    /* Parsed image */
+    ExrImage image;
+
+    /* Progress */
+    ExrProgressCallback progress_callback;
+    void* progress_userdata;
+    int32_t progress_interval_ms;
+
+    uint32_t magic;
+};
+
+#define EXR_DECODER_MAGIC 0x44454352  /* 'DECR' */
 
 /* ============================================================================
  * Async/WASM Suspend State Structure
@@ -779,6 +2062,10 @@ ExrResult exr_decoder_create(ExrContext ctx,
     decoder->flags = create_info->flags;
     decoder->state = EXR_DECODER_STATE_CREATED;
     decoder->magic = EXR_DECODER_MAGIC;
+    exr_mutex_init(&decoder->fetch_lock);
+    exr_mutex_init(&decoder->offsets_lock);
+    exr_mutex_init(&decoder->submit_lock);
+    exr_cond_init(&decoder->idle_cond);
 
     exr_context_add_ref(ctx);
     *out_decoder = decoder;
@@ -788,6 +2075,9 @@ ExrResult exr_decoder_create(ExrContext ctx,
 void exr_decoder_destroy(ExrDecoder decoder) {
     if (!exr_decoder_is_valid(decoder)) return;
 
+    /* Async submits still reference the decoder */
+    exr_decoder_wait_idle(decoder);
+
     ExrContext ctx = decoder->ctx;
     decoder->magic = 0;
 
@@ -810,6 +2100,11 @@ void exr_decoder_destroy(ExrDecoder decoder) {
         exr_image_destroy(decoder->image);
     }
 
+    exr_cond_destroy(&decoder->idle_cond);
+    exr_mutex_destroy(&decoder->submit_lock);
+    exr_mutex_destroy(&decoder->fetch_lock);
+    exr_mutex_destroy(&decoder->offsets_lock);
+
     ctx->allocator.free(ctx->allocator.userdata, decoder,
                         sizeof(struct ExrDecoder_T));
     exr_context_release(ctx);
@@ -833,6 +2128,12 @@ ExrResult exr_decoder_set_progress_callback(ExrDecoder decoder,
  * Image Internal Structure
  * ============================================================================ */
 
+/* With EXR_DECODER_LAZY_LOAD, offset tables are fetched in pages of this
+ * many entries (2 KB) the first time one of their chunks is read */
+#define EXR_OFFSET_PAGE_SIZE 256
+#define EXR_OFFSET_PAGE_COUNT(num_chunks) \
+    (((size_t)(num_chunks) + EXR_OFFSET_PAGE_SIZE - 1) / EXR_OFFSET_PAGE_SIZE)
+
 typedef struct ExrChannelData {
     char name[64];
     uint32_t pixel_type;
@@ -863,6 +2164,8 @@ typedef struct ExrPartData {
     /* Offset table */
     uint64_t* offsets;
     uint32_t num_chunks;
+    uint64_t offset_table_pos;     /* File position of the offset table */
+    uint8_t* offset_pages_loaded;  /* EXR_DECODER_LAZY_LOAD: per-page flags, else NULL */
 
     /* Tile info */
     uint32_t tile_size_x;
@@ -930,6 +2233,10 @@ void exr_image_destroy(ExrImage image) {
             ctx->allocator.free(ctx->allocator.userdata, part->offsets,
                                part->num_chunks * sizeof(uint64_t));
         }
+        if (part->offset_pages_loaded) {
+            ctx->allocator.free(ctx->allocator.userdata, part->offset_pages_loaded,
+                               EXR_OFFSET_PAGE_COUNT(part->num_chunks));
+        }
         if (part->attributes) {
             for (uint32_t j = 0; j < part->num_attributes; j++) {
                 if (part->attributes[j].value) {
@@ -1187,6 +2494,7 @@ ExrResult exr_part_get_chunk_count(ExrPart part, uint32_t* out_count) {
 struct ExrFence_T {
     ExrContext ctx;
     ATOMIC_INT signaled;
+    ExrResult result;  /* Outcome of the work that signaled the fence */
     uint32_t magic;
 
 #if defined(_WIN32)
@@ -1268,11 +2576,11 @@ ExrResult exr_fence_wait(ExrFence fence, uint64_t timeout_ns) {
 
     /* Fast path: already signaled */
     if (ATOMIC_LOAD(fence->signaled)) {
-        return EXR_SUCCESS;
+        return fence->result;
     }
 
     if (timeout_ns == EXR_TIMEOUT_NONE) {
-        return ATOMIC_LOAD(fence->signaled) ? EXR_SUCCESS : EXR_ERROR_NOT_READY;
+        return EXR_ERROR_NOT_READY;
     }
 
 #if defined(_WIN32)
@@ -1280,7 +2588,7 @@ ExrResult exr_fence_wait(ExrFence fence, uint64_t timeout_ns) {
                        (DWORD)(timeout_ns / 1000000);
     DWORD result = WaitForSingleObject(fence->event, timeout_ms);
     if (result == WAIT_OBJECT_0) {
-        return EXR_SUCCESS;
+        return fence->result;
     } else if (result == WAIT_TIMEOUT) {
         return EXR_ERROR_TIMEOUT;
     }
@@ -1313,7 +2621,7 @@ ExrResult exr_fence_wait(ExrFence fence, uint64_t timeout_ns) {
     }
 
     pthread_mutex_unlock(&fence->mutex);
-    return EXR_SUCCESS;
+    return fence->result;
 #endif
 }
 
@@ -1321,7 +2629,7 @@ ExrResult exr_fence_get_status(ExrFence fence) {
     if (!fence || fence->magic != EXR_FENCE_MAGIC) {
         return EXR_ERROR_INVALID_HANDLE;
     }
-    return ATOMIC_LOAD(fence->signaled) ? EXR_SUCCESS : EXR_ERROR_NOT_READY;
+    return ATOMIC_LOAD(fence->signaled) ? fence->result : EXR_ERROR_NOT_READY;
 }
 
 ExrResult exr_fence_reset(ExrFence fence) {
@@ -1330,6 +2638,7 @@ ExrResult exr_fence_reset(ExrFence fence) {
     }
 
     ATOMIC_STORE(fence->signaled, 0);
+    fence->result = EXR_SUCCESS;
 
 #if defined(_WIN32)
     ResetEvent(fence->event);
@@ -1338,10 +2647,11 @@ ExrResult exr_fence_reset(ExrFence fence) {
     return EXR_SUCCESS;
 }
 
-/* Signal fence (internal function) */
-static void exr_fence_signal(ExrFence fence) {
+/* Signal fence with the result of the work it tracks (internal function) */
+static void exr_fence_signal(ExrFence fence, ExrResult result) {
     if (!fence || fence->magic != EXR_FENCE_MAGIC) return;
 
+    fence->result = result;  /* Published by the store below */
     ATOMIC_STORE(fence->signaled, 1);
 
 #if defined(_WIN32)
@@ -1389,6 +2699,7 @@ typedef struct ExrTileReadCmd {
     uint32_t channels_mask;
     uint32_t output_pixel_type;
     uint32_t output_layout;
+    const ExrFrameBuffer* framebuffer;
 } ExrTileReadCmd;
 
 /* Scanline read command */
@@ -1401,6 +2712,7 @@ typedef struct ExrScanlineReadCmd {
     uint32_t channels_mask;
     uint32_t output_pixel_type;
     uint32_t output_layout;
+    const ExrFrameBuffer* framebuffer;
 } ExrScanlineReadCmd;
 
 /* Full image read command */
@@ -1412,6 +2724,7 @@ typedef struct ExrFullImageReadCmd {
     uint32_t output_pixel_type;
     uint32_t output_layout;
     int32_t target_level;
+    const ExrFrameBuffer* framebuffer;
 } ExrFullImageReadCmd;
 
 /* Scanline write command */
@@ -1674,7 +2987,8 @@ ExrResult exr_cmd_request_tile(ExrCommandBuffer cmd, const ExrTileRequest* reque
     if (!cmd->recording) {
         return EXR_ERROR_INVALID_STATE;
     }
-    if (!request || !request->part || !request->output.data) {
+    if (!request || !request->part ||
+        (!request->output.data && !request->framebuffer)) {
         return EXR_ERROR_INVALID_ARGUMENT;
     }
 
@@ -1693,6 +3007,7 @@ ExrResult exr_cmd_request_tile(ExrCommandBuffer cmd, const ExrTileRequest* reque
     tile_cmd->channels_mask = request->channels_mask;
     tile_cmd->output_pixel_type = request->output_pixel_type;
     tile_cmd->output_layout = request->output_layout;
+    tile_cmd->framebuffer = request->framebuffer;
 
     cmd->command_count++;
     return EXR_SUCCESS;
@@ -1722,7 +3037,8 @@ ExrResult exr_cmd_request_scanlines(ExrCommandBuffer cmd,
     if (!cmd->recording) {
         return EXR_ERROR_INVALID_STATE;
     }
-    if (!request || !request->part || !request->output.data) {
+    if (!request || !request->part ||
+        (!request->output.data && !request->framebuffer)) {
         return EXR_ERROR_INVALID_ARGUMENT;
     }
 
@@ -1739,6 +3055,7 @@ ExrResult exr_cmd_request_scanlines(ExrCommandBuffer cmd,
     scan_cmd->channels_mask = request->channels_mask;
     scan_cmd->output_pixel_type = request->output_pixel_type;
     scan_cmd->output_layout = request->output_layout;
+    scan_cmd->framebuffer = request->framebuffer;
 
     cmd->command_count++;
     return EXR_SUCCESS;
@@ -1768,7 +3085,8 @@ ExrResult exr_cmd_request_full_image(ExrCommandBuffer cmd,
     if (!cmd->recording) {
         return EXR_ERROR_INVALID_STATE;
     }
-    if (!request || !request->part || !request->output.data) {
+    if (!request || !request->part ||
+        (!request->output.data && !request->framebuffer)) {
         return EXR_ERROR_INVALID_ARGUMENT;
     }
 
@@ -1784,6 +3102,7 @@ ExrResult exr_cmd_request_full_image(ExrCommandBuffer cmd,
     full_cmd->output_pixel_type = request->output_pixel_type;
     full_cmd->output_layout = request->output_layout;
     full_cmd->target_level = request->target_level;
+    full_cmd->framebuffer = request->framebuffer;
 
     cmd->command_count++;
     return EXR_SUCCESS;
@@ -1799,10 +3118,12 @@ ExrResult exr_cmd_request_full_image(ExrCommandBuffer cmd,
 #include "tinyexr_huffman.hh"
 #include "tinyexr_piz.hh"
 #include "tinyexr_v2_impl.hh"
+#include "tinyexr_dwa.hh"
 #define TINYEXR_V3_HAS_DEFLATE 1
 #define TINYEXR_V3_HAS_PIZ 1
 #define TINYEXR_V3_HAS_PXR24 1
 #define TINYEXR_V3_HAS_B44 1
+#define TINYEXR_V3_HAS_DWA 1
 
 /* Include tinyexr.h for EXRChannelInfo type if any V1 wrappers are enabled */
 #if defined(TINYEXR_V3_ENABLE_PIZ) || defined(TINYEXR_V3_ENABLE_PXR24) || defined(TINYEXR_V3_ENABLE_B44)
@@ -1847,11 +3168,50 @@ static int32_t read_le_i32(const uint8_t* p);
 static uint32_t read_le_u32(const uint8_t* p);
 static uint64_t read_le_u64(const uint8_t* p);
 static ExrResult sync_fetch(ExrDecoder decoder, uint64_t offset, uint64_t size, void* dst);
+static ExrResult chunk_fetch(ExrDecoder decoder, const ExrScratch* scratch,
+                             uint64_t offset, uint64_t size, void* dst);
+static ExrResult chunk_view(ExrDecoder decoder, ExrScratch* scratch,
+                            uint64_t offset, uint64_t size,
+                            const uint8_t** out_data, uint8_t** out_copy);
+static ExrResult get_chunk_offset(ExrDecoder decoder, ExrPartData* part,
+                                  uint32_t chunk_index, uint64_t* out_offset);
+
+/* Undo the ZIP/RLE predictor and byte reorder in one pass. src holds the two
+ * predicted halves (split at (size + 1) / 2) and is not modified. */
+static void decode_predictor_and_reorder(const uint8_t* src, uint8_t* dst, size_t size) {
+#ifdef TINYEXR_V3_USE_SIMD
+    exr_simd_delta_decode_unreorder(src, dst, size);
+#else
+    size_t half_a = (size + 1) / 2;
+    size_t half_b = size / 2;
+    const uint8_t* src_b = src + half_a;
+
+    /* Decoded byte i is 128 + sum(src[0..i] - 128); the second half carries
+       on from the last decoded byte of the first half */
+    uint32_t sum = 0;
+    for (size_t i = 0; i < half_a; i++) {
+        sum += src[i];
+    }
+    uint8_t a = 128;
+    uint8_t b = (uint8_t)(sum + 128 - 128 * (half_a & 1));
+
+    /* Two independent dependency chains instead of one */
+    for (size_t i = 0; i < half_b; i++) {
+        a = (uint8_t)(a + src[i] - 128);
+        b = (uint8_t)(b + src_b[i] - 128);
+        dst[i * 2] = a;
+        dst[i * 2 + 1] = b;
+    }
+    if (half_a > half_b) {
+        dst[size - 1] = (uint8_t)(a + src[half_b] - 128);
+    }
+#endif
+}
 
 /* ZIP decompression with EXR-specific post-processing */
 static ExrResult decompress_zip(const uint8_t* src, size_t src_size,
                                  uint8_t* dst, size_t dst_size,
-                                 size_t* out_size, ExrContext ctx) {
+                                 size_t* out_size, ExrScratch* scratch) {
     /* If sizes match, data is not compressed (Issue 40) */
     if (src_size == dst_size) {
         memcpy(dst, src, src_size);
@@ -1859,9 +3219,29 @@ static ExrResult decompress_zip(const uint8_t* src, size_t src_size,
         return EXR_SUCCESS;
     }
 
+#if defined(TINYEXR_V3_HAS_DEFLATE)
+    /* Inflate straight into dst through a bounded window, undoing the
+       predictor and reorder as bytes are emitted. Streams that are malformed
+       or decode short of dst_size take the buffered path below. */
+    {
+        size_t window_size = dst_size < tinyexr::huffman::DEFLATE_UNPREDICT_WINDOW
+                                 ? dst_size : tinyexr::huffman::DEFLATE_UNPREDICT_WINDOW;
+        uint8_t* window = (uint8_t*)exr_scratch_alloc(scratch, window_size);
+        if (!window) {
+            return EXR_ERROR_OUT_OF_MEMORY;
+        }
+        bool streamed = tinyexr::huffman::inflate_zlib_unpredict(src, src_size, dst, dst_size,
+                                                                 window, window_size);
+        exr_scratch_free(scratch, window, window_size);
+        if (streamed) {
+            *out_size = dst_size;
+            return EXR_SUCCESS;
+        }
+    }
+#endif
+
     /* Allocate temp buffer for decompression */
-    uint8_t* tmpBuf = (uint8_t*)ctx->allocator.alloc(
-        ctx->allocator.userdata, dst_size, EXR_DEFAULT_ALIGNMENT);
+    uint8_t* tmpBuf = (uint8_t*)exr_scratch_alloc(scratch, dst_size);
     if (!tmpBuf) {
         return EXR_ERROR_OUT_OF_MEMORY;
     }
@@ -1871,7 +3251,7 @@ static ExrResult decompress_zip(const uint8_t* src, size_t src_size,
     size_t uncomp_size = dst_size;
     bool ok = tinyexr::huffman::inflate_zlib(src, src_size, tmpBuf, &uncomp_size);
     if (!ok) {
-        ctx->allocator.free(ctx->allocator.userdata, tmpBuf, dst_size);
+        exr_scratch_free(scratch, tmpBuf, dst_size);
         return EXR_ERROR_DECOMPRESSION_FAILED;
     }
 #elif defined(TINYEXR_V3_USE_MINIZ)
@@ -1879,40 +3259,19 @@ static ExrResult decompress_zip(const uint8_t* src, size_t src_size,
     mz_ulong uncomp_size = (mz_ulong)dst_size;
     int ret = mz_uncompress(tmpBuf, &uncomp_size, src, (mz_ulong)src_size);
     if (ret != MZ_OK) {
-        ctx->allocator.free(ctx->allocator.userdata, tmpBuf, dst_size);
+        exr_scratch_free(scratch, tmpBuf, dst_size);
         return EXR_ERROR_DECOMPRESSION_FAILED;
     }
 #else
-    ctx->allocator.free(ctx->allocator.userdata, tmpBuf, dst_size);
+    exr_scratch_free(scratch, tmpBuf, dst_size);
     (void)src; (void)src_size; (void)dst; (void)dst_size; (void)out_size;
     return EXR_ERROR_UNSUPPORTED_FORMAT;
 #endif
 
-    /* Apply EXR predictor (delta decoding) */
-    {
-        uint8_t* t = tmpBuf + 1;
-        uint8_t* stop = tmpBuf + uncomp_size;
-        while (t < stop) {
-            int d = (int)t[-1] + (int)t[0] - 128;
-            t[0] = (uint8_t)d;
-            ++t;
-        }
-    }
-
-    /* Reorder pixel data (interleave two halves) */
-    {
-        const uint8_t* t1 = tmpBuf;
-        const uint8_t* t2 = tmpBuf + (uncomp_size + 1) / 2;
-        uint8_t* s = dst;
-        uint8_t* stop = dst + uncomp_size;
-
-        while (s < stop) {
-            if (s < stop) *s++ = *t1++;
-            if (s < stop) *s++ = *t2++;
-        }
-    }
+    /* Apply EXR predictor (delta decoding) and interleave the two halves */
+    decode_predictor_and_reorder(tmpBuf, dst, uncomp_size);
 
-    ctx->allocator.free(ctx->allocator.userdata, tmpBuf, dst_size);
+    exr_scratch_free(scratch, tmpBuf, dst_size);
     *out_size = uncomp_size;
     return EXR_SUCCESS;
 }
@@ -1959,8 +3318,6 @@ static int get_bytes_per_pixel(uint32_t pixel_type) {
 
 #define PIZ_BITMAP_SIZE 8192
 #define PIZ_USHORT_RANGE 65536
-#define PIZ_HUF_ENCBITS 16
-#define PIZ_HUF_ENCSIZE ((1 << PIZ_HUF_ENCBITS) + 1)
 
 /* PIZ channel data structure */
 typedef struct {
@@ -1993,297 +3350,15 @@ static void piz_apply_lut(const uint16_t* lut, uint16_t* data, int n) {
     }
 }
 
-/* Wavelet decode (16-bit lifting scheme) */
-static void piz_wav2_decode(uint16_t* in, int nx, int ox, int ny, int oy, uint16_t mx) {
-    int w14 = (mx < (1 << 14)) ? (mx + 1) : (1 << 14);
-    int n = (nx > ny) ? ny : nx;
-    int p = 1;
-    int p2;
-
-    while (p <= n) p <<= 1;
-    p >>= 1;
-    p2 = p;
-    p >>= 1;
-
-    for (; p >= 1; p2 = p, p >>= 1) {
-        uint16_t* py = in;
-        uint16_t* ey = in + oy * (ny - p2);
-        int oy1 = oy * p;
-        int oy2 = oy * p2;
-        int ox1 = ox * p;
-        int ox2 = ox * p2;
-
-        for (; py <= ey; py += oy2) {
-            uint16_t* px = py;
-            uint16_t* ex = py + ox * (nx - p2);
-
-            for (; px <= ex; px += ox2) {
-                uint16_t* p00 = px;
-                uint16_t* p10 = px + ox1;
-                uint16_t* p01 = px + oy1;
-                uint16_t* p11 = px + ox1 + oy1;
-
-                uint16_t s00 = *p00;
-                uint16_t s10 = *p10;
-                uint16_t s01 = *p01;
-                uint16_t s11 = *p11;
-
-                /* Wdec14 for s00, s10 */
-                int d = s10;
-                int m = s00;
-                if (d > (w14 - 1) || d < -(w14 - 1)) {
-                    m = ((d >= 0) ? (d - (w14 - 1)) : (d + (w14 - 1)));
-                    d -= m;
-                }
-                s10 = (uint16_t)(s00 + d);
-                s00 = (uint16_t)(s00 - d);
-
-                /* Wdec14 for s01, s11 */
-                d = s11;
-                m = s01;
-                if (d > (w14 - 1) || d < -(w14 - 1)) {
-                    m = ((d >= 0) ? (d - (w14 - 1)) : (d + (w14 - 1)));
-                    d -= m;
-                }
-                s11 = (uint16_t)(s01 + d);
-                s01 = (uint16_t)(s01 - d);
-
-                /* Wdec14 for s00, s01 */
-                d = s01;
-                m = s00;
-                if (d > (w14 - 1) || d < -(w14 - 1)) {
-                    m = ((d >= 0) ? (d - (w14 - 1)) : (d + (w14 - 1)));
-                    d -= m;
-                }
-                *p01 = (uint16_t)(s00 + d);
-                *p00 = (uint16_t)(s00 - d);
-
-                /* Wdec14 for s10, s11 */
-                d = s11;
-                m = s10;
-                if (d > (w14 - 1) || d < -(w14 - 1)) {
-                    m = ((d >= 0) ? (d - (w14 - 1)) : (d + (w14 - 1)));
-                    d -= m;
-                }
-                *p11 = (uint16_t)(s10 + d);
-                *p10 = (uint16_t)(s10 - d);
-            }
-
-            /* Handle remaining column if width is odd */
-            if ((nx & p) != 0) {
-                uint16_t* p00 = px;
-                uint16_t* p01 = px + oy1;
-
-                uint16_t s00 = *p00;
-                uint16_t s01 = *p01;
-
-                int d = s01;
-                if (d > (w14 - 1) || d < -(w14 - 1)) {
-                    d = ((d >= 0) ? (d - (w14 - 1)) : (d + (w14 - 1)));
-                }
-                *p01 = (uint16_t)(s00 + d);
-                *p00 = (uint16_t)(s00 - d);
-            }
-        }
-
-        /* Handle remaining row if height is odd */
-        if ((ny & p) != 0) {
-            uint16_t* px = py;
-            uint16_t* ex = py + ox * (nx - p2);
-
-            for (; px <= ex; px += ox2) {
-                uint16_t* p00 = px;
-                uint16_t* p10 = px + ox1;
-
-                uint16_t s00 = *p00;
-                uint16_t s10 = *p10;
-
-                int d = s10;
-                if (d > (w14 - 1) || d < -(w14 - 1)) {
-                    d = ((d >= 0) ? (d - (w14 - 1)) : (d + (w14 - 1)));
-                }
-                *p10 = (uint16_t)(s00 + d);
-                *p00 = (uint16_t)(s00 - d);
-            }
-        }
-    }
-}
-
-/* Huffman table entry */
-typedef struct {
-    uint64_t code;
-    int len;
-} HufCode;
-
-/* Huffman decoder table for fast path */
-#define HUF_DECBITS 10
-#define HUF_DECSIZE (1 << HUF_DECBITS)
-#define HUF_DECMASK (HUF_DECSIZE - 1)
-
-/* Decode Huffman symbol using table lookup */
-static int piz_huf_decode_symbol(const uint64_t* hdec, const uint16_t* hdec_short,
-                                  const uint8_t* data, size_t data_len,
-                                  size_t* bit_pos, uint64_t* buffer, int* bits_in_buffer) {
-    /* Refill buffer if needed */
-    while (*bits_in_buffer < 32 && (*bit_pos / 8) < data_len) {
-        size_t byte_pos = *bit_pos / 8;
-        int bit_offset = *bit_pos % 8;
-        *buffer |= ((uint64_t)data[byte_pos] >> bit_offset) << *bits_in_buffer;
-        int bits_taken = 8 - bit_offset;
-        *bits_in_buffer += bits_taken;
-        *bit_pos += bits_taken;
-    }
-
-    /* Fast path: table lookup for short codes */
-    int idx = *buffer & HUF_DECMASK;
-    int len = hdec_short[idx] & 0x3F;
-    if (len > 0 && len <= HUF_DECBITS) {
-        int sym = hdec_short[idx] >> 6;
-        *buffer >>= len;
-        *bits_in_buffer -= len;
-        return sym;
-    }
-
-    /* Slow path: linear search through longer codes */
-    /* This is a simplified fallback - real implementation would use canonical codes */
-    return -1;  /* Error: symbol not found */
-}
-
-/* Simplified Huffman decompression (V1-compatible format) */
-static bool piz_huf_uncompress(const uint8_t* in, size_t in_len,
-                                uint16_t* out, size_t out_len) {
-    if (in_len < 20) return false;
-
-    /* Read header */
-    uint32_t im_val, iM_val, nBits_val;
-    memcpy(&im_val, in, 4);
-    memcpy(&iM_val, in + 4, 4);
-    memcpy(&nBits_val, in + 12, 4);  /* nBits at offset 12 */
-
-    if (im_val >= PIZ_HUF_ENCSIZE || iM_val >= PIZ_HUF_ENCSIZE || im_val > iM_val) {
-        return false;
-    }
-
-    const uint8_t* ptr = in + 20;  /* Skip header */
-    size_t remaining = in_len - 20;
-
-    /* Read Huffman table: for each symbol from im to iM, read code length and code */
-    uint64_t codes[PIZ_HUF_ENCSIZE] = {0};
-    uint8_t lengths[PIZ_HUF_ENCSIZE] = {0};
-
-    for (uint32_t i = im_val; i <= iM_val; /* incremented in loop */) {
-        if (remaining < 1) return false;
-
-        uint8_t l = *ptr++;
-        remaining--;
-
-        if (l >= 59) {
-            /* Run of zero-length codes */
-            uint32_t n = l - 59 + 2;
-            i += n;
-        } else if (l >= 0x3F) {
-            /* Long code: 6 bits length + code */
-            if (remaining < 4) return false;
-            uint32_t packed;
-            memcpy(&packed, ptr, 4);
-            ptr += 4;
-            remaining -= 4;
-            lengths[i] = (uint8_t)(packed & 0x3F);
-            codes[i] = packed >> 6;
-            i++;
-        } else {
-            lengths[i] = l;
-            /* Code follows based on length */
-            if (l > 0) {
-                int code_bytes = (l + 7) / 8;
-                if ((size_t)code_bytes > remaining) return false;
-                uint64_t code = 0;
-                for (int b = 0; b < code_bytes; b++) {
-                    code |= ((uint64_t)ptr[b]) << (b * 8);
-                }
-                ptr += code_bytes;
-                remaining -= code_bytes;
-                codes[i] = code;
-            }
-            i++;
-        }
-    }
-
-    /* Build decoding table for fast lookup */
-    uint16_t dec_table[HUF_DECSIZE] = {0};
-    for (uint32_t sym = im_val; sym <= iM_val; sym++) {
-        int len = lengths[sym];
-        if (len > 0 && len <= HUF_DECBITS) {
-            uint64_t code = codes[sym];
-            int fill_count = 1 << (HUF_DECBITS - len);
-            for (int f = 0; f < fill_count; f++) {
-                int idx = (int)(code | (f << len));
-                if (idx < HUF_DECSIZE) {
-                    dec_table[idx] = (uint16_t)((sym << 6) | len);
-                }
-            }
-        }
-    }
-
-    /* Decode symbols */
-    uint64_t buffer = 0;
-    int bits_in_buffer = 0;
-    size_t bit_pos = 0;
-    const uint8_t* bit_data = ptr;
-    size_t bit_data_len = remaining;
-
-    /* Initialize buffer */
-    while (bits_in_buffer < 64 && bit_pos < bit_data_len * 8) {
-        size_t byte_idx = bit_pos / 8;
-        if (byte_idx < bit_data_len) {
-            buffer |= ((uint64_t)bit_data[byte_idx]) << bits_in_buffer;
-            bits_in_buffer += 8;
-            bit_pos += 8;
-        }
-    }
-
-    for (size_t i = 0; i < out_len; i++) {
-        /* Refill buffer */
-        while (bits_in_buffer < 32) {
-            size_t byte_idx = bit_pos / 8;
-            if (byte_idx >= bit_data_len) break;
-            buffer |= ((uint64_t)bit_data[byte_idx]) << bits_in_buffer;
-            bits_in_buffer += 8;
-            bit_pos += 8;
-        }
-
-        /* Fast decode using table */
-        int idx = buffer & HUF_DECMASK;
-        uint16_t entry = dec_table[idx];
-        int len = entry & 0x3F;
-        if (len > 0 && len <= HUF_DECBITS) {
-            out[i] = (uint16_t)(entry >> 6);
-            buffer >>= len;
-            bits_in_buffer -= len;
-        } else {
-            /* Slow path: search for longer codes */
-            bool found = false;
-            for (int test_len = HUF_DECBITS + 1; test_len <= 58 && !found; test_len++) {
-                uint64_t mask = (1ULL << test_len) - 1;
-                uint64_t test_code = buffer & mask;
-                for (uint32_t sym = im_val; sym <= iM_val; sym++) {
-                    if (lengths[sym] == test_len && codes[sym] == test_code) {
-                        out[i] = (uint16_t)sym;
-                        buffer >>= test_len;
-                        bits_in_buffer -= test_len;
-                        found = true;
-                        break;
-                    }
-                }
-            }
-            if (!found) {
-                return false;  /* Decode error */
-            }
-        }
-    }
-
-    return true;
+#if defined(TINYEXR_V3_HAS_PIZ)
+/* tinyexr::piz::PizParallelFor backend over the context's worker pool. Nests
+ * inside the chunk-level job, so idle workers pick up a large chunk's
+ * channels while busy ones leave them to the decoding thread. */
+static void piz_parallel_for(void* pool, uint32_t count,
+                             tinyexr::piz::PizTaskFunc task, void* userdata) {
+    exr_parallel_for((ExrThreadPool*)pool, count, task, userdata);
 }
+#endif
 
 /* PIZ decompression */
 static ExrResult decompress_piz(const uint8_t* src, size_t src_size,
@@ -2315,9 +3390,15 @@ static ExrResult decompress_piz(const uint8_t* src, size_t src_size,
         v2_channels[i].p_linear = channels[i].p_linear;
     }
 
+    tinyexr::piz::PizParallelFor parallel;
+    ExrThreadPool* pool = ctx ? exr_context_get_thread_pool(ctx) : NULL;
+    if (pool) {
+        parallel = tinyexr::piz::PizParallelFor(piz_parallel_for, pool);
+    }
+
     auto result = tinyexr::piz::DecompressPizV2(
         dst, dst_size, src, src_size,
-        num_channels, v2_channels, data_width, num_lines);
+        num_channels, v2_channels, data_width, num_lines, parallel);
 
     delete[] v2_channels;
 
@@ -2336,6 +3417,49 @@ static ExrResult decompress_piz(const uint8_t* src, size_t src_size,
 #endif
 }
 
+/* DWAA/DWAB decompression */
+static ExrResult decompress_dwa(const uint8_t* src, size_t src_size,
+                                 uint8_t* dst, size_t dst_size,
+                                 size_t* out_size,
+                                 uint32_t num_channels, const ExrChannelData* channels,
+                                 int x0, int y0, int data_width, int num_lines,
+                                 ExrScratch* scratch) {
+#if defined(TINYEXR_V3_HAS_DWA)
+    tinyexr::dwa::ChannelInfo* dwa_channels = (tinyexr::dwa::ChannelInfo*)exr_scratch_alloc(
+        scratch, num_channels * sizeof(tinyexr::dwa::ChannelInfo));
+    if (!dwa_channels) {
+        return EXR_ERROR_OUT_OF_MEMORY;
+    }
+
+    for (uint32_t c = 0; c < num_channels; c++) {
+        dwa_channels[c].name = channels[c].name;
+        dwa_channels[c].pixel_type = (int)channels[c].pixel_type;
+        dwa_channels[c].x_sampling = channels[c].x_sampling > 0 ? channels[c].x_sampling : 1;
+        dwa_channels[c].y_sampling = channels[c].y_sampling > 0 ? channels[c].y_sampling : 1;
+        dwa_channels[c].p_linear = channels[c].p_linear != 0;
+    }
+
+    bool ok = tinyexr::dwa::Decompress(dst, dst_size, src, src_size,
+                                       dwa_channels, (int)num_channels,
+                                       x0, y0, data_width, num_lines);
+
+    exr_scratch_free(scratch, dwa_channels, num_channels * sizeof(tinyexr::dwa::ChannelInfo));
+
+    if (!ok) {
+        return EXR_ERROR_DECOMPRESSION_FAILED;
+    }
+
+    *out_size = dst_size;
+    return EXR_SUCCESS;
+#else
+    /* DWA needs the C++ codec */
+    (void)src; (void)src_size; (void)dst; (void)dst_size; (void)out_size;
+    (void)num_channels; (void)channels; (void)x0; (void)y0;
+    (void)data_width; (void)num_lines; (void)scratch;
+    return EXR_ERROR_UNSUPPORTED_FORMAT;
+#endif
+}
+
 /* RLE decompression (OpenEXR format)
    Format (signed byte interpretation):
    - Negative value (-n): followed by n literal bytes (copy them)
@@ -2343,7 +3467,7 @@ static ExrResult decompress_piz(const uint8_t* src, size_t src_size,
    After RLE decode, applies predictor and reorder like ZIP compression */
 static ExrResult decompress_rle(const uint8_t* src, size_t src_size,
                                  uint8_t* dst, size_t dst_size,
-                                 size_t* out_size) {
+                                 size_t* out_size, ExrScratch* scratch) {
     /* Handle uncompressed data (size matches expected) */
     if (src_size == dst_size) {
         memcpy(dst, src, src_size);
@@ -2352,7 +3476,7 @@ static ExrResult decompress_rle(const uint8_t* src, size_t src_size,
     }
 
     /* Allocate temp buffer for RLE-decoded data (before predictor/reorder) */
-    uint8_t* tmpBuf = (uint8_t*)malloc(dst_size);
+    uint8_t* tmpBuf = (uint8_t*)exr_scratch_alloc(scratch, dst_size);
     if (!tmpBuf) {
         return EXR_ERROR_OUT_OF_MEMORY;
     }
@@ -2370,7 +3494,7 @@ static ExrResult decompress_rle(const uint8_t* src, size_t src_size,
             /* Literal run: -count bytes follow */
             size_t len = (size_t)(-count);
             if (in + len > in_end || out + len > out_end) {
-                free(tmpBuf);
+                exr_scratch_free(scratch, tmpBuf, dst_size);
                 return EXR_ERROR_INVALID_DATA;
             }
             memcpy(out, in, len);
@@ -2380,7 +3504,7 @@ static ExrResult decompress_rle(const uint8_t* src, size_t src_size,
             /* RLE run: repeat next byte (count + 1) times */
             size_t len = (size_t)count + 1;
             if (in >= in_end || out + len > out_end) {
-                free(tmpBuf);
+                exr_scratch_free(scratch, tmpBuf, dst_size);
                 return EXR_ERROR_INVALID_DATA;
             }
             uint8_t val = (uint8_t)*in++;
@@ -2391,31 +3515,10 @@ static ExrResult decompress_rle(const uint8_t* src, size_t src_size,
 
     size_t uncomp_size = (size_t)(out - tmpBuf);
 
-    /* Apply EXR predictor (delta decoding) */
-    {
-        uint8_t* t = tmpBuf + 1;
-        uint8_t* stop = tmpBuf + uncomp_size;
-        while (t < stop) {
-            int d = (int)t[-1] + (int)t[0] - 128;
-            t[0] = (uint8_t)d;
-            ++t;
-        }
-    }
-
-    /* Reorder pixel data (interleave two halves) */
-    {
-        const uint8_t* t1 = tmpBuf;
-        const uint8_t* t2 = tmpBuf + (uncomp_size + 1) / 2;
-        uint8_t* s = dst;
-        uint8_t* stop = dst + uncomp_size;
-
-        while (s < stop) {
-            if (s < stop) *s++ = *t1++;
-            if (s < stop) *s++ = *t2++;
-        }
-    }
+    /* Apply EXR predictor (delta decoding) and interleave the two halves */
+    decode_predictor_and_reorder(tmpBuf, dst, uncomp_size);
 
-    free(tmpBuf);
+    exr_scratch_free(scratch, tmpBuf, dst_size);
     *out_size = uncomp_size;
     return EXR_SUCCESS;
 }
@@ -2440,8 +3543,10 @@ static void deinterleave_channels(const uint8_t* src, uint8_t* dst,
     }
 }
 
-/* Read and decompress a single chunk */
-static ExrResult read_chunk(ExrDecoder decoder, ExrPartData* part, uint32_t chunk_index,
+/* Read and decompress a single chunk. *out_size is the scratch allocation
+ * behind *out_data, 0 when uncompressed data is borrowed from the source. */
+static ExrResult read_chunk(ExrDecoder decoder, ExrScratch* scratch,
+                            ExrPartData* part, uint32_t chunk_index,
                             uint8_t** out_data, size_t* out_size,
                             int* out_y_start, int* out_num_lines) {
     ExrContext ctx = decoder->ctx;
@@ -2451,11 +3556,13 @@ static ExrResult read_chunk(ExrDecoder decoder, ExrPartData* part, uint32_t chun
         return EXR_ERROR_INVALID_ARGUMENT;
     }
 
-    uint64_t offset = part->offsets[chunk_index];
+    uint64_t offset;
+    result = get_chunk_offset(decoder, part, chunk_index, &offset);
+    if (EXR_FAILED(result)) return result;
 
     /* Read chunk header (y coordinate + data size) */
     uint8_t header[8];
-    result = sync_fetch(decoder, offset, 8, header);
+    result = chunk_fetch(decoder, scratch, offset, 8, header);
     if (EXR_FAILED(result)) return result;
 
     int32_t y_coord = read_le_i32(header);
@@ -2483,47 +3590,42 @@ static ExrResult read_chunk(ExrDecoder decoder, ExrPartData* part, uint32_t chun
     }
     size_t expected_size = bytes_per_line * num_lines;
 
-    /* Allocate compressed data buffer */
-    uint8_t* compressed = (uint8_t*)ctx->allocator.alloc(
-        ctx->allocator.userdata, data_size, EXR_DEFAULT_ALIGNMENT);
-    if (!compressed) {
-        return EXR_ERROR_OUT_OF_MEMORY;
-    }
+    /* Read compressed data (in place when the source is mapped) */
+    const uint8_t* compressed;
+    uint8_t* compressed_copy;
+    result = chunk_view(decoder, scratch, offset + 8, data_size,
+                        &compressed, &compressed_copy);
+    if (EXR_FAILED(result)) return result;
 
-    /* Read compressed data */
-    result = sync_fetch(decoder, offset + 8, data_size, compressed);
-    if (EXR_FAILED(result)) {
-        ctx->allocator.free(ctx->allocator.userdata, compressed, data_size);
-        return result;
+    /* Uncompressed data is handed out as is; nothing to free if borrowed */
+    if (part->compression == EXR_COMPRESSION_NONE) {
+        if (data_size != expected_size) {
+            exr_scratch_free(scratch, compressed_copy, data_size);
+            return EXR_ERROR_INVALID_DATA;
+        }
+        *out_data = (uint8_t*)compressed;
+        *out_size = compressed_copy ? data_size : 0;
+        *out_y_start = y_start;
+        *out_num_lines = num_lines;
+        return EXR_SUCCESS;
     }
 
     /* Allocate decompressed buffer */
-    uint8_t* decompressed = (uint8_t*)ctx->allocator.alloc(
-        ctx->allocator.userdata, expected_size, EXR_DEFAULT_ALIGNMENT);
+    uint8_t* decompressed = (uint8_t*)exr_scratch_alloc(scratch, expected_size);
     if (!decompressed) {
-        ctx->allocator.free(ctx->allocator.userdata, compressed, data_size);
+        exr_scratch_free(scratch, compressed_copy, data_size);
         return EXR_ERROR_OUT_OF_MEMORY;
     }
 
     /* Decompress based on compression type */
     size_t decompressed_size = 0;
     switch (part->compression) {
-        case EXR_COMPRESSION_NONE:
-            if (data_size != expected_size) {
-                ctx->allocator.free(ctx->allocator.userdata, compressed, data_size);
-                ctx->allocator.free(ctx->allocator.userdata, decompressed, expected_size);
-                return EXR_ERROR_INVALID_DATA;
-            }
-            memcpy(decompressed, compressed, data_size);
-            decompressed_size = data_size;
-            break;
-
         case EXR_COMPRESSION_RLE:
             result = decompress_rle(compressed, data_size, decompressed,
-                                     expected_size, &decompressed_size);
+                                     expected_size, &decompressed_size, scratch);
             if (EXR_FAILED(result)) {
-                ctx->allocator.free(ctx->allocator.userdata, compressed, data_size);
-                ctx->allocator.free(ctx->allocator.userdata, decompressed, expected_size);
+                exr_scratch_free(scratch, compressed_copy, data_size);
+                exr_scratch_free(scratch, decompressed, expected_size);
                 return result;
             }
             break;
@@ -2531,12 +3633,12 @@ static ExrResult read_chunk(ExrDecoder decoder, ExrPartData* part, uint32_t chun
         case EXR_COMPRESSION_ZIP:
         case EXR_COMPRESSION_ZIPS:
             result = decompress_zip(compressed, data_size, decompressed,
-                                     expected_size, &decompressed_size, ctx);
+                                     expected_size, &decompressed_size, scratch);
             if (EXR_FAILED(result)) {
                 exr_context_add_error(ctx, result,
                                       "ZIP decompression failed", "chunk", offset);
-                ctx->allocator.free(ctx->allocator.userdata, compressed, data_size);
-                ctx->allocator.free(ctx->allocator.userdata, decompressed, expected_size);
+                exr_scratch_free(scratch, compressed_copy, data_size);
+                exr_scratch_free(scratch, decompressed, expected_size);
                 return result;
             }
             break;
@@ -2544,12 +3646,10 @@ static ExrResult read_chunk(ExrDecoder decoder, ExrPartData* part, uint32_t chun
         case EXR_COMPRESSION_PIZ: {
 #if defined(TINYEXR_V3_USE_V1_PIZ)
             /* Use V1's DecompressPiz - construct EXRChannelInfo array */
-            EXRChannelInfo* v1_channels = (EXRChannelInfo*)ctx->allocator.alloc(
-                ctx->allocator.userdata, part->num_channels * sizeof(EXRChannelInfo),
-                EXR_DEFAULT_ALIGNMENT);
+            EXRChannelInfo* v1_channels = (EXRChannelInfo*)exr_scratch_alloc(scratch, part->num_channels * sizeof(EXRChannelInfo));
             if (!v1_channels) {
-                ctx->allocator.free(ctx->allocator.userdata, compressed, data_size);
-                ctx->allocator.free(ctx->allocator.userdata, decompressed, expected_size);
+                exr_scratch_free(scratch, compressed_copy, data_size);
+                exr_scratch_free(scratch, decompressed, expected_size);
                 return EXR_ERROR_OUT_OF_MEMORY;
             }
 
@@ -2565,25 +3665,22 @@ static ExrResult read_chunk(ExrDecoder decoder, ExrPartData* part, uint32_t chun
                 static_cast<int>(part->num_channels), v1_channels,
                 part->width, num_lines);
 
-            ctx->allocator.free(ctx->allocator.userdata, v1_channels,
-                               part->num_channels * sizeof(EXRChannelInfo));
+            exr_scratch_free(scratch, v1_channels, part->num_channels * sizeof(EXRChannelInfo));
 
             if (!piz_ok) {
                 exr_context_add_error(ctx, EXR_ERROR_DECOMPRESSION_FAILED,
                                       "PIZ decompression failed", "chunk", offset);
-                ctx->allocator.free(ctx->allocator.userdata, compressed, data_size);
-                ctx->allocator.free(ctx->allocator.userdata, decompressed, expected_size);
+                exr_scratch_free(scratch, compressed_copy, data_size);
+                exr_scratch_free(scratch, decompressed, expected_size);
                 return EXR_ERROR_DECOMPRESSION_FAILED;
             }
             decompressed_size = expected_size;
 #else
             /* Set up channel data for PIZ decompression */
-            ExrChannelData* piz_channels = (ExrChannelData*)ctx->allocator.alloc(
-                ctx->allocator.userdata, part->num_channels * sizeof(ExrChannelData),
-                EXR_DEFAULT_ALIGNMENT);
+            ExrChannelData* piz_channels = (ExrChannelData*)exr_scratch_alloc(scratch, part->num_channels * sizeof(ExrChannelData));
             if (!piz_channels) {
-                ctx->allocator.free(ctx->allocator.userdata, compressed, data_size);
-                ctx->allocator.free(ctx->allocator.userdata, decompressed, expected_size);
+                exr_scratch_free(scratch, compressed_copy, data_size);
+                exr_scratch_free(scratch, decompressed, expected_size);
                 return EXR_ERROR_OUT_OF_MEMORY;
             }
 
@@ -2598,14 +3695,13 @@ static ExrResult read_chunk(ExrDecoder decoder, ExrPartData* part, uint32_t chun
                                      part->num_channels, piz_channels,
                                      part->width, num_lines, ctx);
 
-            ctx->allocator.free(ctx->allocator.userdata, piz_channels,
-                               part->num_channels * sizeof(ExrChannelData));
+            exr_scratch_free(scratch, piz_channels, part->num_channels * sizeof(ExrChannelData));
 
             if (EXR_FAILED(result)) {
                 exr_context_add_error(ctx, result,
                                       "PIZ decompression failed", "chunk", offset);
-                ctx->allocator.free(ctx->allocator.userdata, compressed, data_size);
-                ctx->allocator.free(ctx->allocator.userdata, decompressed, expected_size);
+                exr_scratch_free(scratch, compressed_copy, data_size);
+                exr_scratch_free(scratch, decompressed, expected_size);
                 return result;
             }
 #endif
@@ -2618,8 +3714,8 @@ static ExrResult read_chunk(ExrDecoder decoder, ExrPartData* part, uint32_t chun
              * Note: v2::Channel uses std::string, so we must use new/delete */
             tinyexr::v2::Channel* v2_channels = new (std::nothrow) tinyexr::v2::Channel[part->num_channels];
             if (!v2_channels) {
-                ctx->allocator.free(ctx->allocator.userdata, compressed, data_size);
-                ctx->allocator.free(ctx->allocator.userdata, decompressed, expected_size);
+                exr_scratch_free(scratch, compressed_copy, data_size);
+                exr_scratch_free(scratch, decompressed, expected_size);
                 return EXR_ERROR_OUT_OF_MEMORY;
             }
 
@@ -2645,12 +3741,11 @@ static ExrResult read_chunk(ExrDecoder decoder, ExrPartData* part, uint32_t chun
             }
 
             /* Decompress zlib using V2 deflate */
-            uint8_t* pxr24_buf = (uint8_t*)ctx->allocator.alloc(
-                ctx->allocator.userdata, pxr24_size, EXR_DEFAULT_ALIGNMENT);
+            uint8_t* pxr24_buf = (uint8_t*)exr_scratch_alloc(scratch, pxr24_size);
             if (!pxr24_buf) {
                 delete[] v2_channels;
-                ctx->allocator.free(ctx->allocator.userdata, compressed, data_size);
-                ctx->allocator.free(ctx->allocator.userdata, decompressed, expected_size);
+                exr_scratch_free(scratch, compressed_copy, data_size);
+                exr_scratch_free(scratch, decompressed, expected_size);
                 return EXR_ERROR_OUT_OF_MEMORY;
             }
 
@@ -2740,14 +3835,14 @@ static ExrResult read_chunk(ExrDecoder decoder, ExrPartData* part, uint32_t chun
                 }
             }
 
-            ctx->allocator.free(ctx->allocator.userdata, pxr24_buf, pxr24_size);
+            exr_scratch_free(scratch, pxr24_buf, pxr24_size);
             delete[] v2_channels;
 
             if (!pxr24_ok) {
                 exr_context_add_error(ctx, EXR_ERROR_DECOMPRESSION_FAILED,
                                       "PXR24 decompression failed", "chunk", offset);
-                ctx->allocator.free(ctx->allocator.userdata, compressed, data_size);
-                ctx->allocator.free(ctx->allocator.userdata, decompressed, expected_size);
+                exr_scratch_free(scratch, compressed_copy, data_size);
+                exr_scratch_free(scratch, decompressed, expected_size);
                 return EXR_ERROR_DECOMPRESSION_FAILED;
             }
             decompressed_size = expected_size;
@@ -2755,8 +3850,8 @@ static ExrResult read_chunk(ExrDecoder decoder, ExrPartData* part, uint32_t chun
             exr_context_add_error(ctx, EXR_ERROR_UNSUPPORTED_FORMAT,
                                   "PXR24 compression not supported",
                                   "chunk", offset);
-            ctx->allocator.free(ctx->allocator.userdata, compressed, data_size);
-            ctx->allocator.free(ctx->allocator.userdata, decompressed, expected_size);
+            exr_scratch_free(scratch, compressed_copy, data_size);
+            exr_scratch_free(scratch, decompressed, expected_size);
             return EXR_ERROR_UNSUPPORTED_FORMAT;
 #endif
             break;
@@ -2769,8 +3864,8 @@ static ExrResult read_chunk(ExrDecoder decoder, ExrPartData* part, uint32_t chun
              * Note: v2::Channel uses std::string, so we must use new/delete */
             tinyexr::v2::Channel* v2_channels = new (std::nothrow) tinyexr::v2::Channel[part->num_channels];
             if (!v2_channels) {
-                ctx->allocator.free(ctx->allocator.userdata, compressed, data_size);
-                ctx->allocator.free(ctx->allocator.userdata, decompressed, expected_size);
+                exr_scratch_free(scratch, compressed_copy, data_size);
+                exr_scratch_free(scratch, decompressed, expected_size);
                 return EXR_ERROR_OUT_OF_MEMORY;
             }
 
@@ -2797,8 +3892,8 @@ static ExrResult read_chunk(ExrDecoder decoder, ExrPartData* part, uint32_t chun
             if (!b44_ok) {
                 exr_context_add_error(ctx, EXR_ERROR_DECOMPRESSION_FAILED,
                                       "B44 decompression failed", "chunk", offset);
-                ctx->allocator.free(ctx->allocator.userdata, compressed, data_size);
-                ctx->allocator.free(ctx->allocator.userdata, decompressed, expected_size);
+                exr_scratch_free(scratch, compressed_copy, data_size);
+                exr_scratch_free(scratch, decompressed, expected_size);
                 return EXR_ERROR_DECOMPRESSION_FAILED;
             }
             decompressed_size = expected_size;
@@ -2806,20 +3901,40 @@ static ExrResult read_chunk(ExrDecoder decoder, ExrPartData* part, uint32_t chun
             exr_context_add_error(ctx, EXR_ERROR_UNSUPPORTED_FORMAT,
                                   "B44 compression not supported",
                                   "chunk", offset);
-            ctx->allocator.free(ctx->allocator.userdata, compressed, data_size);
-            ctx->allocator.free(ctx->allocator.userdata, decompressed, expected_size);
+            exr_scratch_free(scratch, compressed_copy, data_size);
+            exr_scratch_free(scratch, decompressed, expected_size);
             return EXR_ERROR_UNSUPPORTED_FORMAT;
 #endif
             break;
         }
 
+        case EXR_COMPRESSION_DWAA:
+        case EXR_COMPRESSION_DWAB: {
+            result = decompress_dwa(compressed, data_size, decompressed,
+                                     expected_size, &decompressed_size,
+                                     part->num_channels, part->channels,
+                                     decoder->image->data_window.min_x, y_coord,
+                                     part->width, num_lines, scratch);
+            if (EXR_FAILED(result)) {
+                exr_context_add_error(ctx, result,
+                                      result == EXR_ERROR_UNSUPPORTED_FORMAT
+                                          ? "DWAA/DWAB compression not supported"
+                                          : "DWA decompression failed",
+                                      "chunk", offset);
+                exr_scratch_free(scratch, compressed_copy, data_size);
+                exr_scratch_free(scratch, decompressed, expected_size);
+                return result;
+            }
+            break;
+        }
+
         default:
-            ctx->allocator.free(ctx->allocator.userdata, compressed, data_size);
-            ctx->allocator.free(ctx->allocator.userdata, decompressed, expected_size);
+            exr_scratch_free(scratch, compressed_copy, data_size);
+            exr_scratch_free(scratch, decompressed, expected_size);
             return EXR_ERROR_UNSUPPORTED_FORMAT;
     }
 
-    ctx->allocator.free(ctx->allocator.userdata, compressed, data_size);
+    exr_scratch_free(scratch, compressed_copy, data_size);
 
     *out_data = decompressed;
     *out_size = decompressed_size;
@@ -2934,8 +4049,8 @@ static uint32_t calc_tile_index(ExrPartData* part, int tile_x, int tile_y,
     return index;
 }
 
-/* Read and decompress a single tile */
-static ExrResult read_tile(ExrDecoder decoder, ExrPartData* part,
+/* Read and decompress a single tile; *out_size as for read_chunk */
+static ExrResult read_tile(ExrDecoder decoder, ExrScratch* scratch, ExrPartData* part,
                            int tile_x, int tile_y, int level_x, int level_y,
                            uint8_t** out_data, size_t* out_size,
                            int* out_width, int* out_height) {
@@ -2947,7 +4062,9 @@ static ExrResult read_tile(ExrDecoder decoder, ExrPartData* part,
         return EXR_ERROR_INVALID_ARGUMENT;
     }
 
-    uint64_t offset = part->offsets[tile_index];
+    uint64_t offset;
+    result = get_chunk_offset(decoder, part, tile_index, &offset);
+    if (EXR_FAILED(result)) return result;
 
     /* Read tile header:
      * - tile_x (4 bytes)
@@ -2958,7 +4075,7 @@ static ExrResult read_tile(ExrDecoder decoder, ExrPartData* part,
      * Total: 20 bytes
      */
     uint8_t header[20];
-    result = sync_fetch(decoder, offset, 20, header);
+    result = chunk_fetch(decoder, scratch, offset, 20, header);
     if (EXR_FAILED(result)) return result;
 
     /* Read and validate tile coordinates from header */
@@ -3005,47 +4122,42 @@ static ExrResult read_tile(ExrDecoder decoder, ExrPartData* part,
     }
     size_t expected_size = bytes_per_line * tile_height;
 
-    /* Allocate compressed data buffer */
-    uint8_t* compressed = (uint8_t*)ctx->allocator.alloc(
-        ctx->allocator.userdata, data_size, EXR_DEFAULT_ALIGNMENT);
-    if (!compressed) {
-        return EXR_ERROR_OUT_OF_MEMORY;
-    }
+    /* Read compressed data (in place when the source is mapped) */
+    const uint8_t* compressed;
+    uint8_t* compressed_copy;
+    result = chunk_view(decoder, scratch, offset + 20, data_size,
+                        &compressed, &compressed_copy);
+    if (EXR_FAILED(result)) return result;
 
-    /* Read compressed data */
-    result = sync_fetch(decoder, offset + 20, data_size, compressed);
-    if (EXR_FAILED(result)) {
-        ctx->allocator.free(ctx->allocator.userdata, compressed, data_size);
-        return result;
+    /* Uncompressed data is handed out as is; nothing to free if borrowed */
+    if (part->compression == EXR_COMPRESSION_NONE) {
+        if (data_size != expected_size) {
+            exr_scratch_free(scratch, compressed_copy, data_size);
+            return EXR_ERROR_INVALID_DATA;
+        }
+        *out_data = (uint8_t*)compressed;
+        *out_size = compressed_copy ? data_size : 0;
+        *out_width = tile_width;
+        *out_height = tile_height;
+        return EXR_SUCCESS;
     }
 
     /* Allocate decompressed buffer */
-    uint8_t* decompressed = (uint8_t*)ctx->allocator.alloc(
-        ctx->allocator.userdata, expected_size, EXR_DEFAULT_ALIGNMENT);
+    uint8_t* decompressed = (uint8_t*)exr_scratch_alloc(scratch, expected_size);
     if (!decompressed) {
-        ctx->allocator.free(ctx->allocator.userdata, compressed, data_size);
+        exr_scratch_free(scratch, compressed_copy, data_size);
         return EXR_ERROR_OUT_OF_MEMORY;
     }
 
     /* Decompress based on compression type */
     size_t decompressed_size = 0;
     switch (part->compression) {
-        case EXR_COMPRESSION_NONE:
-            if (data_size != expected_size) {
-                ctx->allocator.free(ctx->allocator.userdata, compressed, data_size);
-                ctx->allocator.free(ctx->allocator.userdata, decompressed, expected_size);
-                return EXR_ERROR_INVALID_DATA;
-            }
-            memcpy(decompressed, compressed, data_size);
-            decompressed_size = data_size;
-            break;
-
         case EXR_COMPRESSION_RLE:
             result = decompress_rle(compressed, data_size, decompressed,
-                                     expected_size, &decompressed_size);
+                                     expected_size, &decompressed_size, scratch);
             if (EXR_FAILED(result)) {
-                ctx->allocator.free(ctx->allocator.userdata, compressed, data_size);
-                ctx->allocator.free(ctx->allocator.userdata, decompressed, expected_size);
+                exr_scratch_free(scratch, compressed_copy, data_size);
+                exr_scratch_free(scratch, decompressed, expected_size);
                 return result;
             }
             break;
@@ -3053,21 +4165,19 @@ static ExrResult read_tile(ExrDecoder decoder, ExrPartData* part,
         case EXR_COMPRESSION_ZIP:
         case EXR_COMPRESSION_ZIPS:
             result = decompress_zip(compressed, data_size, decompressed,
-                                     expected_size, &decompressed_size, ctx);
+                                     expected_size, &decompressed_size, scratch);
             if (EXR_FAILED(result)) {
-                ctx->allocator.free(ctx->allocator.userdata, compressed, data_size);
-                ctx->allocator.free(ctx->allocator.userdata, decompressed, expected_size);
+                exr_scratch_free(scratch, compressed_copy, data_size);
+                exr_scratch_free(scratch, decompressed, expected_size);
                 return result;
             }
             break;
 
         case EXR_COMPRESSION_PIZ: {
-            ExrChannelData* piz_channels = (ExrChannelData*)ctx->allocator.alloc(
-                ctx->allocator.userdata, part->num_channels * sizeof(ExrChannelData),
-                EXR_DEFAULT_ALIGNMENT);
+            ExrChannelData* piz_channels = (ExrChannelData*)exr_scratch_alloc(scratch, part->num_channels * sizeof(ExrChannelData));
             if (!piz_channels) {
-                ctx->allocator.free(ctx->allocator.userdata, compressed, data_size);
-                ctx->allocator.free(ctx->allocator.userdata, decompressed, expected_size);
+                exr_scratch_free(scratch, compressed_copy, data_size);
+                exr_scratch_free(scratch, decompressed, expected_size);
                 return EXR_ERROR_OUT_OF_MEMORY;
             }
 
@@ -3082,12 +4192,11 @@ static ExrResult read_tile(ExrDecoder decoder, ExrPartData* part,
                                      part->num_channels, piz_channels,
                                      tile_width, tile_height, ctx);
 
-            ctx->allocator.free(ctx->allocator.userdata, piz_channels,
-                               part->num_channels * sizeof(ExrChannelData));
+            exr_scratch_free(scratch, piz_channels, part->num_channels * sizeof(ExrChannelData));
 
             if (EXR_FAILED(result)) {
-                ctx->allocator.free(ctx->allocator.userdata, compressed, data_size);
-                ctx->allocator.free(ctx->allocator.userdata, decompressed, expected_size);
+                exr_scratch_free(scratch, compressed_copy, data_size);
+                exr_scratch_free(scratch, decompressed, expected_size);
                 return result;
             }
             break;
@@ -3098,8 +4207,8 @@ static ExrResult read_tile(ExrDecoder decoder, ExrPartData* part,
             /* Use V2 PXR24 implementation for tiles */
             tinyexr::v2::Channel* v2_channels = new (std::nothrow) tinyexr::v2::Channel[part->num_channels];
             if (!v2_channels) {
-                ctx->allocator.free(ctx->allocator.userdata, compressed, data_size);
-                ctx->allocator.free(ctx->allocator.userdata, decompressed, expected_size);
+                exr_scratch_free(scratch, compressed_copy, data_size);
+                exr_scratch_free(scratch, decompressed, expected_size);
                 return EXR_ERROR_OUT_OF_MEMORY;
             }
 
@@ -3125,12 +4234,11 @@ static ExrResult read_tile(ExrDecoder decoder, ExrPartData* part,
             }
 
             /* Decompress zlib */
-            uint8_t* pxr24_buf = (uint8_t*)ctx->allocator.alloc(
-                ctx->allocator.userdata, pxr24_size, EXR_DEFAULT_ALIGNMENT);
+            uint8_t* pxr24_buf = (uint8_t*)exr_scratch_alloc(scratch, pxr24_size);
             if (!pxr24_buf) {
                 delete[] v2_channels;
-                ctx->allocator.free(ctx->allocator.userdata, compressed, data_size);
-                ctx->allocator.free(ctx->allocator.userdata, decompressed, expected_size);
+                exr_scratch_free(scratch, compressed_copy, data_size);
+                exr_scratch_free(scratch, decompressed, expected_size);
                 return EXR_ERROR_OUT_OF_MEMORY;
             }
 
@@ -3214,18 +4322,18 @@ static ExrResult read_tile(ExrDecoder decoder, ExrPartData* part,
                 }
             }
 
-            ctx->allocator.free(ctx->allocator.userdata, pxr24_buf, pxr24_size);
+            exr_scratch_free(scratch, pxr24_buf, pxr24_size);
             delete[] v2_channels;
 
             if (!pxr24_ok) {
-                ctx->allocator.free(ctx->allocator.userdata, compressed, data_size);
-                ctx->allocator.free(ctx->allocator.userdata, decompressed, expected_size);
+                exr_scratch_free(scratch, compressed_copy, data_size);
+                exr_scratch_free(scratch, decompressed, expected_size);
                 return EXR_ERROR_DECOMPRESSION_FAILED;
             }
             decompressed_size = expected_size;
 #else
-            ctx->allocator.free(ctx->allocator.userdata, compressed, data_size);
-            ctx->allocator.free(ctx->allocator.userdata, decompressed, expected_size);
+            exr_scratch_free(scratch, compressed_copy, data_size);
+            exr_scratch_free(scratch, decompressed, expected_size);
             return EXR_ERROR_UNSUPPORTED_FORMAT;
 #endif
             break;
@@ -3237,8 +4345,8 @@ static ExrResult read_tile(ExrDecoder decoder, ExrPartData* part,
             /* Use V2 B44 implementation for tiles */
             tinyexr::v2::Channel* v2_channels = new (std::nothrow) tinyexr::v2::Channel[part->num_channels];
             if (!v2_channels) {
-                ctx->allocator.free(ctx->allocator.userdata, compressed, data_size);
-                ctx->allocator.free(ctx->allocator.userdata, decompressed, expected_size);
+                exr_scratch_free(scratch, compressed_copy, data_size);
+                exr_scratch_free(scratch, decompressed, expected_size);
                 return EXR_ERROR_OUT_OF_MEMORY;
             }
 
@@ -3262,27 +4370,40 @@ static ExrResult read_tile(ExrDecoder decoder, ExrPartData* part,
             delete[] v2_channels;
 
             if (!b44_ok) {
-                ctx->allocator.free(ctx->allocator.userdata, compressed, data_size);
-                ctx->allocator.free(ctx->allocator.userdata, decompressed, expected_size);
+                exr_scratch_free(scratch, compressed_copy, data_size);
+                exr_scratch_free(scratch, decompressed, expected_size);
                 return EXR_ERROR_DECOMPRESSION_FAILED;
             }
             decompressed_size = expected_size;
 #else
-            ctx->allocator.free(ctx->allocator.userdata, compressed, data_size);
-            ctx->allocator.free(ctx->allocator.userdata, decompressed, expected_size);
+            exr_scratch_free(scratch, compressed_copy, data_size);
+            exr_scratch_free(scratch, decompressed, expected_size);
             return EXR_ERROR_UNSUPPORTED_FORMAT;
 #endif
             break;
         }
 
+        case EXR_COMPRESSION_DWAA:
+        case EXR_COMPRESSION_DWAB:
+            result = decompress_dwa(compressed, data_size, decompressed,
+                                     expected_size, &decompressed_size,
+                                     part->num_channels, part->channels,
+                                     tile_start_x, tile_start_y,
+                                     tile_width, tile_height, scratch);
+            if (EXR_FAILED(result)) {
+                exr_scratch_free(scratch, compressed_copy, data_size);
+                exr_scratch_free(scratch, decompressed, expected_size);
+                return result;
+            }
+            break;
+
         default:
-            /* DWAA/DWAB and other compression types not supported */
-            ctx->allocator.free(ctx->allocator.userdata, compressed, data_size);
-            ctx->allocator.free(ctx->allocator.userdata, decompressed, expected_size);
+            exr_scratch_free(scratch, compressed_copy, data_size);
+            exr_scratch_free(scratch, decompressed, expected_size);
             return EXR_ERROR_UNSUPPORTED_FORMAT;
     }
 
-    ctx->allocator.free(ctx->allocator.userdata, compressed, data_size);
+    exr_scratch_free(scratch, compressed_copy, data_size);
 
     *out_data = decompressed;
     *out_size = decompressed_size;
@@ -3328,6 +4449,112 @@ static inline uint16_t float_to_half_single(float val) {
     return h | (uint16_t)sign;
 }
 
+/* Row conversion kernel: converts `count` contiguous values of one pixel type
+ * into another. Neither pointer needs to be aligned. */
+typedef void (*ExrConvertRowFunc)(const uint8_t* src, uint8_t* dst, size_t count);
+
+static inline uint32_t float_to_uint_clamped(float val) {
+    return (val < 0.0f) ? 0 :
+           (val > 4294967295.0f) ? 0xFFFFFFFF : (uint32_t)val;
+}
+
+static int is_aligned(const void* ptr, size_t alignment) {
+    return ((uintptr_t)ptr % alignment) == 0;
+}
+
+static void convert_row_copy2(const uint8_t* src, uint8_t* dst, size_t count) {
+    if (src != dst) memcpy(dst, src, count * 2);
+}
+
+static void convert_row_copy4(const uint8_t* src, uint8_t* dst, size_t count) {
+    if (src != dst) memcpy(dst, src, count * 4);
+}
+
+static void convert_row_half_to_float(const uint8_t* src, uint8_t* dst, size_t count) {
+    if (is_aligned(src, sizeof(uint16_t)) && is_aligned(dst, sizeof(float))) {
+        /* SIMD when built with TINYEXR_V3_USE_SIMD */
+        exr_convert_half_to_float((const uint16_t*)src, (float*)dst, count);
+        return;
+    }
+    init_half_tables();
+    for (size_t i = 0; i < count; i++) {
+        uint16_t h;
+        memcpy(&h, src + i * 2, sizeof(uint16_t));
+        uint32_t f = g_mantissa_table[g_offset_table[h >> 10] + (h & 0x3FF)] +
+                     g_exponent_table[h >> 10];
+        memcpy(dst + i * 4, &f, sizeof(float));
+    }
+}
+
+static void convert_row_float_to_half(const uint8_t* src, uint8_t* dst, size_t count) {
+    if (is_aligned(src, sizeof(float)) && is_aligned(dst, sizeof(uint16_t))) {
+        exr_convert_float_to_half((const float*)src, (uint16_t*)dst, count);
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        float val;
+        memcpy(&val, src + i * 4, sizeof(float));
+        uint16_t h = float_to_half_single(val);
+        memcpy(dst + i * 2, &h, sizeof(uint16_t));
+    }
+}
+
+static void convert_row_half_to_uint(const uint8_t* src, uint8_t* dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        uint16_t h;
+        memcpy(&h, src + i * 2, sizeof(uint16_t));
+        uint32_t u = float_to_uint_clamped(half_to_float_single(h));
+        memcpy(dst + i * 4, &u, sizeof(uint32_t));
+    }
+}
+
+static void convert_row_uint_to_half(const uint8_t* src, uint8_t* dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        uint32_t u;
+        memcpy(&u, src + i * 4, sizeof(uint32_t));
+        uint16_t h = float_to_half_single((float)u);
+        memcpy(dst + i * 2, &h, sizeof(uint16_t));
+    }
+}
+
+static void convert_row_float_to_uint(const uint8_t* src, uint8_t* dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        float val;
+        memcpy(&val, src + i * 4, sizeof(float));
+        uint32_t u = float_to_uint_clamped(val);
+        memcpy(dst + i * 4, &u, sizeof(uint32_t));
+    }
+}
+
+static void convert_row_uint_to_float(const uint8_t* src, uint8_t* dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        uint32_t u;
+        memcpy(&u, src + i * 4, sizeof(uint32_t));
+        /* UINT values are typically used for sample counts or IDs */
+        float val = (float)u;
+        memcpy(dst + i * 4, &val, sizeof(float));
+    }
+}
+
+/* Kernels indexed by [src_type][dst_type] (EXR_PIXEL_UINT/HALF/FLOAT) */
+static const ExrConvertRowFunc g_convert_row_table[3][3] = {
+    /* from UINT */
+    { convert_row_copy4, convert_row_uint_to_half, convert_row_uint_to_float },
+    /* from HALF */
+    { convert_row_half_to_uint, convert_row_copy2, convert_row_half_to_float },
+    /* from FLOAT */
+    { convert_row_float_to_uint, convert_row_float_to_half, convert_row_copy4 },
+};
+
+/* Pick the conversion kernel once per channel, instead of per value.
+ * Returns NULL for unknown pixel types. */
+static ExrConvertRowFunc select_convert_row(uint32_t src_type, uint32_t dst_type) {
+    if (src_type > EXR_PIXEL_FLOAT || dst_type > EXR_PIXEL_FLOAT) {
+        return NULL;
+    }
+    return g_convert_row_table[src_type][dst_type];
+}
+
 /* Convert pixels from source type to destination type
  * Handles HALF (1), FLOAT (2), UINT (0)
  * src and dst can be the same buffer if in-place conversion is safe
@@ -3335,73 +4562,68 @@ static inline uint16_t float_to_half_single(float val) {
 static void convert_pixels(const void* src, uint32_t src_type,
                            void* dst, uint32_t dst_type,
                            size_t pixel_count) {
-    if (src_type == dst_type) {
-        /* No conversion needed */
-        if (src != dst) {
-            size_t bytes = pixel_count * get_bytes_per_pixel(src_type);
-            memcpy(dst, src, bytes);
-        }
-        return;
+    ExrConvertRowFunc convert = select_convert_row(src_type, dst_type);
+    if (convert) {
+        convert((const uint8_t*)src, (uint8_t*)dst, pixel_count);
+    } else if (dst_type <= EXR_PIXEL_FLOAT) {
+        /* Unknown source type reads as zero */
+        memset(dst, 0, pixel_count * get_bytes_per_pixel(dst_type));
     }
+}
 
-    const uint8_t* src_ptr = (const uint8_t*)src;
-    uint8_t* dst_ptr = (uint8_t*)dst;
+/* Values converted per block when writing an interleaved channel; sized so
+ * that four float blocks stay in L1 */
+#define EXR_CONVERT_BLOCK_PIXELS 256
 
-    for (size_t i = 0; i < pixel_count; i++) {
-        float val;
+/* Convert `count` contiguous values of one channel into every
+ * `dst_stride`-th byte of an interleaved destination. Blocks are converted
+ * with the contiguous kernel first, then scattered. */
+static void convert_pixels_strided(const uint8_t* src, uint32_t src_type,
+                                   uint8_t* dst, uint32_t dst_type,
+                                   size_t count, ptrdiff_t dst_stride) {
+    uint32_t block[EXR_CONVERT_BLOCK_PIXELS];
+    size_t src_bytes = get_bytes_per_pixel(src_type);
+    size_t dst_bytes = get_bytes_per_pixel(dst_type);
 
-        /* Read source value and convert to float */
-        switch (src_type) {
-            case EXR_PIXEL_HALF: {
-                uint16_t h;
-                memcpy(&h, src_ptr, sizeof(uint16_t));
-                val = half_to_float_single(h);
-                src_ptr += 2;
-                break;
-            }
-            case EXR_PIXEL_FLOAT: {
-                memcpy(&val, src_ptr, sizeof(float));
-                src_ptr += 4;
-                break;
+    if (dst_type > EXR_PIXEL_FLOAT) return;  /* Unknown output type */
+
+    for (size_t x0 = 0; x0 < count; x0 += EXR_CONVERT_BLOCK_PIXELS) {
+        size_t n = count - x0;
+        if (n > EXR_CONVERT_BLOCK_PIXELS) n = EXR_CONVERT_BLOCK_PIXELS;
+
+        convert_pixels(src + x0 * src_bytes, src_type, block, dst_type, n);
+
+        uint8_t* out = dst + (ptrdiff_t)x0 * dst_stride;
+        if (dst_bytes == 4) {
+            for (size_t i = 0; i < n; i++) {
+                memcpy(out + (ptrdiff_t)i * dst_stride, &block[i], 4);
             }
-            case EXR_PIXEL_UINT: {
-                uint32_t u;
-                memcpy(&u, src_ptr, sizeof(uint32_t));
-                /* UINT values are typically used for sample counts or IDs */
-                val = (float)u;
-                src_ptr += 4;
-                break;
+        } else {
+            const uint16_t* block16 = (const uint16_t*)block;
+            for (size_t i = 0; i < n; i++) {
+                memcpy(out + (ptrdiff_t)i * dst_stride, &block16[i], 2);
             }
-            default:
-                val = 0.0f;
-                src_ptr += 4;
-                break;
         }
+    }
+}
 
-        /* Write destination value */
-        switch (dst_type) {
-            case EXR_PIXEL_HALF: {
-                uint16_t h = float_to_half_single(val);
-                memcpy(dst_ptr, &h, sizeof(uint16_t));
-                dst_ptr += 2;
-                break;
-            }
-            case EXR_PIXEL_FLOAT: {
-                memcpy(dst_ptr, &val, sizeof(float));
-                dst_ptr += 4;
-                break;
-            }
-            case EXR_PIXEL_UINT: {
-                uint32_t u = (val < 0.0f) ? 0 :
-                             (val > 4294967295.0f) ? 0xFFFFFFFF : (uint32_t)val;
-                memcpy(dst_ptr, &u, sizeof(uint32_t));
-                dst_ptr += 4;
-                break;
-            }
-            default:
-                dst_ptr += 4;
-                break;
+/* Convert four channel rows into interleaved FLOAT RGBA(dst must be 4-byte
+ * aligned) */
+static void convert_rgba_to_interleaved_float(const uint8_t* const src[4],
+                                              const uint32_t src_types[4],
+                                              float* dst, size_t count) {
+    float block[4][EXR_CONVERT_BLOCK_PIXELS];
+
+    for (size_t x0 = 0; x0 < count; x0 += EXR_CONVERT_BLOCK_PIXELS) {
+        size_t n = count - x0;
+        if (n > EXR_CONVERT_BLOCK_PIXELS) n = EXR_CONVERT_BLOCK_PIXELS;
+
+        for (int c = 0; c < 4; c++) {
+            convert_pixels(src[c] + x0 * get_bytes_per_pixel(src_types[c]),
+                           src_types[c], block[c], EXR_PIXEL_FLOAT, n);
         }
+        exr_interleave_rgba(block[0], block[1], block[2], block[3],
+                            dst + x0 * 4, n);
     }
 }
 
@@ -3427,58 +4649,28 @@ static void convert_scanline_data(const uint8_t* src, uint8_t* dst,
 
         if (layout == EXR_LAYOUT_INTERLEAVED) {
             /* Convert to interleaved: RGBARGBA... */
-            size_t src_ch_offset = 0;
-            for (uint32_t c = 0; c < num_channels; c++) {
-                const uint8_t* src_ch = src_line + src_ch_offset;
-                size_t src_bytes = get_bytes_per_pixel(channels[c].pixel_type);
-
-                for (int x = 0; x < width; x++) {
-                    /* Read source pixel */
-                    float val;
-                    switch (channels[c].pixel_type) {
-                        case EXR_PIXEL_HALF: {
-                            uint16_t h;
-                            memcpy(&h, src_ch + x * src_bytes, sizeof(uint16_t));
-                            val = half_to_float_single(h);
-                            break;
-                        }
-                        case EXR_PIXEL_FLOAT:
-                            memcpy(&val, src_ch + x * src_bytes, sizeof(float));
-                            break;
-                        case EXR_PIXEL_UINT: {
-                            uint32_t u;
-                            memcpy(&u, src_ch + x * src_bytes, sizeof(uint32_t));
-                            val = (float)u;
-                            break;
-                        }
-                        default:
-                            val = 0.0f;
-                            break;
-                    }
-
-                    /* Write destination pixel (interleaved) */
-                    uint8_t* dst_pixel = dst_line + (x * num_channels + c) * dst_bytes_per_pixel;
-                    switch (output_type) {
-                        case EXR_PIXEL_HALF: {
-                            uint16_t h = float_to_half_single(val);
-                            memcpy(dst_pixel, &h, sizeof(uint16_t));
-                            break;
-                        }
-                        case EXR_PIXEL_FLOAT:
-                            memcpy(dst_pixel, &val, sizeof(float));
-                            break;
-                        case EXR_PIXEL_UINT: {
-                            uint32_t u = (val < 0.0f) ? 0 :
-                                         (val > 4294967295.0f) ? 0xFFFFFFFF : (uint32_t)val;
-                            memcpy(dst_pixel, &u, sizeof(uint32_t));
-                            break;
-                        }
-                        default:
-                            break;
-                    }
+            if (num_channels == 4 && output_type == EXR_PIXEL_FLOAT &&
+                is_aligned(dst_line, sizeof(float))) {
+                const uint8_t* src_ch[4];
+                uint32_t src_types[4];
+                size_t src_ch_offset = 0;
+                for (uint32_t c = 0; c < 4; c++) {
+                    src_ch[c] = src_line + src_ch_offset;
+                    src_types[c] = channels[c].pixel_type;
+                    src_ch_offset += (size_t)width * get_bytes_per_pixel(src_types[c]);
                 }
+                convert_rgba_to_interleaved_float(src_ch, src_types,
+                                                  (float*)dst_line, (size_t)width);
+                continue;
+            }
 
-                src_ch_offset += (size_t)width * src_bytes;
+            size_t src_ch_offset = 0;
+            for (uint32_t c = 0; c < num_channels; c++) {
+                convert_pixels_strided(src_line + src_ch_offset, channels[c].pixel_type,
+                                       dst_line + c * dst_bytes_per_pixel, output_type,
+                                       (size_t)width,
+                                       (ptrdiff_t)(num_channels * dst_bytes_per_pixel));
+                src_ch_offset += (size_t)width * get_bytes_per_pixel(channels[c].pixel_type);
             }
         } else {
             /* Planar or native layout: convert each channel sequentially */
@@ -3500,85 +4692,216 @@ static void convert_scanline_data(const uint8_t* src, uint8_t* dst,
     }
 }
 
-/* Execute a scanline read command */
-static ExrResult execute_scanline_read(ExrDecoder decoder, ExrScanlineReadCmd* cmd) {
-    ExrContext ctx = decoder->ctx;
-    ExrImage image = decoder->image;
+/* Store one value of `pixel_type` converted from a slice's fill value */
+static void make_fill_pixel(double value, uint32_t pixel_type, uint8_t out[4]) {
+    if (pixel_type == EXR_PIXEL_HALF) {
+        uint16_t h = float_to_half_single((float)value);
+        memcpy(out, &h, sizeof(h));
+    } else if (pixel_type == EXR_PIXEL_UINT) {
+        uint32_t u = (value <= 0.0) ? 0u :
+                     (value >= 4294967295.0) ? 0xFFFFFFFFu : (uint32_t)value;
+        memcpy(out, &u, sizeof(u));
+    } else {
+        float f = (float)value;
+        memcpy(out, &f, sizeof(f));
+    }
+}
 
-    if (!image || cmd->base.part_index >= image->num_parts) {
-        return EXR_ERROR_INVALID_ARGUMENT;
+/* Write decoded lines (planar per line, as produced by decompression) into
+ * the slices of a frame buffer. (x, y) is the position of the first pixel
+ * within the level. */
+static void write_framebuffer_lines(const uint8_t* src, int width, int num_lines,
+                                    int x, int y,
+                                    uint32_t num_channels,
+                                    const ExrChannelData* channels,
+                                    const ExrFrameBuffer* fb) {
+    size_t src_bytes_per_line = 0;
+    for (uint32_t c = 0; c < num_channels; c++) {
+        src_bytes_per_line += (size_t)width * get_bytes_per_pixel(channels[c].pixel_type);
     }
 
-    ExrPartData* part = &image->parts[cmd->base.part_index];
-    int lines_per_block = get_lines_per_block(part->compression);
+    for (uint32_t s = 0; s < fb->slice_count; s++) {
+        const ExrSlice* slice = &fb->slices[s];
+        if (!slice->base || slice->pixel_type > EXR_PIXEL_FLOAT) continue;
 
-    /* Calculate which chunks we need to read */
-    int start_chunk = cmd->y_start / lines_per_block;
-    int end_y = cmd->y_start + cmd->num_lines;
-    int end_chunk = (end_y + lines_per_block - 1) / lines_per_block;
+        /* Locate the channel within a decoded line */
+        uint32_t ch = num_channels;
+        size_t src_ch_offset = 0;
+        if (slice->channel_name) {
+            for (uint32_t c = 0; c < num_channels; c++) {
+                if (strcmp(channels[c].name, slice->channel_name) == 0) {
+                    ch = c;
+                    break;
+                }
+                src_ch_offset += (size_t)width * get_bytes_per_pixel(channels[c].pixel_type);
+            }
+        }
 
-    /* Calculate output stride */
-    size_t bytes_per_pixel_out = get_bytes_per_pixel(cmd->output_pixel_type);
-    size_t output_stride = (size_t)part->width * part->num_channels * bytes_per_pixel_out;
+        size_t dst_bytes = get_bytes_per_pixel(slice->pixel_type);
+        ptrdiff_t x_stride = (ptrdiff_t)slice->x_stride;
+        ptrdiff_t y_stride = (ptrdiff_t)slice->y_stride;
+        uint8_t fill[4];
+        if (ch == num_channels) {
+            make_fill_pixel(slice->fill_value, slice->pixel_type, fill);
+        }
 
-    uint8_t* output = (uint8_t*)cmd->output;
-    int lines_written = 0;
+        for (int line = 0; line < num_lines; line++) {
+            uint8_t* dst = (uint8_t*)slice->base + (ptrdiff_t)x * x_stride +
+                           (ptrdiff_t)(y + line) * y_stride;
 
-    /* Read each chunk */
-    for (int chunk = start_chunk; chunk < end_chunk && chunk < (int)part->num_chunks; chunk++) {
-        uint8_t* chunk_data = NULL;
-        size_t chunk_size;
-        int chunk_y_start, chunk_num_lines;
+            if (ch == num_channels) {
+                for (int i = 0; i < width; i++) {
+                    memcpy(dst + (ptrdiff_t)i * x_stride, fill, dst_bytes);
+                }
+                continue;
+            }
 
-        ExrResult result = read_chunk(decoder, part, (uint32_t)chunk,
-                                       &chunk_data, &chunk_size,
-                                       &chunk_y_start, &chunk_num_lines);
-        if (EXR_FAILED(result)) {
-            return result;
+            const uint8_t* src_ch = src + (size_t)line * src_bytes_per_line + src_ch_offset;
+            if (x_stride == (ptrdiff_t)dst_bytes) {
+                convert_pixels(src_ch, channels[ch].pixel_type,
+                               dst, slice->pixel_type, (size_t)width);
+            } else {
+                convert_pixels_strided(src_ch, channels[ch].pixel_type,
+                                       dst, slice->pixel_type, (size_t)width, x_stride);
+            }
         }
+    }
+}
 
-        /* Calculate overlap with requested region */
-        int copy_start = (chunk_y_start > cmd->y_start) ? chunk_y_start : cmd->y_start;
-        int copy_end = (chunk_y_start + chunk_num_lines < end_y) ?
-                       (chunk_y_start + chunk_num_lines) : end_y;
-        int copy_lines = copy_end - copy_start;
+/* Shared state for decoding the chunks of one scanline read in parallel */
+typedef struct ExrScanlineReadJob {
+    ExrDecoder decoder;
+    const ExrChunkPrefetch* prefetch;
+    ExrPartData* part;
+    const ExrScanlineReadCmd* cmd;
+    int start_chunk;
+    ATOMIC_INT result;
+} ExrScanlineReadJob;
+
+/* Decode one chunk of a scanline read and convert it into the output */
+static void scanline_read_task(void* userdata, uint32_t index) {
+    ExrScanlineReadJob* job = (ExrScanlineReadJob*)userdata;
+    if (ATOMIC_LOAD(job->result) < 0) return;  /* Another chunk failed */
+
+    ExrPartData* part = job->part;
+    const ExrScanlineReadCmd* cmd = job->cmd;
+    int end_y = cmd->y_start + cmd->num_lines;
 
-        if (copy_lines > 0) {
-            /* Calculate source offset within chunk */
-            int src_y_offset = copy_start - chunk_y_start;
-            size_t bytes_per_line = 0;
-            for (uint32_t c = 0; c < part->num_channels; c++) {
-                bytes_per_line += (size_t)part->width *
-                                  get_bytes_per_pixel(part->channels[c].pixel_type);
-            }
-            size_t src_offset = src_y_offset * bytes_per_line;
-
-            /* Convert and copy data with pixel type conversion */
-            size_t dst_bytes_per_pixel = get_bytes_per_pixel(cmd->output_pixel_type);
-            size_t dst_line_size = (size_t)part->width * part->num_channels * dst_bytes_per_pixel;
-            size_t required_size = (lines_written + copy_lines) * dst_line_size;
-
-            if (required_size <= cmd->output_size) {
-                convert_scanline_data(
-                    chunk_data + src_offset,
-                    output + lines_written * dst_line_size,
-                    part->width, copy_lines,
-                    part->num_channels, part->channels,
-                    cmd->output_pixel_type,
-                    cmd->output_layout);
-            }
+    uint8_t* chunk_data = NULL;
+    size_t chunk_size;
+    int chunk_y_start, chunk_num_lines;
 
-            lines_written += copy_lines;
+    ExrScratch scratch;
+    exr_scratch_begin(&scratch, job->decoder->ctx, job->decoder->scratch_pool);
+    scratch.prefetch = job->prefetch;
+
+    ExrResult result = read_chunk(job->decoder, &scratch, part,
+                                   (uint32_t)(job->start_chunk + (int)index),
+                                   &chunk_data, &chunk_size,
+                                   &chunk_y_start, &chunk_num_lines);
+    if (EXR_FAILED(result)) {
+        exr_scratch_end(&scratch);
+        ATOMIC_STORE(job->result, result);
+        return;
+    }
+
+    /* Calculate overlap with requested region */
+    int copy_start = (chunk_y_start > cmd->y_start) ? chunk_y_start : cmd->y_start;
+    int copy_end = (chunk_y_start + chunk_num_lines < end_y) ?
+                   (chunk_y_start + chunk_num_lines) : end_y;
+    int copy_lines = copy_end - copy_start;
+
+    if (copy_lines > 0 && cmd->framebuffer) {
+        size_t bytes_per_line = 0;
+        for (uint32_t c = 0; c < part->num_channels; c++) {
+            bytes_per_line += (size_t)part->width *
+                              get_bytes_per_pixel(part->channels[c].pixel_type);
+        }
+        write_framebuffer_lines(chunk_data + (size_t)(copy_start - chunk_y_start) * bytes_per_line,
+                                part->width, copy_lines, 0, copy_start,
+                                part->num_channels, part->channels, cmd->framebuffer);
+    } else if (copy_lines > 0) {
+        /* Calculate source offset within chunk */
+        int src_y_offset = copy_start - chunk_y_start;
+        size_t bytes_per_line = 0;
+        for (uint32_t c = 0; c < part->num_channels; c++) {
+            bytes_per_line += (size_t)part->width *
+                              get_bytes_per_pixel(part->channels[c].pixel_type);
         }
+        size_t src_offset = src_y_offset * bytes_per_line;
 
-        ctx->allocator.free(ctx->allocator.userdata, chunk_data, chunk_size);
+        /* Chunks complete in any order, so place lines by their y */
+        size_t dst_bytes_per_pixel = get_bytes_per_pixel(cmd->output_pixel_type);
+        size_t dst_line_size = (size_t)part->width * part->num_channels * dst_bytes_per_pixel;
+        size_t dst_line = (size_t)(copy_start - cmd->y_start);
+        size_t required_size = (dst_line + copy_lines) * dst_line_size;
+
+        if (required_size <= cmd->output_size) {
+            convert_scanline_data(
+                chunk_data + src_offset,
+                (uint8_t*)cmd->output + dst_line * dst_line_size,
+                part->width, copy_lines,
+                part->num_channels, part->channels,
+                cmd->output_pixel_type,
+                cmd->output_layout);
+        }
     }
 
-    return EXR_SUCCESS;
+    if (chunk_size > 0) {
+        exr_scratch_free(&scratch, chunk_data, chunk_size);
+    }
+    exr_scratch_end(&scratch);
+}
+
+/* Chunks [start, end) holding scanlines [y_start, y_start + num_lines) */
+static void calc_scanline_chunk_range(const ExrPartData* part, int y_start, int num_lines,
+                                      int* out_start, int* out_end) {
+    int lines_per_block = get_lines_per_block(part->compression);
+    int end_y = y_start + num_lines;
+    *out_start = y_start / lines_per_block;
+    *out_end = (end_y + lines_per_block - 1) / lines_per_block;
+    if (*out_end > (int)part->num_chunks) {
+        *out_end = (int)part->num_chunks;
+    }
+}
+
+/* Execute a scanline read command */
+static ExrResult execute_scanline_read(ExrDecoder decoder, const ExrChunkPrefetch* prefetch,
+                                       ExrScanlineReadCmd* cmd) {
+    ExrImage image = decoder->image;
+
+    if (!image || cmd->base.part_index >= image->num_parts) {
+        return EXR_ERROR_INVALID_ARGUMENT;
+    }
+
+    ExrPartData* part = &image->parts[cmd->base.part_index];
+
+    /* Calculate which chunks we need to read */
+    int start_chunk, end_chunk;
+    calc_scanline_chunk_range(part, cmd->y_start, cmd->num_lines, &start_chunk, &end_chunk);
+    if (end_chunk <= start_chunk) {
+        return EXR_SUCCESS;
+    }
+
+    ExrScanlineReadJob job;
+    job.decoder = decoder;
+    job.prefetch = prefetch;
+    job.part = part;
+    job.cmd = cmd;
+    job.start_chunk = start_chunk;
+    ATOMIC_INIT(job.result, EXR_SUCCESS);
+
+    /* Chunks are independent: decode them across the context's workers */
+    exr_parallel_for(exr_context_get_thread_pool(decoder->ctx),
+                     (uint32_t)(end_chunk - start_chunk),
+                     scanline_read_task, &job);
+
+    return (ExrResult)ATOMIC_LOAD(job.result);
 }
 
 /* Execute a tile read command */
-static ExrResult execute_tile_read(ExrDecoder decoder, ExrTileReadCmd* cmd) {
+static ExrResult execute_tile_read(ExrDecoder decoder, const ExrChunkPrefetch* prefetch,
+                                   ExrTileReadCmd* cmd) {
     ExrContext ctx = decoder->ctx;
     ExrImage image = decoder->image;
 
@@ -3599,36 +4922,130 @@ static ExrResult execute_tile_read(ExrDecoder decoder, ExrTileReadCmd* cmd) {
     size_t tile_size;
     int tile_width, tile_height;
 
-    ExrResult result = read_tile(decoder, part, cmd->tile_x, cmd->tile_y,
+    ExrScratch scratch;
+    exr_scratch_begin(&scratch, ctx, decoder->scratch_pool);
+    scratch.prefetch = prefetch;
+
+    ExrResult result = read_tile(decoder, &scratch, part, cmd->tile_x, cmd->tile_y,
                                   cmd->level_x, cmd->level_y,
                                   &tile_data, &tile_size, &tile_width, &tile_height);
     if (EXR_FAILED(result)) {
+        exr_scratch_end(&scratch);
         return result;
     }
 
+    if (cmd->framebuffer) {
+        /* Slices are addressed in level coordinates */
+        write_framebuffer_lines(tile_data, tile_width, tile_height,
+                                cmd->tile_x * (int)part->tile_size_x,
+                                cmd->tile_y * (int)part->tile_size_y,
+                                part->num_channels, part->channels, cmd->framebuffer);
+        if (tile_size > 0) {
+            exr_scratch_free(&scratch, tile_data, tile_size);
+        }
+        exr_scratch_end(&scratch);
+        return EXR_SUCCESS;
+    }
+
     /* Calculate output size */
     size_t bytes_per_pixel_out = get_bytes_per_pixel(cmd->output_pixel_type);
     size_t output_size = (size_t)tile_width * tile_height * part->num_channels * bytes_per_pixel_out;
 
-    if (output_size > cmd->output_size) {
-        ctx->allocator.free(ctx->allocator.userdata, tile_data, tile_size);
-        return EXR_ERROR_BUFFER_TOO_SMALL;
+    if (output_size <= cmd->output_size) {
+        /* Convert and copy to output */
+        convert_scanline_data(tile_data, (uint8_t*)cmd->output,
+                              tile_width, tile_height,
+                              part->num_channels, part->channels,
+                              cmd->output_pixel_type, cmd->output_layout);
     }
 
-    /* Convert and copy to output */
-    convert_scanline_data(tile_data, (uint8_t*)cmd->output,
-                          tile_width, tile_height,
-                          part->num_channels, part->channels,
-                          cmd->output_pixel_type, cmd->output_layout);
+    if (tile_size > 0) {
+        exr_scratch_free(&scratch, tile_data, tile_size);
+    }
+    exr_scratch_end(&scratch);
 
-    ctx->allocator.free(ctx->allocator.userdata, tile_data, tile_size);
+    return (output_size <= cmd->output_size) ? EXR_SUCCESS : EXR_ERROR_BUFFER_TOO_SMALL;
+}
 
-    return EXR_SUCCESS;
+/* Shared state for decoding the tiles of one full image read in parallel */
+typedef struct ExrTiledImageReadJob {
+    ExrDecoder decoder;
+    const ExrChunkPrefetch* prefetch;
+    ExrPartData* part;
+    const ExrFullImageReadCmd* cmd;
+    int level_width;
+    int num_x_tiles;
+    ATOMIC_INT result;
+} ExrTiledImageReadJob;
+
+/* Decode one tile of a full image read and copy it into place */
+static void tiled_image_read_task(void* userdata, uint32_t index) {
+    ExrTiledImageReadJob* job = (ExrTiledImageReadJob*)userdata;
+    if (ATOMIC_LOAD(job->result) < 0) return;  /* Another tile failed */
+
+    ExrPartData* part = job->part;
+    const ExrFullImageReadCmd* cmd = job->cmd;
+    int tx = (int)index % job->num_x_tiles;
+    int ty = (int)index / job->num_x_tiles;
+
+    size_t bytes_per_pixel_out = get_bytes_per_pixel(cmd->output_pixel_type);
+
+    uint8_t* tile_data = NULL;
+    size_t tile_size;
+    int tile_width, tile_height;
+
+    ExrScratch scratch;
+    exr_scratch_begin(&scratch, job->decoder->ctx, job->decoder->scratch_pool);
+    scratch.prefetch = job->prefetch;
+
+    ExrResult result = read_tile(job->decoder, &scratch, part, tx, ty, 0, 0,
+                                  &tile_data, &tile_size, &tile_width, &tile_height);
+    if (EXR_FAILED(result)) {
+        exr_scratch_end(&scratch);
+        ATOMIC_STORE(job->result, result);
+        return;
+    }
+
+    /* Calculate pixel position of this tile */
+    int tile_px_x = tx * (int)part->tile_size_x;
+    int tile_px_y = ty * (int)part->tile_size_y;
+
+    if (cmd->framebuffer) {
+        write_framebuffer_lines(tile_data, tile_width, tile_height,
+                                tile_px_x, tile_px_y,
+                                part->num_channels, part->channels, cmd->framebuffer);
+        if (tile_size > 0) {
+            exr_scratch_free(&scratch, tile_data, tile_size);
+        }
+        exr_scratch_end(&scratch);
+        return;
+    }
+
+    /* Convert each tile row straight into its place in the output */
+    size_t output_stride = (size_t)job->level_width * part->num_channels * bytes_per_pixel_out;
+    size_t src_stride = 0;
+    for (uint32_t c = 0; c < part->num_channels; c++) {
+        src_stride += (size_t)tile_width * get_bytes_per_pixel(part->channels[c].pixel_type);
+    }
+
+    for (int y = 0; y < tile_height; y++) {
+        uint8_t* dst = (uint8_t*)cmd->output + (tile_px_y + y) * output_stride +
+                       tile_px_x * part->num_channels * bytes_per_pixel_out;
+        convert_scanline_data(tile_data + y * src_stride, dst,
+                              tile_width, 1,
+                              part->num_channels, part->channels,
+                              cmd->output_pixel_type, cmd->output_layout);
+    }
+
+    if (tile_size > 0) {
+        exr_scratch_free(&scratch, tile_data, tile_size);
+    }
+    exr_scratch_end(&scratch);
 }
 
 /* Execute a full image read command */
-static ExrResult execute_full_image_read(ExrDecoder decoder, ExrFullImageReadCmd* cmd) {
-    ExrContext ctx = decoder->ctx;
+static ExrResult execute_full_image_read(ExrDecoder decoder, const ExrChunkPrefetch* prefetch,
+                                         ExrFullImageReadCmd* cmd) {
     ExrImage image = decoder->image;
 
     if (!image || cmd->base.part_index >= image->num_parts) {
@@ -3637,7 +5054,7 @@ static ExrResult execute_full_image_read(ExrDecoder decoder, ExrFullImageReadCmd
 
     ExrPartData* part = &image->parts[cmd->base.part_index];
 
-    /* For scanline images, read all chunks sequentially */
+    /* For scanline images, read all chunks */
     if (part->part_type == EXR_PART_SCANLINE) {
         ExrScanlineReadCmd scan_cmd;
         scan_cmd.base.type = EXR_CMD_TYPE_READ_SCANLINES;
@@ -3649,8 +5066,9 @@ static ExrResult execute_full_image_read(ExrDecoder decoder, ExrFullImageReadCmd
         scan_cmd.channels_mask = cmd->channels_mask;
         scan_cmd.output_pixel_type = cmd->output_pixel_type;
         scan_cmd.output_layout = cmd->output_layout;
+        scan_cmd.framebuffer = cmd->framebuffer;
 
-        return execute_scanline_read(decoder, &scan_cmd);
+        return execute_scanline_read(decoder, prefetch, &scan_cmd);
     }
 
     /* For tiled images - read all tiles at level 0 */
@@ -3658,66 +5076,29 @@ static ExrResult execute_full_image_read(ExrDecoder decoder, ExrFullImageReadCmd
         int level_width, level_height, num_x_tiles, num_y_tiles;
         calc_level_size(part, 0, 0, &level_width, &level_height, &num_x_tiles, &num_y_tiles);
 
-        size_t bytes_per_pixel_out = get_bytes_per_pixel(cmd->output_pixel_type);
-        size_t tile_bytes_per_line = (size_t)part->tile_size_x * part->num_channels * bytes_per_pixel_out;
+        ExrTiledImageReadJob job;
+        job.decoder = decoder;
+        job.prefetch = prefetch;
+        job.part = part;
+        job.cmd = cmd;
+        job.level_width = level_width;
+        job.num_x_tiles = num_x_tiles;
+        ATOMIC_INIT(job.result, EXR_SUCCESS);
 
-        /* Read each tile and copy to the correct position in output */
-        for (int ty = 0; ty < num_y_tiles; ty++) {
-            for (int tx = 0; tx < num_x_tiles; tx++) {
-                uint8_t* tile_data = NULL;
-                size_t tile_size;
-                int tile_width, tile_height;
+        /* Tiles land in disjoint output regions: decode them across workers */
+        exr_parallel_for(exr_context_get_thread_pool(decoder->ctx),
+                         (uint32_t)(num_x_tiles * num_y_tiles),
+                         tiled_image_read_task, &job);
 
-                ExrResult result = read_tile(decoder, part, tx, ty, 0, 0,
-                                              &tile_data, &tile_size, &tile_width, &tile_height);
-                if (EXR_FAILED(result)) {
-                    return result;
-                }
-
-                /* Calculate pixel position of this tile */
-                int tile_px_x = tx * (int)part->tile_size_x;
-                int tile_px_y = ty * (int)part->tile_size_y;
-
-                /* Allocate temp buffer for converted tile */
-                size_t conv_size = (size_t)tile_width * tile_height * part->num_channels * bytes_per_pixel_out;
-                uint8_t* converted = (uint8_t*)ctx->allocator.alloc(
-                    ctx->allocator.userdata, conv_size, EXR_DEFAULT_ALIGNMENT);
-                if (!converted) {
-                    ctx->allocator.free(ctx->allocator.userdata, tile_data, tile_size);
-                    return EXR_ERROR_OUT_OF_MEMORY;
-                }
-
-                /* Convert tile data */
-                convert_scanline_data(tile_data, converted,
-                                      tile_width, tile_height,
-                                      part->num_channels, part->channels,
-                                      cmd->output_pixel_type, cmd->output_layout);
-
-                ctx->allocator.free(ctx->allocator.userdata, tile_data, tile_size);
-
-                /* Copy converted tile to the correct position in output */
-                size_t output_stride = (size_t)level_width * part->num_channels * bytes_per_pixel_out;
-                size_t tile_stride = (size_t)tile_width * part->num_channels * bytes_per_pixel_out;
-
-                for (int y = 0; y < tile_height; y++) {
-                    uint8_t* dst = (uint8_t*)cmd->output + (tile_px_y + y) * output_stride +
-                                   tile_px_x * part->num_channels * bytes_per_pixel_out;
-                    const uint8_t* src = converted + y * tile_stride;
-                    memcpy(dst, src, tile_stride);
-                }
-
-                ctx->allocator.free(ctx->allocator.userdata, converted, conv_size);
-            }
-        }
-
-        return EXR_SUCCESS;
+        return (ExrResult)ATOMIC_LOAD(job.result);
     }
 
     return EXR_ERROR_UNSUPPORTED_FORMAT;
 }
 
-/* Execute a deep scanline read command */
-static ExrResult execute_deep_scanline_read(ExrDecoder decoder, ExrDeepScanlineReadCmd* cmd) {
+/* Decode a deep scanline read, allocating temporaries from scratch */
+static ExrResult deep_scanline_read(ExrDecoder decoder, ExrScratch* scratch,
+                                    ExrDeepScanlineReadCmd* cmd) {
     ExrContext ctx = decoder->ctx;
     ExrImage image = decoder->image;
 
@@ -3747,7 +5128,11 @@ static ExrResult execute_deep_scanline_read(ExrDecoder decoder, ExrDeepScanlineR
         return EXR_ERROR_OUT_OF_BOUNDS;
     }
 
-    uint64_t offset = part->offsets[block_index];
+    uint64_t offset;
+    ExrResult result = get_chunk_offset(decoder, part, (uint32_t)block_index, &offset);
+    if (EXR_FAILED(result)) {
+        return result;
+    }
 
     /* Read deep chunk header:
      * - int32: y coordinate
@@ -3756,7 +5141,7 @@ static ExrResult execute_deep_scanline_read(ExrDecoder decoder, ExrDeepScanlineR
      * - int64: unpacked size of sample data
      */
     uint8_t header[28];
-    ExrResult result = sync_fetch(decoder, offset, 28, header);
+    result = chunk_fetch(decoder, scratch, offset, 28, header);
     if (EXR_FAILED(result)) {
         return result;
     }
@@ -3776,34 +5161,31 @@ static ExrResult execute_deep_scanline_read(ExrDecoder decoder, ExrDeepScanlineR
 
     /* Read compressed sample data */
     size_t sample_data_offset = 28 + (size_t)packed_offset_table_size;
-    uint8_t* compressed_data = (uint8_t*)ctx->allocator.alloc(
-        ctx->allocator.userdata, (size_t)packed_sample_data_size, EXR_DEFAULT_ALIGNMENT);
+    uint8_t* compressed_data = (uint8_t*)exr_scratch_alloc(scratch, (size_t)packed_sample_data_size);
     if (!compressed_data) {
         return EXR_ERROR_OUT_OF_MEMORY;
     }
 
-    result = sync_fetch(decoder, offset + sample_data_offset,
-                        (size_t)packed_sample_data_size, compressed_data);
+    result = chunk_fetch(decoder, scratch, offset + sample_data_offset,
+                         (size_t)packed_sample_data_size, compressed_data);
     if (EXR_FAILED(result)) {
-        ctx->allocator.free(ctx->allocator.userdata, compressed_data, (size_t)packed_sample_data_size);
+        exr_scratch_free(scratch, compressed_data, (size_t)packed_sample_data_size);
         return result;
     }
 
     /* Allocate temp buffer for decompression */
     size_t data_size = (size_t)unpacked_sample_data_size;
-    uint8_t* temp_buf = (uint8_t*)ctx->allocator.alloc(
-        ctx->allocator.userdata, data_size, EXR_DEFAULT_ALIGNMENT);
+    uint8_t* temp_buf = (uint8_t*)exr_scratch_alloc(scratch, data_size);
     if (!temp_buf) {
-        ctx->allocator.free(ctx->allocator.userdata, compressed_data, (size_t)packed_sample_data_size);
+        exr_scratch_free(scratch, compressed_data, (size_t)packed_sample_data_size);
         return EXR_ERROR_OUT_OF_MEMORY;
     }
 
     /* Allocate final sample data buffer */
-    uint8_t* sample_data = (uint8_t*)ctx->allocator.alloc(
-        ctx->allocator.userdata, data_size, EXR_DEFAULT_ALIGNMENT);
+    uint8_t* sample_data = (uint8_t*)exr_scratch_alloc(scratch, data_size);
     if (!sample_data) {
-        ctx->allocator.free(ctx->allocator.userdata, temp_buf, data_size);
-        ctx->allocator.free(ctx->allocator.userdata, compressed_data, (size_t)packed_sample_data_size);
+        exr_scratch_free(scratch, temp_buf, data_size);
+        exr_scratch_free(scratch, compressed_data, (size_t)packed_sample_data_size);
         return EXR_ERROR_OUT_OF_MEMORY;
     }
 
@@ -3822,34 +5204,17 @@ static ExrResult execute_deep_scanline_read(ExrDecoder decoder, ExrDeepScanlineR
                               compressed_data, (mz_ulong)packed_sample_data_size);
     decomp_ok = (zret == MZ_OK && dst_len == (mz_ulong)data_size);
 #endif
-    ctx->allocator.free(ctx->allocator.userdata, compressed_data, (size_t)packed_sample_data_size);
+    exr_scratch_free(scratch, compressed_data, (size_t)packed_sample_data_size);
 
     if (decomp_ok) {
-        /* Apply predictor: t[i] = t[i-1] + t[i] - 128 */
-        uint8_t* t = temp_buf + 1;
-        uint8_t* stop = temp_buf + data_size;
-        while (t < stop) {
-            int d = (int)t[-1] + (int)t[0] - 128;
-            t[0] = (uint8_t)d;
-            ++t;
-        }
-
-        /* Reorder bytes: interleave first half and second half */
-        const uint8_t* t1 = temp_buf;
-        const uint8_t* t2 = temp_buf + (data_size + 1) / 2;
-        uint8_t* dst = sample_data;
-        uint8_t* dst_stop = dst + data_size;
-
-        while (dst < dst_stop) {
-            if (dst < dst_stop) *dst++ = *t1++;
-            if (dst < dst_stop) *dst++ = *t2++;
-        }
+        /* Apply predictor and interleave first half and second half */
+        decode_predictor_and_reorder(temp_buf, sample_data, data_size);
     }
 
-    ctx->allocator.free(ctx->allocator.userdata, temp_buf, data_size);
+    exr_scratch_free(scratch, temp_buf, data_size);
 
     if (!decomp_ok) {
-        ctx->allocator.free(ctx->allocator.userdata, sample_data, data_size);
+        exr_scratch_free(scratch, sample_data, data_size);
         return EXR_ERROR_DECOMPRESSION_FAILED;
     }
 
@@ -3859,7 +5224,7 @@ static ExrResult execute_deep_scanline_read(ExrDecoder decoder, ExrDeepScanlineR
         sample_size += (int)get_bytes_per_pixel(part->channels[c].pixel_type);
     }
     if (sample_size <= 0) {
-        ctx->allocator.free(ctx->allocator.userdata, sample_data, (size_t)unpacked_sample_data_size);
+        exr_scratch_free(scratch, sample_data, (size_t)unpacked_sample_data_size);
         return EXR_ERROR_INVALID_DATA;
     }
 
@@ -3873,7 +5238,7 @@ static ExrResult execute_deep_scanline_read(ExrDecoder decoder, ExrDeepScanlineR
     size_t required_output = total_samples * part->num_channels * bytes_per_output_sample;
 
     if (cmd->output_size < required_output) {
-        ctx->allocator.free(ctx->allocator.userdata, sample_data, (size_t)unpacked_sample_data_size);
+        exr_scratch_free(scratch, sample_data, (size_t)unpacked_sample_data_size);
         exr_context_add_error(ctx, EXR_ERROR_BUFFER_TOO_SMALL,
                               "Output buffer too small for deep sample data", NULL, 0);
         return EXR_ERROR_BUFFER_TOO_SMALL;
@@ -3888,47 +5253,33 @@ static ExrResult execute_deep_scanline_read(ExrDecoder decoder, ExrDeepScanlineR
         size_t src_bytes = get_bytes_per_pixel(src_pixel_type);
         const uint8_t* src = sample_data + channel_data_offset;
 
-        /* Copy each sample for this channel */
-        for (uint64_t s = 0; s < total_samples; s++) {
-            /* Output offset: sample * num_channels + channel_index */
-            size_t dst_offset = (s * part->num_channels + c) * bytes_per_output_sample;
-            uint8_t* dst = output + dst_offset;
-
-            /* Convert pixel type */
-            float val = 0.0f;
-            if (src_pixel_type == EXR_PIXEL_UINT) {
-                uint32_t ui;
-                memcpy(&ui, src + s * src_bytes, 4);
-                val = (float)ui;
-            } else if (src_pixel_type == EXR_PIXEL_HALF) {
-                uint16_t h;
-                memcpy(&h, src + s * src_bytes, 2);
-                val = half_to_float_single(h);
-            } else if (src_pixel_type == EXR_PIXEL_FLOAT) {
-                memcpy(&val, src + s * src_bytes, 4);
-            }
-
-            /* Write to output in requested format */
-            if (cmd->output_pixel_type == EXR_PIXEL_FLOAT) {
-                memcpy(dst, &val, 4);
-            } else if (cmd->output_pixel_type == EXR_PIXEL_HALF) {
-                uint16_t h = float_to_half_single(val);
-                memcpy(dst, &h, 2);
-            } else if (cmd->output_pixel_type == EXR_PIXEL_UINT) {
-                uint32_t ui = (uint32_t)val;
-                memcpy(dst, &ui, 4);
-            }
-        }
+        /* Convert this channel's samples into every num_channels-th slot */
+        convert_pixels_strided(src, src_pixel_type,
+                               output + c * bytes_per_output_sample,
+                               cmd->output_pixel_type, (size_t)total_samples,
+                               part->num_channels * bytes_per_output_sample);
 
         channel_data_offset += total_samples * src_bytes;
     }
 
-    ctx->allocator.free(ctx->allocator.userdata, sample_data, data_size);
+    exr_scratch_free(scratch, sample_data, data_size);
     return EXR_SUCCESS;
 }
 
-/* Execute a deep tile read command */
-static ExrResult execute_deep_tile_read(ExrDecoder decoder, ExrDeepTileReadCmd* cmd) {
+/* Execute a deep scanline read command */
+static ExrResult execute_deep_scanline_read(ExrDecoder decoder, const ExrChunkPrefetch* prefetch,
+                                            ExrDeepScanlineReadCmd* cmd) {
+    ExrScratch scratch;
+    exr_scratch_begin(&scratch, decoder->ctx, decoder->scratch_pool);
+    scratch.prefetch = prefetch;
+    ExrResult result = deep_scanline_read(decoder, &scratch, cmd);
+    exr_scratch_end(&scratch);
+    return result;
+}
+
+/* Decode a deep tile read, allocating temporaries from scratch */
+static ExrResult deep_tile_read(ExrDecoder decoder, ExrScratch* scratch,
+                                ExrDeepTileReadCmd* cmd) {
     ExrContext ctx = decoder->ctx;
     ExrImage image = decoder->image;
 
@@ -3957,7 +5308,11 @@ static ExrResult execute_deep_tile_read(ExrDecoder decoder, ExrDeepTileReadCmd*
         return EXR_ERROR_OUT_OF_BOUNDS;
     }
 
-    uint64_t offset = part->offsets[tile_index];
+    uint64_t offset;
+    ExrResult result = get_chunk_offset(decoder, part, tile_index, &offset);
+    if (EXR_FAILED(result)) {
+        return result;
+    }
 
     /* Read deep tile header:
      * - tile_x (4 bytes)
@@ -3970,7 +5325,7 @@ static ExrResult execute_deep_tile_read(ExrDecoder decoder, ExrDeepTileReadCmd*
      * Total: 40 bytes
      */
     uint8_t header[40];
-    ExrResult result = sync_fetch(decoder, offset, 40, header);
+    result = chunk_fetch(decoder, scratch, offset, 40, header);
     if (EXR_FAILED(result)) {
         return result;
     }
@@ -4002,34 +5357,31 @@ static ExrResult execute_deep_tile_read(ExrDecoder decoder, ExrDeepTileReadCmd*
 
     /* Read compressed sample data */
     size_t sample_data_offset = 40 + (size_t)packed_offset_table_size;
-    uint8_t* compressed_data = (uint8_t*)ctx->allocator.alloc(
-        ctx->allocator.userdata, (size_t)packed_sample_data_size, EXR_DEFAULT_ALIGNMENT);
+    uint8_t* compressed_data = (uint8_t*)exr_scratch_alloc(scratch, (size_t)packed_sample_data_size);
     if (!compressed_data) {
         return EXR_ERROR_OUT_OF_MEMORY;
     }
 
-    result = sync_fetch(decoder, offset + sample_data_offset,
-                        (size_t)packed_sample_data_size, compressed_data);
+    result = chunk_fetch(decoder, scratch, offset + sample_data_offset,
+                         (size_t)packed_sample_data_size, compressed_data);
     if (EXR_FAILED(result)) {
-        ctx->allocator.free(ctx->allocator.userdata, compressed_data, (size_t)packed_sample_data_size);
+        exr_scratch_free(scratch, compressed_data, (size_t)packed_sample_data_size);
         return result;
     }
 
     /* Allocate temp buffer for decompression */
     size_t data_size = (size_t)unpacked_sample_data_size;
-    uint8_t* temp_buf = (uint8_t*)ctx->allocator.alloc(
-        ctx->allocator.userdata, data_size, EXR_DEFAULT_ALIGNMENT);
+    uint8_t* temp_buf = (uint8_t*)exr_scratch_alloc(scratch, data_size);
     if (!temp_buf) {
-        ctx->allocator.free(ctx->allocator.userdata, compressed_data, (size_t)packed_sample_data_size);
+        exr_scratch_free(scratch, compressed_data, (size_t)packed_sample_data_size);
         return EXR_ERROR_OUT_OF_MEMORY;
     }
 
     /* Allocate final sample data buffer */
-    uint8_t* sample_data = (uint8_t*)ctx->allocator.alloc(
-        ctx->allocator.userdata, data_size, EXR_DEFAULT_ALIGNMENT);
+    uint8_t* sample_data = (uint8_t*)exr_scratch_alloc(scratch, data_size);
     if (!sample_data) {
-        ctx->allocator.free(ctx->allocator.userdata, temp_buf, data_size);
-        ctx->allocator.free(ctx->allocator.userdata, compressed_data, (size_t)packed_sample_data_size);
+        exr_scratch_free(scratch, temp_buf, data_size);
+        exr_scratch_free(scratch, compressed_data, (size_t)packed_sample_data_size);
         return EXR_ERROR_OUT_OF_MEMORY;
     }
 
@@ -4048,152 +5400,565 @@ static ExrResult execute_deep_tile_read(ExrDecoder decoder, ExrDeepTileReadCmd*
                               compressed_data, (mz_ulong)packed_sample_data_size);
     decomp_ok = (zret == MZ_OK && dst_len == (mz_ulong)data_size);
 #endif
-    ctx->allocator.free(ctx->allocator.userdata, compressed_data, (size_t)packed_sample_data_size);
+    exr_scratch_free(scratch, compressed_data, (size_t)packed_sample_data_size);
 
     if (decomp_ok) {
-        /* Apply predictor: t[i] = t[i-1] + t[i] - 128 */
-        uint8_t* t = temp_buf + 1;
-        uint8_t* stop = temp_buf + data_size;
-        while (t < stop) {
-            int d = (int)t[-1] + (int)t[0] - 128;
-            t[0] = (uint8_t)d;
-            ++t;
+        /* Apply predictor and interleave first half and second half */
+        decode_predictor_and_reorder(temp_buf, sample_data, data_size);
+    }
+
+    exr_scratch_free(scratch, temp_buf, data_size);
+
+    if (!decomp_ok) {
+        exr_scratch_free(scratch, sample_data, data_size);
+        return EXR_ERROR_DECOMPRESSION_FAILED;
+    }
+
+    /* Calculate sample size (bytes per sample across all channels) */
+    int sample_size = 0;
+    for (uint32_t c = 0; c < part->num_channels; c++) {
+        sample_size += (int)get_bytes_per_pixel(part->channels[c].pixel_type);
+    }
+    if (sample_size <= 0) {
+        exr_scratch_free(scratch, sample_data, (size_t)unpacked_sample_data_size);
+        return EXR_ERROR_INVALID_DATA;
+    }
+
+    uint64_t total_samples = sample_info->total_samples;
+
+    /* Calculate output size requirements */
+    size_t bytes_per_output_sample = get_bytes_per_pixel(cmd->output_pixel_type);
+    size_t required_output = total_samples * part->num_channels * bytes_per_output_sample;
+
+    if (cmd->output_size < required_output) {
+        exr_scratch_free(scratch, sample_data, (size_t)unpacked_sample_data_size);
+        exr_context_add_error(ctx, EXR_ERROR_BUFFER_TOO_SMALL,
+                              "Output buffer too small for deep tile sample data", NULL, 0);
+        return EXR_ERROR_BUFFER_TOO_SMALL;
+    }
+
+    /* Convert from channel-planar to interleaved output format */
+    uint8_t* output = (uint8_t*)cmd->output;
+    size_t channel_data_offset = 0;
+
+    for (uint32_t c = 0; c < part->num_channels; c++) {
+        uint32_t src_pixel_type = part->channels[c].pixel_type;
+        size_t src_bytes = get_bytes_per_pixel(src_pixel_type);
+        const uint8_t* src = sample_data + channel_data_offset;
+
+        /* Convert this channel's samples into every num_channels-th slot */
+        convert_pixels_strided(src, src_pixel_type,
+                               output + c * bytes_per_output_sample,
+                               cmd->output_pixel_type, (size_t)total_samples,
+                               part->num_channels * bytes_per_output_sample);
+
+        channel_data_offset += total_samples * src_bytes;
+    }
+
+    exr_scratch_free(scratch, sample_data, data_size);
+    return EXR_SUCCESS;
+}
+
+/* Execute a deep tile read command */
+static ExrResult execute_deep_tile_read(ExrDecoder decoder, const ExrChunkPrefetch* prefetch,
+                                        ExrDeepTileReadCmd* cmd) {
+    ExrScratch scratch;
+    exr_scratch_begin(&scratch, decoder->ctx, decoder->scratch_pool);
+    scratch.prefetch = prefetch;
+    ExrResult result = deep_tile_read(decoder, &scratch, cmd);
+    exr_scratch_end(&scratch);
+    return result;
+}
+
+/* Execute a single read command */
+static ExrResult execute_command(ExrDecoder decoder, const ExrChunkPrefetch* prefetch,
+                                 ExrCommandUnion* command) {
+    switch (command->base.type) {
+        case EXR_CMD_TYPE_READ_TILE:
+            return execute_tile_read(decoder, prefetch, &command->tile_read);
+
+        case EXR_CMD_TYPE_READ_SCANLINES:
+            return execute_scanline_read(decoder, prefetch, &command->scanline_read);
+
+        case EXR_CMD_TYPE_READ_FULL_IMAGE:
+            return execute_full_image_read(decoder, prefetch, &command->full_image_read);
+
+        case EXR_CMD_TYPE_READ_DEEP_SCANLINES:
+            return execute_deep_scanline_read(decoder, prefetch, &command->deep_scanline_read);
+
+        case EXR_CMD_TYPE_READ_DEEP_TILES:
+            return execute_deep_tile_read(decoder, prefetch, &command->deep_tile_read);
+
+        default:
+            return EXR_ERROR_INVALID_ARGUMENT;
+    }
+}
+
+/* ============================================================================
+ * Chunk Prefetch
+ *
+ * With EXR_DATA_SOURCE_COALESCE the chunk ranges of every command in a
+ * command buffer are collected up front, merged across gaps of at most
+ * source.coalesce_gap bytes and fetched in one batch. Chunk headers are not
+ * known yet, so each chunk's extent is estimated from the offset of the next
+ * chunk in the table; fetches the spans do not cover go to the source.
+ *
+ * With EXR_DATA_SOURCE_BACKGROUND_IO the spans are instead issued as async
+ * fetches, kept small so the first chunks can decode while later ones are
+ * still being read. Commands block only on the span they need.
+ * ============================================================================ */
+
+/* Chunks larger than this are not prefetched */
+#define EXR_PREFETCH_MAX_CHUNK_SIZE ((uint64_t)64 << 20)
+
+/* Merged spans of background reads stop growing past this size */
+#define EXR_PREFETCH_ASYNC_SPAN_SIZE ((uint64_t)1 << 20)
+
+/* Chunk ranges gathered from a command buffer */
+typedef struct ExrRangeList {
+    ExrContext ctx;
+    ExrFetchRange* ranges;
+    uint32_t count;
+    uint32_t capacity;
+} ExrRangeList;
+
+static ExrResult range_list_add(ExrRangeList* list, uint64_t offset, uint64_t size) {
+    if (list->count == list->capacity) {
+        ExrContext ctx = list->ctx;
+        uint32_t new_capacity = list->capacity ? list->capacity * 2 : 64;
+        ExrFetchRange* ranges = (ExrFetchRange*)ctx->allocator.alloc(
+            ctx->allocator.userdata, new_capacity * sizeof(ExrFetchRange),
+            EXR_DEFAULT_ALIGNMENT);
+        if (!ranges) {
+            return EXR_ERROR_OUT_OF_MEMORY;
+        }
+        if (list->ranges) {
+            memcpy(ranges, list->ranges, list->count * sizeof(ExrFetchRange));
+            ctx->allocator.free(ctx->allocator.userdata, list->ranges,
+                                list->capacity * sizeof(ExrFetchRange));
+        }
+        list->ranges = ranges;
+        list->capacity = new_capacity;
+    }
+
+    list->ranges[list->count].offset = offset;
+    list->ranges[list->count].size = size;
+    list->ranges[list->count].dst = NULL;
+    list->count++;
+    return EXR_SUCCESS;
+}
+
+/* Add the estimated byte range of one chunk. Chunks that cannot be bounded
+ * (random line order, last chunk of an unsized source) are skipped and read
+ * on demand. */
+static ExrResult prefetch_add_chunk(ExrDecoder decoder, ExrRangeList* list,
+                                    ExrPartData* part, uint32_t chunk_index) {
+    uint64_t total_size = decoder->source.total_size;
+    uint64_t offset, end;
+
+    if (chunk_index >= part->num_chunks) {
+        return EXR_SUCCESS;  /* Reported by the command itself */
+    }
+
+    ExrResult result = get_chunk_offset(decoder, part, chunk_index, &offset);
+    if (EXR_FAILED(result)) return result;
+
+    if (chunk_index + 1 < part->num_chunks) {
+        result = get_chunk_offset(decoder, part, chunk_index + 1, &end);
+        if (EXR_FAILED(result)) return result;
+    } else if (decoder->image->num_parts == 1) {
+        end = total_size;
+    } else {
+        return EXR_SUCCESS;
+    }
+
+    if (offset == 0 || end <= offset || end - offset > EXR_PREFETCH_MAX_CHUNK_SIZE ||
+        (total_size > 0 && end > total_size)) {
+        return EXR_SUCCESS;
+    }
+    return range_list_add(list, offset, end - offset);
+}
+
+/* Add the chunks one read command will fetch */
+static ExrResult prefetch_add_command(ExrDecoder decoder, ExrRangeList* list,
+                                      const ExrCommandUnion* command) {
+    ExrImage image = decoder->image;
+    if (!image || command->base.part_index >= image->num_parts) {
+        return EXR_SUCCESS;
+    }
+
+    ExrPartData* part = &image->parts[command->base.part_index];
+    int is_tiled = part->part_type == EXR_PART_TILED ||
+                   part->part_type == EXR_PART_DEEP_TILED;
+    int lines_per_block = get_lines_per_block(part->compression);
+    ExrResult result = EXR_SUCCESS;
+
+    switch (command->base.type) {
+        case EXR_CMD_TYPE_READ_TILE: {
+            const ExrTileReadCmd* cmd = &command->tile_read;
+            if (!is_tiled) break;
+            result = prefetch_add_chunk(decoder, list, part,
+                                        calc_tile_index(part, cmd->tile_x, cmd->tile_y,
+                                                        cmd->level_x, cmd->level_y));
+            break;
         }
 
-        /* Reorder bytes: interleave first half and second half */
-        const uint8_t* t1 = temp_buf;
-        const uint8_t* t2 = temp_buf + (data_size + 1) / 2;
-        uint8_t* dst = sample_data;
-        uint8_t* dst_stop = dst + data_size;
+        case EXR_CMD_TYPE_READ_SCANLINES: {
+            const ExrScanlineReadCmd* cmd = &command->scanline_read;
+            int start_chunk, end_chunk;
+            calc_scanline_chunk_range(part, cmd->y_start, cmd->num_lines,
+                                      &start_chunk, &end_chunk);
+            for (int i = start_chunk; i < end_chunk && EXR_SUCCEEDED(result); i++) {
+                result = prefetch_add_chunk(decoder, list, part, (uint32_t)i);
+            }
+            break;
+        }
+
+        case EXR_CMD_TYPE_READ_FULL_IMAGE: {
+            uint32_t num_chunks;
+            if (part->part_type == EXR_PART_TILED) {
+                /* Level 0 tiles come first in the offset table */
+                int level_width, level_height, num_x_tiles, num_y_tiles;
+                calc_level_size(part, 0, 0, &level_width, &level_height,
+                                &num_x_tiles, &num_y_tiles);
+                num_chunks = (uint32_t)(num_x_tiles * num_y_tiles);
+            } else if (part->part_type == EXR_PART_SCANLINE) {
+                int start_chunk, end_chunk;
+                calc_scanline_chunk_range(part, 0, part->height, &start_chunk, &end_chunk);
+                num_chunks = (uint32_t)end_chunk;
+            } else {
+                break;
+            }
+            for (uint32_t i = 0; i < num_chunks && EXR_SUCCEEDED(result); i++) {
+                result = prefetch_add_chunk(decoder, list, part, i);
+            }
+            break;
+        }
+
+        case EXR_CMD_TYPE_READ_DEEP_SCANLINES: {
+            const ExrDeepScanlineReadCmd* cmd = &command->deep_scanline_read;
+            int block_index = (cmd->y_start - image->data_window.min_y) / lines_per_block;
+            if (block_index < 0) break;
+            result = prefetch_add_chunk(decoder, list, part, (uint32_t)block_index);
+            break;
+        }
+
+        case EXR_CMD_TYPE_READ_DEEP_TILES: {
+            const ExrDeepTileReadCmd* cmd = &command->deep_tile_read;
+            if (part->part_type != EXR_PART_DEEP_TILED) break;
+            result = prefetch_add_chunk(decoder, list, part,
+                                        calc_tile_index(part, cmd->tile_x, cmd->tile_y,
+                                                        cmd->level_x, cmd->level_y));
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    return result;
+}
+
+static int compare_fetch_ranges(const void* a, const void* b) {
+    uint64_t offset_a = ((const ExrFetchRange*)a)->offset;
+    uint64_t offset_b = ((const ExrFetchRange*)b)->offset;
+    return (offset_a > offset_b) - (offset_a < offset_b);
+}
+
+/* Completion of a background span read; runs on a data source thread */
+static void prefetch_span_complete(void* userdata, ExrResult result, size_t bytes_read) {
+    ExrPrefetchSpan* span = (ExrPrefetchSpan*)userdata;
+    ExrChunkPrefetch* prefetch = span->owner;
 
-        while (dst < dst_stop) {
-            if (dst < dst_stop) *dst++ = *t1++;
-            if (dst < dst_stop) *dst++ = *t2++;
-        }
+    if (EXR_SUCCEEDED(result) && (uint64_t)bytes_read < span->size) {
+        result = EXR_ERROR_IO;
     }
 
-    ctx->allocator.free(ctx->allocator.userdata, temp_buf, data_size);
+    exr_mutex_lock(&prefetch->lock);
+    span->status = EXR_SUCCEEDED(result) ? EXR_SUCCESS : result;
+    prefetch->pending--;
+    exr_cond_broadcast(&prefetch->ready);
+    exr_mutex_unlock(&prefetch->lock);
+}
 
-    if (!decomp_ok) {
-        ctx->allocator.free(ctx->allocator.userdata, sample_data, data_size);
-        return EXR_ERROR_DECOMPRESSION_FAILED;
+/* Wait until a span's bytes are in; EXR_SUCCESS when they can be used */
+static ExrResult prefetch_wait_span(const ExrChunkPrefetch* prefetch,
+                                    const ExrPrefetchSpan* span) {
+    if (!prefetch->async) {
+        return EXR_SUCCESS;
     }
 
-    /* Calculate sample size (bytes per sample across all channels) */
-    int sample_size = 0;
-    for (uint32_t c = 0; c < part->num_channels; c++) {
-        sample_size += (int)get_bytes_per_pixel(part->channels[c].pixel_type);
-    }
-    if (sample_size <= 0) {
-        ctx->allocator.free(ctx->allocator.userdata, sample_data, (size_t)unpacked_sample_data_size);
-        return EXR_ERROR_INVALID_DATA;
+    /* The lock and condition are the only mutable parts of a shared prefetch */
+    ExrChunkPrefetch* shared = (ExrChunkPrefetch*)prefetch;
+    exr_mutex_lock(&shared->lock);
+    while (span->status == EXR_WOULD_BLOCK) {
+        exr_cond_wait(&shared->ready, &shared->lock);
     }
+    ExrResult status = span->status;
+    exr_mutex_unlock(&shared->lock);
+    return status;
+}
 
-    uint64_t total_samples = sample_info->total_samples;
+static void prefetch_release(ExrContext ctx, ExrChunkPrefetch* prefetch) {
+    if (prefetch->async) {
+        /* Reads still in flight write into the buffer */
+        exr_mutex_lock(&prefetch->lock);
+        while (prefetch->pending > 0) {
+            exr_cond_wait(&prefetch->ready, &prefetch->lock);
+        }
+        exr_mutex_unlock(&prefetch->lock);
+        exr_cond_destroy(&prefetch->ready);
+        exr_mutex_destroy(&prefetch->lock);
+    }
+    if (prefetch->buffer) {
+        ctx->allocator.free(ctx->allocator.userdata, prefetch->buffer,
+                            prefetch->buffer_size);
+    }
+    if (prefetch->spans) {
+        ctx->allocator.free(ctx->allocator.userdata, prefetch->spans,
+                            prefetch->num_spans * sizeof(ExrPrefetchSpan));
+    }
+    memset(prefetch, 0, sizeof(*prefetch));
+}
 
-    /* Calculate output size requirements */
-    size_t bytes_per_output_sample = get_bytes_per_pixel(cmd->output_pixel_type);
-    size_t required_output = total_samples * part->num_channels * bytes_per_output_sample;
+/* Fetch the merged chunk ranges of a command buffer. Prefetching only saves
+ * round trips, so on any failure the prefetch is left empty and the commands
+ * fetch (and report errors) on their own. */
+static void prefetch_chunks(ExrDecoder decoder, ExrCommandBuffer cmd,
+                            ExrChunkPrefetch* prefetch) {
+    ExrContext ctx = decoder->ctx;
+    ExrDataSource* src = &decoder->source;
+    ExrResult result = EXR_SUCCESS;
 
-    if (cmd->output_size < required_output) {
-        ctx->allocator.free(ctx->allocator.userdata, sample_data, (size_t)unpacked_sample_data_size);
-        exr_context_add_error(ctx, EXR_ERROR_BUFFER_TOO_SMALL,
-                              "Output buffer too small for deep tile sample data", NULL, 0);
-        return EXR_ERROR_BUFFER_TOO_SMALL;
+    memset(prefetch, 0, sizeof(*prefetch));
+    if (!(src->flags & (EXR_DATA_SOURCE_COALESCE | EXR_DATA_SOURCE_BACKGROUND_IO))) {
+        return;
     }
 
-    /* Convert from channel-planar to interleaved output format */
-    uint8_t* output = (uint8_t*)cmd->output;
-    size_t channel_data_offset = 0;
-
-    for (uint32_t c = 0; c < part->num_channels; c++) {
-        uint32_t src_pixel_type = part->channels[c].pixel_type;
-        size_t src_bytes = get_bytes_per_pixel(src_pixel_type);
-        const uint8_t* src = sample_data + channel_data_offset;
+    int async = (src->flags & EXR_DATA_SOURCE_BACKGROUND_IO) != 0;
+    uint64_t gap = (src->flags & EXR_DATA_SOURCE_COALESCE) ? src->coalesce_gap : 0;
+
+    ExrRangeList list;
+    list.ctx = ctx;
+    list.ranges = NULL;
+    list.count = 0;
+    list.capacity = 0;
+
+    for (uint32_t i = 0; i < cmd->command_count && EXR_SUCCEEDED(result); i++) {
+        result = prefetch_add_command(decoder, &list, &cmd->commands[i]);
+    }
+
+    if (EXR_SUCCEEDED(result) && list.count > 0) {
+        qsort(list.ranges, list.count, sizeof(ExrFetchRange), compare_fetch_ranges);
+
+        /* Merge in place: overlapping ranges and ranges separated by at most
+         * coalesce_gap bytes become one (up to a size cap for async reads) */
+        uint32_t num_spans = 0;
+        uint64_t total = 0;
+        for (uint32_t i = 0; i < list.count; i++) {
+            const ExrFetchRange* range = &list.ranges[i];
+            if (num_spans > 0) {
+                ExrFetchRange* last = &list.ranges[num_spans - 1];
+                uint64_t last_end = last->offset + last->size;
+                if (range->offset < last_end ||
+                    (range->offset - last_end <= gap &&
+                     (!async || last->size < EXR_PREFETCH_ASYNC_SPAN_SIZE))) {
+                    uint64_t end = range->offset + range->size;
+                    if (end > last_end) {
+                        total += end - last_end;
+                        last->size = end - last->offset;
+                    }
+                    continue;
+                }
+            }
+            list.ranges[num_spans++] = *range;
+            total += range->size;
+        }
 
-        /* Copy each sample for this channel */
-        for (uint64_t s = 0; s < total_samples; s++) {
-            /* Output offset: sample * num_channels + channel_index */
-            size_t dst_offset = (s * part->num_channels + c) * bytes_per_output_sample;
-            uint8_t* dst_ptr = output + dst_offset;
-
-            /* Convert pixel type */
-            float val = 0.0f;
-            if (src_pixel_type == EXR_PIXEL_UINT) {
-                uint32_t ui;
-                memcpy(&ui, src + s * src_bytes, 4);
-                val = (float)ui;
-            } else if (src_pixel_type == EXR_PIXEL_HALF) {
-                uint16_t h;
-                memcpy(&h, src + s * src_bytes, 2);
-                val = half_to_float_single(h);
-            } else if (src_pixel_type == EXR_PIXEL_FLOAT) {
-                memcpy(&val, src + s * src_bytes, 4);
+        if (total <= (uint64_t)SIZE_MAX) {
+            prefetch->buffer = (uint8_t*)ctx->allocator.alloc(
+                ctx->allocator.userdata, (size_t)total, EXR_DEFAULT_ALIGNMENT);
+            prefetch->spans = (ExrPrefetchSpan*)ctx->allocator.alloc(
+                ctx->allocator.userdata, num_spans * sizeof(ExrPrefetchSpan),
+                EXR_DEFAULT_ALIGNMENT);
+        }
+        prefetch->buffer_size = (size_t)total;
+        prefetch->num_spans = num_spans;
+
+        if (prefetch->buffer && prefetch->spans) {
+            uint8_t* dst = prefetch->buffer;
+            for (uint32_t i = 0; i < num_spans; i++) {
+                list.ranges[i].dst = dst;
+                prefetch->spans[i].offset = list.ranges[i].offset;
+                prefetch->spans[i].size = list.ranges[i].size;
+                prefetch->spans[i].data = dst;
+                prefetch->spans[i].status = EXR_WOULD_BLOCK;
+                prefetch->spans[i].owner = prefetch;
+                dst += list.ranges[i].size;
             }
 
-            /* Write to output in requested format */
-            if (cmd->output_pixel_type == EXR_PIXEL_FLOAT) {
-                memcpy(dst_ptr, &val, 4);
-            } else if (cmd->output_pixel_type == EXR_PIXEL_HALF) {
-                uint16_t h = float_to_half_single(val);
-                memcpy(dst_ptr, &h, 2);
-            } else if (cmd->output_pixel_type == EXR_PIXEL_UINT) {
-                uint32_t ui = (uint32_t)val;
-                memcpy(dst_ptr, &ui, 4);
+            if (async) {
+                /* Issue every span up front; a span whose read cannot be
+                 * started is marked failed and its chunks fetch on demand */
+                exr_mutex_init(&prefetch->lock);
+                exr_cond_init(&prefetch->ready);
+                prefetch->async = 1;
+                for (uint32_t i = 0; i < num_spans; i++) {
+                    ExrPrefetchSpan* span = &prefetch->spans[i];
+                    exr_mutex_lock(&prefetch->lock);
+                    prefetch->pending++;
+                    exr_mutex_unlock(&prefetch->lock);
+
+                    ExrResult issued = src->fetch(src->userdata, span->offset, span->size,
+                                                  span->data, prefetch_span_complete, span);
+                    if (issued != EXR_WOULD_BLOCK) {
+                        prefetch_span_complete(span, issued, EXR_SUCCEEDED(issued) ?
+                                               (size_t)span->size : 0);
+                    }
+                }
+            } else if (src->fetch_batch) {
+                if (src->flags & EXR_DATA_SOURCE_CONCURRENT) {
+                    result = src->fetch_batch(src->userdata, list.ranges, num_spans);
+                } else {
+                    exr_mutex_lock(&decoder->fetch_lock);
+                    result = src->fetch_batch(src->userdata, list.ranges, num_spans);
+                    exr_mutex_unlock(&decoder->fetch_lock);
+                }
+            } else {
+                for (uint32_t i = 0; i < num_spans && EXR_SUCCEEDED(result); i++) {
+                    result = sync_fetch(decoder, list.ranges[i].offset,
+                                        list.ranges[i].size, list.ranges[i].dst);
+                }
             }
+        } else {
+            result = EXR_ERROR_OUT_OF_MEMORY;
         }
+    }
 
-        channel_data_offset += total_samples * src_bytes;
+    if (EXR_FAILED(result)) {
+        prefetch_release(ctx, prefetch);
+    }
+    if (list.ranges) {
+        ctx->allocator.free(ctx->allocator.userdata, list.ranges,
+                            list.capacity * sizeof(ExrFetchRange));
     }
+}
 
-    ctx->allocator.free(ctx->allocator.userdata, sample_data, data_size);
-    return EXR_SUCCESS;
+/* Shared state for executing the commands of one buffer in parallel */
+typedef struct ExrCommandBatchJob {
+    ExrDecoder decoder;
+    ExrCommandBuffer cmd;
+    const ExrChunkPrefetch* prefetch;
+    ATOMIC_INT result;
+} ExrCommandBatchJob;
+
+static void command_batch_task(void* userdata, uint32_t index) {
+    ExrCommandBatchJob* job = (ExrCommandBatchJob*)userdata;
+    if (ATOMIC_LOAD(job->result) < 0) return;  /* Another command failed */
+
+    ExrResult result = execute_command(job->decoder, job->prefetch,
+                                       &job->cmd->commands[index]);
+    if (EXR_FAILED(result)) {
+        ATOMIC_STORE(job->result, result);
+    }
 }
 
-/* Execute all commands in a command buffer */
+/* Execute all commands in a command buffer. Read commands write disjoint
+ * outputs, so they run concurrently; each command may fan out further into
+ * its chunks on the same pool. */
 static ExrResult execute_commands(ExrDecoder decoder, ExrCommandBuffer cmd) {
-    ExrResult result = EXR_SUCCESS;
+    ExrChunkPrefetch prefetch;
+    prefetch_chunks(decoder, cmd, &prefetch);
 
-    for (uint32_t i = 0; i < cmd->command_count; i++) {
-        ExrCommandUnion* command = &cmd->commands[i];
+    ExrCommandBatchJob job;
+    job.decoder = decoder;
+    job.cmd = cmd;
+    job.prefetch = &prefetch;
+    ATOMIC_INIT(job.result, EXR_SUCCESS);
 
-        switch (command->base.type) {
-            case EXR_CMD_TYPE_READ_TILE:
-                result = execute_tile_read(decoder, &command->tile_read);
-                break;
-
-            case EXR_CMD_TYPE_READ_SCANLINES:
-                result = execute_scanline_read(decoder, &command->scanline_read);
-                break;
+    exr_parallel_for(exr_context_get_thread_pool(decoder->ctx),
+                     cmd->command_count, command_batch_task, &job);
 
-            case EXR_CMD_TYPE_READ_FULL_IMAGE:
-                result = execute_full_image_read(decoder, &command->full_image_read);
-                break;
+    prefetch_release(decoder->ctx, &prefetch);
+    return (ExrResult)ATOMIC_LOAD(job.result);
+}
 
-            case EXR_CMD_TYPE_READ_DEEP_SCANLINES:
-                result = execute_deep_scanline_read(decoder, &command->deep_scanline_read);
-                break;
+/* ============================================================================
+ * Submit Function
+ * ============================================================================ */
 
-            case EXR_CMD_TYPE_READ_DEEP_TILES:
-                result = execute_deep_tile_read(decoder, &command->deep_tile_read);
-                break;
+/* Run every command buffer of a submit in order */
+static ExrResult submit_execute(ExrDecoder decoder, const ExrCommandBuffer* command_buffers,
+                                uint32_t command_buffer_count) {
+    /* Build lazily-initialized tables before workers can race on them */
+    init_half_tables();
 
-            default:
-                result = EXR_ERROR_INVALID_ARGUMENT;
-                break;
-        }
+    /* Scratch arenas start each submit folded to the previous peak */
+    if (decoder->scratch_pool) {
+        exr_memory_pool_reset(decoder->scratch_pool);
+    }
 
+    for (uint32_t i = 0; i < command_buffer_count; i++) {
+        ExrResult result = execute_commands(decoder, command_buffers[i]);
         if (EXR_FAILED(result)) {
             return result;
         }
     }
-
     return EXR_SUCCESS;
 }
 
-/* ============================================================================
- * Submit Function
- * ============================================================================ */
+/* An EXR_SUBMIT_ASYNC submit in flight; the command buffer handles are
+ * copied right after the struct since the caller's array may be transient */
+typedef struct ExrAsyncSubmit {
+    ExrDecoder decoder;
+    uint32_t command_buffer_count;
+    ExrFence signal_fence;
+    ExrSubmitComplete on_complete;
+    void* userdata;
+} ExrAsyncSubmit;
+
+static size_t async_submit_size(uint32_t command_buffer_count) {
+    return EXR_ALIGN(sizeof(ExrAsyncSubmit), sizeof(void*)) +
+           command_buffer_count * sizeof(ExrCommandBuffer);
+}
+
+static ExrCommandBuffer* async_submit_buffers(ExrAsyncSubmit* submit) {
+    return (ExrCommandBuffer*)((uint8_t*)submit +
+                               EXR_ALIGN(sizeof(ExrAsyncSubmit), sizeof(void*)));
+}
+
+/* Worker entry point for an async submit */
+static void async_submit_task(void* userdata, uint32_t index) {
+    ExrAsyncSubmit* submit = (ExrAsyncSubmit*)userdata;
+    ExrDecoder decoder = submit->decoder;
+    ExrContext ctx = decoder->ctx;
+    (void)index;
+
+    ExrResult result = submit_execute(decoder, async_submit_buffers(submit),
+                                      submit->command_buffer_count);
+
+    ExrFence signal_fence = submit->signal_fence;
+    ExrSubmitComplete on_complete = submit->on_complete;
+    void* complete_userdata = submit->userdata;
+    ctx->allocator.free(ctx->allocator.userdata, submit,
+                        async_submit_size(submit->command_buffer_count));
+
+    /* Leave the pending count before running user code, so on_complete may
+     * wait on or destroy the decoder. The decoder may be gone after this. */
+    exr_mutex_lock(&decoder->submit_lock);
+    if (--decoder->pending_submits == 0) {
+        exr_cond_broadcast(&decoder->idle_cond);
+    }
+    exr_mutex_unlock(&decoder->submit_lock);
+
+    if (on_complete) {
+        on_complete(complete_userdata, result);
+    }
+    if (signal_fence) {
+        /* Always signal so waiters wake up; the fence carries the result */
+        exr_fence_signal(signal_fence, result);
+    }
+}
 
 ExrResult exr_submit(ExrDecoder decoder, const ExrSubmitInfo* submit_info) {
     if (!exr_decoder_is_valid(decoder)) {
@@ -4206,9 +5971,7 @@ ExrResult exr_submit(ExrDecoder decoder, const ExrSubmitInfo* submit_info) {
         return EXR_ERROR_INVALID_STATE;
     }
 
-    ExrResult result = EXR_SUCCESS;
-
-    /* Execute all command buffers */
+    /* Validate all command buffers before running any of them */
     for (uint32_t i = 0; i < submit_info->command_buffer_count; i++) {
         ExrCommandBuffer cmd = submit_info->command_buffers[i];
         if (!exr_command_buffer_is_valid(cmd)) {
@@ -4217,19 +5980,61 @@ ExrResult exr_submit(ExrDecoder decoder, const ExrSubmitInfo* submit_info) {
         if (cmd->recording) {
             return EXR_ERROR_INVALID_STATE;  /* Can't submit recording buffer */
         }
+    }
 
-        result = execute_commands(decoder, cmd);
-        if (EXR_FAILED(result)) {
-            break;
+    if (submit_info->flags & EXR_SUBMIT_ASYNC) {
+        ExrContext ctx = decoder->ctx;
+        ExrThreadPool* pool = exr_context_get_thread_pool(ctx);
+
+        /* Without workers, fall through and complete synchronously */
+        if (pool) {
+            uint32_t count = submit_info->command_buffer_count;
+            ExrAsyncSubmit* submit = (ExrAsyncSubmit*)ctx->allocator.alloc(
+                ctx->allocator.userdata, async_submit_size(count), EXR_DEFAULT_ALIGNMENT);
+            if (!submit) {
+                return EXR_ERROR_OUT_OF_MEMORY;
+            }
+            submit->decoder = decoder;
+            submit->command_buffer_count = count;
+            submit->signal_fence = submit_info->signal_fence;
+            submit->on_complete = submit_info->on_complete;
+            submit->userdata = submit_info->userdata;
+            if (count > 0) {
+                memcpy(async_submit_buffers(submit), submit_info->command_buffers,
+                       count * sizeof(ExrCommandBuffer));
+            }
+
+            exr_mutex_lock(&decoder->submit_lock);
+            decoder->pending_submits++;
+            exr_mutex_unlock(&decoder->submit_lock);
+
+            ExrResult result = exr_thread_pool_enqueue(pool, async_submit_task, submit);
+            if (EXR_FAILED(result)) {
+                exr_mutex_lock(&decoder->submit_lock);
+                decoder->pending_submits--;
+                exr_mutex_unlock(&decoder->submit_lock);
+                ctx->allocator.free(ctx->allocator.userdata, submit,
+                                    async_submit_size(count));
+                return result;
+            }
+            return EXR_SUCCESS;
         }
     }
 
-    /* Signal fence if provided */
+    ExrResult result = submit_execute(decoder, submit_info->command_buffers,
+                                      submit_info->command_buffer_count);
+
+    if (submit_info->on_complete) {
+        submit_info->on_complete(submit_info->userdata, result);
+    }
+
+    /* Signal fence if provided. Async submits completed here signal
+     * whatever the outcome, as they would on a worker. */
     if (submit_info->signal_fence) {
-        if (EXR_FAILED(result)) {
+        if (EXR_FAILED(result) && !(submit_info->flags & EXR_SUBMIT_ASYNC)) {
             /* Don't signal on failure */
         } else {
-            exr_fence_signal(submit_info->signal_fence);
+            exr_fence_signal(submit_info->signal_fence, result);
         }
     }
 
@@ -4511,10 +6316,133 @@ static size_t read_string(const uint8_t* data, size_t size, char* out, size_t ma
     return 0;  /* Not found or truncated */
 }
 
-/* Synchronous fetch helper - fetches data synchronously from the data source */
+/* Synchronous fetch helper - fetches data synchronously from the data source.
+ * May be called from pool workers; fetches are serialized unless the source
+ * declares itself safe for concurrent use. */
 static ExrResult sync_fetch(ExrDecoder decoder, uint64_t offset, uint64_t size, void* dst) {
     ExrDataSource* src = &decoder->source;
-    return src->fetch(src->userdata, offset, size, dst, NULL, NULL);
+    if (src->flags & EXR_DATA_SOURCE_CONCURRENT) {
+        return src->fetch(src->userdata, offset, size, dst, NULL, NULL);
+    }
+    exr_mutex_lock(&decoder->fetch_lock);
+    ExrResult result = src->fetch(src->userdata, offset, size, dst, NULL, NULL);
+    exr_mutex_unlock(&decoder->fetch_lock);
+    return result;
+}
+
+/* Prefetched span holding [offset, offset + size), or NULL */
+static const ExrPrefetchSpan* find_prefetch_span(const ExrChunkPrefetch* prefetch,
+                                                 uint64_t offset, uint64_t size) {
+    if (!prefetch || prefetch->num_spans == 0) {
+        return NULL;
+    }
+
+    /* Last span starting at or before offset */
+    uint32_t lo = 0, hi = prefetch->num_spans;
+    while (hi - lo > 1) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (prefetch->spans[mid].offset <= offset) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+
+    const ExrPrefetchSpan* span = &prefetch->spans[lo];
+    if (span->offset <= offset && offset - span->offset <= span->size &&
+        size <= span->size - (offset - span->offset)) {
+        return span;
+    }
+    return NULL;
+}
+
+/* Fetch part of a chunk, copying from the submit's prefetched spans when they
+ * cover the range and falling back to the data source otherwise */
+static ExrResult chunk_fetch(ExrDecoder decoder, const ExrScratch* scratch,
+                             uint64_t offset, uint64_t size, void* dst) {
+    const ExrPrefetchSpan* span = find_prefetch_span(scratch->prefetch, offset, size);
+    if (span && EXR_SUCCEEDED(prefetch_wait_span(scratch->prefetch, span))) {
+        memcpy(dst, span->data + (offset - span->offset), (size_t)size);
+        return EXR_SUCCESS;
+    }
+    return sync_fetch(decoder, offset, size, dst);
+}
+
+/* Access part of a chunk without copying when possible: in place from a
+ * mapped source or the prefetched spans, else fetched into scratch. *out_copy
+ * receives the scratch buffer to free, NULL when the bytes are borrowed. */
+static ExrResult chunk_view(ExrDecoder decoder, ExrScratch* scratch,
+                            uint64_t offset, uint64_t size,
+                            const uint8_t** out_data, uint8_t** out_copy) {
+    const ExrDataSource* src = &decoder->source;
+    *out_copy = NULL;
+
+    if (src->map) {
+        const void* mapped = src->map(src->userdata, offset, size);
+        if (mapped) {
+            *out_data = (const uint8_t*)mapped;
+            return EXR_SUCCESS;
+        }
+    }
+
+    const ExrPrefetchSpan* span = find_prefetch_span(scratch->prefetch, offset, size);
+    if (span && EXR_SUCCEEDED(prefetch_wait_span(scratch->prefetch, span))) {
+        *out_data = span->data + (offset - span->offset);
+        return EXR_SUCCESS;
+    }
+
+    uint8_t* copy = (uint8_t*)exr_scratch_alloc(scratch, (size_t)size);
+    if (!copy) {
+        return EXR_ERROR_OUT_OF_MEMORY;
+    }
+    ExrResult result = sync_fetch(decoder, offset, size, copy);
+    if (EXR_FAILED(result)) {
+        exr_scratch_free(scratch, copy, (size_t)size);
+        return result;
+    }
+    *out_data = copy;
+    *out_copy = copy;
+    return EXR_SUCCESS;
+}
+
+/* Look up a chunk's file offset, fetching its offset table page first if
+ * the table is loaded lazily */
+static ExrResult get_chunk_offset(ExrDecoder decoder, ExrPartData* part,
+                                  uint32_t chunk_index, uint64_t* out_offset) {
+    if (chunk_index >= part->num_chunks) {
+        return EXR_ERROR_OUT_OF_BOUNDS;
+    }
+
+    if (part->offset_pages_loaded) {
+        uint32_t page = chunk_index / EXR_OFFSET_PAGE_SIZE;
+        ExrResult result = EXR_SUCCESS;
+
+        exr_mutex_lock(&decoder->offsets_lock);
+        if (!part->offset_pages_loaded[page]) {
+            uint32_t first = page * EXR_OFFSET_PAGE_SIZE;
+            uint32_t count = part->num_chunks - first;
+            if (count > EXR_OFFSET_PAGE_SIZE) count = EXR_OFFSET_PAGE_SIZE;
+
+            result = sync_fetch(decoder, part->offset_table_pos + (uint64_t)first * 8,
+                                (uint64_t)count * 8, &part->offsets[first]);
+            if (EXR_SUCCEEDED(result)) {
+                for (uint32_t i = first; i < first + count; i++) {
+                    part->offsets[i] = read_le_u64((const uint8_t*)&part->offsets[i]);
+                }
+                part->offset_pages_loaded[page] = 1;
+            }
+        }
+        exr_mutex_unlock(&decoder->offsets_lock);
+
+        if (EXR_FAILED(result)) {
+            exr_context_add_error(decoder->ctx, result, "Failed to read offset table",
+                                  "offsets", part->offset_table_pos);
+            return result;
+        }
+    }
+
+    *out_offset = part->offsets[chunk_index];
+    return EXR_SUCCESS;
 }
 
 /* Callback for async fetch completion */
@@ -4854,8 +6782,16 @@ static ExrResult parse_attribute(ExrDecoder decoder, ExrPartData* part,
     }
 
     /* Read attribute value */
-    uint8_t* attr_data = buf + header_size;
-    if (header_size + attr_size > sizeof(buf)) {
+    const uint8_t* attr_data = buf + header_size;
+    const void* mapped = NULL;
+    if (header_size + attr_size > sizeof(buf) && decoder->source.map) {
+        mapped = decoder->source.map(decoder->source.userdata,
+                                     *offset + header_size, attr_size);
+    }
+    if (mapped) {
+        /* Large value resident in a mapped source: parse it in place */
+        attr_data = (const uint8_t*)mapped;
+    } else if (header_size + attr_size > sizeof(buf)) {
         /* Need to allocate larger buffer */
         result = ensure_read_buffer(decoder, attr_size);
         if (EXR_FAILED(result)) return result;
@@ -5160,12 +7096,26 @@ static ExrResult parse_offset_table(ExrDecoder decoder, ExrPartData* part, uint6
 
     /* SUSPEND POINT: Read offset table */
     size_t table_size = part->num_chunks * sizeof(uint64_t);
+    part->offset_table_pos = *offset;
     part->offsets = (uint64_t*)ctx->allocator.alloc(
         ctx->allocator.userdata, table_size, EXR_DEFAULT_ALIGNMENT);
     if (!part->offsets) {
         return EXR_ERROR_OUT_OF_MEMORY;
     }
 
+    if (decoder->flags & EXR_DECODER_LAZY_LOAD) {
+        /* Only note where the table lives; get_chunk_offset fetches pages */
+        size_t num_pages = EXR_OFFSET_PAGE_COUNT(part->num_chunks);
+        part->offset_pages_loaded = (uint8_t*)ctx->allocator.alloc(
+            ctx->allocator.userdata, num_pages, EXR_DEFAULT_ALIGNMENT);
+        if (!part->offset_pages_loaded) {
+            return EXR_ERROR_OUT_OF_MEMORY;
+        }
+        memset(part->offset_pages_loaded, 0, num_pages);
+        *offset += table_size;
+        return EXR_SUCCESS;
+    }
+
     result = unified_fetch(decoder, *offset, table_size, part->offsets, EXR_PHASE_OFFSET_TABLE);
     if (result == EXR_WOULD_BLOCK) return EXR_WOULD_BLOCK;
     if (EXR_FAILED(result)) {
@@ -5353,7 +7303,12 @@ ExrResult exr_decoder_wait_idle(ExrDecoder decoder) {
     if (!exr_decoder_is_valid(decoder)) {
         return EXR_ERROR_INVALID_HANDLE;
     }
-    /* For now, nothing to wait for in stub implementation */
+
+    exr_mutex_lock(&decoder->submit_lock);
+    while (decoder->pending_submits > 0) {
+        exr_cond_wait(&decoder->idle_cond, &decoder->submit_lock);
+    }
+    exr_mutex_unlock(&decoder->submit_lock);
     return EXR_SUCCESS;
 }
 
@@ -5482,7 +7437,11 @@ ExrResult exr_part_get_deep_sample_counts(
         return EXR_ERROR_OUT_OF_BOUNDS;
     }
 
-    uint64_t offset = part_data->offsets[block_index];
+    uint64_t offset;
+    ExrResult result = get_chunk_offset(decoder, part_data, (uint32_t)block_index, &offset);
+    if (EXR_FAILED(result)) {
+        return result;
+    }
 
     /* Read deep chunk header:
      * - int32: y coordinate
@@ -5492,7 +7451,7 @@ ExrResult exr_part_get_deep_sample_counts(
      * Total: 28 bytes
      */
     uint8_t header[28];
-    ExrResult result = sync_fetch(decoder, offset, 28, header);
+    result = sync_fetch(decoder, offset, 28, header);
     if (EXR_FAILED(result)) {
         return result;
     }
@@ -5557,25 +7516,8 @@ ExrResult exr_part_get_deep_sample_counts(
     ctx->allocator.free(ctx->allocator.userdata, compressed_offsets, (size_t)packed_offset_table_size);
 
     if (decomp_ok) {
-        /* Apply predictor: t[i] = t[i-1] + t[i] - 128 */
-        uint8_t* t = temp_buf + 1;
-        uint8_t* stop = temp_buf + offset_table_size;
-        while (t < stop) {
-            int d = (int)t[-1] + (int)t[0] - 128;
-            t[0] = (uint8_t)d;
-            ++t;
-        }
-
-        /* Reorder bytes: interleave first half and second half */
-        const uint8_t* t1 = temp_buf;
-        const uint8_t* t2 = temp_buf + (offset_table_size + 1) / 2;
-        uint8_t* dst = (uint8_t*)pixel_offsets;
-        uint8_t* dst_stop = dst + offset_table_size;
-
-        while (dst < dst_stop) {
-            if (dst < dst_stop) *dst++ = *t1++;
-            if (dst < dst_stop) *dst++ = *t2++;
-        }
+        /* Apply predictor and interleave first half and second half */
+        decode_predictor_and_reorder(temp_buf, (uint8_t*)pixel_offsets, offset_table_size);
     }
 
     ctx->allocator.free(ctx->allocator.userdata, temp_buf, offset_table_size);
@@ -5678,7 +7620,11 @@ ExrResult exr_part_get_deep_tile_sample_counts(
         return EXR_ERROR_OUT_OF_BOUNDS;
     }
 
-    uint64_t offset = part_data->offsets[tile_index];
+    uint64_t offset;
+    ExrResult result = get_chunk_offset(decoder, part_data, tile_index, &offset);
+    if (EXR_FAILED(result)) {
+        return result;
+    }
 
     /* Read deep tile header:
      * - tile_x (4 bytes)
@@ -5691,7 +7637,7 @@ ExrResult exr_part_get_deep_tile_sample_counts(
      * Total: 40 bytes
      */
     uint8_t header[40];
-    ExrResult result = sync_fetch(decoder, offset, 40, header);
+    result = sync_fetch(decoder, offset, 40, header);
     if (EXR_FAILED(result)) {
         return result;
     }
@@ -5776,25 +7722,8 @@ ExrResult exr_part_get_deep_tile_sample_counts(
     ctx->allocator.free(ctx->allocator.userdata, compressed_offsets, (size_t)packed_offset_table_size);
 
     if (decomp_ok) {
-        /* Apply predictor: t[i] = t[i-1] + t[i] - 128 */
-        uint8_t* t = temp_buf + 1;
-        uint8_t* stop = temp_buf + offset_table_size;
-        while (t < stop) {
-            int d = (int)t[-1] + (int)t[0] - 128;
-            t[0] = (uint8_t)d;
-            ++t;
-        }
-
-        /* Reorder bytes: interleave first half and second half */
-        const uint8_t* t1 = temp_buf;
-        const uint8_t* t2 = temp_buf + (offset_table_size + 1) / 2;
-        uint8_t* dst = (uint8_t*)pixel_offsets;
-        uint8_t* dst_stop = dst + offset_table_size;
-
-        while (dst < dst_stop) {
-            if (dst < dst_stop) *dst++ = *t1++;
-            if (dst < dst_stop) *dst++ = *t2++;
-        }
+        /* Apply predictor and interleave first half and second half */
+        decode_predictor_and_reorder(temp_buf, (uint8_t*)pixel_offsets, offset_table_size);
     }
 
     ctx->allocator.free(ctx->allocator.userdata, temp_buf, offset_table_size);
@@ -6092,6 +8021,9 @@ struct ExrEncoder_T {
     uint32_t num_parts;
     int is_multipart;
     int headers_written;
+    /* Offset tables awaiting exr_encoder_finalize (EXR_ENCODER_PARALLEL) */
+    struct ExrWriteImage_T* pending_tables[MAX_MULTIPART_PARTS];
+    uint32_t num_pending_tables;
 };
 
 struct ExrWriteImage_T {
@@ -6238,12 +8170,20 @@ void exr_encoder_destroy(ExrEncoder encoder) {
     ctx->allocator.free(ctx->allocator.userdata, encoder, sizeof(struct ExrEncoder_T));
 }
 
+static ExrResult write_chunk_offset_table(ExrEncoder encoder, ExrWriteImage image);
+
 ExrResult exr_encoder_finalize(ExrEncoder encoder) {
     if (!exr_encoder_is_valid(encoder)) {
         return EXR_ERROR_INVALID_HANDLE;
     }
-    /* For now, nothing special to finalize - all writes are immediate */
-    return EXR_SUCCESS;
+
+    /* Patch offset tables deferred by EXR_ENCODER_PARALLEL submits */
+    ExrResult result = EXR_SUCCESS;
+    for (uint32_t i = 0; i < encoder->num_pending_tables && !EXR_FAILED(result); i++) {
+        result = write_chunk_offset_table(encoder, encoder->pending_tables[i]);
+    }
+    encoder->num_pending_tables = 0;
+    return result;
 }
 
 ExrResult exr_write_image_create(ExrEncoder encoder,
@@ -6329,6 +8269,20 @@ ExrResult exr_write_image_create(ExrEncoder encoder,
         image->part_name[0] = '\0';
     }
 
+    /* DWA quantization level, stored as the standard header attribute */
+    if ((create_info->compression == EXR_COMPRESSION_DWAA ||
+         create_info->compression == EXR_COMPRESSION_DWAB) &&
+        create_info->dwa_compression_level > 0.0f) {
+        ExrResult attr_result = exr_write_image_set_float_attribute(
+            image, "dwaCompressionLevel", create_info->dwa_compression_level);
+        if (attr_result != EXR_SUCCESS) {
+            ctx->allocator.free(ctx->allocator.userdata, image->channels,
+                                create_info->num_channels * sizeof(WriteChannelData));
+            ctx->allocator.free(ctx->allocator.userdata, image, sizeof(struct ExrWriteImage_T));
+            return attr_result;
+        }
+    }
+
     /* Register with encoder for multipart */
     if (create_info->flags & EXR_WRITE_MULTIPART) {
         if (encoder->num_parts >= MAX_MULTIPART_PARTS) {
@@ -6353,7 +8307,16 @@ ExrResult exr_write_image_create(ExrEncoder encoder,
 void exr_write_image_destroy(ExrWriteImage image) {
     if (!exr_write_image_is_valid(image)) return;
 
-    ExrContext ctx = image->encoder->ctx;
+    ExrEncoder encoder = image->encoder;
+    ExrContext ctx = encoder->ctx;
+
+    /* Drop any offset table still waiting for exr_encoder_finalize */
+    for (uint32_t i = 0; i < encoder->num_pending_tables; i++) {
+        if (encoder->pending_tables[i] == image) {
+            encoder->pending_tables[i] = encoder->pending_tables[--encoder->num_pending_tables];
+            break;
+        }
+    }
 
     if (image->channels) {
         ctx->allocator.free(ctx->allocator.userdata, image->channels,
@@ -6644,7 +8607,10 @@ static int get_write_lines_per_block(uint32_t compression) {
         case EXR_COMPRESSION_PIZ:
         case EXR_COMPRESSION_B44:
         case EXR_COMPRESSION_B44A:
+        case EXR_COMPRESSION_DWAA:
             return 32;
+        case EXR_COMPRESSION_DWAB:
+            return 256;
         default:
             return 16;
     }
@@ -6844,10 +8810,38 @@ static void apply_delta_predictor_encode(uint8_t* data, size_t size) {
 #endif
 }
 
+#if defined(TINYEXR_V3_HAS_DEFLATE) || defined(TINYEXR_V3_USE_MINIZ)
+#define TINYEXR_V3_HAS_ZIP_WRITE 1
+
+/* Helper: worst-case zlib stream size for `size` input bytes */
+static size_t zip_compress_bound(size_t size) {
+#if defined(TINYEXR_V3_HAS_DEFLATE)
+    return tinyexr::huffman::deflate_zlib_bound(size);
+#else
+    return (size_t)mz_compressBound((mz_ulong)size);
+#endif
+}
+
+/* Helper: zlib-compress src into dst (at least zip_compress_bound(size)
+   bytes). Returns the compressed size, or 0 on failure. */
+static size_t zip_compress(uint8_t* dst, size_t dst_capacity,
+                           const uint8_t* src, size_t size, int32_t level) {
+#if defined(TINYEXR_V3_HAS_DEFLATE)
+    return tinyexr::huffman::deflate_zlib(src, size, dst, dst_capacity, level);
+#else
+    mz_ulong dst_len = (mz_ulong)dst_capacity;
+    if (mz_compress2(dst, &dst_len, src, (mz_ulong)size, level) != MZ_OK) {
+        return 0;
+    }
+    return (size_t)dst_len;
+#endif
+}
+#endif
+
 /* Helper: compress scanline data */
 static ExrResult compress_scanline_data(ExrContext ctx, const void* input, size_t input_size,
                                          void** output, size_t* output_size,
-                                         uint32_t compression) {
+                                         uint32_t compression, int32_t level) {
     if (compression == EXR_COMPRESSION_NONE) {
         /* No compression - just copy */
         void* copy = ctx->allocator.alloc(ctx->allocator.userdata, input_size, EXR_DEFAULT_ALIGNMENT);
@@ -6879,12 +8873,51 @@ static ExrResult compress_scanline_data(ExrContext ctx, const void* input, size_
             return EXR_ERROR_OUT_OF_MEMORY;
         }
 
-        size_t compressed_size = rle_encode(temp_buf, input_size, compressed, max_compressed);
+        size_t compressed_size = rle_encode(temp_buf, input_size, compressed, max_compressed);
+        ctx->allocator.free(ctx->allocator.userdata, temp_buf, input_size);
+
+        if (compressed_size == 0 || compressed_size >= input_size) {
+            /* Compression didn't help, store uncompressed */
+            ctx->allocator.free(ctx->allocator.userdata, compressed, max_compressed);
+            void* copy = ctx->allocator.alloc(ctx->allocator.userdata, input_size, EXR_DEFAULT_ALIGNMENT);
+            if (!copy) return EXR_ERROR_OUT_OF_MEMORY;
+            memcpy(copy, input, input_size);
+            *output = copy;
+            *output_size = input_size;
+            return EXR_SUCCESS;
+        }
+
+        *output = compressed;
+        *output_size = compressed_size;
+        return EXR_SUCCESS;
+    }
+
+#if defined(TINYEXR_V3_HAS_ZIP_WRITE)
+    if (compression == EXR_COMPRESSION_ZIP || compression == EXR_COMPRESSION_ZIPS) {
+        /* ZIP compression: 1) reorder bytes, 2) apply predictor, 3) deflate */
+        uint8_t* temp_buf = (uint8_t*)ctx->allocator.alloc(ctx->allocator.userdata, input_size, EXR_DEFAULT_ALIGNMENT);
+        if (!temp_buf) return EXR_ERROR_OUT_OF_MEMORY;
+
+        reorder_bytes_for_compression((const uint8_t*)input, temp_buf, input_size);
+        apply_delta_predictor_encode(temp_buf, input_size);
+
+        size_t compressed_bound = zip_compress_bound(input_size);
+        uint8_t* compressed = (uint8_t*)ctx->allocator.alloc(ctx->allocator.userdata, compressed_bound, EXR_DEFAULT_ALIGNMENT);
+        if (!compressed) {
+            ctx->allocator.free(ctx->allocator.userdata, temp_buf, input_size);
+            return EXR_ERROR_OUT_OF_MEMORY;
+        }
+
+        size_t compressed_size = zip_compress(compressed, compressed_bound, temp_buf, input_size, level);
         ctx->allocator.free(ctx->allocator.userdata, temp_buf, input_size);
 
-        if (compressed_size == 0 || compressed_size >= input_size) {
-            /* Compression didn't help, store uncompressed */
-            ctx->allocator.free(ctx->allocator.userdata, compressed, max_compressed);
+        if (compressed_size == 0) {
+            ctx->allocator.free(ctx->allocator.userdata, compressed, compressed_bound);
+            return EXR_ERROR_COMPRESSION_FAILED;
+        }
+        if (compressed_size >= input_size) {
+            /* Compression didn't help, store uncompressed (Issue 40) */
+            ctx->allocator.free(ctx->allocator.userdata, compressed, compressed_bound);
             void* copy = ctx->allocator.alloc(ctx->allocator.userdata, input_size, EXR_DEFAULT_ALIGNMENT);
             if (!copy) return EXR_ERROR_OUT_OF_MEMORY;
             memcpy(copy, input, input_size);
@@ -6897,26 +8930,6 @@ static ExrResult compress_scanline_data(ExrContext ctx, const void* input, size_
         *output_size = compressed_size;
         return EXR_SUCCESS;
     }
-
-#if defined(TINYEXR_V3_USE_MINIZ)
-    if (compression == EXR_COMPRESSION_ZIP || compression == EXR_COMPRESSION_ZIPS) {
-        /* ZIP compression using miniz */
-        mz_ulong compressed_bound = mz_compressBound((mz_ulong)input_size);
-        void* compressed = ctx->allocator.alloc(ctx->allocator.userdata, compressed_bound, EXR_DEFAULT_ALIGNMENT);
-        if (!compressed) return EXR_ERROR_OUT_OF_MEMORY;
-
-        mz_ulong compressed_size = compressed_bound;
-        int mz_result = mz_compress((unsigned char*)compressed, &compressed_size,
-                                     (const unsigned char*)input, (mz_ulong)input_size);
-        if (mz_result != MZ_OK) {
-            ctx->allocator.free(ctx->allocator.userdata, compressed, compressed_bound);
-            return EXR_ERROR_COMPRESSION_FAILED;
-        }
-
-        *output = compressed;
-        *output_size = (size_t)compressed_size;
-        return EXR_SUCCESS;
-    }
 #endif
 
     /* For other compression types, fall back to no compression */
@@ -6928,6 +8941,328 @@ static ExrResult compress_scanline_data(ExrContext ctx, const void* input, size_
     return EXR_SUCCESS;
 }
 
+/* DWAA/DWAB compression of one chunk in the converted EXR layout. (x0, y0)
+   is the chunk's first pixel in data window coordinates. The quantization
+   level is the image's dwaCompressionLevel attribute, so a value set with
+   exr_write_image_set_float_attribute() after creation still applies. */
+static ExrResult compress_dwa_chunk(ExrContext ctx, ExrWriteImage image,
+                                    const uint8_t* input, size_t input_size,
+                                    int x0, int y0, int width, int num_lines,
+                                    void** output, size_t* output_size) {
+#if defined(TINYEXR_V3_HAS_DWA)
+    float level = tinyexr::dwa::DEFAULT_COMPRESSION_LEVEL;
+    for (uint32_t i = 0; i < image->num_custom_attrs; i++) {
+        const WriteCustomAttribute* attr = &image->custom_attrs[i];
+        if (strcmp(attr->name, "dwaCompressionLevel") == 0 &&
+            strcmp(attr->type, "float") == 0 && attr->size == sizeof(float)) {
+            memcpy(&level, attr->data, sizeof(float));
+            break;
+        }
+    }
+    if (!(level >= 0.0f) || !std::isfinite(level)) {
+        level = tinyexr::dwa::DEFAULT_COMPRESSION_LEVEL;
+    }
+
+    size_t info_size = image->num_channels * sizeof(tinyexr::dwa::ChannelInfo);
+    tinyexr::dwa::ChannelInfo* dwa_channels = (tinyexr::dwa::ChannelInfo*)ctx->allocator.alloc(
+        ctx->allocator.userdata, info_size, EXR_DEFAULT_ALIGNMENT);
+    if (!dwa_channels) return EXR_ERROR_OUT_OF_MEMORY;
+
+    for (uint32_t c = 0; c < image->num_channels; c++) {
+        dwa_channels[c].name = image->channels[c].name;
+        dwa_channels[c].pixel_type = (int)image->channels[c].pixel_type;
+        dwa_channels[c].x_sampling = image->channels[c].x_sampling;
+        dwa_channels[c].y_sampling = image->channels[c].y_sampling;
+        dwa_channels[c].p_linear = image->channels[c].p_linear != 0;
+    }
+
+    std::vector<uint8_t> compressed;
+    bool ok = tinyexr::dwa::Compress(input, input_size, dwa_channels, (int)image->num_channels,
+                                     x0, y0, width, num_lines, level,
+                                     image->compression_level, &compressed);
+    ctx->allocator.free(ctx->allocator.userdata, dwa_channels, info_size);
+    if (!ok) return EXR_ERROR_COMPRESSION_FAILED;
+
+    void* out = ctx->allocator.alloc(ctx->allocator.userdata, compressed.size(), EXR_DEFAULT_ALIGNMENT);
+    if (!out) return EXR_ERROR_OUT_OF_MEMORY;
+    memcpy(out, compressed.data(), compressed.size());
+    *output = out;
+    *output_size = compressed.size();
+    return EXR_SUCCESS;
+#else
+    /* DWA needs the C++ codec */
+    (void)ctx; (void)image; (void)input; (void)input_size; (void)x0; (void)y0;
+    (void)width; (void)num_lines; (void)output; (void)output_size;
+    return EXR_ERROR_UNSUPPORTED_FORMAT;
+#endif
+}
+
+/* ============================================================================
+ * Chunk Encoding
+ * ============================================================================ */
+
+/* Shared state for encoding a window of regular (non-deep) tiles or
+ * scanline blocks. Each chunk is converted and compressed into its own
+ * buffer; the caller writes the buffers to the sink in chunk order. */
+typedef struct ExrChunkEncodeJob {
+    ExrContext ctx;
+    ExrWriteImage image;
+    const ExrSubmitInfo* submit_info;
+    int num_x_tiles;              /* 0 for scanline images */
+    int lines_per_block;
+    size_t total_bytes_per_pixel;
+    int first_chunk;
+    void** chunks;                /* [window] compressed chunk data */
+    size_t* chunk_sizes;          /* [window] compressed chunk sizes */
+    ATOMIC_INT result;
+} ExrChunkEncodeJob;
+
+/* Convert and compress a single tile (tiled images) or scanline block */
+static ExrResult encode_write_chunk(const ExrChunkEncodeJob* job, int chunk,
+                                     void** out_data, size_t* out_size) {
+    ExrContext ctx = job->ctx;
+    ExrWriteImage write_image = job->image;
+    const ExrSubmitInfo* submit_info = job->submit_info;
+    const void* input_data = NULL;
+    uint32_t input_layout = EXR_LAYOUT_INTERLEAVED;
+    uint32_t input_pixel_type = EXR_PIXEL_FLOAT;
+    int chunk_width, chunk_height;
+    int chunk_x0, chunk_y0;  /* First pixel, in data window coordinates */
+
+    if (job->num_x_tiles > 0) {
+        int tx = chunk % job->num_x_tiles;
+        int ty = chunk / job->num_x_tiles;
+        int tile_px_x = tx * write_image->tile_size_x;
+        int tile_px_y = ty * write_image->tile_size_y;
+        chunk_x0 = write_image->data_window.min_x + tile_px_x;
+        chunk_y0 = write_image->data_window.min_y + tile_px_y;
+        chunk_width = write_image->tile_size_x;
+        chunk_height = write_image->tile_size_y;
+
+        /* Clamp to image bounds */
+        if (tile_px_x + chunk_width > write_image->width) {
+            chunk_width = write_image->width - tile_px_x;
+        }
+        if (tile_px_y + chunk_height > write_image->height) {
+            chunk_height = write_image->height - tile_px_y;
+        }
+
+        /* Find write command for this tile */
+        for (uint32_t i = 0; i < submit_info->command_buffer_count && !input_data; i++) {
+            ExrCommandBuffer cmd = submit_info->command_buffers[i];
+            if (!exr_command_buffer_is_valid(cmd)) continue;
+
+            for (uint32_t j = 0; j < cmd->command_count; j++) {
+                if (cmd->commands[j].base.type == EXR_CMD_TYPE_WRITE_TILE) {
+                    ExrTileWriteCmd* write_cmd = &cmd->commands[j].tile_write;
+                    if (write_cmd->tile_x == tx && write_cmd->tile_y == ty &&
+                        write_cmd->level_x == 0 && write_cmd->level_y == 0) {
+                        input_data = write_cmd->input;
+                        input_layout = write_cmd->input_layout;
+                        input_pixel_type = write_cmd->input_pixel_type;
+                        break;
+                    }
+                }
+            }
+        }
+    } else {
+        int y_start = write_image->data_window.min_y + chunk * job->lines_per_block;
+        int y_end = y_start + job->lines_per_block;
+        if (y_end > write_image->data_window.max_y + 1) {
+            y_end = write_image->data_window.max_y + 1;
+        }
+        chunk_x0 = write_image->data_window.min_x;
+        chunk_y0 = y_start;
+        chunk_width = write_image->width;
+        chunk_height = y_end - y_start;
+
+        /* Find write command covering this block */
+        for (uint32_t i = 0; i < submit_info->command_buffer_count && !input_data; i++) {
+            ExrCommandBuffer cmd = submit_info->command_buffers[i];
+            if (!exr_command_buffer_is_valid(cmd)) continue;
+
+            for (uint32_t j = 0; j < cmd->command_count; j++) {
+                if (cmd->commands[j].base.type == EXR_CMD_TYPE_WRITE_SCANLINES) {
+                    ExrScanlineWriteCmd* write_cmd = &cmd->commands[j].scanline_write;
+                    if (write_cmd->y_start <= y_start &&
+                        write_cmd->y_start + write_cmd->num_lines >= y_end) {
+                        /* Calculate offset into input data */
+                        size_t bytes_per_input_pixel = (write_cmd->input_pixel_type == EXR_PIXEL_HALF) ? 2 : 4;
+                        size_t input_line_offset = (size_t)(y_start - write_cmd->y_start) *
+                            write_image->width * write_image->num_channels * bytes_per_input_pixel;
+                        input_data = (const uint8_t*)write_cmd->input + input_line_offset;
+                        input_layout = write_cmd->input_layout;
+                        input_pixel_type = write_cmd->input_pixel_type;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    if (!input_data) {
+        return EXR_ERROR_INVALID_STATE;  /* Missing data for chunk */
+    }
+
+    /* Convert to EXR channel-planar layout */
+    size_t chunk_data_size = (size_t)chunk_width * chunk_height * job->total_bytes_per_pixel;
+    uint8_t* converted = (uint8_t*)ctx->allocator.alloc(ctx->allocator.userdata, chunk_data_size, EXR_DEFAULT_ALIGNMENT);
+    if (!converted) return EXR_ERROR_OUT_OF_MEMORY;
+
+    convert_to_exr_layout(input_data, converted, chunk_width, chunk_height,
+                          write_image->num_channels, write_image->channels,
+                          input_pixel_type, input_layout);
+
+    /* Compress */
+    ExrResult result;
+    if (write_image->compression == EXR_COMPRESSION_DWAA ||
+        write_image->compression == EXR_COMPRESSION_DWAB) {
+        result = compress_dwa_chunk(ctx, write_image, converted, chunk_data_size,
+                                    chunk_x0, chunk_y0, chunk_width, chunk_height,
+                                    out_data, out_size);
+    } else {
+        result = compress_scanline_data(ctx, converted, chunk_data_size, out_data, out_size,
+                                        write_image->compression, write_image->compression_level);
+    }
+    ctx->allocator.free(ctx->allocator.userdata, converted, chunk_data_size);
+    return result;
+}
+
+static void encode_write_chunk_task(void* userdata, uint32_t index) {
+    ExrChunkEncodeJob* job = (ExrChunkEncodeJob*)userdata;
+    if (ATOMIC_LOAD(job->result) != EXR_SUCCESS) return;
+
+    ExrResult result = encode_write_chunk(job, job->first_chunk + (int)index,
+                                          &job->chunks[index], &job->chunk_sizes[index]);
+    if (EXR_FAILED(result)) {
+        job->chunks[index] = NULL;
+        ATOMIC_STORE(job->result, result);
+    }
+}
+
+/* Write the image's chunk offset table into the space reserved after its header */
+static ExrResult write_chunk_offset_table(ExrEncoder encoder, ExrWriteImage image) {
+    for (uint32_t b = 0; b < image->num_scanline_blocks; b++) {
+        ExrResult result = encoder_write(encoder, image->offset_table_pos + (uint64_t)b * 8,
+                                         &image->scanline_offsets[b], 8);
+        if (EXR_FAILED(result)) return result;
+    }
+    return EXR_SUCCESS;
+}
+
+/* Patch the image's offset table now, or with EXR_ENCODER_PARALLEL queue it
+ * for exr_encoder_finalize so chunk data streams to the sink uninterrupted */
+static ExrResult update_chunk_offset_table(ExrEncoder encoder, ExrWriteImage image) {
+    if (!(encoder->flags & EXR_ENCODER_PARALLEL)) {
+        return write_chunk_offset_table(encoder, image);
+    }
+
+    for (uint32_t i = 0; i < encoder->num_pending_tables; i++) {
+        if (encoder->pending_tables[i] == image) return EXR_SUCCESS;
+    }
+    if (encoder->num_pending_tables >= MAX_MULTIPART_PARTS) {
+        return write_chunk_offset_table(encoder, image);
+    }
+    encoder->pending_tables[encoder->num_pending_tables++] = image;
+    return EXR_SUCCESS;
+}
+
+/* Encode all regular tiles or scanline blocks of an image and write them in
+ * chunk order starting at *io_offset, recording each chunk's file offset.
+ * With EXR_ENCODER_PARALLEL, a window of chunks is compressed concurrently
+ * on the context thread pool before being written out sequentially. */
+static ExrResult encode_and_write_chunks(ExrEncoder encoder, ExrWriteImage write_image,
+                                         const ExrSubmitInfo* submit_info,
+                                         int num_chunks, int num_x_tiles,
+                                         size_t total_bytes_per_pixel,
+                                         uint64_t* chunk_offsets, uint64_t* io_offset) {
+    ExrContext ctx = encoder->ctx;
+    ExrThreadPool* pool = NULL;
+    uint32_t window = 1;
+    ExrResult result = EXR_SUCCESS;
+    uint64_t offset = *io_offset;
+
+    if (encoder->flags & EXR_ENCODER_PARALLEL) {
+        pool = exr_context_get_thread_pool(ctx);
+        if (pool) {
+            /* A few chunks per thread keeps workers busy while bounding
+             * how much compressed data is held before it is written */
+            window = (pool->num_threads + 1) * 4;
+        }
+    }
+    if (window > (uint32_t)num_chunks) window = (uint32_t)num_chunks;
+
+    ExrChunkEncodeJob job;
+    job.ctx = ctx;
+    job.image = write_image;
+    job.submit_info = submit_info;
+    job.num_x_tiles = num_x_tiles;
+    job.lines_per_block = get_write_lines_per_block(write_image->compression);
+    job.total_bytes_per_pixel = total_bytes_per_pixel;
+    job.chunks = (void**)ctx->allocator.alloc(ctx->allocator.userdata,
+                                              window * sizeof(void*), EXR_DEFAULT_ALIGNMENT);
+    job.chunk_sizes = (size_t*)ctx->allocator.alloc(ctx->allocator.userdata,
+                                                    window * sizeof(size_t), EXR_DEFAULT_ALIGNMENT);
+    if (!job.chunks || !job.chunk_sizes) {
+        if (job.chunks) ctx->allocator.free(ctx->allocator.userdata, job.chunks, window * sizeof(void*));
+        if (job.chunk_sizes) ctx->allocator.free(ctx->allocator.userdata, job.chunk_sizes, window * sizeof(size_t));
+        return EXR_ERROR_OUT_OF_MEMORY;
+    }
+
+    /* Build lazily-initialized tables before workers can race on them */
+    init_half_tables();
+
+    for (int first = 0; first < num_chunks && !EXR_FAILED(result); first += (int)window) {
+        uint32_t count = window;
+        if (first + (int)count > num_chunks) count = (uint32_t)(num_chunks - first);
+
+        memset(job.chunks, 0, count * sizeof(void*));
+        job.first_chunk = first;
+        ATOMIC_INIT(job.result, EXR_SUCCESS);
+        exr_parallel_for(pool, count, encode_write_chunk_task, &job);
+        result = (ExrResult)ATOMIC_LOAD(job.result);
+
+        for (uint32_t i = 0; i < count; i++) {
+            int chunk = first + (int)i;
+            if (!EXR_FAILED(result)) {
+                chunk_offsets[chunk] = offset;
+
+                if (num_x_tiles > 0) {
+                    /* Tile header: tile_x(4) + tile_y(4) + level_x(4) + level_y(4) */
+                    int32_t tile_coords[4] = {chunk % num_x_tiles, chunk / num_x_tiles, 0, 0};
+                    result = encoder_write(encoder, offset, tile_coords, 16);
+                    offset += 16;
+                } else {
+                    /* Block header: y coordinate (4 bytes) */
+                    int32_t y_coord = write_image->data_window.min_y + chunk * job.lines_per_block;
+                    result = encoder_write(encoder, offset, &y_coord, 4);
+                    offset += 4;
+                }
+
+                /* Compressed size (4 bytes) followed by the compressed data */
+                if (!EXR_FAILED(result)) {
+                    uint32_t chunk_size = (uint32_t)job.chunk_sizes[i];
+                    result = encoder_write(encoder, offset, &chunk_size, 4);
+                    offset += 4;
+                }
+                if (!EXR_FAILED(result)) {
+                    result = encoder_write(encoder, offset, job.chunks[i], job.chunk_sizes[i]);
+                    offset += job.chunk_sizes[i];
+                }
+            }
+            if (job.chunks[i]) {
+                ctx->allocator.free(ctx->allocator.userdata, job.chunks[i], job.chunk_sizes[i]);
+            }
+        }
+    }
+
+    ctx->allocator.free(ctx->allocator.userdata, job.chunks, window * sizeof(void*));
+    ctx->allocator.free(ctx->allocator.userdata, job.chunk_sizes, window * sizeof(size_t));
+
+    *io_offset = offset;
+    return result;
+}
+
 ExrResult exr_submit_write(ExrEncoder encoder, const ExrSubmitInfo* submit_info) {
     if (!exr_encoder_is_valid(encoder)) {
         return EXR_ERROR_INVALID_HANDLE;
@@ -7156,23 +9491,6 @@ ExrResult exr_submit_write(ExrEncoder encoder, const ExrSubmitInfo* submit_info)
         num_x_tiles = (write_image->width + write_image->tile_size_x - 1) / write_image->tile_size_x;
         num_y_tiles = (write_image->height + write_image->tile_size_y - 1) / write_image->tile_size_y;
         num_blocks = num_x_tiles * num_y_tiles;
-
-        /* Reserve space for tile offset table */
-        offset_table_pos = offset;
-        tile_offsets = (uint64_t*)ctx->allocator.alloc(
-            ctx->allocator.userdata, num_blocks * sizeof(uint64_t), EXR_DEFAULT_ALIGNMENT);
-        if (!tile_offsets) return EXR_ERROR_OUT_OF_MEMORY;
-
-        /* Write placeholder offset table */
-        for (int t = 0; t < num_blocks; t++) {
-            uint64_t placeholder = 0;
-            result = encoder_write(encoder, offset, &placeholder, 8);
-            if (EXR_FAILED(result)) {
-                ctx->allocator.free(ctx->allocator.userdata, tile_offsets, num_blocks * sizeof(uint64_t));
-                return result;
-            }
-            offset += 8;
-        }
     } else {
         /* Scanline or deep: calculate block count */
         int lines_per_block;
@@ -7182,21 +9500,42 @@ ExrResult exr_submit_write(ExrEncoder encoder, const ExrSubmitInfo* submit_info)
             lines_per_block = get_write_lines_per_block(write_image->compression);
         }
         num_blocks = (write_image->height + lines_per_block - 1) / lines_per_block;
-        write_image->num_scanline_blocks = (uint32_t)num_blocks;
+    }
 
-        /* Reserve space for offset table */
-        offset_table_pos = offset;
+    /* Reserve space for offset table */
+    offset_table_pos = offset;
+    write_image->offset_table_pos = offset_table_pos;
+    if ((write_image->flags & EXR_WRITE_TILED) && is_deep) {
+        tile_offsets = (uint64_t*)ctx->allocator.alloc(
+            ctx->allocator.userdata, num_blocks * sizeof(uint64_t), EXR_DEFAULT_ALIGNMENT);
+        if (!tile_offsets) return EXR_ERROR_OUT_OF_MEMORY;
+    } else {
+        /* Regular tiles share the per-image chunk offset table with scanline
+         * blocks so exr_encoder_finalize can patch either kind */
+        if (write_image->scanline_offsets) {
+            ctx->allocator.free(ctx->allocator.userdata, write_image->scanline_offsets,
+                                write_image->num_scanline_blocks * sizeof(uint64_t));
+        }
+        write_image->num_scanline_blocks = (uint32_t)num_blocks;
         write_image->scanline_offsets = (uint64_t*)ctx->allocator.alloc(
             ctx->allocator.userdata, num_blocks * sizeof(uint64_t), EXR_DEFAULT_ALIGNMENT);
-        if (!write_image->scanline_offsets) return EXR_ERROR_OUT_OF_MEMORY;
+        if (!write_image->scanline_offsets) {
+            write_image->num_scanline_blocks = 0;
+            return EXR_ERROR_OUT_OF_MEMORY;
+        }
+    }
 
-        /* Write placeholder offset table */
-        for (int b = 0; b < num_blocks; b++) {
-            uint64_t placeholder = 0;
-            result = encoder_write(encoder, offset, &placeholder, 8);
-            if (EXR_FAILED(result)) return result;
-            offset += 8;
+    /* Write placeholder offset table */
+    for (int b = 0; b < num_blocks; b++) {
+        uint64_t placeholder = 0;
+        result = encoder_write(encoder, offset, &placeholder, 8);
+        if (EXR_FAILED(result)) {
+            if (tile_offsets) {
+                ctx->allocator.free(ctx->allocator.userdata, tile_offsets, num_blocks * sizeof(uint64_t));
+            }
+            return result;
         }
+        offset += 8;
     }
 
     /* Calculate bytes per pixel for each channel */
@@ -7214,115 +9553,14 @@ ExrResult exr_submit_write(ExrEncoder encoder, const ExrSubmitInfo* submit_info)
 
     if ((write_image->flags & EXR_WRITE_TILED) && !is_deep) {
         /* ===== Write regular tiles ===== */
-        for (int ty = 0; ty < num_y_tiles; ty++) {
-            for (int tx = 0; tx < num_x_tiles; tx++) {
-                int tile_idx = ty * num_x_tiles + tx;
-                tile_offsets[tile_idx] = offset;
-
-                /* Calculate tile dimensions */
-                int tile_px_x = tx * write_image->tile_size_x;
-                int tile_px_y = ty * write_image->tile_size_y;
-                int tile_width = write_image->tile_size_x;
-                int tile_height = write_image->tile_size_y;
-
-                /* Clamp to image bounds */
-                if (tile_px_x + tile_width > write_image->width) {
-                    tile_width = write_image->width - tile_px_x;
-                }
-                if (tile_px_y + tile_height > write_image->height) {
-                    tile_height = write_image->height - tile_px_y;
-                }
-
-                /* Find write command for this tile */
-                const void* input_data = NULL;
-                uint32_t input_layout = EXR_LAYOUT_INTERLEAVED;
-                uint32_t input_pixel_type = EXR_PIXEL_FLOAT;
-
-                for (uint32_t i = 0; i < submit_info->command_buffer_count && !input_data; i++) {
-                    ExrCommandBuffer cmd = submit_info->command_buffers[i];
-                    if (!exr_command_buffer_is_valid(cmd)) continue;
-
-                    for (uint32_t j = 0; j < cmd->command_count; j++) {
-                        if (cmd->commands[j].base.type == EXR_CMD_TYPE_WRITE_TILE) {
-                            ExrTileWriteCmd* write_cmd = &cmd->commands[j].tile_write;
-                            if (write_cmd->tile_x == tx && write_cmd->tile_y == ty &&
-                                write_cmd->level_x == 0 && write_cmd->level_y == 0) {
-                                input_data = write_cmd->input;
-                                input_layout = write_cmd->input_layout;
-                                input_pixel_type = write_cmd->input_pixel_type;
-                                break;
-                            }
-                        }
-                    }
-                }
-
-                if (!input_data) {
-                    ctx->allocator.free(ctx->allocator.userdata, tile_offsets, num_blocks * sizeof(uint64_t));
-                    return EXR_ERROR_INVALID_STATE;  /* Missing data for tile */
-                }
-
-                /* Convert to EXR channel-planar layout */
-                size_t tile_data_size = (size_t)tile_width * tile_height * total_bytes_per_pixel;
-                uint8_t* converted = (uint8_t*)ctx->allocator.alloc(ctx->allocator.userdata, tile_data_size, EXR_DEFAULT_ALIGNMENT);
-                if (!converted) {
-                    ctx->allocator.free(ctx->allocator.userdata, tile_offsets, num_blocks * sizeof(uint64_t));
-                    return EXR_ERROR_OUT_OF_MEMORY;
-                }
-
-                convert_to_exr_layout(input_data, converted, tile_width, tile_height,
-                                      write_image->num_channels, write_image->channels,
-                                      input_pixel_type, input_layout);
-
-                /* Compress */
-                void* compressed = NULL;
-                size_t compressed_size = 0;
-                result = compress_scanline_data(ctx, converted, tile_data_size, &compressed, &compressed_size,
-                                                write_image->compression);
-                ctx->allocator.free(ctx->allocator.userdata, converted, tile_data_size);
-                if (EXR_FAILED(result)) {
-                    ctx->allocator.free(ctx->allocator.userdata, tile_offsets, num_blocks * sizeof(uint64_t));
-                    return result;
-                }
-
-                /* Write tile header: tile_x(4) + tile_y(4) + level_x(4) + level_y(4) + size(4) = 20 bytes */
-                int32_t tile_coords[4] = {tx, ty, 0, 0};  /* level_x = level_y = 0 for single level */
-                result = encoder_write(encoder, offset, tile_coords, 16);
-                if (EXR_FAILED(result)) {
-                    ctx->allocator.free(ctx->allocator.userdata, compressed, compressed_size);
-                    ctx->allocator.free(ctx->allocator.userdata, tile_offsets, num_blocks * sizeof(uint64_t));
-                    return result;
-                }
-                offset += 16;
-
-                uint32_t tile_size = (uint32_t)compressed_size;
-                result = encoder_write(encoder, offset, &tile_size, 4);
-                if (EXR_FAILED(result)) {
-                    ctx->allocator.free(ctx->allocator.userdata, compressed, compressed_size);
-                    ctx->allocator.free(ctx->allocator.userdata, tile_offsets, num_blocks * sizeof(uint64_t));
-                    return result;
-                }
-                offset += 4;
-
-                /* Write compressed data */
-                result = encoder_write(encoder, offset, compressed, compressed_size);
-                ctx->allocator.free(ctx->allocator.userdata, compressed, compressed_size);
-                if (EXR_FAILED(result)) {
-                    ctx->allocator.free(ctx->allocator.userdata, tile_offsets, num_blocks * sizeof(uint64_t));
-                    return result;
-                }
-                offset += compressed_size;
-            }
-        }
+        result = encode_and_write_chunks(encoder, write_image, submit_info, num_blocks,
+                                         num_x_tiles, total_bytes_per_pixel,
+                                         write_image->scanline_offsets, &offset);
+        if (EXR_FAILED(result)) return result;
 
         /* Update tile offset table */
-        for (int t = 0; t < num_blocks; t++) {
-            result = encoder_write(encoder, offset_table_pos + t * 8, &tile_offsets[t], 8);
-            if (EXR_FAILED(result)) {
-                ctx->allocator.free(ctx->allocator.userdata, tile_offsets, num_blocks * sizeof(uint64_t));
-                return result;
-            }
-        }
-        ctx->allocator.free(ctx->allocator.userdata, tile_offsets, num_blocks * sizeof(uint64_t));
+        result = update_chunk_offset_table(encoder, write_image);
+        if (EXR_FAILED(result)) return result;
 
     } else if ((write_image->flags & EXR_WRITE_TILED) && is_deep) {
         /* ===== Write deep tiles ===== */
@@ -7421,8 +9659,8 @@ ExrResult exr_submit_write(ExrEncoder encoder, const ExrSubmitInfo* submit_info)
                 /* Compress with ZIP */
                 size_t offset_compressed_size = 0;
                 uint8_t* offset_compressed = NULL;
-#if defined(TINYEXR_V3_USE_MINIZ)
-                mz_ulong comp_bound = mz_compressBound((mz_ulong)offset_table_size);
+#if defined(TINYEXR_V3_HAS_ZIP_WRITE)
+                size_t comp_bound = zip_compress_bound(offset_table_size);
                 offset_compressed = (uint8_t*)ctx->allocator.alloc(
                     ctx->allocator.userdata, (size_t)comp_bound, EXR_DEFAULT_ALIGNMENT);
                 if (!offset_compressed) {
@@ -7432,18 +9670,18 @@ ExrResult exr_submit_write(ExrEncoder encoder, const ExrSubmitInfo* submit_info)
                     return EXR_ERROR_OUT_OF_MEMORY;
                 }
 
-                mz_ulong offset_comp_len = comp_bound;
-                int zret = mz_compress((unsigned char*)offset_compressed, &offset_comp_len,
-                                       (const unsigned char*)offset_temp, (mz_ulong)offset_table_size);
+                size_t offset_comp_len = zip_compress(offset_compressed, comp_bound,
+                                                      offset_temp, offset_table_size,
+                                                      write_image->compression_level);
                 ctx->allocator.free(ctx->allocator.userdata, offset_temp, offset_table_size);
                 ctx->allocator.free(ctx->allocator.userdata, pixel_offsets, offset_table_size);
 
-                if (zret != MZ_OK) {
+                if (offset_comp_len == 0) {
                     ctx->allocator.free(ctx->allocator.userdata, offset_compressed, (size_t)comp_bound);
                     ctx->allocator.free(ctx->allocator.userdata, tile_offsets, num_blocks * sizeof(uint64_t));
                     return EXR_ERROR_COMPRESSION_FAILED;
                 }
-                offset_compressed_size = (size_t)offset_comp_len;
+                offset_compressed_size = offset_comp_len;
 #else
                 /* If no miniz, write uncompressed */
                 offset_compressed = offset_temp;
@@ -7509,8 +9747,8 @@ ExrResult exr_submit_write(ExrEncoder encoder, const ExrSubmitInfo* submit_info)
                     }
                     ctx->allocator.free(ctx->allocator.userdata, sample_data, sample_data_size);
 
-#if defined(TINYEXR_V3_USE_MINIZ)
-                    mz_ulong sample_comp_bound = mz_compressBound((mz_ulong)sample_data_size);
+#if defined(TINYEXR_V3_HAS_ZIP_WRITE)
+                    size_t sample_comp_bound = zip_compress_bound(sample_data_size);
                     sample_compressed = (uint8_t*)ctx->allocator.alloc(
                         ctx->allocator.userdata, (size_t)sample_comp_bound, EXR_DEFAULT_ALIGNMENT);
                     if (!sample_compressed) {
@@ -7520,18 +9758,18 @@ ExrResult exr_submit_write(ExrEncoder encoder, const ExrSubmitInfo* submit_info)
                         return EXR_ERROR_OUT_OF_MEMORY;
                     }
 
-                    mz_ulong sample_comp_len = sample_comp_bound;
-                    zret = mz_compress((unsigned char*)sample_compressed, &sample_comp_len,
-                                       (const unsigned char*)sample_temp, (mz_ulong)sample_data_size);
+                    size_t sample_comp_len = zip_compress(sample_compressed, sample_comp_bound,
+                                                          sample_temp, sample_data_size,
+                                                          write_image->compression_level);
                     ctx->allocator.free(ctx->allocator.userdata, sample_temp, sample_data_size);
 
-                    if (zret != MZ_OK) {
+                    if (sample_comp_len == 0) {
                         ctx->allocator.free(ctx->allocator.userdata, sample_compressed, (size_t)sample_comp_bound);
                         ctx->allocator.free(ctx->allocator.userdata, offset_compressed, offset_compressed_size);
                         ctx->allocator.free(ctx->allocator.userdata, tile_offsets, num_blocks * sizeof(uint64_t));
                         return EXR_ERROR_COMPRESSION_FAILED;
                     }
-                    sample_compressed_size = (size_t)sample_comp_len;
+                    sample_compressed_size = sample_comp_len;
 #else
                     sample_compressed = sample_temp;
                     sample_compressed_size = sample_data_size;
@@ -7700,8 +9938,8 @@ ExrResult exr_submit_write(ExrEncoder encoder, const ExrSubmitInfo* submit_info)
             }
 
             /* Compress with ZIP */
-#if defined(TINYEXR_V3_USE_MINIZ)
-            mz_ulong comp_bound = mz_compressBound((mz_ulong)offset_table_size);
+#if defined(TINYEXR_V3_HAS_ZIP_WRITE)
+            size_t comp_bound = zip_compress_bound(offset_table_size);
             uint8_t* offset_compressed = (uint8_t*)ctx->allocator.alloc(
                 ctx->allocator.userdata, (size_t)comp_bound, EXR_DEFAULT_ALIGNMENT);
             if (!offset_compressed) {
@@ -7710,13 +9948,13 @@ ExrResult exr_submit_write(ExrEncoder encoder, const ExrSubmitInfo* submit_info)
                 return EXR_ERROR_OUT_OF_MEMORY;
             }
 
-            mz_ulong offset_compressed_size = comp_bound;
-            int zret = mz_compress((unsigned char*)offset_compressed, &offset_compressed_size,
-                                   (const unsigned char*)offset_temp, (mz_ulong)offset_table_size);
+            size_t offset_compressed_size = zip_compress(offset_compressed, comp_bound,
+                                                         offset_temp, offset_table_size,
+                                                         write_image->compression_level);
             ctx->allocator.free(ctx->allocator.userdata, offset_temp, offset_table_size);
             ctx->allocator.free(ctx->allocator.userdata, pixel_offsets, offset_table_size);
 
-            if (zret != MZ_OK) {
+            if (offset_compressed_size == 0) {
                 ctx->allocator.free(ctx->allocator.userdata, offset_compressed, (size_t)comp_bound);
                 return EXR_ERROR_COMPRESSION_FAILED;
             }
@@ -7755,7 +9993,7 @@ ExrResult exr_submit_write(ExrEncoder encoder, const ExrSubmitInfo* submit_info)
                 void* sample_compressed = NULL;
                 result = compress_scanline_data(ctx, sample_data, sample_data_size,
                                                &sample_compressed, &sample_compressed_size,
-                                               write_image->compression);
+                                               write_image->compression, write_image->compression_level);
                 ctx->allocator.free(ctx->allocator.userdata, sample_data, sample_data_size);
                 if (EXR_FAILED(result)) {
                     ctx->allocator.free(ctx->allocator.userdata, offset_compressed, (size_t)comp_bound);
@@ -7825,96 +10063,14 @@ ExrResult exr_submit_write(ExrEncoder encoder, const ExrSubmitInfo* submit_info)
 
     } else {
         /* ===== Write scanline blocks ===== */
-        int lines_per_block = get_write_lines_per_block(write_image->compression);
-
-        for (int block = 0; block < num_blocks; block++) {
-            write_image->scanline_offsets[block] = offset;
-
-            int y_start = write_image->data_window.min_y + block * lines_per_block;
-            int y_end = y_start + lines_per_block;
-            if (y_end > write_image->data_window.max_y + 1) {
-                y_end = write_image->data_window.max_y + 1;
-            }
-            int block_lines = y_end - y_start;
-
-            /* Find write command covering this block */
-            const void* input_data = NULL;
-            uint32_t input_layout = EXR_LAYOUT_INTERLEAVED;
-            uint32_t input_pixel_type = EXR_PIXEL_FLOAT;
-
-            for (uint32_t i = 0; i < submit_info->command_buffer_count && !input_data; i++) {
-                ExrCommandBuffer cmd = submit_info->command_buffers[i];
-                if (!exr_command_buffer_is_valid(cmd)) continue;
-
-                for (uint32_t j = 0; j < cmd->command_count; j++) {
-                    if (cmd->commands[j].base.type == EXR_CMD_TYPE_WRITE_SCANLINES) {
-                        ExrScanlineWriteCmd* write_cmd = &cmd->commands[j].scanline_write;
-                        if (write_cmd->y_start <= y_start &&
-                            write_cmd->y_start + write_cmd->num_lines >= y_end) {
-                            /* Calculate offset into input data */
-                            size_t bytes_per_input_pixel = (write_cmd->input_pixel_type == EXR_PIXEL_HALF) ? 2 : 4;
-                            size_t input_line_offset = (size_t)(y_start - write_cmd->y_start) *
-                                write_image->width * write_image->num_channels * bytes_per_input_pixel;
-                            input_data = (const uint8_t*)write_cmd->input + input_line_offset;
-                            input_layout = write_cmd->input_layout;
-                            input_pixel_type = write_cmd->input_pixel_type;
-                            break;
-                        }
-                    }
-                }
-            }
-
-            if (!input_data) {
-                return EXR_ERROR_INVALID_STATE;  /* Missing data for block */
-            }
-
-            /* Convert to EXR channel-planar layout */
-            size_t block_size = (size_t)write_image->width * block_lines * total_bytes_per_pixel;
-            uint8_t* converted = (uint8_t*)ctx->allocator.alloc(ctx->allocator.userdata, block_size, EXR_DEFAULT_ALIGNMENT);
-            if (!converted) return EXR_ERROR_OUT_OF_MEMORY;
-
-            convert_to_exr_layout(input_data, converted, write_image->width, block_lines,
-                                  write_image->num_channels, write_image->channels,
-                                  input_pixel_type, input_layout);
-
-            /* Compress */
-            void* compressed = NULL;
-            size_t compressed_size = 0;
-            result = compress_scanline_data(ctx, converted, block_size, &compressed, &compressed_size,
-                                            write_image->compression);
-            ctx->allocator.free(ctx->allocator.userdata, converted, block_size);
-            if (EXR_FAILED(result)) return result;
-
-            /* Write block header: y coordinate (4 bytes) + compressed size (4 bytes) */
-            int32_t y_coord = y_start;
-            result = encoder_write(encoder, offset, &y_coord, 4);
-            if (EXR_FAILED(result)) {
-                ctx->allocator.free(ctx->allocator.userdata, compressed, compressed_size);
-                return result;
-            }
-            offset += 4;
-
-            uint32_t block_data_size = (uint32_t)compressed_size;
-            result = encoder_write(encoder, offset, &block_data_size, 4);
-            if (EXR_FAILED(result)) {
-                ctx->allocator.free(ctx->allocator.userdata, compressed, compressed_size);
-                return result;
-            }
-            offset += 4;
-
-            /* Write compressed data */
-            result = encoder_write(encoder, offset, compressed, compressed_size);
-            ctx->allocator.free(ctx->allocator.userdata, compressed, compressed_size);
-            if (EXR_FAILED(result)) return result;
-            offset += compressed_size;
-        }
+        result = encode_and_write_chunks(encoder, write_image, submit_info, num_blocks,
+                                         0, total_bytes_per_pixel,
+                                         write_image->scanline_offsets, &offset);
+        if (EXR_FAILED(result)) return result;
 
         /* Update scanline offset table */
-        for (int b = 0; b < num_blocks; b++) {
-            result = encoder_write(encoder, offset_table_pos + b * 8,
-                                    &write_image->scanline_offsets[b], 8);
-            if (EXR_FAILED(result)) return result;
-        }
+        result = update_chunk_offset_table(encoder, write_image);
+        if (EXR_FAILED(result)) return result;
     }
 
     encoder->write_offset = offset;
@@ -8082,6 +10238,7 @@ ExrResult exr_decompress_chunk(ExrContext ctx, const ExrDecompressInfo* info) {
 
     ExrResult result = EXR_SUCCESS;
     size_t out_size = 0;
+    ExrScratch scratch;
 
     switch (info->compression) {
         case EXR_COMPRESSION_NONE:
@@ -8094,16 +10251,20 @@ ExrResult exr_decompress_chunk(ExrContext ctx, const ExrDecompressInfo* info) {
             break;
 
         case EXR_COMPRESSION_RLE:
+            exr_scratch_begin(&scratch, ctx, info->scratch);
             result = decompress_rle((const uint8_t*)info->src, info->src_size,
                                      (uint8_t*)info->dst, info->dst_capacity,
-                                     &out_size);
+                                     &out_size, &scratch);
+            exr_scratch_end(&scratch);
             break;
 
         case EXR_COMPRESSION_ZIPS:
         case EXR_COMPRESSION_ZIP:
+            exr_scratch_begin(&scratch, ctx, info->scratch);
             result = decompress_zip((const uint8_t*)info->src, info->src_size,
                                      (uint8_t*)info->dst, info->dst_capacity,
-                                     &out_size, ctx);
+                                     &out_size, &scratch);
+            exr_scratch_end(&scratch);
             break;
 
 #if defined(TINYEXR_V3_HAS_PIZ)
@@ -8139,11 +10300,13 @@ ExrResult exr_decompress_chunk(ExrContext ctx, const ExrDecompressInfo* info) {
             break;
 #endif
 
-        /* PXR24 and B44 decompression not exposed through direct chunk API */
+        /* PXR24, B44 and DWA decompression not exposed through direct chunk API */
         /* Use full decoder API for these compression formats */
         case EXR_COMPRESSION_PXR24:
         case EXR_COMPRESSION_B44:
         case EXR_COMPRESSION_B44A:
+        case EXR_COMPRESSION_DWAA:
+        case EXR_COMPRESSION_DWAB:
 
         default:
             return EXR_ERROR_UNSUPPORTED_FORMAT;
@@ -8222,22 +10385,44 @@ ExrResult exr_compress_chunk(ExrContext ctx, const ExrCompressInfo* info) {
             apply_delta_predictor_encode(temp, temp_size);
 
             /* ZIP compress */
-#if defined(TINYEXR_V3_USE_MINIZ)
-            mz_ulong dst_len = (mz_ulong)info->dst_capacity;
-            int level = (info->compression_level > 0) ? info->compression_level : MZ_DEFAULT_LEVEL;
-            int zret = mz_compress2((unsigned char*)info->dst, &dst_len,
-                                     temp, (mz_ulong)temp_size, level);
-            if (zret == MZ_OK) {
-                out_size = dst_len;
+#if defined(TINYEXR_V3_HAS_ZIP_WRITE)
+            int32_t level = (info->compression_level > 0) ? info->compression_level : 6;
+            size_t bound = zip_compress_bound(temp_size);
+            if (info->dst_capacity >= bound) {
+                out_size = zip_compress((uint8_t*)info->dst, info->dst_capacity, temp, temp_size, level);
             } else {
-                ctx->allocator.free(ctx->allocator.userdata, temp, temp_size);
+                /* Compress into a bound-sized buffer and copy if it fits */
+                uint8_t* zbuf = (uint8_t*)ctx->allocator.alloc(
+                    ctx->allocator.userdata, bound, EXR_DEFAULT_ALIGNMENT);
+                if (!zbuf) {
+                    ctx->allocator.free(ctx->allocator.userdata, temp, temp_size);
+                    return EXR_ERROR_OUT_OF_MEMORY;
+                }
+                out_size = zip_compress(zbuf, bound, temp, temp_size, level);
+                if (out_size > 0 && out_size <= info->dst_capacity) {
+                    memcpy(info->dst, zbuf, out_size);
+                } else if (out_size > 0) {
+                    out_size = info->src_size;  /* Store uncompressed below, if it fits */
+                }
+                ctx->allocator.free(ctx->allocator.userdata, zbuf, bound);
+            }
+            ctx->allocator.free(ctx->allocator.userdata, temp, temp_size);
+            if (out_size == 0) {
                 return EXR_ERROR_COMPRESSION_FAILED;
             }
+
+            if (out_size >= info->src_size) {
+                /* Compression didn't help, store uncompressed (Issue 40) */
+                if (info->dst_capacity < info->src_size) {
+                    return EXR_ERROR_BUFFER_TOO_SMALL;
+                }
+                memcpy(info->dst, info->src, info->src_size);
+                out_size = info->src_size;
+            }
 #else
             ctx->allocator.free(ctx->allocator.userdata, temp, temp_size);
             return EXR_ERROR_UNSUPPORTED_FORMAT;
 #endif
-            ctx->allocator.free(ctx->allocator.userdata, temp, temp_size);
             break;
         }
 
@@ -0,0 +1,1095 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2025, Syoyo Fujita and many contributors.
+// All rights reserved.
+//
+// TinyEXR DWAA/DWAB Compression Module
+//
+// Shared by the V1, V2 and V3 readers and writers.
+//
+// Provides native decoding of DreamWorks Animation (DWAA/DWAB) chunks:
+// - Channel classification from the rules stored in the chunk (or the legacy
+//   rules of version 0/1 streams)
+// - Lossy DCT channels: AC from static Huffman or zlib, DC from zlib with
+//   the ZIP predictor, 8x8 inverse DCT and Rec.709 Y'CbCr -> R'G'B' through
+//   tinyexr::simd, and the perceptual-to-linear lookup
+// - RLE channels (zlib + EXR run-length) and zlib for all other channels
+//
+// and encoding with OpenEXR's default rules: forward DCT, color conversion
+// and quantization through tinyexr::simd, with the quantization error set
+// by the dwaCompressionLevel attribute (45 by default).
+//
+// DWAA and DWAB only differ in lines per chunk (32 and 256); the chunk
+// layout is the same.
+//
+// Usage:
+//   #include "tinyexr_dwa.hh"
+//   tinyexr::dwa::Decompress(dst, dst_size, src, src_size, channels, ...);
+//   tinyexr::dwa::Compress(src, src_size, channels, ..., level, &out);
+
+#ifndef TINYEXR_DWA_HH_
+#define TINYEXR_DWA_HH_
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <map>
+
+#include "tinyexr_simd.hh"
+#include "tinyexr_huffman.hh"
+
+namespace tinyexr {
+namespace dwa {
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+// How a channel is stored
+enum CompressorScheme {
+  SCHEME_UNKNOWN = 0,    // zlib
+  SCHEME_LOSSY_DCT = 1,  // 8x8 DCT, quantized
+  SCHEME_RLE = 2,        // EXR run-length, then zlib
+  NUM_SCHEMES = 3
+};
+
+// How the AC coefficients are entropy coded
+enum AcCompression {
+  AC_STATIC_HUFFMAN = 0,
+  AC_DEFLATE = 1
+};
+
+// EXR pixel types
+enum PixelType {
+  PIXEL_UINT = 0,
+  PIXEL_HALF = 1,
+  PIXEL_FLOAT = 2
+};
+
+// Chunk header: eleven little-endian uint64 counters
+enum HeaderField {
+  HDR_VERSION = 0,
+  HDR_UNKNOWN_UNCOMPRESSED_SIZE,
+  HDR_UNKNOWN_COMPRESSED_SIZE,
+  HDR_AC_COMPRESSED_SIZE,
+  HDR_DC_COMPRESSED_SIZE,
+  HDR_RLE_COMPRESSED_SIZE,
+  HDR_RLE_UNCOMPRESSED_SIZE,
+  HDR_RLE_RAW_SIZE,
+  HDR_AC_UNCOMPRESSED_COUNT,
+  HDR_DC_UNCOMPRESSED_COUNT,
+  HDR_AC_COMPRESSION,
+  NUM_HEADER_FIELDS
+};
+
+static const size_t HEADER_SIZE = NUM_HEADER_FIELDS * 8;
+
+// Scanlines per chunk
+static const int DWAA_LINES_PER_BLOCK = 32;
+static const int DWAB_LINES_PER_BLOCK = 256;
+
+// AC run-length symbols: 0xff00 ends a block, 0xffNN skips NN zeros
+static const uint16_t AC_END_OF_BLOCK = 0xff00;
+
+// Default of the dwaCompressionLevel header attribute
+static const float DEFAULT_COMPRESSION_LEVEL = 45.0f;
+
+// Raster position -> index in the zigzag-ordered coefficient list
+static const uint8_t kZigZagIndex[64] = {
+    0,  1,  5,  6,  14, 15, 27, 28,
+    2,  4,  7,  13, 16, 26, 29, 42,
+    3,  8,  12, 17, 25, 30, 41, 43,
+    9,  11, 18, 24, 31, 40, 44, 53,
+    10, 19, 23, 32, 39, 45, 52, 54,
+    20, 22, 33, 38, 46, 51, 55, 60,
+    21, 34, 37, 47, 50, 56, 59, 61,
+    35, 36, 48, 49, 57, 58, 62, 63};
+
+// ============================================================================
+// Channel Classification
+// ============================================================================
+
+// A channel as described by the EXR header
+struct ChannelInfo {
+  const char* name;
+  int pixel_type;  // PixelType
+  int x_sampling;
+  int y_sampling;
+  bool p_linear;   // Already perceptually linear; skip the lookup
+};
+
+// Maps a channel name suffix ("R", "green", ...) and pixel type to a scheme.
+// csc_index 0/1/2 marks the red/green/blue member of a color set.
+struct ClassifierRule {
+  std::string suffix;
+  int scheme;
+  int pixel_type;
+  int csc_index;
+  bool case_insensitive;
+
+  ClassifierRule(const std::string& s, int sch, int type, int csc, bool ci)
+      : suffix(s), scheme(sch), pixel_type(type), csc_index(csc),
+        case_insensitive(ci) {
+    if (case_insensitive) suffix = ToLower(suffix);
+  }
+
+  bool Match(const std::string& s, int type) const {
+    if (type != pixel_type) return false;
+    return case_insensitive ? ToLower(s) == suffix : s == suffix;
+  }
+
+  static std::string ToLower(std::string s) {
+    for (size_t i = 0; i < s.size(); i++) {
+      if (s[i] >= 'A' && s[i] <= 'Z') s[i] = static_cast<char>(s[i] - 'A' + 'a');
+    }
+    return s;
+  }
+};
+
+// Rules implied by version 0 and 1 streams, which carry none
+inline void LegacyRules(std::vector<ClassifierRule>* rules) {
+  static const struct { const char* suffix; int csc; } kDct[] = {
+      {"r", 0}, {"red", 0}, {"g", 1}, {"grn", 1}, {"green", 1},
+      {"b", 2}, {"blu", 2}, {"blue", 2}, {"y", -1}, {"by", -1}, {"ry", -1}};
+  rules->clear();
+  for (size_t i = 0; i < sizeof(kDct) / sizeof(kDct[0]); i++) {
+    rules->push_back(ClassifierRule(kDct[i].suffix, SCHEME_LOSSY_DCT, PIXEL_HALF, kDct[i].csc, true));
+    rules->push_back(ClassifierRule(kDct[i].suffix, SCHEME_LOSSY_DCT, PIXEL_FLOAT, kDct[i].csc, true));
+  }
+  rules->push_back(ClassifierRule("a", SCHEME_RLE, PIXEL_UINT, -1, true));
+  rules->push_back(ClassifierRule("a", SCHEME_RLE, PIXEL_HALF, -1, true));
+  rules->push_back(ClassifierRule("a", SCHEME_RLE, PIXEL_FLOAT, -1, true));
+}
+
+// Rules the encoder writes, as OpenEXR does: R, G and B (case sensitive)
+// form color sets, Y/BY/RY are lossy and A is run-length coded.
+inline void DefaultRules(std::vector<ClassifierRule>* rules) {
+  static const struct { const char* suffix; int csc; } kDct[] = {
+      {"R", 0}, {"G", 1}, {"B", 2}, {"Y", -1}, {"BY", -1}, {"RY", -1}};
+  rules->clear();
+  for (size_t i = 0; i < sizeof(kDct) / sizeof(kDct[0]); i++) {
+    rules->push_back(ClassifierRule(kDct[i].suffix, SCHEME_LOSSY_DCT, PIXEL_HALF, kDct[i].csc, false));
+    rules->push_back(ClassifierRule(kDct[i].suffix, SCHEME_LOSSY_DCT, PIXEL_FLOAT, kDct[i].csc, false));
+  }
+  rules->push_back(ClassifierRule("A", SCHEME_RLE, PIXEL_UINT, -1, false));
+  rules->push_back(ClassifierRule("A", SCHEME_RLE, PIXEL_HALF, -1, false));
+  rules->push_back(ClassifierRule("A", SCHEME_RLE, PIXEL_FLOAT, -1, false));
+}
+
+// Serialize rules in the version 2 layout below
+inline void WriteRules(const std::vector<ClassifierRule>& rules, std::vector<uint8_t>* out) {
+  for (size_t r = 0; r < rules.size(); r++) {
+    const ClassifierRule& rule = rules[r];
+    out->insert(out->end(), rule.suffix.begin(), rule.suffix.end());
+    out->push_back(0);
+    out->push_back(static_cast<uint8_t>(((rule.csc_index + 1) << 4) | (rule.scheme << 2) |
+                                        (rule.case_insensitive ? 1 : 0)));
+    out->push_back(static_cast<uint8_t>(rule.pixel_type));
+  }
+}
+
+// Parse the rule table of a version 2 stream. `size` excludes the leading
+// uint16 size field. Each rule is a NUL-terminated suffix, a packed byte
+// ((csc + 1) << 4 | scheme << 2 | case_insensitive) and the pixel type.
+inline bool ParseRules(const uint8_t* p, size_t size, std::vector<ClassifierRule>* rules) {
+  rules->clear();
+  while (size > 0) {
+    size_t len = 0;
+    while (len < size && p[len] != 0) len++;
+    if (len + 3 > size) return false;
+    std::string suffix(reinterpret_cast<const char*>(p), len);
+    int value = static_cast<int8_t>(p[len + 1]);
+    int type = static_cast<int8_t>(p[len + 2]);
+    int csc = (value >> 4) - 1;
+    int scheme = (value >> 2) & 3;
+    if (csc < -1 || csc > 2 || scheme >= NUM_SCHEMES) return false;
+    if (type < PIXEL_UINT || type > PIXEL_FLOAT) return false;
+    rules->push_back(ClassifierRule(suffix, scheme, type, csc, (value & 1) != 0));
+    p += len + 3;
+    size -= len + 3;
+  }
+  return true;
+}
+
+// Three channels sharing a prefix that are color converted together
+struct CscSet {
+  int idx[3];  // Red, green, blue channel
+};
+
+// Assign a scheme to every channel and collect the color sets. The last
+// matching rule wins; sets are ordered by prefix, as in OpenEXR.
+inline void ClassifyChannels(const ChannelInfo* channels, int num_channels,
+                             const std::vector<ClassifierRule>& rules,
+                             std::vector<int>* schemes, std::vector<CscSet>* csc_sets) {
+  std::map<std::string, CscSet> prefixes;
+  schemes->assign(static_cast<size_t>(num_channels), SCHEME_UNKNOWN);
+
+  for (int c = 0; c < num_channels; c++) {
+    std::string name(channels[c].name ? channels[c].name : "");
+    std::string prefix, suffix = name;
+    size_t dot = name.find_last_of('.');
+    if (dot != std::string::npos) {
+      prefix = name.substr(0, dot);
+      suffix = name.substr(dot + 1);
+    }
+    if (prefixes.find(prefix) == prefixes.end()) {
+      CscSet empty = {{-1, -1, -1}};
+      prefixes[prefix] = empty;
+    }
+    for (size_t r = 0; r < rules.size(); r++) {
+      if (rules[r].Match(suffix, channels[c].pixel_type)) {
+        (*schemes)[static_cast<size_t>(c)] = rules[r].scheme;
+        if (rules[r].csc_index >= 0) prefixes[prefix].idx[rules[r].csc_index] = c;
+      }
+    }
+  }
+
+  csc_sets->clear();
+  for (std::map<std::string, CscSet>::const_iterator it = prefixes.begin();
+       it != prefixes.end(); ++it) {
+    const int* idx = it->second.idx;
+    if (idx[0] < 0 || idx[1] < 0 || idx[2] < 0) continue;
+    const ChannelInfo& r = channels[idx[0]];
+    const ChannelInfo& g = channels[idx[1]];
+    const ChannelInfo& b = channels[idx[2]];
+    if (r.x_sampling != g.x_sampling || r.x_sampling != b.x_sampling ||
+        r.y_sampling != g.y_sampling || r.y_sampling != b.y_sampling) {
+      continue;
+    }
+    csc_sets->push_back(it->second);
+  }
+}
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+inline uint64_t ReadU64LE(const uint8_t* p) {
+  uint64_t v = 0;
+  for (int i = 7; i >= 0; i--) v = (v << 8) | p[i];
+  return v;
+}
+
+inline void WriteU64LE(uint8_t* p, uint64_t v) {
+  for (int i = 0; i < 8; i++) p[i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+inline int DivFloor(int a, int b) {
+  return (a >= 0) ? a / b : -((b - a - 1) / b);
+}
+
+inline int ModFloor(int a, int b) {
+  return a - b * DivFloor(a, b);
+}
+
+// Samples of a channel with sampling rate s in [a, b], as OpenEXR counts them
+inline int NumSamples(int s, int a, int b) {
+  int a1 = DivFloor(a, s);
+  int b1 = DivFloor(b, s);
+  return b1 - a1 + ((a1 * s < a) ? 0 : 1);
+}
+
+inline int PixelSize(int pixel_type) {
+  return pixel_type == PIXEL_HALF ? 2 : 4;
+}
+
+// Perceptually encoded half -> linear half. DWA quantizes in a space that
+// is a 2.2 gamma below 1 and logarithmic above; Inf and NaN map to zero.
+inline const uint16_t* ToLinearTable() {
+  struct Table {
+    uint16_t v[65536];
+    Table() {
+      const float log_base = static_cast<float>(std::pow(2.7182818, 2.2));
+      v[0] = 0;
+      for (uint32_t i = 1; i < 65536; i++) {
+        if ((i & 0x7c00) == 0x7c00) {
+          v[i] = 0;
+          continue;
+        }
+        float h = simd::half_to_float_scalar(static_cast<uint16_t>(i));
+        float sign = (h < 0.0f) ? -1.0f : 1.0f;
+        float a = std::fabs(h);
+        float l = (a <= 1.0f) ? sign * std::pow(a, 2.2f)
+                              : sign * std::pow(log_base, a - 1.0f);
+        v[i] = simd::float_to_half_rne_scalar(l);
+      }
+    }
+  };
+  static const Table table;
+  return table.v;
+}
+
+// Linear half -> perceptually encoded float, the inverse of ToLinearTable
+inline const float* ToNonlinearTable() {
+  struct Table {
+    float v[65536];
+    Table() {
+      for (uint32_t i = 0; i < 65536; i++) {
+        if ((i & 0x7c00) == 0x7c00) {
+          v[i] = 0.0f;
+          continue;
+        }
+        float h = simd::half_to_float_scalar(static_cast<uint16_t>(i));
+        float sign = (h < 0.0f) ? -1.0f : 1.0f;
+        float a = std::fabs(h);
+        // log(e^2.2) is the 2.2 below
+        v[i] = (a <= 1.0f) ? sign * std::pow(a, 1.0f / 2.2f)
+                           : sign * (std::log(a) / 2.2f + 1.0f);
+      }
+    }
+  };
+  static const Table table;
+  return table.v;
+}
+
+// EXR run-length encode: runs of three or more bytes become a count - 1
+// byte and the value, everything else literal blocks of up to 127 bytes
+// after a negative count.
+inline void RleCompress(const uint8_t* src, size_t src_size, std::vector<uint8_t>* dst) {
+  const size_t kMinRun = 3, kMaxRun = 127;
+  size_t start = 0, end = 1;
+  while (start < src_size) {
+    while (end < src_size && src[start] == src[end] && end - start - 1 < kMaxRun) end++;
+    if (end - start >= kMinRun) {
+      dst->push_back(static_cast<uint8_t>(end - start - 1));
+      dst->push_back(src[start]);
+      start = end;
+    } else {
+      while (end < src_size &&
+             (end + 1 >= src_size || src[end] != src[end + 1] ||
+              end + 2 >= src_size || src[end + 1] != src[end + 2]) &&
+             end - start < kMaxRun) {
+        end++;
+      }
+      dst->push_back(static_cast<uint8_t>(-static_cast<int>(end - start)));
+      dst->insert(dst->end(), src + start, src + end);
+      start = end;
+    }
+    end++;
+  }
+}
+
+// EXR run-length decode to exactly dst_size bytes. A negative count byte
+// -n is followed by n literal bytes, otherwise count + 1 copies of the next
+// byte follow.
+inline bool RleUncompress(const uint8_t* src, size_t src_size,
+                          uint8_t* dst, size_t dst_size) {
+  size_t in = 0, out = 0;
+  while (in < src_size) {
+    int count = static_cast<int8_t>(src[in++]);
+    if (count < 0) {
+      size_t n = static_cast<size_t>(-count);
+      if (n > src_size - in || n > dst_size - out) return false;
+      std::memcpy(dst + out, src + in, n);
+      in += n;
+      out += n;
+    } else {
+      size_t n = static_cast<size_t>(count) + 1;
+      if (in >= src_size || n > dst_size - out) return false;
+      std::memset(dst + out, src[in++], n);
+      out += n;
+    }
+  }
+  return out == dst_size;
+}
+
+// ============================================================================
+// Lossy DCT Decoder and Encoder
+// ============================================================================
+
+// Decodes one channel, or a color set of three, from the shared AC and DC
+// streams into the channels' output rows, advancing `ac` and `dc` past the
+// values it consumed. DC values are stored per component plane.
+class LossyDctDecoder {
+ public:
+  LossyDctDecoder(int width, int height, const uint16_t* to_linear)
+      : width_(width), height_(height), to_linear_(to_linear), num_comp_(0) {}
+
+  void AddComponent(uint8_t* const* rows, int pixel_type) {
+    rows_[num_comp_] = rows;
+    types_[num_comp_] = pixel_type;
+    num_comp_++;
+  }
+
+  bool Execute(const uint16_t** ac, const uint16_t* ac_end,
+               const uint16_t** dc, const uint16_t* dc_end) {
+    if (width_ <= 0 || height_ <= 0) return true;
+    const int blocks_x = (width_ + 7) / 8;
+    const int blocks_y = (height_ + 7) / 8;
+    const int full_blocks_x = width_ / 8;
+    const int leftover_x = width_ - (blocks_x - 1) * 8;
+    const int leftover_y = height_ - (blocks_y - 1) * 8;
+    const size_t plane = static_cast<size_t>(blocks_x) * static_cast<size_t>(blocks_y);
+
+    if (static_cast<size_t>(dc_end - *dc) < plane * static_cast<size_t>(num_comp_)) {
+      return false;
+    }
+    const uint16_t* dc_comp[3];
+    for (int c = 0; c < num_comp_; c++) dc_comp[c] = *dc + plane * static_cast<size_t>(c);
+
+    const float dc_scale = 3.535536e-01f;
+    std::vector<uint16_t> row_block(static_cast<size_t>(num_comp_) * static_cast<size_t>(blocks_x) * 64);
+    uint16_t zig[64];
+    float dct[3][64];
+
+    for (int by = 0; by < blocks_y; by++) {
+      const int max_y = (by == blocks_y - 1) ? leftover_y : 8;
+
+      for (int bx = 0; bx < blocks_x; bx++) {
+        // Blocks with DC only in every component are converted once
+        bool constant = true;
+        for (int c = 0; c < num_comp_; c++) {
+          std::memset(zig, 0, sizeof(zig));
+          zig[0] = *dc_comp[c]++;
+          int last_non_zero = 0;
+          if (!UnRleAc(ac, ac_end, zig, &last_non_zero)) return false;
+
+          float* d = dct[c];
+          if (last_non_zero == 0) {
+            float v = simd::half_to_float_scalar(zig[0]) * dc_scale * dc_scale;
+            for (int i = 0; i < 64; i++) d[i] = v;
+            continue;
+          }
+          constant = false;
+          for (int i = 0; i < 64; i++) {
+            int z = kZigZagIndex[i];
+            d[i] = (z <= last_non_zero) ? simd::half_to_float_scalar(zig[z]) : 0.0f;
+          }
+          // Rows past the last coefficient's row are all zero
+          int zeroed_rows = (last_non_zero < 2)    ? 7
+                            : (last_non_zero < 3)  ? 6
+                            : (last_non_zero < 9)  ? 5
+                            : (last_non_zero < 10) ? 4
+                            : (last_non_zero < 20) ? 3
+                            : (last_non_zero < 21) ? 2
+                            : (last_non_zero < 35) ? 1
+                                                   : 0;
+          simd::dct_inverse_8x8(d, zeroed_rows);
+        }
+
+        if (num_comp_ == 3) {
+          if (!constant) {
+            simd::csc709_inverse_64(dct[0], dct[1], dct[2]);
+          } else {
+            float y = dct[0][0], cb = dct[1][0], cr = dct[2][0];
+            dct[0][0] = y + 1.5747f * cr;
+            dct[1][0] = y - 0.1873f * cb - 0.4682f * cr;
+            dct[2][0] = y + 1.8556f * cb;
+          }
+        }
+
+        for (int c = 0; c < num_comp_; c++) {
+          uint16_t* out = &row_block[(static_cast<size_t>(c) * static_cast<size_t>(blocks_x) +
+                                      static_cast<size_t>(bx)) * 64];
+          if (!constant) {
+            simd::float_to_half_rne_batch(dct[c], out, 64);
+          } else {
+            uint16_t h = simd::float_to_half_rne_scalar(dct[c][0]);
+            for (int i = 0; i < 64; i++) out[i] = h;
+          }
+        }
+      }
+
+      // Unblock into the output rows, back to linear
+      for (int c = 0; c < num_comp_; c++) {
+        const uint16_t* blocks = &row_block[static_cast<size_t>(c) * static_cast<size_t>(blocks_x) * 64];
+        for (int y = 0; y < max_y; y++) {
+          uint16_t* dst = reinterpret_cast<uint16_t*>(rows_[c][by * 8 + y]);
+          for (int bx = 0; bx < blocks_x; bx++) {
+            const uint16_t* src = blocks + static_cast<size_t>(bx) * 64 + static_cast<size_t>(y) * 8;
+            int n = (bx < full_blocks_x) ? 8 : leftover_x;
+            if (to_linear_) {
+              for (int x = 0; x < n; x++) dst[x] = to_linear_[src[x]];
+            } else {
+              std::memcpy(dst, src, static_cast<size_t>(n) * sizeof(uint16_t));
+            }
+            dst += 8;
+          }
+        }
+      }
+    }
+
+    // FLOAT channels were decoded as half; widen each row in place
+    std::vector<uint16_t> half_row(static_cast<size_t>(width_));
+    for (int c = 0; c < num_comp_; c++) {
+      if (types_[c] != PIXEL_FLOAT) continue;
+      for (int y = 0; y < height_; y++) {
+        std::memcpy(half_row.data(), rows_[c][y], static_cast<size_t>(width_) * sizeof(uint16_t));
+        simd::half_to_float_batch(half_row.data(), reinterpret_cast<float*>(rows_[c][y]),
+                                  static_cast<size_t>(width_));
+      }
+    }
+
+    *dc += plane * static_cast<size_t>(num_comp_);
+    return true;
+  }
+
+ private:
+  // Expand one block's run-length coded AC values into zigzag order
+  static bool UnRleAc(const uint16_t** ac, const uint16_t* ac_end,
+                      uint16_t* zig, int* last_non_zero) {
+    const uint16_t* p = *ac;
+    int comp = 1;
+    while (comp < 64) {
+      if (p >= ac_end) return false;
+      uint16_t v = *p++;
+      if (v == AC_END_OF_BLOCK) {
+        break;
+      } else if ((v >> 8) == 0xff) {
+        comp += v & 0xff;
+      } else {
+        *last_non_zero = comp;
+        zig[comp++] = v;
+      }
+    }
+    *ac = p;
+    return true;
+  }
+
+  int width_;
+  int height_;
+  const uint16_t* to_linear_;  // nullptr for p_linear channels
+  int num_comp_;
+  uint8_t* const* rows_[3];
+  int types_[3];
+};
+
+// Encodes one channel, or a color set of three, appending run-length coded
+// AC values to `ac` and one DC plane per component to `dc`, in the order
+// LossyDctDecoder reads them back.
+class LossyDctEncoder {
+ public:
+  LossyDctEncoder(int width, int height, float level, const float* to_nonlinear)
+      : width_(width), height_(height), to_nonlinear_(to_nonlinear), num_comp_(0) {
+    // Quantization error allowed per coefficient: the JPEG tables scaled by
+    // the level, rounded down to a power-of-two step
+    static const uint8_t kQuantY[64] = {
+        16, 11, 10, 16, 24,  40,  51,  61,  12, 12, 14, 19, 26,  58,  60,  55,
+        14, 13, 16, 24, 40,  57,  69,  56,  14, 17, 22, 29, 51,  87,  80,  62,
+        18, 22, 37, 56, 68,  109, 103, 77,  24, 35, 55, 64, 81,  104, 113, 92,
+        49, 64, 78, 87, 103, 121, 120, 101, 72, 92, 95, 98, 112, 100, 103, 99};
+    static const uint8_t kQuantCbCr[64] = {
+        17, 18, 24, 47, 99, 99, 99, 99, 18, 21, 26, 66, 99, 99, 99, 99,
+        24, 26, 56, 99, 99, 99, 99, 99, 47, 66, 99, 99, 99, 99, 99, 99,
+        99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99,
+        99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99};
+    for (int i = 0; i < 64; i++) {
+      SetStep(&step_y_[i], &inv_step_y_[i], level / 100000.0f * kQuantY[i] / 10.0f);
+      SetStep(&step_c_[i], &inv_step_c_[i], level / 100000.0f * kQuantCbCr[i] / 17.0f);
+    }
+  }
+
+  void AddComponent(const uint8_t* const* rows, int pixel_type) {
+    rows_[num_comp_] = rows;
+    types_[num_comp_] = pixel_type;
+    num_comp_++;
+  }
+
+  void Execute(std::vector<uint16_t>* ac, std::vector<uint16_t>* dc) {
+    if (width_ <= 0 || height_ <= 0) return;
+    const int blocks_x = (width_ + 7) / 8;
+    const int blocks_y = (height_ + 7) / 8;
+    const size_t plane = static_cast<size_t>(blocks_x) * static_cast<size_t>(blocks_y);
+
+    // Every component as a half plane; FLOAT channels are narrowed first
+    std::vector<std::vector<uint16_t> > halves(static_cast<size_t>(num_comp_));
+    std::vector<float> row(static_cast<size_t>(width_));
+    for (int c = 0; c < num_comp_; c++) {
+      std::vector<uint16_t>& h = halves[c];
+      h.resize(static_cast<size_t>(width_) * static_cast<size_t>(height_));
+      for (int y = 0; y < height_; y++) {
+        uint16_t* dst = &h[static_cast<size_t>(y) * static_cast<size_t>(width_)];
+        if (types_[c] == PIXEL_FLOAT) {
+          std::memcpy(row.data(), rows_[c][y], row.size() * sizeof(float));
+          simd::float_to_half_rne_batch(row.data(), dst, row.size());
+        } else {
+          std::memcpy(dst, rows_[c][y], static_cast<size_t>(width_) * sizeof(uint16_t));
+        }
+      }
+    }
+
+    const size_t dc_start = dc->size();
+    dc->resize(dc_start + plane * static_cast<size_t>(num_comp_));
+    float dct[3][64];
+    uint16_t quant[64];
+    uint16_t zig[64];
+
+    for (int by = 0; by < blocks_y; by++) {
+      for (int bx = 0; bx < blocks_x; bx++) {
+        // Gather the block, replicating the last row and column past the edge
+        for (int c = 0; c < num_comp_; c++) {
+          const uint16_t* h = halves[c].data();
+          for (int y = 0; y < 8; y++) {
+            int sy = by * 8 + y < height_ ? by * 8 + y : height_ - 1;
+            const uint16_t* row = h + static_cast<size_t>(sy) * static_cast<size_t>(width_);
+            for (int x = 0; x < 8; x++) {
+              int sx = bx * 8 + x < width_ ? bx * 8 + x : width_ - 1;
+              dct[c][y * 8 + x] = to_nonlinear_ ? to_nonlinear_[row[sx]]
+                                                : simd::half_to_float_scalar(row[sx]);
+            }
+          }
+        }
+
+        if (num_comp_ == 3) simd::csc709_forward_64(dct[0], dct[1], dct[2]);
+
+        for (int c = 0; c < num_comp_; c++) {
+          simd::dct_forward_8x8(dct[c]);
+          if (num_comp_ == 3 && c > 0) {
+            simd::dct_quantize_64(dct[c], step_c_, inv_step_c_);
+          } else {
+            simd::dct_quantize_64(dct[c], step_y_, inv_step_y_);
+          }
+          simd::float_to_half_rne_batch(dct[c], quant, 64);
+          for (int i = 0; i < 64; i++) {
+            // -0 would be coded as a nonzero coefficient
+            zig[kZigZagIndex[i]] = (quant[i] == 0x8000) ? 0 : quant[i];
+          }
+          (*dc)[dc_start + static_cast<size_t>(c) * plane +
+                static_cast<size_t>(by) * static_cast<size_t>(blocks_x) + static_cast<size_t>(bx)] = zig[0];
+          RleAc(zig, ac);
+        }
+      }
+    }
+  }
+
+ private:
+  static void SetStep(float* step, float* inv_step, float tolerance) {
+    // Rounding to a multiple of s errs by at most s / 2 <= tolerance
+    int e = 0;
+    std::frexp(2.0f * tolerance, &e);
+    float s = (tolerance > 0.0f) ? std::ldexp(1.0f, e - 1) : 0.0f;
+    if (s < 5.9604645e-08f) s = 5.9604645e-08f;  // Smallest half subnormal
+    *step = s;
+    *inv_step = 1.0f / s;
+  }
+
+  // Run-length code one block's AC values: zero runs become 0xffNN, a run
+  // to the end of the block AC_END_OF_BLOCK, a single zero stays literal.
+  static void RleAc(const uint16_t* zig, std::vector<uint16_t>* ac) {
+    int comp = 1;
+    while (comp < 64) {
+      if (zig[comp] != 0) {
+        ac->push_back(zig[comp++]);
+        continue;
+      }
+      int run = 1;
+      while (comp + run < 64 && zig[comp + run] == 0) run++;
+      if (run == 1) {
+        ac->push_back(0);
+      } else if (comp + run == 64) {
+        ac->push_back(AC_END_OF_BLOCK);
+      } else {
+        ac->push_back(static_cast<uint16_t>(AC_END_OF_BLOCK | run));
+      }
+      comp += run;
+    }
+  }
+
+  int width_;
+  int height_;
+  const float* to_nonlinear_;  // nullptr for p_linear channels
+  int num_comp_;
+  const uint8_t* const* rows_[3];
+  int types_[3];
+  float step_y_[64], inv_step_y_[64];
+  float step_c_[64], inv_step_c_[64];
+};
+
+// ============================================================================
+// Chunk Decompression
+// ============================================================================
+
+// Decompress a DWAA/DWAB chunk covering pixels [x0, x0 + width) x
+// [y0, y0 + num_lines) into the uncompressed EXR layout (per line, per
+// channel, little-endian) of exactly dst_size bytes. Channels are in header
+// order.
+inline bool Decompress(uint8_t* dst, size_t dst_size,
+                       const uint8_t* src, size_t src_size,
+                       const ChannelInfo* channels, int num_channels,
+                       int x0, int y0, int width, int num_lines) {
+  if (src_size == dst_size) {
+    // Stored uncompressed
+    std::memcpy(dst, src, src_size);
+    return true;
+  }
+  if (!dst || !src || !channels || num_channels <= 0 || width <= 0 || num_lines <= 0 ||
+      src_size < HEADER_SIZE) {
+    return false;
+  }
+
+  uint64_t hdr[NUM_HEADER_FIELDS];
+  for (int i = 0; i < NUM_HEADER_FIELDS; i++) hdr[i] = ReadU64LE(src + i * 8);
+  const uint64_t version = hdr[HDR_VERSION];
+  if (version > 2) return false;
+
+  // Version 2 stores its classification rules; earlier ones imply them
+  size_t offset = HEADER_SIZE;
+  std::vector<ClassifierRule> rules;
+  if (version < 2) {
+    LegacyRules(&rules);
+  } else {
+    if (src_size - offset < 2) return false;
+    size_t rule_size = static_cast<size_t>(src[offset]) | (static_cast<size_t>(src[offset + 1]) << 8);
+    if (rule_size < 2 || rule_size > src_size - offset) return false;
+    if (!ParseRules(src + offset + 2, rule_size - 2, &rules)) return false;
+    offset += rule_size;
+  }
+
+  // Compressed sections follow in this order; all must fit in the chunk
+  const uint64_t unknown_size = hdr[HDR_UNKNOWN_COMPRESSED_SIZE];
+  const uint64_t ac_size = hdr[HDR_AC_COMPRESSED_SIZE];
+  const uint64_t dc_size = hdr[HDR_DC_COMPRESSED_SIZE];
+  const uint64_t rle_size = hdr[HDR_RLE_COMPRESSED_SIZE];
+  const uint64_t avail = src_size - offset;
+  if (unknown_size > avail || ac_size > avail - unknown_size ||
+      dc_size > avail - unknown_size - ac_size ||
+      rle_size > avail - unknown_size - ac_size - dc_size) {
+    return false;
+  }
+  const uint8_t* unknown_src = src + offset;
+  const uint8_t* ac_src = unknown_src + unknown_size;
+  const uint8_t* dc_src = ac_src + ac_size;
+  const uint8_t* rle_src = dc_src + dc_size;
+
+  std::vector<int> schemes;
+  std::vector<CscSet> csc_sets;
+  ClassifyChannels(channels, num_channels, rules, &schemes, &csc_sets);
+
+  // Per-channel geometry, planar offsets and output rows
+  const int x1 = x0 + width - 1;
+  const int y1 = y0 + num_lines - 1;
+  std::vector<int> widths(static_cast<size_t>(num_channels));
+  std::vector<int> heights(static_cast<size_t>(num_channels));
+  std::vector<size_t> planar_offset(static_cast<size_t>(num_channels), 0);
+  std::vector<std::vector<uint8_t*> > rows(static_cast<size_t>(num_channels));
+  size_t planar_size[NUM_SCHEMES] = {0, 0, 0};
+  uint64_t max_dc = 0, max_ac = 0;
+  for (int c = 0; c < num_channels; c++) {
+    const ChannelInfo& ch = channels[c];
+    if (ch.x_sampling < 1 || ch.y_sampling < 1 ||
+        ch.pixel_type < PIXEL_UINT || ch.pixel_type > PIXEL_FLOAT) {
+      return false;
+    }
+    widths[c] = NumSamples(ch.x_sampling, x0, x1);
+    heights[c] = NumSamples(ch.y_sampling, y0, y1);
+    size_t samples = static_cast<size_t>(widths[c]) * static_cast<size_t>(heights[c]);
+    if (schemes[c] == SCHEME_LOSSY_DCT) {
+      if (ch.pixel_type == PIXEL_UINT) return false;
+      uint64_t blocks = static_cast<uint64_t>((widths[c] + 7) / 8) *
+                        static_cast<uint64_t>((heights[c] + 7) / 8);
+      max_dc += blocks;
+      max_ac += blocks * 63;
+    } else {
+      planar_offset[c] = planar_size[schemes[c]];
+      planar_size[schemes[c]] += samples * static_cast<size_t>(PixelSize(ch.pixel_type));
+    }
+  }
+  size_t out_size = 0;
+  for (int y = y0; y <= y1; y++) {
+    for (int c = 0; c < num_channels; c++) {
+      if (ModFloor(y, channels[c].y_sampling) != 0) continue;
+      size_t row_bytes = static_cast<size_t>(widths[c]) *
+                         static_cast<size_t>(PixelSize(channels[c].pixel_type));
+      if (row_bytes > dst_size - out_size) return false;
+      rows[c].push_back(dst + out_size);
+      out_size += row_bytes;
+    }
+  }
+  if (out_size != dst_size) return false;
+
+  // UNKNOWN: zlib into the planar buffer
+  std::vector<uint8_t> unknown(planar_size[SCHEME_UNKNOWN]);
+  if (unknown_size > 0 || !unknown.empty()) {
+    size_t n = unknown.size();
+    if (hdr[HDR_UNKNOWN_UNCOMPRESSED_SIZE] != n ||
+        !huffman::inflate_zlib(unknown_src, static_cast<size_t>(unknown_size), unknown.data(), &n) ||
+        n != unknown.size()) {
+      return false;
+    }
+  }
+
+  // AC: static Huffman or zlib
+  const uint64_t ac_count = hdr[HDR_AC_UNCOMPRESSED_COUNT];
+  if (ac_count > max_ac) return false;
+  std::vector<uint16_t> ac(static_cast<size_t>(ac_count));
+  if (ac_count > 0) {
+    if (hdr[HDR_AC_COMPRESSION] == AC_STATIC_HUFFMAN) {
+      if (!huffman::huf_uncompress(ac_src, static_cast<size_t>(ac_size), ac.data(), ac.size())) {
+        return false;
+      }
+    } else if (hdr[HDR_AC_COMPRESSION] == AC_DEFLATE) {
+      size_t n = ac.size() * sizeof(uint16_t);
+      if (!huffman::inflate_zlib(ac_src, static_cast<size_t>(ac_size),
+                                 reinterpret_cast<uint8_t*>(ac.data()), &n) ||
+          n != ac.size() * sizeof(uint16_t)) {
+        return false;
+      }
+    } else {
+      return false;
+    }
+  }
+
+  // DC: zlib with the ZIP predictor and byte split
+  const uint64_t dc_count = hdr[HDR_DC_UNCOMPRESSED_COUNT];
+  if (dc_count > max_dc) return false;
+  std::vector<uint16_t> dc(static_cast<size_t>(dc_count));
+  if (dc_count > 0) {
+    std::vector<uint8_t> tmp(dc.size() * sizeof(uint16_t));
+    size_t n = tmp.size();
+    if (!huffman::inflate_zlib(dc_src, static_cast<size_t>(dc_size), tmp.data(), &n) ||
+        n != tmp.size()) {
+      return false;
+    }
+    simd::predictor_unreorder(tmp.data(), reinterpret_cast<uint8_t*>(dc.data()), n);
+  }
+
+  // RLE: zlib, then run-length, into byte planes per channel
+  std::vector<uint8_t> rle(planar_size[SCHEME_RLE]);
+  if (hdr[HDR_RLE_RAW_SIZE] != rle.size()) return false;
+  if (!rle.empty()) {
+    const uint64_t packed_size = hdr[HDR_RLE_UNCOMPRESSED_SIZE];
+    if (packed_size == 0 || packed_size > rle.size() * 2 + 2) return false;
+    std::vector<uint8_t> packed(static_cast<size_t>(packed_size));
+    size_t n = packed.size();
+    if (!huffman::inflate_zlib(rle_src, static_cast<size_t>(rle_size), packed.data(), &n) ||
+        n != packed.size() ||
+        !RleUncompress(packed.data(), packed.size(), rle.data(), rle.size())) {
+      return false;
+    }
+  }
+
+  // Lossy DCT: color sets first, then single channels, in the order the
+  // encoder consumed the AC and DC streams
+  const uint16_t* ac_ptr = ac.data();
+  const uint16_t* ac_end = ac_ptr + ac.size();
+  const uint16_t* dc_ptr = dc.data();
+  const uint16_t* dc_end = dc_ptr + dc.size();
+  std::vector<bool> decoded(static_cast<size_t>(num_channels), false);
+  for (size_t s = 0; s < csc_sets.size(); s++) {
+    const int* idx = csc_sets[s].idx;
+    for (int i = 0; i < 3; i++) {
+      if (schemes[idx[i]] != SCHEME_LOSSY_DCT) return false;
+    }
+    LossyDctDecoder decoder(widths[idx[0]], heights[idx[0]], ToLinearTable());
+    for (int i = 0; i < 3; i++) {
+      decoder.AddComponent(rows[idx[i]].data(), channels[idx[i]].pixel_type);
+      decoded[idx[i]] = true;
+    }
+    if (!decoder.Execute(&ac_ptr, ac_end, &dc_ptr, dc_end)) return false;
+  }
+
+  for (int c = 0; c < num_channels; c++) {
+    if (decoded[c]) continue;
+    const size_t pixel_size = static_cast<size_t>(PixelSize(channels[c].pixel_type));
+    const size_t row_bytes = static_cast<size_t>(widths[c]) * pixel_size;
+
+    if (schemes[c] == SCHEME_LOSSY_DCT) {
+      LossyDctDecoder decoder(widths[c], heights[c],
+                              channels[c].p_linear ? nullptr : ToLinearTable());
+      decoder.AddComponent(rows[c].data(), channels[c].pixel_type);
+      if (!decoder.Execute(&ac_ptr, ac_end, &dc_ptr, dc_end)) return false;
+    } else if (schemes[c] == SCHEME_RLE) {
+      // One plane per byte of the pixel, interleave them back
+      const size_t plane = static_cast<size_t>(widths[c]) * static_cast<size_t>(heights[c]);
+      const uint8_t* base = rle.data() + planar_offset[c];
+      for (size_t r = 0; r < rows[c].size(); r++) {
+        uint8_t* out = rows[c][r];
+        const size_t row_start = r * static_cast<size_t>(widths[c]);
+        for (size_t x = 0; x < static_cast<size_t>(widths[c]); x++) {
+          for (size_t b = 0; b < pixel_size; b++) {
+            out[x * pixel_size + b] = base[b * plane + row_start + x];
+          }
+        }
+      }
+    } else {
+      const uint8_t* base = unknown.data() + planar_offset[c];
+      for (size_t r = 0; r < rows[c].size(); r++) {
+        std::memcpy(rows[c][r], base + r * row_bytes, row_bytes);
+      }
+    }
+  }
+  return true;
+}
+
+// ============================================================================
+// Chunk Compression
+// ============================================================================
+
+// Deflate n bytes onto the end of `out` and store the stream size in `size`
+inline bool DeflateSection(const uint8_t* p, size_t n, int zlib_level,
+                           std::vector<uint8_t>* out, uint64_t* size) {
+  *size = 0;
+  if (n == 0) return true;
+  const size_t start = out->size();
+  out->resize(start + huffman::deflate_zlib_bound(n));
+  size_t written = huffman::deflate_zlib(p, n, out->data() + start, out->size() - start, zlib_level);
+  if (written == 0) return false;
+  out->resize(start + written);
+  *size = written;
+  return true;
+}
+
+// Compress `num_lines` lines of `width` pixels starting at (x0, y0), given
+// in the uncompressed EXR layout, into a version 2 DWAA/DWAB chunk. `level`
+// is the dwaCompressionLevel attribute (higher is smaller and lossier) and
+// zlib_level the deflate effort. When compression does not pay off the
+// input is stored as is, which Decompress recognizes by its size.
+inline bool Compress(const uint8_t* src, size_t src_size,
+                     const ChannelInfo* channels, int num_channels,
+                     int x0, int y0, int width, int num_lines,
+                     float level, int zlib_level, std::vector<uint8_t>* dst) {
+  if (!src || !channels || !dst || num_channels <= 0 || width <= 0 || num_lines <= 0) {
+    return false;
+  }
+  if (!(level >= 0.0f) || !std::isfinite(level)) level = DEFAULT_COMPRESSION_LEVEL;
+
+  std::vector<ClassifierRule> rules;
+  DefaultRules(&rules);
+  std::vector<int> schemes;
+  std::vector<CscSet> csc_sets;
+  ClassifyChannels(channels, num_channels, rules, &schemes, &csc_sets);
+
+  // Per-channel geometry, planar offsets and input rows, as in Decompress
+  const int x1 = x0 + width - 1;
+  const int y1 = y0 + num_lines - 1;
+  std::vector<int> widths(static_cast<size_t>(num_channels));
+  std::vector<int> heights(static_cast<size_t>(num_channels));
+  std::vector<size_t> planar_offset(static_cast<size_t>(num_channels), 0);
+  std::vector<std::vector<const uint8_t*> > rows(static_cast<size_t>(num_channels));
+  size_t planar_size[NUM_SCHEMES] = {0, 0, 0};
+  for (int c = 0; c < num_channels; c++) {
+    const ChannelInfo& ch = channels[c];
+    if (ch.x_sampling < 1 || ch.y_sampling < 1 ||
+        ch.pixel_type < PIXEL_UINT || ch.pixel_type > PIXEL_FLOAT) {
+      return false;
+    }
+    widths[c] = NumSamples(ch.x_sampling, x0, x1);
+    heights[c] = NumSamples(ch.y_sampling, y0, y1);
+    if (schemes[c] != SCHEME_LOSSY_DCT) {
+      planar_offset[c] = planar_size[schemes[c]];
+      planar_size[schemes[c]] += static_cast<size_t>(widths[c]) * static_cast<size_t>(heights[c]) *
+                                 static_cast<size_t>(PixelSize(ch.pixel_type));
+    }
+  }
+  size_t in_size = 0;
+  for (int y = y0; y <= y1; y++) {
+    for (int c = 0; c < num_channels; c++) {
+      if (ModFloor(y, channels[c].y_sampling) != 0) continue;
+      size_t row_bytes = static_cast<size_t>(widths[c]) *
+                         static_cast<size_t>(PixelSize(channels[c].pixel_type));
+      if (row_bytes > src_size - in_size) return false;
+      rows[c].push_back(src + in_size);
+      in_size += row_bytes;
+    }
+  }
+  if (in_size != src_size) return false;
+
+  // Lossy DCT: color sets first, then single channels
+  std::vector<uint16_t> ac, dc;
+  std::vector<bool> encoded(static_cast<size_t>(num_channels), false);
+  for (size_t s = 0; s < csc_sets.size(); s++) {
+    const int* idx = csc_sets[s].idx;
+    LossyDctEncoder encoder(widths[idx[0]], heights[idx[0]], level, ToNonlinearTable());
+    for (int i = 0; i < 3; i++) {
+      encoder.AddComponent(rows[idx[i]].data(), channels[idx[i]].pixel_type);
+      encoded[idx[i]] = true;
+    }
+    encoder.Execute(&ac, &dc);
+  }
+
+  std::vector<uint8_t> unknown(planar_size[SCHEME_UNKNOWN]);
+  std::vector<uint8_t> rle(planar_size[SCHEME_RLE]);
+  for (int c = 0; c < num_channels; c++) {
+    if (encoded[c]) continue;
+    const size_t pixel_size = static_cast<size_t>(PixelSize(channels[c].pixel_type));
+    const size_t row_bytes = static_cast<size_t>(widths[c]) * pixel_size;
+
+    if (schemes[c] == SCHEME_LOSSY_DCT) {
+      LossyDctEncoder encoder(widths[c], heights[c], level,
+                              channels[c].p_linear ? nullptr : ToNonlinearTable());
+      encoder.AddComponent(rows[c].data(), channels[c].pixel_type);
+      encoder.Execute(&ac, &dc);
+    } else if (schemes[c] == SCHEME_RLE) {
+      // One plane per byte of the pixel
+      const size_t plane = static_cast<size_t>(widths[c]) * static_cast<size_t>(heights[c]);
+      uint8_t* base = rle.data() + planar_offset[c];
+      for (size_t r = 0; r < rows[c].size(); r++) {
+        const uint8_t* in = rows[c][r];
+        const size_t row_start = r * static_cast<size_t>(widths[c]);
+        for (size_t x = 0; x < static_cast<size_t>(widths[c]); x++) {
+          for (size_t b = 0; b < pixel_size; b++) {
+            base[b * plane + row_start + x] = in[x * pixel_size + b];
+          }
+        }
+      }
+    } else {
+      uint8_t* base = unknown.data() + planar_offset[c];
+      for (size_t r = 0; r < rows[c].size(); r++) {
+        std::memcpy(base + r * row_bytes, rows[c][r], row_bytes);
+      }
+    }
+  }
+
+  uint64_t hdr[NUM_HEADER_FIELDS] = {0};
+  hdr[HDR_VERSION] = 2;
+  hdr[HDR_AC_COMPRESSION] = AC_DEFLATE;
+
+  std::vector<uint8_t> out(HEADER_SIZE, 0);
+  std::vector<uint8_t> rule_bytes;
+  WriteRules(rules, &rule_bytes);
+  const size_t rule_size = rule_bytes.size() + 2;
+  out.push_back(static_cast<uint8_t>(rule_size & 0xff));
+  out.push_back(static_cast<uint8_t>(rule_size >> 8));
+  out.insert(out.end(), rule_bytes.begin(), rule_bytes.end());
+
+  hdr[HDR_UNKNOWN_UNCOMPRESSED_SIZE] = unknown.size();
+  if (!DeflateSection(unknown.data(), unknown.size(), zlib_level, &out,
+                      &hdr[HDR_UNKNOWN_COMPRESSED_SIZE])) {
+    return false;
+  }
+
+  hdr[HDR_AC_UNCOMPRESSED_COUNT] = ac.size();
+  if (!DeflateSection(reinterpret_cast<const uint8_t*>(ac.data()), ac.size() * sizeof(uint16_t),
+                      zlib_level, &out, &hdr[HDR_AC_COMPRESSED_SIZE])) {
+    return false;
+  }
+
+  // DC: byte split and delta predictor, as in ZIP
+  hdr[HDR_DC_UNCOMPRESSED_COUNT] = dc.size();
+  if (!dc.empty()) {
+    const size_t n = dc.size() * sizeof(uint16_t);
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(dc.data());
+    std::vector<uint8_t> tmp(n);
+    for (size_t i = 0; i < n; i++) tmp[(i & 1) ? (n + 1) / 2 + i / 2 : i / 2] = bytes[i];
+    for (size_t i = n - 1; i > 0; i--) tmp[i] = static_cast<uint8_t>(tmp[i] - tmp[i - 1] + 128);
+    if (!DeflateSection(tmp.data(), n, zlib_level, &out, &hdr[HDR_DC_COMPRESSED_SIZE])) {
+      return false;
+    }
+  }
+
+  hdr[HDR_RLE_RAW_SIZE] = rle.size();
+  if (!rle.empty()) {
+    std::vector<uint8_t> packed;
+    RleCompress(rle.data(), rle.size(), &packed);
+    hdr[HDR_RLE_UNCOMPRESSED_SIZE] = packed.size();
+    if (!DeflateSection(packed.data(), packed.size(), zlib_level, &out,
+                        &hdr[HDR_RLE_COMPRESSED_SIZE])) {
+      return false;
+    }
+  }
+
+  if (out.size() >= src_size) {
+    dst->assign(src, src + src_size);
+    return true;
+  }
+  for (int i = 0; i < NUM_HEADER_FIELDS; i++) WriteU64LE(out.data() + i * 8, hdr[i]);
+  dst->swap(out);
+  return true;
+}
+
+}  // namespace dwa
+}  // namespace tinyexr
+
+#endif  // TINYEXR_DWA_HH_
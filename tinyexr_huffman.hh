@@ -311,53 +311,40 @@ TINYEXR_ALWAYS_INLINE uint64_t bswap64(uint64_t x) {
 // Fast Bit Buffer
 // ============================================================================
 
-// 64-bit bit buffer for efficient bit reading
-// Stores bits in big-endian order (MSB first)
+// 64-bit MSB-first bit reader for PIZ Huffman streams. The next unread bit
+// is the top bit of `bits`; `count` bits are valid.
 struct BitBuffer {
-  uint64_t bits;     // Current bit buffer
-  int32_t count;     // Number of valid bits in buffer
-  const uint8_t* ptr;  // Current read position
-  const uint8_t* end;  // End of input
+  uint64_t bits;       // Current bit buffer
+  int32_t count;       // Number of valid bits in buffer
+  const uint8_t* ptr;  // Next byte not yet accounted for in `count`
 
-  BitBuffer() : bits(0), count(0), ptr(nullptr), end(nullptr) {}
+  BitBuffer() : bits(0), count(0), ptr(nullptr) {}
 
-  BitBuffer(const uint8_t* data, const uint8_t* data_end)
-    : bits(0), count(0), ptr(data), end(data_end) {}
-
-  BitBuffer(const uint8_t* data, size_t size)
-    : bits(0), count(0), ptr(data), end(data + size) {}
-
-  TINYEXR_ALWAYS_INLINE void init(const uint8_t* data, size_t size) {
+  // Start reading at bit `pos` of `data`; needs 8 readable bytes at the
+  // byte containing `pos`.
+  TINYEXR_ALWAYS_INLINE void seek(const uint8_t* data, size_t pos) {
     bits = 0;
     count = 0;
-    ptr = data;
-    end = data + size;
-  }
-
-  // Refill buffer to have at least 32 bits (if possible)
-  TINYEXR_ALWAYS_INLINE void refill() {
-    while (count <= 56 && ptr < end) {
-      bits |= static_cast<uint64_t>(*ptr++) << (56 - count);
-      count += 8;
-    }
+    ptr = data + (pos >> 3);
+    refill_fast();
+    consume(static_cast<int>(pos & 7));
   }
 
-  // Refill buffer with exactly 8 bytes (fast path)
+  // Branchless refill to 56..63 bits; needs 8 readable bytes at ptr.
+  // Bits below `count` may hold the start of the next byte, which the
+  // following refill ORs in again at the same position.
   TINYEXR_ALWAYS_INLINE void refill_fast() {
-    if (TINYEXR_LIKELY(ptr + 8 <= end)) {
-      // Read 8 bytes at once
-      uint64_t new_bits;
-      std::memcpy(&new_bits, ptr, 8);
-      new_bits = bswap64(new_bits);
-      bits = new_bits;
-      ptr += (64 - count) / 8;
-      count = 64;
-    } else {
-      refill();
-    }
+    uint64_t word;
+    std::memcpy(&word, ptr, 8);
+#if !defined(__BYTE_ORDER__) || (__BYTE_ORDER__ != __ORDER_BIG_ENDIAN__)
+    word = bswap64(word);
+#endif
+    bits |= word >> count;
+    ptr += (63 - count) >> 3;
+    count |= 56;
   }
 
-  // Peek n bits without consuming
+  // Peek n bits (MSB) without consuming
   TINYEXR_ALWAYS_INLINE uint32_t peek(int n) const {
     return static_cast<uint32_t>(bits >> (64 - n));
   }
@@ -368,16 +355,9 @@ struct BitBuffer {
     count -= n;
   }
 
-  // Read n bits (peek + consume)
-  TINYEXR_ALWAYS_INLINE uint32_t read(int n) {
-    uint32_t result = peek(n);
-    consume(n);
-    return result;
-  }
-
-  // Check if more data available
-  TINYEXR_ALWAYS_INLINE bool has_data() const {
-    return count > 0 || ptr < end;
+  // Bit offset of the next unread bit from `data`
+  TINYEXR_ALWAYS_INLINE size_t position(const uint8_t* data) const {
+    return static_cast<size_t>(ptr - data) * 8 - static_cast<size_t>(count);
   }
 };
 
@@ -387,203 +367,323 @@ struct BitBuffer {
 
 // Constants from OpenEXR Huffman coding
 static const int HUF_ENCBITS = 16;  // literal (value) bit length
-static const int HUF_DECBITS = 14;  // decoding bit size
 static const int HUF_ENCSIZE = (1 << HUF_ENCBITS) + 1;
-static const int HUF_DECSIZE = 1 << HUF_DECBITS;
-static const int HUF_DECMASK = HUF_DECSIZE - 1;
-
-// Optimized decoding table entry
-// Packed for cache efficiency
-struct HufDecFast {
-  uint16_t symbol;   // Decoded symbol (or first symbol for long codes)
-  uint8_t len;       // Code length (0 = long code)
-  uint8_t count;     // Number of symbols for long codes
-  const uint32_t* longs;  // Long code table (symbol | len<<16)
-};
-
-// Fast Huffman decoder
-class FastHuffmanDecoder {
-public:
-  FastHuffmanDecoder() : table_(nullptr), long_table_(nullptr) {}
-
-  ~FastHuffmanDecoder() {
-    delete[] table_;
-    delete[] long_table_;
+static const int HUF_MAX_CODE_LEN = 58;
+static const int HUF_SHORT_ZEROCODE_RUN = 59;
+static const int HUF_LONG_ZEROCODE_RUN = 63;
+static const int HUF_SHORTEST_LONG_RUN =
+    2 + HUF_LONG_ZEROCODE_RUN - HUF_SHORT_ZEROCODE_RUN;
+
+// Codes up to HUF_TABLE_BITS long decode with one lookup. 12 bits keeps the
+// table at 16 KB while covering nearly every symbol of real images.
+static const int HUF_TABLE_BITS = 12;
+static const uint32_t HUF_TABLE_LONG = 0x80;  // Only longer codes here
+
+// Read nBits from the packed code length table, MSB first
+TINYEXR_ALWAYS_INLINE bool huf_table_bits(int nBits, uint64_t& c, int& lc,
+                                          const uint8_t*& in,
+                                          const uint8_t* in_end,
+                                          uint32_t& value) {
+  while (lc < nBits) {
+    if (in >= in_end) return false;
+    c = (c << 8) | *in++;
+    lc += 8;
   }
+  lc -= nBits;
+  value = static_cast<uint32_t>(c >> lc) & ((1u << nBits) - 1);
+  return true;
+}
 
-  // Build decoding table from encoding table
-  bool build(const int64_t* encoding_table, int im, int iM) {
-    delete[] table_;
-    delete[] long_table_;
-
-    table_ = new HufDecFast[HUF_DECSIZE];
-    std::memset(table_, 0, sizeof(HufDecFast) * HUF_DECSIZE);
+// Repeat `value` `run` times (run-length symbol)
+TINYEXR_ALWAYS_INLINE uint16_t* huf_fill_run(uint16_t* out, uint16_t value,
+                                             uint32_t run) {
+#if defined(TINYEXR_ENABLE_SIMD) && TINYEXR_ENABLE_SIMD
+  return tinyexr::simd::fill_u16_simd(out, value, run);
+#else
+  for (uint32_t j = 0; j < run; j++) out[j] = value;
+  return out + run;
+#endif
+}
 
-    // Count long codes
-    size_t long_count = 0;
+// Table-driven decoder for the canonical, MSB-first PIZ Huffman codes.
+//
+// Primary table entries hold `symbol << 8 | length` for codes of up to
+// HUF_TABLE_BITS, HUF_TABLE_LONG where the prefix only starts longer codes
+// and 0 where no code starts. Canonical PIZ codes of one length are
+// consecutive and longer lengths take numerically smaller codes, so a long
+// code is found as the shortest length whose first code, left-justified,
+// is not above the 64-bit bit window.
+class FastHuffmanDecoder {
+public:
+  FastHuffmanDecoder() : rlc_(0), num_long_(0) {}
+
+  // Unpack the code lengths of symbols im..iM from `ptr` (advanced past
+  // the packed table) and build the decoding tables. Rejects truncated
+  // tables and lengths that do not form a prefix code.
+  bool build(const uint8_t*& ptr, size_t size, int im, int iM) {
+    if (im < 0 || iM >= HUF_ENCSIZE || im > iM || size == 0) return false;
+
+    std::vector<uint8_t> lens(static_cast<size_t>(iM - im + 1), 0);
+    const uint8_t* in = ptr;
+    const uint8_t* in_end = ptr + size;
+    uint64_t c = 0;
+    int lc = 0;
     for (int i = im; i <= iM; i++) {
-      int len = encoding_table[i] & 63;
-      if (len > HUF_DECBITS) {
-        long_count++;
+      uint32_t l;
+      if (!huf_table_bits(6, c, lc, in, in_end, l)) return false;
+      if (l == HUF_LONG_ZEROCODE_RUN) {
+        uint32_t zerun;
+        if (!huf_table_bits(8, c, lc, in, in_end, zerun)) return false;
+        zerun += HUF_SHORTEST_LONG_RUN;
+        if (i + static_cast<int>(zerun) > iM + 1) return false;
+        i += static_cast<int>(zerun) - 1;
+      } else if (l >= HUF_SHORT_ZEROCODE_RUN) {
+        int zerun = static_cast<int>(l) - HUF_SHORT_ZEROCODE_RUN + 2;
+        if (i + zerun > iM + 1) return false;
+        i += zerun - 1;
+      } else {
+        lens[static_cast<size_t>(i - im)] = static_cast<uint8_t>(l);
       }
     }
+    ptr = in;
+
+    // Canonical code assignment (see hufCanonicalCodeTable)
+    uint64_t n[HUF_MAX_CODE_LEN + 1] = {0};
+    for (size_t i = 0; i < lens.size(); i++) n[lens[i]]++;
+    uint64_t start[HUF_MAX_CODE_LEN + 1] = {0};
+    uint64_t code = 0;
+    for (int l = HUF_MAX_CODE_LEN; l > 0; l--) {
+      start[l] = code;
+      code = (code + n[l]) >> 1;
+    }
+
+    // Code ranges must be disjoint: walking from the longest length up,
+    // each range starts at or above where the previous one ended.
+    uint64_t prev_end = 0;
+    bool full = false;
+    for (int l = HUF_MAX_CODE_LEN; l > 0; l--) {
+      if (n[l] == 0) continue;
+      if (full || start[l] + n[l] > (1ULL << l)) return false;
+      uint64_t base = start[l] << (64 - l);
+      if (base < prev_end) return false;
+      uint64_t end = start[l] + n[l];
+      full = (end == (1ULL << l));
+      prev_end = full ? 0 : end << (64 - l);
+    }
 
-    if (long_count > 0) {
-      long_table_ = new uint32_t[long_count * 2];  // Extra space
+    // Long code lengths, shortest first, with their symbol ranges
+    num_long_ = 0;
+    uint32_t long_total = 0;
+    uint32_t long_offset[HUF_MAX_CODE_LEN + 1] = {0};
+    for (int l = HUF_TABLE_BITS + 1; l <= HUF_MAX_CODE_LEN; l++) {
+      if (n[l] == 0) continue;
+      long_len_[num_long_] = static_cast<uint8_t>(l);
+      long_base_[num_long_] = start[l] << (64 - l);
+      long_start_[num_long_] = start[l];
+      long_count_[num_long_] = static_cast<uint32_t>(n[l]);
+      long_first_[num_long_] = long_total;
+      long_offset[l] = long_total;
+      long_total += static_cast<uint32_t>(n[l]);
+      num_long_++;
     }
-    size_t long_idx = 0;
+    long_symbols_.resize(long_total);
 
-    // Build table
+    table_.assign(static_cast<size_t>(1) << HUF_TABLE_BITS, 0);
+    uint64_t next[HUF_MAX_CODE_LEN + 1];
+    std::memcpy(next, start, sizeof(next));
     for (int i = im; i <= iM; i++) {
-      int64_t code_info = encoding_table[i];
-      if (code_info == 0) continue;
-
-      int len = static_cast<int>(code_info & 63);
-      int64_t code = code_info >> 6;
-
-      if (len <= 0 || len > 58) continue;
-
-      if (len <= HUF_DECBITS) {
-        // Short code - fill all table entries
-        int shift = HUF_DECBITS - len;
-        uint32_t base = static_cast<uint32_t>(code << shift);
-        uint32_t count = 1U << shift;
-
-        for (uint32_t j = 0; j < count; j++) {
-          HufDecFast& entry = table_[base + j];
-          entry.symbol = static_cast<uint16_t>(i);
-          entry.len = static_cast<uint8_t>(len);
-          entry.count = 0;
-          entry.longs = nullptr;
-        }
+      int l = lens[static_cast<size_t>(i - im)];
+      if (l == 0) continue;
+      uint64_t cd = next[l]++;
+      if (l <= HUF_TABLE_BITS) {
+        uint32_t entry = (static_cast<uint32_t>(i) << 8) | static_cast<uint32_t>(l);
+        size_t first = static_cast<size_t>(cd) << (HUF_TABLE_BITS - l);
+        size_t num = static_cast<size_t>(1) << (HUF_TABLE_BITS - l);
+        for (size_t j = 0; j < num; j++) table_[first + j] = entry;
       } else {
-        // Long code - add to appropriate table entry
-        int prefix_len = HUF_DECBITS;
-        uint32_t prefix = static_cast<uint32_t>(code >> (len - prefix_len));
-
-        HufDecFast& entry = table_[prefix];
-        if (entry.len == 0 && entry.longs == nullptr) {
-          // First long code for this prefix
-          entry.len = 0;
-          entry.count = 1;
-          entry.longs = &long_table_[long_idx];
-          long_table_[long_idx++] = static_cast<uint32_t>(i) | (static_cast<uint32_t>(len) << 16);
-        } else if (entry.len == 0) {
-          // Additional long code
-          entry.count++;
-          long_table_[long_idx++] = static_cast<uint32_t>(i) | (static_cast<uint32_t>(len) << 16);
-        }
+        table_[static_cast<size_t>(cd >> (l - HUF_TABLE_BITS))] = HUF_TABLE_LONG;
+        long_symbols_[long_offset[l] + static_cast<uint32_t>(cd - start[l])] =
+            static_cast<uint32_t>(i);
       }
     }
 
+    rlc_ = static_cast<uint32_t>(iM);
     return true;
   }
 
-  // Decode a single symbol
-  TINYEXR_ALWAYS_INLINE bool decode_symbol(BitBuffer& buf, uint16_t& symbol) const {
-    // Ensure we have enough bits
-    if (buf.count < HUF_DECBITS) {
-      buf.refill();
-      if (buf.count < 1) return false;
-    }
-
-    // Table lookup
-    uint32_t idx = buf.peek(HUF_DECBITS) & HUF_DECMASK;
-    const HufDecFast& entry = table_[idx];
+  // Decode exactly `nout` values from the first `nbits` bits of `in`.
+  // Symbol iM is the run-length code: the next 8 bits repeat the previous
+  // value. Bits left over after the last value are ignored.
+  bool decode(const uint8_t* in, size_t nbits, uint16_t* out,
+              size_t nout) const {
+    uint16_t* const outb = out;
+    uint16_t* const oe = out + nout;
+    const uint8_t* const ie = in + (nbits + 7) / 8;
+    const uint32_t* table = table_.data();
+    const uint32_t rlc = rlc_;
+
+    // Fast loop: one refill yields at least 56 bits, enough for two table
+    // codes with a run byte. Stopping 9 bytes short of the end keeps every
+    // consumed bit inside `nbits`.
+    BitBuffer buf;
+    size_t pos = 0;
+    if (ie - in >= 9) {
+      buf.seek(in, 0);
+      for (;;) {
+        if (ie - buf.ptr < 9 || oe - out < 2) {
+          pos = buf.position(in);
+          break;
+        }
+        buf.refill_fast();
+
+        uint32_t entry = table[buf.peek(HUF_TABLE_BITS)];
+        uint32_t len = entry & 0xFF;
+        if (TINYEXR_LIKELY(len - 1 < HUF_TABLE_BITS && (entry >> 8) != rlc)) {
+          buf.consume(static_cast<int>(len));
+          *out++ = static_cast<uint16_t>(entry >> 8);
+          entry = table[buf.peek(HUF_TABLE_BITS)];
+          len = entry & 0xFF;
+          if (TINYEXR_LIKELY(len - 1 < HUF_TABLE_BITS && (entry >> 8) != rlc)) {
+            buf.consume(static_cast<int>(len));
+            *out++ = static_cast<uint16_t>(entry >> 8);
+            continue;
+          }
+        }
 
-    if (TINYEXR_LIKELY(entry.len > 0)) {
-      // Short code - fast path
-      symbol = entry.symbol;
-      buf.consume(entry.len);
-      return true;
+        if (len - 1 < HUF_TABLE_BITS) {
+          // Run of the previous value
+          buf.consume(static_cast<int>(len));
+          uint32_t run = buf.peek(8);
+          buf.consume(8);
+          if (TINYEXR_UNLIKELY(out == outb || run > static_cast<size_t>(oe - out))) {
+            return false;
+          }
+          out = huf_fill_run(out, out[-1], run);
+        } else {
+          // Long or invalid code
+          pos = buf.position(in);
+          if (!decode_careful(in, ie, nbits, pos, outb, out, oe)) return false;
+          if (ie - (in + (pos >> 3)) < 9) break;
+          buf.seek(in, pos);
+        }
+      }
     }
 
-    if (TINYEXR_UNLIKELY(entry.longs == nullptr)) {
-      return false;  // Invalid code
+    while (out < oe) {
+      if (pos >= nbits) return false;
+      if (!decode_careful(in, ie, nbits, pos, outb, out, oe)) return false;
     }
+    return true;
+  }
 
-    // Long code - search
-    for (uint32_t i = 0; i < entry.count; i++) {
-      uint32_t packed = entry.longs[i];
-      uint16_t sym = static_cast<uint16_t>(packed & 0xFFFF);
-      int len = static_cast<int>(packed >> 16);
-
-      // Ensure we have enough bits
-      while (buf.count < len && buf.ptr < buf.end) {
-        buf.refill();
-      }
-
-      if (buf.count >= len) {
-        // Check if code matches
-        // Need to get the actual code from encoding table
-        // For now, use simple matching
-        symbol = sym;
-        buf.consume(len);
-        return true;
-      }
+private:
+  // Left-justified 64-bit window at bit `pos`, zero past `ie`
+  static uint64_t window(const uint8_t* in, const uint8_t* ie, size_t pos) {
+    const uint8_t* p = in + (pos >> 3);
+    size_t avail = static_cast<size_t>(ie - p);
+    uint64_t x = 0;
+    for (size_t i = 0; i < 8; i++) {
+      x = (x << 8) | (i < avail ? p[i] : 0u);
     }
-
-    return false;
+    int shift = static_cast<int>(pos & 7);
+    if (shift) {
+      x <<= shift;
+      if (avail > 8) x |= p[8] >> (8 - shift);
+    }
+    return x;
   }
 
-  // Decode multiple symbols (batch processing)
-  size_t decode_batch(BitBuffer& buf, uint16_t* TINYEXR_RESTRICT output,
-                      size_t max_symbols, uint16_t rlc_symbol) const {
-    size_t decoded = 0;
-    uint16_t* out = output;
-    uint16_t* out_end = output + max_symbols;
-
-    while (out < out_end && buf.has_data()) {
-      // Prefetch next table entry
-      if (buf.count >= HUF_DECBITS) {
-        uint32_t next_idx = (buf.peek(HUF_DECBITS) & HUF_DECMASK);
-        TINYEXR_PREFETCH(&table_[next_idx]);
-      }
-
-      uint16_t symbol;
-      if (!decode_symbol(buf, symbol)) {
-        break;
-      }
+  // Decode one symbol (and its run byte) at bit `pos`, checking every bit
+  // against `nbits`. Handles codes of any length.
+  bool decode_careful(const uint8_t* in, const uint8_t* ie, size_t nbits,
+                      size_t& pos, uint16_t* outb, uint16_t*& out,
+                      uint16_t* oe) const {
+    uint64_t x = window(in, ie, pos);
+    uint32_t entry = table_[static_cast<size_t>(x >> (64 - HUF_TABLE_BITS))];
+    uint32_t len = entry & 0xFF;
+    uint32_t sym;
+    if (len - 1 < HUF_TABLE_BITS) {
+      sym = entry >> 8;
+    } else if (entry == HUF_TABLE_LONG) {
+      int k = 0;
+      while (k < num_long_ && x < long_base_[k]) k++;
+      if (k == num_long_) return false;
+      len = long_len_[k];
+      uint64_t idx = (x >> (64 - len)) - long_start_[k];
+      if (idx >= long_count_[k]) return false;
+      sym = long_symbols_[long_first_[k] + static_cast<uint32_t>(idx)];
+    } else {
+      return false;
+    }
+    if (len > nbits - pos) return false;
+    pos += len;
+
+    if (sym == rlc_) {
+      if (8 > nbits - pos || out == outb) return false;
+      uint32_t run = static_cast<uint32_t>(window(in, ie, pos) >> 56);
+      pos += 8;
+      if (run > static_cast<size_t>(oe - out)) return false;
+      out = huf_fill_run(out, out[-1], run);
+    } else {
+      *out++ = static_cast<uint16_t>(sym);
+    }
+    return true;
+  }
 
-      if (TINYEXR_UNLIKELY(symbol == rlc_symbol)) {
-        // Run-length encoding
-        if (buf.count < 8) {
-          buf.refill();
-        }
-        if (buf.count < 8 || out == output) {
-          break;  // Error
-        }
+  std::vector<uint32_t> table_;
+  std::vector<uint32_t> long_symbols_;  // By length, then code
+  uint32_t rlc_;
+  int num_long_;
+  uint8_t long_len_[HUF_MAX_CODE_LEN];
+  uint64_t long_base_[HUF_MAX_CODE_LEN];   // First code, left-justified
+  uint64_t long_start_[HUF_MAX_CODE_LEN];  // First code
+  uint32_t long_count_[HUF_MAX_CODE_LEN];
+  uint32_t long_first_[HUF_MAX_CODE_LEN];  // Index into long_symbols_
+};
 
-        uint8_t run_len = static_cast<uint8_t>(buf.read(8));
-        uint16_t repeat = out[-1];
+// Decompress an OpenEXR Huffman block (PIZ) into exactly `nRaw` values.
+// Layout: im, iM, table length, nBits, reserved (little-endian uint32),
+// the packed code length table, then nBits of code stream.
+inline bool huf_uncompress(const uint8_t* compressed, size_t nCompressed,
+                           uint16_t* raw, size_t nRaw) {
+  if (nCompressed == 0) return nRaw == 0;
+  if (!compressed || (!raw && nRaw) || nCompressed < 20) return false;
+
+  uint32_t im = static_cast<uint32_t>(compressed[0]) |
+                (static_cast<uint32_t>(compressed[1]) << 8) |
+                (static_cast<uint32_t>(compressed[2]) << 16) |
+                (static_cast<uint32_t>(compressed[3]) << 24);
+  uint32_t iM = static_cast<uint32_t>(compressed[4]) |
+                (static_cast<uint32_t>(compressed[5]) << 8) |
+                (static_cast<uint32_t>(compressed[6]) << 16) |
+                (static_cast<uint32_t>(compressed[7]) << 24);
+  uint32_t nBits = static_cast<uint32_t>(compressed[12]) |
+                   (static_cast<uint32_t>(compressed[13]) << 8) |
+                   (static_cast<uint32_t>(compressed[14]) << 16) |
+                   (static_cast<uint32_t>(compressed[15]) << 24);
+  if (im >= static_cast<uint32_t>(HUF_ENCSIZE) ||
+      iM >= static_cast<uint32_t>(HUF_ENCSIZE) || im > iM) {
+    return false;
+  }
 
-        if (out + run_len > out_end) {
-          break;  // Would overflow
-        }
+  const uint8_t* ptr = compressed + 20;
+  FastHuffmanDecoder decoder;
+  if (!decoder.build(ptr, nCompressed - 20, static_cast<int>(im),
+                     static_cast<int>(iM))) {
+    return false;
+  }
 
-        // SIMD-accelerated fill for longer runs
-        if (run_len >= 8) {
-          // Use memset for aligned runs
-          for (int i = 0; i < run_len; i++) {
-            *out++ = repeat;
-          }
-        } else {
-          for (int i = 0; i < run_len; i++) {
-            *out++ = repeat;
-          }
-        }
-      } else {
-        *out++ = symbol;
-      }
-    }
+  size_t remaining = nCompressed - static_cast<size_t>(ptr - compressed);
+  if (nBits > 8 * static_cast<uint64_t>(remaining)) return false;
 
-    return out - output;
+  // nBits == 0: a single value, symbol im, fills the block
+  if (nBits == 0) {
+    for (size_t i = 0; i < nRaw; i++) raw[i] = static_cast<uint16_t>(im);
+    return true;
   }
 
-private:
-  HufDecFast* table_;
-  uint32_t* long_table_;
-};
+  return decoder.decode(ptr, nBits, raw, nRaw);
+}
 
 // ============================================================================
 // Fast Deflate/Inflate Implementation
@@ -620,116 +720,100 @@ static const uint8_t DIST_EXTRA[30] = {
   7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
 };
 
-// Optimized Huffman table for deflate (16KB, fits in L1 cache)
-struct DeflateHuffTable {
-  // Lookup table: 10 bits = 1024 entries
-  // Entry format: symbol (11 bits) | length (4 bits) | valid (1 bit)
-  uint16_t fast_table[1024];
-
-  // Slow table for codes > 10 bits (11-15 bit codes)
-  // Format: [count_11][code,sym]...[count_12][code,sym]...[count_13]...[count_14]...[count_15]
-  // Each entry pair: reversed_code (16 bits), symbol (16 bits)
-  // Maximum entries: 5 counts + 286 symbols * 2 words = ~600 words
-  uint16_t slow_table[640];
-  int slow_count;  // Total code entries in slow_table
-  int max_bits;
-
-  void build_fixed_litlen() {
-    max_bits = 9;
-    slow_count = 0;
-    // Fixed literal/length code:
-    // 0-143: 8 bits, 144-255: 9 bits, 256-279: 7 bits, 280-287: 8 bits
-    std::memset(fast_table, 0, sizeof(fast_table));
-    std::memset(slow_table, 0, sizeof(slow_table));
-
-    // Build codes
-    for (int sym = 0; sym <= 287; sym++) {
-      int len, code;
-      if (sym <= 143) {
-        len = 8; code = 0x30 + sym;
-      } else if (sym <= 255) {
-        len = 9; code = 0x190 + (sym - 144);
-      } else if (sym <= 279) {
-        len = 7; code = sym - 256;
-      } else {
-        len = 8; code = 0xC0 + (sym - 280);
-      }
-
-      // Fill table - reverse bits for deflate
-      int rev_code = 0;
-      for (int i = 0; i < len; i++) {
-        rev_code = (rev_code << 1) | ((code >> i) & 1);
-      }
-
-      int fill = 1 << (10 - len);
-      for (int i = 0; i < fill; i++) {
-        int idx = rev_code | (i << len);
-        if (idx < 1024) {
-          fast_table[idx] = static_cast<uint16_t>((sym << 4) | len | 0x8000);
-        }
-      }
-    }
+// Deflate Huffman decode table. The main table is indexed by the next
+// kTableBits input bits; codes longer than that point to a subtable sized
+// for the longest code sharing the prefix. In the literal/length table an
+// entry whose code leaves room for a second literal code decodes both.
+//
+// Entry layout:
+//   bits  0..4   code bits to consume (both codes for a literal pair, the
+//                main table bits for a subtable pointer)
+//   bits  5..8   extra bits after the code (first code length for a pair,
+//                index bits for a subtable pointer)
+//   bits  9..13  DEFLATE_ENTRY_* flags
+//   bits 16..31  literal byte(s), length/distance base, code length
+//                symbol, or subtable offset
+static const uint32_t DEFLATE_ENTRY_LITERAL = 1u << 9;
+static const uint32_t DEFLATE_ENTRY_PAIR = 1u << 10;
+static const uint32_t DEFLATE_ENTRY_EOB = 1u << 11;
+static const uint32_t DEFLATE_ENTRY_SUBTABLE = 1u << 12;
+static const uint32_t DEFLATE_ENTRY_INVALID = 1u << 13;
+
+static const int DEFLATE_LITLEN_TABLE_BITS = 11;
+static const int DEFLATE_DIST_TABLE_BITS = 8;
+static const int DEFLATE_CODELEN_TABLE_BITS = 7;
+
+// Main table plus worst-case subtables for complete codes (zlib's
+// `enough` for 288 and 32 symbols with 15-bit codes)
+static const int DEFLATE_LITLEN_TABLE_SIZE = 2342;
+static const int DEFLATE_DIST_TABLE_SIZE = 402;
+static const int DEFLATE_CODELEN_TABLE_SIZE = 1 << DEFLATE_CODELEN_TABLE_BITS;
+
+// Entry payloads per symbol, without the code length
+inline uint32_t deflate_litlen_entry(int sym) {
+  if (sym < 256) return DEFLATE_ENTRY_LITERAL | (static_cast<uint32_t>(sym) << 16);
+  if (sym == 256) return DEFLATE_ENTRY_EOB;
+  if (sym < 286) {
+    return (static_cast<uint32_t>(LENGTH_BASE[sym - 257]) << 16) |
+           (static_cast<uint32_t>(LENGTH_EXTRA[sym - 257]) << 5);
   }
+  return DEFLATE_ENTRY_INVALID;
+}
 
-  void build_fixed_dist() {
-    max_bits = 5;
-    slow_count = 0;
-    std::memset(fast_table, 0, sizeof(fast_table));
-    std::memset(slow_table, 0, sizeof(slow_table));
-
-    // Fixed distance codes: 5 bits each
-    for (int sym = 0; sym < 32; sym++) {
-      int rev_code = 0;
-      for (int i = 0; i < 5; i++) {
-        rev_code = (rev_code << 1) | ((sym >> i) & 1);
-      }
-
-      int fill = 1 << (10 - 5);
-      for (int i = 0; i < fill; i++) {
-        int idx = rev_code | (i << 5);
-        if (idx < 1024) {
-          fast_table[idx] = static_cast<uint16_t>((sym << 4) | 5 | 0x8000);
-        }
-      }
-    }
+inline uint32_t deflate_dist_entry(int sym) {
+  if (sym < 30) {
+    return (static_cast<uint32_t>(DIST_BASE[sym]) << 16) |
+           (static_cast<uint32_t>(DIST_EXTRA[sym]) << 5);
   }
-};
+  return DEFLATE_ENTRY_INVALID;
+}
+
+inline uint32_t deflate_codelen_entry(int sym) {
+  return static_cast<uint32_t>(sym) << 16;
+}
 
 // Bit reader for deflate (LSB first, different from Huffman)
 struct DeflateBitReader {
   uint64_t bits;
   int count;
+  int overrun;  // Zero bytes shifted in past the end of input
   const uint8_t* ptr;
   const uint8_t* end;
 
   TINYEXR_ALWAYS_INLINE void init(const uint8_t* data, size_t size) {
     bits = 0;
     count = 0;
+    overrun = 0;
     ptr = data;
     end = data + size;
   }
 
-  // Refill to have at least 32 bits
+  // Refill to at least 56 bits one byte at a time. Past the end of input
+  // zero bytes are shifted in so decoding never reads out of bounds;
+  // overran() reports whether any of them were consumed.
   TINYEXR_ALWAYS_INLINE void refill() {
-    while (count <= 56 && ptr < end) {
-      bits |= static_cast<uint64_t>(*ptr++) << count;
+    while (count < 56) {
+      if (ptr < end) {
+        bits |= static_cast<uint64_t>(*ptr++) << count;
+      } else {
+        overrun++;
+      }
       count += 8;
     }
   }
 
-  // Fast refill (8 bytes at once)
+  // Branchless refill to 56..63 bits; needs 8 readable bytes at ptr.
+  // Bits above `count` may hold the start of the next byte, which the
+  // following refill ORs in again at the same position.
   TINYEXR_ALWAYS_INLINE void refill_fast() {
-    if (TINYEXR_LIKELY(ptr + 8 <= end)) {
-      uint64_t new_bits;
-      std::memcpy(&new_bits, ptr, 8);
-      // Keep existing bits and add new ones
-      bits |= new_bits << count;
-      int bytes_to_advance = (64 - count) / 8;
-      ptr += bytes_to_advance;
-      count += bytes_to_advance * 8;
-    } else {
-      refill();
-    }
+    uint64_t word;
+    std::memcpy(&word, ptr, 8);
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    word = bswap64(word);
+#endif
+    bits |= word << count;
+    ptr += (63 - count) >> 3;
+    count |= 56;
   }
 
   // Peek n bits (LSB)
@@ -755,16 +839,285 @@ struct DeflateBitReader {
     int skip = count & 7;
     consume(skip);
   }
+
+  // Take `len` raw bytes for a stored block; the reader must be byte
+  // aligned. Returns nullptr if the input is too short.
+  const uint8_t* take_bytes(size_t len) {
+    // Whole bytes left in the bit buffer came from just before ptr
+    int buffered = count >> 3;
+    if (overrun > buffered) return nullptr;
+    const uint8_t* p = ptr - (buffered - overrun);
+    if (static_cast<size_t>(end - p) < len) return nullptr;
+    ptr = p + len;
+    bits = 0;
+    count = 0;
+    overrun = 0;
+    return p;
+  }
+
+  // True if decoding consumed bits past the end of input
+  bool overran() const {
+    return overrun * 8 > count;
+  }
 };
 
-// Fast deflate decompressor
-class FastDeflateDecoder {
-public:
-  FastDeflateDecoder() {
-    fixed_litlen_.build_fixed_litlen();
-    fixed_dist_.build_fixed_dist();
+template <int kTableBits, int kSize>
+struct DeflateDecodeTable {
+  uint32_t entries[kSize];
+
+  // Look up the next symbol. A subtable hop consumes the main table bits;
+  // the returned entry's code length covers the rest.
+  TINYEXR_ALWAYS_INLINE uint32_t lookup(DeflateBitReader& reader) const {
+    uint32_t e = entries[static_cast<uint32_t>(reader.bits) & ((1u << kTableBits) - 1)];
+    if (TINYEXR_UNLIKELY(e & DEFLATE_ENTRY_SUBTABLE)) {
+      reader.consume(kTableBits);
+      uint32_t sub_mask = (1u << ((e >> 5) & 15)) - 1;
+      e = entries[(e >> 16) + (static_cast<uint32_t>(reader.bits) & sub_mask)];
+    }
+    return e;
   }
 
+  // Build from code lengths; entry_of(sym) gives each symbol's payload.
+  // Returns false for over-subscribed codes (or, for incomplete codes,
+  // subtables that would not fit).
+  bool build(const uint8_t* lens, int count, uint32_t (*entry_of)(int)) {
+    int bl_count[DEFLATE_MAX_BITS + 1] = {0};
+    for (int i = 0; i < count; i++) {
+      bl_count[lens[i]]++;
+    }
+    bl_count[0] = 0;
+
+    int left = 1;
+    for (int len = 1; len <= DEFLATE_MAX_BITS; len++) {
+      left = (left << 1) - bl_count[len];
+      if (left < 0) return false;
+    }
+
+    int next_code[DEFLATE_MAX_BITS + 1] = {0};
+    int code = 0;
+    for (int len = 1; len <= DEFLATE_MAX_BITS; len++) {
+      code = (code + bl_count[len - 1]) << 1;
+      next_code[len] = code;
+    }
+
+    // Bit-reversed canonical codes (deflate reads codes LSB first)
+    uint16_t rev_codes[DEFLATE_LITLEN_CODES + DEFLATE_DIST_CODES];
+    for (int sym = 0; sym < count; sym++) {
+      int len = lens[sym];
+      if (len == 0) continue;
+      int c = next_code[len]++;
+      int rev = 0;
+      for (int i = 0; i < len; i++) {
+        rev = (rev << 1) | ((c >> i) & 1);
+      }
+      rev_codes[sym] = static_cast<uint16_t>(rev);
+    }
+
+    const int main_size = 1 << kTableBits;
+    for (int i = 0; i < main_size; i++) {
+      entries[i] = DEFLATE_ENTRY_INVALID;
+    }
+
+    // Short codes fill every main slot that shares their low bits; long
+    // codes record the subtable size their prefix needs
+    uint8_t sub_bits[1 << kTableBits] = {0};
+    for (int sym = 0; sym < count; sym++) {
+      int len = lens[sym];
+      if (len == 0) continue;
+      if (len <= kTableBits) {
+        uint32_t e = entry_of(sym) | static_cast<uint32_t>(len);
+        for (int i = rev_codes[sym]; i < main_size; i += 1 << len) {
+          entries[i] = e;
+        }
+      } else {
+        int prefix = rev_codes[sym] & (main_size - 1);
+        if (len - kTableBits > sub_bits[prefix]) {
+          sub_bits[prefix] = static_cast<uint8_t>(len - kTableBits);
+        }
+      }
+    }
+
+    int next = main_size;
+    for (int prefix = 0; prefix < main_size; prefix++) {
+      int bits = sub_bits[prefix];
+      if (bits == 0) continue;
+      if (next + (1 << bits) > kSize) return false;
+      entries[prefix] = DEFLATE_ENTRY_SUBTABLE | (static_cast<uint32_t>(next) << 16) |
+                        (static_cast<uint32_t>(bits) << 5) | kTableBits;
+      for (int i = 0; i < (1 << bits); i++) {
+        entries[next + i] = DEFLATE_ENTRY_INVALID;
+      }
+      next += 1 << bits;
+    }
+
+    for (int sym = 0; sym < count; sym++) {
+      int len = lens[sym];
+      if (len <= kTableBits) continue;
+      uint32_t ptr_entry = entries[rev_codes[sym] & (main_size - 1)];
+      int base = static_cast<int>(ptr_entry >> 16);
+      int size = 1 << ((ptr_entry >> 5) & 15);
+      uint32_t e = entry_of(sym) | static_cast<uint32_t>(len - kTableBits);
+      for (int i = rev_codes[sym] >> kTableBits; i < size; i += 1 << (len - kTableBits)) {
+        entries[base + i] = e;
+      }
+    }
+
+    return true;
+  }
+
+  // Merge literal codes with a following literal code that fits in the
+  // remaining main table bits. Walking down keeps the second lookup on a
+  // not-yet-merged entry (i >> len1 <= i).
+  void add_literal_pairs() {
+    for (int i = (1 << kTableBits) - 1; i >= 0; i--) {
+      uint32_t e1 = entries[i];
+      if ((e1 & (DEFLATE_ENTRY_LITERAL | DEFLATE_ENTRY_SUBTABLE)) != DEFLATE_ENTRY_LITERAL) {
+        continue;
+      }
+      uint32_t len1 = e1 & 31;
+      uint32_t e2 = entries[i >> len1];
+      if ((e2 & (DEFLATE_ENTRY_LITERAL | DEFLATE_ENTRY_SUBTABLE)) != DEFLATE_ENTRY_LITERAL) {
+        continue;
+      }
+      uint32_t len2 = e2 & 31;
+      if (len1 + len2 > static_cast<uint32_t>(kTableBits)) continue;
+      entries[i] = DEFLATE_ENTRY_LITERAL | DEFLATE_ENTRY_PAIR |
+                   ((e1 >> 16) & 0xFF) << 16 | ((e2 >> 16) & 0xFF) << 24 |
+                   (len1 << 5) | (len1 + len2);
+    }
+  }
+};
+
+typedef DeflateDecodeTable<DEFLATE_LITLEN_TABLE_BITS, DEFLATE_LITLEN_TABLE_SIZE> DeflateLitLenTable;
+typedef DeflateDecodeTable<DEFLATE_DIST_TABLE_BITS, DEFLATE_DIST_TABLE_SIZE> DeflateDistTable;
+typedef DeflateDecodeTable<DEFLATE_CODELEN_TABLE_BITS, DEFLATE_CODELEN_TABLE_SIZE> DeflateCodeLenTable;
+
+// Fixed Huffman tables (RFC 1951 3.2.6), built once
+struct DeflateFixedTables {
+  DeflateLitLenTable litlen;
+  DeflateDistTable dist;
+
+  DeflateFixedTables() {
+    uint8_t lens[DEFLATE_LITLEN_CODES];
+    for (int sym = 0; sym < DEFLATE_LITLEN_CODES; sym++) {
+      lens[sym] = sym <= 143 ? 8 : sym <= 255 ? 9 : sym <= 279 ? 7 : 8;
+    }
+    litlen.build(lens, DEFLATE_LITLEN_CODES, deflate_litlen_entry);
+    litlen.add_literal_pairs();
+    for (int sym = 0; sym < DEFLATE_DIST_CODES; sym++) {
+      lens[sym] = 5;
+    }
+    dist.build(lens, DEFLATE_DIST_CODES, deflate_dist_entry);
+  }
+};
+
+inline const DeflateFixedTables& deflate_fixed_tables() {
+  static const DeflateFixedTables tables;
+  return tables;
+}
+
+// Sliding window used by decompress_unpredict: 32KB match history, the
+// longest match, and the default/minimum window sizes
+static const size_t DEFLATE_HISTORY = 32768;
+static const int DEFLATE_MAX_MATCH = 258;
+static const size_t DEFLATE_UNPREDICT_WINDOW = 128 * 1024;
+static const size_t DEFLATE_UNPREDICT_MIN_WINDOW = 2 * DEFLATE_HISTORY;
+
+// Undoes the EXR ZIP predictor and byte reorder on inflated bytes as they
+// are streamed in, writing each byte straight to its final position. Byte
+// p of the stream lands at dst[2p] in the first half and at
+// dst[2(p - half_a) + 1] in the second; the running predictor sum simply
+// carries across the split.
+struct UnpredictSink {
+  uint8_t* dst;
+  size_t size;
+  size_t half_a;
+  size_t pos;
+  uint8_t prev;
+
+  void init(uint8_t* out, size_t out_size) {
+    dst = out;
+    size = out_size;
+    half_a = (out_size + 1) / 2;
+    pos = 0;
+    prev = 128;
+  }
+
+#if defined(TINYEXR_ENABLE_SIMD) && TINYEXR_ENABLE_SIMD && defined(TINYEXR_SIMD_SSE2) && TINYEXR_SIMD_SSE2
+  // Decode 16 predicted bytes following decoded value d (running byte sums)
+  static TINYEXR_ALWAYS_INLINE __m128i decode16(const uint8_t* src, uint8_t d) {
+    __m128i v = _mm_add_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)),
+                             _mm_set1_epi8(static_cast<char>(0x80)));
+    v = _mm_add_epi8(v, _mm_slli_si128(v, 1));
+    v = _mm_add_epi8(v, _mm_slli_si128(v, 2));
+    v = _mm_add_epi8(v, _mm_slli_si128(v, 4));
+    v = _mm_add_epi8(v, _mm_slli_si128(v, 8));
+    return _mm_add_epi8(v, _mm_set1_epi8(static_cast<char>(d)));
+  }
+
+  static TINYEXR_ALWAYS_INLINE uint8_t last_byte(__m128i v) {
+    return static_cast<uint8_t>(_mm_extract_epi16(v, 7) >> 8);
+  }
+#endif
+
+  void put(const uint8_t* src, size_t n) {
+    size_t end = pos + n;
+    size_t split = end < half_a ? end : half_a;
+    uint8_t d = prev;
+    size_t p = pos;
+
+#if defined(TINYEXR_ENABLE_SIMD) && TINYEXR_ENABLE_SIMD && defined(TINYEXR_SIMD_SSE2) && TINYEXR_SIMD_SSE2
+    // First half: odd bytes are not written yet, so whole 32-byte stores
+    // are fine as long as they stay inside dst
+    for (; p + 16 <= split && p * 2 + 32 <= size; p += 16, src += 16) {
+      __m128i v = decode16(src, d);
+      __m128i zero = _mm_setzero_si128();
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + p * 2), _mm_unpacklo_epi8(v, zero));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + p * 2 + 16), _mm_unpackhi_epi8(v, zero));
+      d = last_byte(v);
+    }
+#endif
+    for (; p < split; ++p) {
+      d = static_cast<uint8_t>(d + *src++ - 128);
+      dst[p * 2] = d;
+    }
+
+    if (p < end) {
+      uint8_t* o = dst + (p - half_a) * 2 + 1;
+#if defined(TINYEXR_ENABLE_SIMD) && TINYEXR_ENABLE_SIMD && defined(TINYEXR_SIMD_SSE2) && TINYEXR_SIMD_SSE2
+      // Second half: merge into the odd bytes, keeping the even ones
+      const __m128i even = _mm_set1_epi16(0x00FF);
+      for (; p + 16 <= end && static_cast<size_t>(o - dst) + 31 <= size;
+           p += 16, src += 16, o += 32) {
+        __m128i v = decode16(src, d);
+        __m128i zero = _mm_setzero_si128();
+        __m128i* q = reinterpret_cast<__m128i*>(o - 1);
+        __m128i lo = _mm_and_si128(_mm_loadu_si128(q), even);
+        __m128i hi = _mm_and_si128(_mm_loadu_si128(q + 1), even);
+        _mm_storeu_si128(q, _mm_or_si128(lo, _mm_unpacklo_epi8(zero, v)));
+        _mm_storeu_si128(q + 1, _mm_or_si128(hi, _mm_unpackhi_epi8(zero, v)));
+        d = last_byte(v);
+      }
+#endif
+      for (; p < end; ++p) {
+        d = static_cast<uint8_t>(d + *src++ - 128);
+        *o = d;
+        o += 2;
+      }
+    }
+
+    prev = d;
+    pos = end;
+  }
+};
+
+// Fast deflate decompressor. Blocks are decoded in a fast loop while at
+// least 8 input bytes and DEFLATE_FASTLOOP_MARGIN output bytes remain:
+// one branchless refill per symbol (or literal pair), and match copies in
+// whole 8/16-byte words that may run past the match. The remainder goes
+// through a careful loop that checks every write.
+class FastDeflateDecoder {
+public:
   // Decompress deflate stream
   bool decompress(const uint8_t* src, size_t src_len,
                   uint8_t* dst, size_t* dst_len) {
@@ -774,6 +1127,7 @@ public:
     uint8_t* out = dst;
     uint8_t* out_end = dst + *dst_len;
 
+    const DeflateFixedTables& fixed = deflate_fixed_tables();
     bool final_block = false;
 
     while (!final_block) {
@@ -785,39 +1139,31 @@ public:
 
       if (block_type == 0) {
         // Stored block
-        reader.align_to_byte();
-        if (reader.count < 32) {
-          reader.refill();
+        size_t len;
+        const uint8_t* stored = read_stored_header(reader, &len);
+        if (!stored) {
+          return false;  // Invalid or truncated stored block
         }
-
-        uint16_t len = static_cast<uint16_t>(reader.read(16));
-        uint16_t nlen = static_cast<uint16_t>(reader.read(16));
-
-        if ((len ^ nlen) != 0xFFFF) {
-          return false;  // Invalid stored block
-        }
-
-        if (out + len > out_end) {
+        if (len > static_cast<size_t>(out_end - out)) {
           return false;  // Output overflow
         }
-
-        // Copy literal bytes
-        for (int i = 0; i < len; i++) {
-          if (reader.count < 8) reader.refill();
-          *out++ = static_cast<uint8_t>(reader.read(8));
-        }
+        std::memcpy(out, stored, len);
+        out += len;
       } else if (block_type == 1) {
         // Fixed Huffman
-        if (!decode_block(reader, &fixed_litlen_, &fixed_dist_, out, dst, out_end)) {
+        if (decode_block<false>(reader, fixed.litlen, fixed.dist,
+                                out, dst, out_end, out_end) != kBlockEnd) {
           return false;
         }
       } else if (block_type == 2) {
         // Dynamic Huffman
-        DeflateHuffTable dyn_litlen, dyn_dist;
+        DeflateLitLenTable dyn_litlen;
+        DeflateDistTable dyn_dist;
         if (!decode_dynamic_tables(reader, dyn_litlen, dyn_dist)) {
           return false;
         }
-        if (!decode_block(reader, &dyn_litlen, &dyn_dist, out, dst, out_end)) {
+        if (decode_block<false>(reader, dyn_litlen, dyn_dist,
+                                out, dst, out_end, out_end) != kBlockEnd) {
           return false;
         }
       } else {
@@ -825,83 +1171,171 @@ public:
       }
     }
 
+    if (reader.overran()) {
+      return false;  // Input truncated
+    }
+
     *dst_len = out - dst;
     return true;
   }
 
-private:
-  DeflateHuffTable fixed_litlen_;
-  DeflateHuffTable fixed_dist_;
-
-  // Decode Huffman symbol
-  TINYEXR_ALWAYS_INLINE int decode_symbol(DeflateBitReader& reader,
-                                          const DeflateHuffTable* table) {
-    if (reader.count < 15) {
-      reader.refill();
+  // Decompress a deflate stream that must produce exactly dst_len bytes of
+  // EXR ZIP data, undoing the predictor and byte reorder as output is
+  // emitted. Inflated bytes only pass through `window`, which slides once
+  // it fills, so it needs to be at least DEFLATE_UNPREDICT_MIN_WINDOW bytes
+  // unless it can hold the whole output. Returns false on malformed input
+  // or if the stream ends short of dst_len; dst contents are then undefined.
+  bool decompress_unpredict(const uint8_t* src, size_t src_len,
+                            uint8_t* dst, size_t dst_len,
+                            uint8_t* window, size_t window_size) {
+    if (window_size < dst_len && window_size < DEFLATE_UNPREDICT_MIN_WINDOW) {
+      return false;
     }
 
-    uint32_t idx = reader.peek(10);
-    uint16_t entry = table->fast_table[idx];
+    DeflateBitReader reader;
+    reader.init(src, src_len);
 
-#ifdef TINYEXR_DEFLATE_DEBUG_VERBOSE
-    fprintf(stderr, "    decode_symbol: peek(10)=0x%03x entry=0x%04x count=%d\n",
-            idx, entry, reader.count);
-#endif
+    UnpredictSink sink;
+    sink.init(dst, dst_len);
+
+    // window[0] holds output byte `base`; bytes before `flushed` have
+    // already been handed to the sink
+    size_t base = 0;
+    uint8_t* out = window;
+    uint8_t* flushed = window;
+    uint8_t* out_end = nullptr;
+    uint8_t* suspend_at = nullptr;
+
+    // Bound the window by the remaining output. Suspend while there is
+    // still room for one maximum-length match, unless the rest of the
+    // output fits.
+    auto set_limits = [&]() {
+      size_t remaining = dst_len - base;
+      if (remaining <= window_size) {
+        out_end = window + remaining;
+        suspend_at = out_end;
+      } else {
+        out_end = window + window_size;
+        suspend_at = out_end - DEFLATE_MAX_MATCH;
+      }
+    };
 
-    if (TINYEXR_LIKELY(entry & 0x8000)) {
-      int len = entry & 0xF;
-      int sym = (entry >> 4) & 0x7FF;
-      reader.consume(len);
-      return sym;
-    }
+    // Flush pending bytes and keep the last 32KB as match history
+    auto slide = [&]() {
+      sink.put(flushed, static_cast<size_t>(out - flushed));
+      size_t produced = static_cast<size_t>(out - window);
+      size_t keep = produced < DEFLATE_HISTORY ? produced : DEFLATE_HISTORY;
+      std::memmove(window, out - keep, keep);
+      base += produced - keep;
+      out = window + keep;
+      flushed = out;
+      set_limits();
+    };
 
-    // Slow path for longer codes (should be rare)
-    return decode_symbol_slow(reader, table);
-  }
+    set_limits();
 
-  int decode_symbol_slow(DeflateBitReader& reader, const DeflateHuffTable* table) {
-    // Handle codes > 10 bits (11-15 bit codes)
-    // Ensure we have enough bits
-    if (reader.count < 15) {
-      reader.refill();
-    }
+    const DeflateFixedTables& fixed = deflate_fixed_tables();
+    DeflateLitLenTable dyn_litlen;
+    DeflateDistTable dyn_dist;
+    bool final_block = false;
 
-    // slow_table format: [count_11][code,sym]...[count_12][code,sym]...[count_15]...
-    const uint16_t* ptr = table->slow_table;
+    while (!final_block) {
+      reader.refill();
 
-    for (int bits = 11; bits <= table->max_bits && bits <= 15; bits++) {
-      uint16_t count = *ptr++;
-      uint32_t code_mask = (1u << bits) - 1;
-      uint32_t peeked = reader.peek(bits) & code_mask;
+      final_block = reader.read(1) != 0;
+      int block_type = reader.read(2);
 
-      for (uint16_t i = 0; i < count; i++) {
-        uint16_t stored_code = ptr[i * 2];
-        uint16_t symbol = ptr[i * 2 + 1];
+      if (block_type == 0) {
+        size_t left;
+        const uint8_t* stored = read_stored_header(reader, &left);
+        if (!stored) {
+          return false;
+        }
+        while (left > 0) {
+          if (out > suspend_at) slide();
+          if (out == out_end) {
+            return false;  // Output overflow
+          }
+          size_t n = static_cast<size_t>(out_end - out);
+          if (n > left) n = left;
+          std::memcpy(out, stored, n);
+          out += n;
+          stored += n;
+          left -= n;
+        }
+      } else if (block_type == 1 || block_type == 2) {
+        const DeflateLitLenTable* litlen = &fixed.litlen;
+        const DeflateDistTable* dist = &fixed.dist;
+        if (block_type == 2) {
+          if (!decode_dynamic_tables(reader, dyn_litlen, dyn_dist)) {
+            return false;
+          }
+          litlen = &dyn_litlen;
+          dist = &dyn_dist;
+        }
 
-        if (peeked == stored_code) {
-          reader.consume(bits);
-          return static_cast<int>(symbol);
+        BlockStatus status;
+        while ((status = decode_block<true>(reader, *litlen, *dist, out, window,
+                                            out_end, suspend_at)) ==
+               kBlockSuspended) {
+          slide();
+        }
+        if (status != kBlockEnd) {
+          return false;
         }
+      } else {
+        return false;
       }
-      ptr += count * 2;
     }
 
-    return -1;  // Invalid code - no match found
+    if (reader.overran()) {
+      return false;
+    }
+
+    sink.put(flushed, static_cast<size_t>(out - flushed));
+    return base + static_cast<size_t>(out - window) == dst_len;
+  }
+
+private:
+  enum BlockStatus { kBlockError, kBlockEnd, kBlockSuspended };
+
+  // Output room the fast loop needs: a maximum-length match plus the
+  // overshoot of its last 16-byte word copy (and of a literal pair store)
+  static const int DEFLATE_FASTLOOP_MARGIN = DEFLATE_MAX_MATCH + 16;
+
+  // LEN/NLEN of a stored block; returns its payload or nullptr
+  static const uint8_t* read_stored_header(DeflateBitReader& reader, size_t* len) {
+    reader.align_to_byte();
+    reader.refill();
+
+    uint16_t n = static_cast<uint16_t>(reader.read(16));
+    uint16_t nn = static_cast<uint16_t>(reader.read(16));
+    if ((n ^ nn) != 0xFFFF) {
+      return nullptr;
+    }
+    *len = n;
+    return reader.take_bytes(n);
+  }
+
+  // Base value of a length/distance entry plus its extra bits
+  static TINYEXR_ALWAYS_INLINE uint32_t decode_value(DeflateBitReader& reader, uint32_t e) {
+    int len = static_cast<int>(e & 31);
+    int extra = static_cast<int>((e >> 5) & 15);
+    uint32_t value = (e >> 16) +
+                     (static_cast<uint32_t>(reader.bits >> len) & ((1u << extra) - 1));
+    reader.consume(len + extra);
+    return value;
   }
 
   bool decode_dynamic_tables(DeflateBitReader& reader,
-                            DeflateHuffTable& litlen,
-                            DeflateHuffTable& dist) {
+                             DeflateLitLenTable& litlen,
+                             DeflateDistTable& dist) {
     reader.refill();
 
     int hlit = reader.read(5) + 257;
     int hdist = reader.read(5) + 1;
     int hclen = reader.read(4) + 4;
 
-#ifdef TINYEXR_DEFLATE_DEBUG
-    fprintf(stderr, "DEBUG: Dynamic block: HLIT=%d, HDIST=%d, HCLEN=%d\n", hlit, hdist, hclen);
-#endif
-
     // Read code length code lengths
     uint8_t codelen_lens[DEFLATE_CODELEN_CODES] = {0};
     for (int i = 0; i < hclen; i++) {
@@ -909,69 +1343,25 @@ private:
       codelen_lens[DEFLATE_CODELEN_ORDER[i]] = static_cast<uint8_t>(reader.read(3));
     }
 
-#ifdef TINYEXR_DEFLATE_DEBUG
-    fprintf(stderr, "DEBUG: Codelen table lens: ");
-    for (int i = 0; i < DEFLATE_CODELEN_CODES; i++) {
-      if (codelen_lens[i] > 0) fprintf(stderr, "[%d]=%d ", i, codelen_lens[i]);
-    }
-    fprintf(stderr, "\n");
-#endif
-
     // Build code length Huffman table
-    DeflateHuffTable codelen_table;
-    if (!build_huffman_table(&codelen_table, codelen_lens, DEFLATE_CODELEN_CODES)) {
-#ifdef TINYEXR_DEFLATE_DEBUG
-      fprintf(stderr, "DEBUG: Failed to build codelen table\n");
-#endif
+    DeflateCodeLenTable codelen_table;
+    if (!codelen_table.build(codelen_lens, DEFLATE_CODELEN_CODES, deflate_codelen_entry)) {
       return false;
     }
 
-#ifdef TINYEXR_DEFLATE_DEBUG
-    fprintf(stderr, "DEBUG: Codelen table built, max_bits=%d\n", codelen_table.max_bits);
-    // Dump unique symbol mappings from fast_table
-    fprintf(stderr, "DEBUG: Codelen fast_table unique symbols:\n");
-    bool seen[19] = {false};
-    for (int i = 0; i < 1024; i++) {
-      if (codelen_table.fast_table[i] & 0x8000) {
-        int sym = (codelen_table.fast_table[i] >> 4) & 0x7FF;
-        int len = codelen_table.fast_table[i] & 0xF;
-        if (sym < 19 && !seen[sym]) {
-          seen[sym] = true;
-          fprintf(stderr, "  sym=%d: code=0x%x len=%d (entry at [0x%03x])\n",
-                  sym, i & ((1 << len) - 1), len, i);
-        }
-      }
-    }
-#endif
-
     // Read literal/length and distance code lengths
     uint8_t all_lens[DEFLATE_LITLEN_CODES + DEFLATE_DIST_CODES] = {0};
     int total = hlit + hdist;
     int i = 0;
 
-#ifdef TINYEXR_DEFLATE_DEBUG
-    fprintf(stderr, "DEBUG: Reading %d code lengths\n", total);
-#endif
-
     while (i < total) {
       reader.refill();
-      int sym = decode_symbol(reader, &codelen_table);
-
-#ifdef TINYEXR_DEFLATE_DEBUG
-      if (i < 20 || sym < 0) {
-        fprintf(stderr, "DEBUG: codelen[%d] = sym %d, peek10=0x%03x, count=%d\n",
-                i, sym, static_cast<unsigned>(reader.peek(10)), reader.count);
-      }
-#endif
-
-      if (sym < 0) {
-#ifdef TINYEXR_DEFLATE_DEBUG
-        fprintf(stderr, "DEBUG: Failed to decode codelen symbol at index %d\n", i);
-        fprintf(stderr, "DEBUG: bits_in_buf=%d, bits=0x%016llx\n",
-                reader.count, static_cast<unsigned long long>(reader.bits));
-#endif
+      uint32_t e = codelen_table.lookup(reader);
+      if (e & DEFLATE_ENTRY_INVALID) {
         return false;
       }
+      reader.consume(static_cast<int>(e & 31));
+      int sym = static_cast<int>(e >> 16);
 
       if (sym < 16) {
         all_lens[i++] = static_cast<uint8_t>(sym);
@@ -989,7 +1379,7 @@ private:
         while (repeat-- > 0 && i < total) {
           all_lens[i++] = 0;
         }
-      } else if (sym == 18) {
+      } else {
         // Repeat 0, 11-138 times
         int repeat = reader.read(7) + 11;
         while (repeat-- > 0 && i < total) {
@@ -999,200 +1389,150 @@ private:
     }
 
     // Build literal/length and distance tables
-    if (!build_huffman_table(&litlen, all_lens, hlit)) {
+    if (!litlen.build(all_lens, hlit, deflate_litlen_entry)) {
       return false;
     }
-    if (!build_huffman_table(&dist, all_lens + hlit, hdist)) {
+    litlen.add_literal_pairs();
+    if (!dist.build(all_lens + hlit, hdist, deflate_dist_entry)) {
       return false;
     }
 
     return true;
   }
 
-  bool build_huffman_table(DeflateHuffTable* table, const uint8_t* lens, int count) {
-    // Count code lengths
-    int bl_count[DEFLATE_MAX_BITS + 1] = {0};
-    int max_len = 0;
-    for (int i = 0; i < count; i++) {
-      if (lens[i] > 0) {
-        bl_count[lens[i]]++;
-        if (lens[i] > max_len) max_len = lens[i];
-      }
-    }
-
-    table->max_bits = max_len;
-    table->slow_count = 0;
-    std::memset(table->fast_table, 0, sizeof(table->fast_table));
-    std::memset(table->slow_table, 0, sizeof(table->slow_table));
-
-    // Compute first code for each length
-    int next_code[DEFLATE_MAX_BITS + 1] = {0};
-    int code = 0;
-    for (int bits = 1; bits <= max_len; bits++) {
-      code = (code + bl_count[bits - 1]) << 1;
-      next_code[bits] = code;
-    }
-
-    // For slow table: we need to track which symbols have which lengths
-    // First pass: build fast table
-    // Second pass: build slow table
-
-    // Reset next_code for second use
-    code = 0;
-    for (int bits = 1; bits <= max_len; bits++) {
-      code = (code + bl_count[bits - 1]) << 1;
-      next_code[bits] = code;
-    }
-
-    // Assign codes to symbols and fill fast table
-    for (int sym = 0; sym < count; sym++) {
-      int len = lens[sym];
-      if (len == 0) continue;
-
-      int code_val = next_code[len]++;
+  // Decode symbols until end of block. With kSuspend, also stop between
+  // symbols once out passes suspend_at so the caller can drain the output.
+  template <bool kSuspend>
+  BlockStatus decode_block(DeflateBitReader& reader,
+                           const DeflateLitLenTable& litlen,
+                           const DeflateDistTable& dist,
+                           uint8_t*& out,
+                           uint8_t* out_start,
+                           uint8_t* out_end,
+                           const uint8_t* suspend_at) {
+    // Work on local copies: byte stores through op may alias anything, so
+    // members would be reloaded after every store
+    DeflateBitReader r = reader;
+    uint8_t* op = out;
+    auto finish = [&](BlockStatus status) {
+      reader = r;
+      out = op;
+      return status;
+    };
 
-      // Reverse bits for deflate (LSB-first bit order)
-      int rev_code = 0;
-      for (int i = 0; i < len; i++) {
-        rev_code = (rev_code << 1) | ((code_val >> i) & 1);
+    // Fast loop. After refill_fast at least 56 bits are buffered, enough
+    // for a literal pair or a full length/distance pair with extra bits.
+    while (TINYEXR_LIKELY(r.end - r.ptr >= 8 &&
+                          out_end - op >= DEFLATE_FASTLOOP_MARGIN)) {
+      r.refill_fast();
+      uint32_t e = litlen.lookup(r);
+
+      if (e & DEFLATE_ENTRY_LITERAL) {
+        r.consume(static_cast<int>(e & 31));
+        op[0] = static_cast<uint8_t>(e >> 16);
+        op[1] = static_cast<uint8_t>(e >> 24);
+        op += 1 + ((e & DEFLATE_ENTRY_PAIR) != 0);
+        continue;
       }
-
-      // Fill fast table for codes <= 10 bits
-      if (len <= 10) {
-        int fill = 1 << (10 - len);
-        for (int i = 0; i < fill; i++) {
-          int idx = rev_code | (i << len);
-          if (idx < 1024) {
-            table->fast_table[idx] = static_cast<uint16_t>((sym << 4) | len | 0x8000);
-          }
-        }
+      if (TINYEXR_UNLIKELY(e & (DEFLATE_ENTRY_EOB | DEFLATE_ENTRY_INVALID))) {
+        r.consume(static_cast<int>(e & 31));
+        return finish((e & DEFLATE_ENTRY_EOB) ? kBlockEnd : kBlockError);
       }
-    }
 
-    // Build slow table for codes > 10 bits
-    // Format: [count_11][entries_11...][count_12][entries_12...]...[count_15][entries_15...]
-    // Each entry is: reversed_code, symbol
-    uint16_t* slow_ptr = table->slow_table;
-    const size_t slow_table_capacity = sizeof(table->slow_table) / sizeof(table->slow_table[0]);
-
-    // Reset next_code again for slow table pass
-    code = 0;
-    for (int bits = 1; bits <= max_len; bits++) {
-      code = (code + bl_count[bits - 1]) << 1;
-      next_code[bits] = code;
-    }
-
-    for (int target_bits = 11; target_bits <= 15; target_bits++) {
-      // Reserve space for count
-      if (static_cast<size_t>(slow_ptr - table->slow_table) >= slow_table_capacity - 1) {
-        break;  // Out of space
-      }
-      uint16_t* count_ptr = slow_ptr++;
-      uint16_t bit_count = 0;
-
-      // Scan all symbols for this bit length
-      // Reset next_code for this pass
-      int nc[DEFLATE_MAX_BITS + 1];
-      code = 0;
-      for (int bits = 1; bits <= max_len; bits++) {
-        code = (code + bl_count[bits - 1]) << 1;
-        nc[bits] = code;
+      uint32_t length = decode_value(r, e);
+      uint32_t d = dist.lookup(r);
+      if (TINYEXR_UNLIKELY(d & DEFLATE_ENTRY_INVALID)) {
+        return finish(kBlockError);  // Invalid distance symbol
       }
-
-      for (int sym = 0; sym < count; sym++) {
-        int len = lens[sym];
-        if (len != target_bits) {
-          if (len > 0) nc[len]++;  // Advance code counter
-          continue;
-        }
-
-        // Check space for entry (2 words: code + symbol)
-        if (static_cast<size_t>(slow_ptr - table->slow_table) >= slow_table_capacity - 2) {
-          break;
-        }
-
-        int code_val = nc[len]++;
-
-        // Reverse bits for deflate (LSB-first bit order)
-        int rev_code = 0;
-        for (int i = 0; i < len; i++) {
-          rev_code = (rev_code << 1) | ((code_val >> i) & 1);
-        }
-
-        *slow_ptr++ = static_cast<uint16_t>(rev_code);
-        *slow_ptr++ = static_cast<uint16_t>(sym);
-        bit_count++;
-        table->slow_count++;
+      uint32_t distance = decode_value(r, d);
+      if (TINYEXR_UNLIKELY(static_cast<size_t>(op - out_start) < distance)) {
+        return finish(kBlockError);  // Distance too far back
       }
-
-      *count_ptr = bit_count;
+      copy_match_fast(op, distance, length);
+      op += length;
     }
 
-    return true;
-  }
-
-  bool decode_block(DeflateBitReader& reader,
-                   const DeflateHuffTable* litlen,
-                   const DeflateHuffTable* dist,
-                   uint8_t*& out,
-                   uint8_t* out_start,
-                   uint8_t* out_end) {
+    // Careful loop near the end of input or output
     while (true) {
-      int sym = decode_symbol(reader, litlen);
-
-      if (sym < 0) {
-        return false;  // Decode error
+      if (kSuspend && TINYEXR_UNLIKELY(op > suspend_at)) {
+        return finish(kBlockSuspended);
       }
 
-      if (sym < 256) {
-        // Literal byte
-        if (TINYEXR_UNLIKELY(out >= out_end)) {
-          return false;  // Output overflow
-        }
-        *out++ = static_cast<uint8_t>(sym);
-      } else if (sym == 256) {
-        // End of block
-        return true;
-      } else {
-        // Length-distance pair
-        int length_sym = sym - 257;
-        if (length_sym >= 29) {
-          return false;  // Invalid length symbol
-        }
-
-        // Get length
-        int length = LENGTH_BASE[length_sym];
-        int extra_bits = LENGTH_EXTRA[length_sym];
-        if (extra_bits > 0) {
-          if (reader.count < extra_bits) reader.refill();
-          length += reader.read(extra_bits);
-        }
+      r.refill();
+      uint32_t e = litlen.lookup(r);
 
-        // Get distance
-        int dist_sym = decode_symbol(reader, dist);
-        if (dist_sym < 0 || dist_sym >= 30) {
-          return false;  // Invalid distance symbol
+      if (e & DEFLATE_ENTRY_LITERAL) {
+        if (TINYEXR_UNLIKELY(op >= out_end)) {
+          return finish(kBlockError);  // Output overflow
         }
-
-        int distance = DIST_BASE[dist_sym];
-        extra_bits = DIST_EXTRA[dist_sym];
-        if (extra_bits > 0) {
-          if (reader.count < extra_bits) reader.refill();
-          distance += reader.read(extra_bits);
+        if ((e & DEFLATE_ENTRY_PAIR) && out_end - op >= 2) {
+          r.consume(static_cast<int>(e & 31));
+          op[0] = static_cast<uint8_t>(e >> 16);
+          op[1] = static_cast<uint8_t>(e >> 24);
+          op += 2;
+        } else {
+          // Single literal, or only the first of a pair (its own length)
+          int len = static_cast<int>((e & DEFLATE_ENTRY_PAIR) ? (e >> 5) & 15 : e & 31);
+          r.consume(len);
+          *op++ = static_cast<uint8_t>(e >> 16);
         }
+        continue;
+      }
+      if (e & (DEFLATE_ENTRY_EOB | DEFLATE_ENTRY_INVALID)) {
+        r.consume(static_cast<int>(e & 31));
+        return finish((e & DEFLATE_ENTRY_EOB) ? kBlockEnd : kBlockError);
+      }
 
-        // Copy match
-        if (TINYEXR_UNLIKELY(out + length > out_end)) {
-          return false;  // Output overflow
-        }
-        if (TINYEXR_UNLIKELY(out - out_start < distance)) {
-          return false;  // Distance too far back
-        }
+      uint32_t length = decode_value(r, e);
+      uint32_t d = dist.lookup(r);
+      if (d & DEFLATE_ENTRY_INVALID) {
+        return finish(kBlockError);  // Invalid distance symbol
+      }
+      uint32_t distance = decode_value(r, d);
 
-        const uint8_t* match = out - distance;
-        copy_match(out, match, length, distance);
-        out += length;
+      // Copy match
+      if (TINYEXR_UNLIKELY(static_cast<size_t>(out_end - op) < length)) {
+        return finish(kBlockError);  // Output overflow
       }
+      if (TINYEXR_UNLIKELY(static_cast<size_t>(op - out_start) < distance)) {
+        return finish(kBlockError);  // Distance too far back
+      }
+      copy_match(op, op - distance, static_cast<int>(length), static_cast<int>(distance));
+      op += length;
+    }
+  }
+
+  // Match copy for the fast loop: whole words, so up to 15 bytes past the
+  // match may be written (covered by DEFLATE_FASTLOOP_MARGIN). Words never
+  // overlap their source when distance >= word size; short distances
+  // replicate the pattern byte by byte except for runs of one byte.
+  static TINYEXR_ALWAYS_INLINE void copy_match_fast(uint8_t* dst, uint32_t distance,
+                                                    uint32_t length) {
+    const uint8_t* src = dst - distance;
+    uint8_t* end = dst + length;
+
+    if (TINYEXR_LIKELY(distance >= 16)) {
+      do {
+        std::memcpy(dst, src, 16);
+        dst += 16;
+        src += 16;
+      } while (dst < end);
+    } else if (distance >= 8) {
+      do {
+        std::memcpy(dst, src, 8);
+        dst += 8;
+        src += 8;
+      } while (dst < end);
+    } else if (distance == 1) {
+      uint64_t v = 0x0101010101010101ULL * src[0];
+      do {
+        std::memcpy(dst, &v, 8);
+        dst += 8;
+      } while (dst < end);
+    } else {
+      do {
+        *dst++ = *src++;
+      } while (dst < end);
     }
   }
 
@@ -1343,9 +1683,10 @@ inline bool inflate(const uint8_t* src, size_t src_len,
   return decoder.decompress(src, src_len, dst, dst_len);
 }
 
-// Decompress zlib data (with 2-byte header)
-inline bool inflate_zlib(const uint8_t* src, size_t src_len,
-                        uint8_t* dst, size_t* dst_len) {
+// Locate the deflate payload of a zlib stream (2-byte header, optional
+// dictionary id, trailing 4-byte Adler-32 which is not checked)
+inline bool zlib_payload(const uint8_t* src, size_t src_len,
+                         const uint8_t** payload, size_t* payload_len) {
   if (src_len < 2) return false;
 
   // Check zlib header
@@ -1363,9 +1704,778 @@ inline bool inflate_zlib(const uint8_t* src, size_t src_len,
     offset += 4;
   }
 
-  // Decompress (ignoring trailing 4-byte Adler-32 checksum)
   if (src_len - offset < 4) return false;
-  return inflate(src + offset, src_len - offset - 4, dst, dst_len);
+  *payload = src + offset;
+  *payload_len = src_len - offset - 4;
+  return true;
+}
+
+// Decompress zlib data (with 2-byte header)
+inline bool inflate_zlib(const uint8_t* src, size_t src_len,
+                        uint8_t* dst, size_t* dst_len) {
+  const uint8_t* payload;
+  size_t payload_len;
+  if (!zlib_payload(src, src_len, &payload, &payload_len)) return false;
+  return inflate(payload, payload_len, dst, dst_len);
+}
+
+// Decompress an EXR ZIP chunk (zlib data) of exactly dst_len bytes straight
+// into dst, undoing the predictor and byte reorder on the fly. `window` is
+// scratch of min(dst_len, DEFLATE_UNPREDICT_WINDOW) bytes or more. Returns
+// false if the stream is malformed or does not decode to dst_len bytes;
+// callers can fall back to inflate_zlib in that case.
+inline bool inflate_zlib_unpredict(const uint8_t* src, size_t src_len,
+                                   uint8_t* dst, size_t dst_len,
+                                   uint8_t* window, size_t window_size) {
+  const uint8_t* payload;
+  size_t payload_len;
+  if (!zlib_payload(src, src_len, &payload, &payload_len)) return false;
+  FastDeflateDecoder decoder;
+  return decoder.decompress_unpredict(payload, payload_len, dst, dst_len,
+                                      window, window_size);
+}
+
+// ============================================================================
+// Deflate Compression
+// ============================================================================
+//
+// zlib-format compressor for ZIP/ZIPS/PXR24 chunks. Level 0 stores, 1 is
+// greedy with a single hash probe per position and skips ahead through
+// incompressible data, 2-3 are greedy over short hash chains and 4-9 use
+// lazy matching with zlib's chain limits. Match
+// lengths are measured a word (or 16-byte vector) at a time. Each block of
+// up to DEFLATE_BLOCK_ITEMS symbols is written with whichever of dynamic,
+// fixed or stored coding is smallest.
+
+static const int DEFLATE_MIN_MATCH = 3;
+static const int DEFLATE_BLOCK_ITEMS = 16383;
+static const int DEFLATE_MAX_HASH_BITS = 16;
+
+// Worst-case zlib stream size for src_len bytes: every block stored (a
+// literal-only block covers DEFLATE_BLOCK_ITEMS bytes and is split into
+// 64KB stored pieces), the 2-byte header and Adler-32, plus slack for the
+// 8-byte bit flushes
+inline size_t deflate_zlib_bound(size_t src_len) {
+  return src_len + 6 * (src_len / DEFLATE_BLOCK_ITEMS + src_len / 65535 + 2) + 6 + 8;
+}
+
+// Adler-32 over data, continuing from `adler`
+inline uint32_t deflate_adler32(const uint8_t* data, size_t len, uint32_t adler = 1) {
+  uint32_t a = adler & 0xFFFF;
+  uint32_t b = adler >> 16;
+  while (len > 0) {
+    // Largest n with no uint32 overflow before the modulo
+    size_t n = len < 5552 ? len : 5552;
+    len -= n;
+    for (; n >= 8; n -= 8, data += 8) {
+      a += data[0]; b += a;
+      a += data[1]; b += a;
+      a += data[2]; b += a;
+      a += data[3]; b += a;
+      a += data[4]; b += a;
+      a += data[5]; b += a;
+      a += data[6]; b += a;
+      a += data[7]; b += a;
+    }
+    for (; n > 0; n--) {
+      a += *data++;
+      b += a;
+    }
+    a %= 65521;
+    b %= 65521;
+  }
+  return (b << 16) | a;
+}
+
+// Huffman code lengths for `freq`, limited to max_bits. Symbols with zero
+// frequency get length 0; a code with fewer than two symbols is padded to
+// two so every decoder accepts it.
+inline void deflate_build_lengths(const uint32_t* freq, int n, int max_bits, uint8_t* lens) {
+  int leaves[DEFLATE_LITLEN_CODES];
+  int count = 0;
+  for (int i = 0; i < n; i++) {
+    lens[i] = 0;
+    if (freq[i]) leaves[count++] = i;
+  }
+  if (count < 2) {
+    int first = count ? leaves[0] : 0;
+    lens[first] = 1;
+    lens[first == 0 ? 1 : 0] = 1;
+    return;
+  }
+
+  // Leaves by ascending frequency (insertion sort; n <= 288)
+  for (int i = 1; i < count; i++) {
+    int s = leaves[i];
+    int j = i;
+    for (; j > 0 && freq[leaves[j - 1]] > freq[s]; j--) {
+      leaves[j] = leaves[j - 1];
+    }
+    leaves[j] = s;
+  }
+
+  // Two-queue Huffman construction: internal nodes are created in
+  // non-decreasing weight order, so both queues stay sorted
+  uint32_t weight[2 * DEFLATE_LITLEN_CODES];
+  int parent[2 * DEFLATE_LITLEN_CODES];
+  for (int i = 0; i < count; i++) {
+    weight[i] = freq[leaves[i]];
+  }
+  int leaf = 0;
+  int inner = count;
+  int next = count;
+  for (int k = 0; k < count - 1; k++) {
+    int pick[2];
+    for (int p = 0; p < 2; p++) {
+      if (leaf < count && (inner >= next || weight[leaf] <= weight[inner])) {
+        pick[p] = leaf++;
+      } else {
+        pick[p] = inner++;
+      }
+    }
+    weight[next] = weight[pick[0]] + weight[pick[1]];
+    parent[pick[0]] = next;
+    parent[pick[1]] = next;
+    next++;
+  }
+
+  // Depths, clamped to max_bits
+  int depth[2 * DEFLATE_LITLEN_CODES];
+  int bl_count[DEFLATE_MAX_BITS + 2] = {0};
+  depth[next - 1] = 0;
+  for (int i = next - 2; i >= 0; i--) {
+    depth[i] = depth[parent[i]] + 1;
+  }
+  for (int i = 0; i < count; i++) {
+    bl_count[depth[i] < max_bits ? depth[i] : max_bits]++;
+  }
+
+  // Restore the Kraft sum after clamping: drop a max-length code and split
+  // the longest shorter code until the code is complete again
+  uint32_t total = 0;
+  for (int i = max_bits; i > 0; i--) {
+    total += static_cast<uint32_t>(bl_count[i]) << (max_bits - i);
+  }
+  while (total != (1u << max_bits)) {
+    bl_count[max_bits]--;
+    for (int i = max_bits - 1; i > 0; i--) {
+      if (bl_count[i]) {
+        bl_count[i]--;
+        bl_count[i + 1] += 2;
+        break;
+      }
+    }
+    total--;
+  }
+
+  // Longest codes to the rarest symbols
+  int i = 0;
+  for (int len = max_bits; len > 0; len--) {
+    for (int c = bl_count[len]; c > 0; c--) {
+      lens[leaves[i++]] = static_cast<uint8_t>(len);
+    }
+  }
+}
+
+// Bit-reversed canonical codes (deflate writes codes LSB first)
+inline void deflate_make_codes(const uint8_t* lens, int n, uint16_t* codes) {
+  int bl_count[DEFLATE_MAX_BITS + 1] = {0};
+  for (int i = 0; i < n; i++) {
+    bl_count[lens[i]]++;
+  }
+  bl_count[0] = 0;
+  int next_code[DEFLATE_MAX_BITS + 1] = {0};
+  int code = 0;
+  for (int len = 1; len <= DEFLATE_MAX_BITS; len++) {
+    code = (code + bl_count[len - 1]) << 1;
+    next_code[len] = code;
+  }
+  for (int i = 0; i < n; i++) {
+    int len = lens[i];
+    int c = len ? next_code[len]++ : 0;
+    int rev = 0;
+    for (int b = 0; b < len; b++) {
+      rev = (rev << 1) | ((c >> b) & 1);
+    }
+    codes[i] = static_cast<uint16_t>(rev);
+  }
+}
+
+// Bit writer for deflate (LSB first). Flushes write 8 bytes at once, so
+// the output needs 8 bytes of slack past the last byte written.
+struct DeflateBitWriter {
+  uint64_t bits;
+  int count;
+  uint8_t* ptr;
+
+  void init(uint8_t* out) {
+    bits = 0;
+    count = 0;
+    ptr = out;
+  }
+
+  // Append n <= 32 bits
+  TINYEXR_ALWAYS_INLINE void put(uint32_t value, int n) {
+    bits |= static_cast<uint64_t>(value) << count;
+    count += n;
+    if (count >= 32) {
+      uint64_t word = bits;
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+      word = bswap64(word);
+#endif
+      std::memcpy(ptr, &word, 8);
+      int nbytes = count >> 3;
+      ptr += nbytes;
+      bits >>= nbytes * 8;
+      count &= 7;
+    }
+  }
+
+  // Pad to a byte boundary and write out everything buffered
+  void align_to_byte() {
+    while (count > 0) {
+      *ptr++ = static_cast<uint8_t>(bits);
+      bits >>= 8;
+      count = count > 8 ? count - 8 : 0;
+    }
+  }
+};
+
+// Length and distance to symbol maps, plus the fixed-block code lengths.
+// Distances above 256 are looked up by (dist - 1) >> 7: every distance
+// code past 16 spans a multiple of 128.
+struct DeflateEncodeTables {
+  uint8_t length_sym[DEFLATE_MAX_MATCH + 1];
+  uint8_t dist_sym_lo[256];
+  uint8_t dist_sym_hi[256];
+  uint8_t fixed_litlen_lens[DEFLATE_LITLEN_CODES];
+  uint8_t fixed_dist_lens[DEFLATE_DIST_CODES];
+
+  DeflateEncodeTables() {
+    for (int sym = 0; sym < 29; sym++) {
+      int end = LENGTH_BASE[sym] + (1 << LENGTH_EXTRA[sym]);
+      for (int len = LENGTH_BASE[sym]; len < end && len <= DEFLATE_MAX_MATCH; len++) {
+        length_sym[len] = static_cast<uint8_t>(sym);
+      }
+    }
+    length_sym[DEFLATE_MAX_MATCH] = 28;
+    for (int sym = 0; sym < 30; sym++) {
+      int first = DIST_BASE[sym] - 1;
+      int last = first + (1 << DIST_EXTRA[sym]) - 1;
+      if (first < 256) {
+        for (int d = first; d <= last; d++) dist_sym_lo[d] = static_cast<uint8_t>(sym);
+      } else {
+        for (int i = first >> 7; i <= (last >> 7); i++) dist_sym_hi[i] = static_cast<uint8_t>(sym);
+      }
+    }
+    for (int sym = 0; sym < DEFLATE_LITLEN_CODES; sym++) {
+      fixed_litlen_lens[sym] = sym <= 143 ? 8 : sym <= 255 ? 9 : sym <= 279 ? 7 : 8;
+    }
+    for (int sym = 0; sym < DEFLATE_DIST_CODES; sym++) {
+      fixed_dist_lens[sym] = 5;
+    }
+  }
+};
+
+inline const DeflateEncodeTables& deflate_encode_tables() {
+  static const DeflateEncodeTables tables;
+  return tables;
+}
+
+class FastDeflateEncoder {
+public:
+  explicit FastDeflateEncoder(int level) {
+    // good_length, max_lazy (max_insert for greedy levels), nice_length,
+    // max_chain for levels 2-9, as in zlib (level 1 has its own loop)
+    static const uint16_t kConfig[10][4] = {
+      {0, 0, 0, 0},       {0, 0, 0, 0},         {4, 5, 16, 8},
+      {4, 6, 32, 32},     {4, 4, 16, 16},       {8, 16, 32, 32},
+      {8, 16, 128, 128},  {8, 32, 128, 256},    {32, 128, 258, 1024},
+      {32, 258, 258, 4096}
+    };
+    if (level < 0 || level > 9) level = 6;
+    level_ = level;
+    good_length_ = kConfig[level][0];
+    max_lazy_ = kConfig[level][1];
+    nice_length_ = kConfig[level][2];
+    max_chain_ = kConfig[level][3];
+  }
+
+  // Compress src into a zlib stream. dst_capacity must be at least
+  // deflate_zlib_bound(src_len). Returns the stream size, or 0 on failure.
+  size_t compress_zlib(const uint8_t* src, size_t src_len,
+                       uint8_t* dst, size_t dst_capacity) {
+    if (dst_capacity < deflate_zlib_bound(src_len)) {
+      return 0;
+    }
+
+    tables_ = &deflate_encode_tables();
+    src_ = src;
+    src_len_ = src_len;
+    block_start_ = 0;
+    block_len_ = 0;
+    num_items_ = 0;
+    // A block never holds more items than there are input bytes
+    block_items_ = src_len < static_cast<size_t>(DEFLATE_BLOCK_ITEMS) ? static_cast<int>(src_len) + 1
+                                                                      : DEFLATE_BLOCK_ITEMS;
+    if (items_.size() < static_cast<size_t>(block_items_)) items_.resize(block_items_);
+    std::memset(litlen_freq_, 0, sizeof(litlen_freq_));
+    std::memset(dist_freq_, 0, sizeof(dist_freq_));
+
+    // zlib header: deflate, 32KB window, FLEVEL from the level
+    int flevel = level_ < 2 ? 0 : level_ < 6 ? 1 : level_ == 6 ? 2 : 3;
+    uint32_t header = (0x78u << 8) | (static_cast<uint32_t>(flevel) << 6);
+    header += 31 - header % 31;
+    dst[0] = static_cast<uint8_t>(header >> 8);
+    dst[1] = static_cast<uint8_t>(header);
+    writer_.init(dst + 2);
+
+    if (level_ == 0) {
+      write_stored(src, src_len, true);
+    } else {
+      int hash_bits = 10;
+      while (hash_bits < DEFLATE_MAX_HASH_BITS && (static_cast<size_t>(1) << hash_bits) < src_len) {
+        hash_bits++;
+      }
+      hash_shift_ = 32 - hash_bits;
+      head_.assign(static_cast<size_t>(1) << hash_bits, -1);
+      // Only positions < src_len are ever linked, so short inputs need no
+      // more than src_len chain slots
+      size_t prev_size = src_len < DEFLATE_HISTORY ? src_len : DEFLATE_HISTORY;
+      if (prev_.size() < prev_size) prev_.resize(prev_size);
+
+      if (level_ == 1) {
+        compress_fast();
+      } else if (level_ <= 3) {
+        compress_greedy();
+      } else {
+        compress_lazy();
+      }
+      flush_block(true);
+    }
+
+    writer_.align_to_byte();
+    uint32_t adler = deflate_adler32(src, src_len);
+    writer_.ptr[0] = static_cast<uint8_t>(adler >> 24);
+    writer_.ptr[1] = static_cast<uint8_t>(adler >> 16);
+    writer_.ptr[2] = static_cast<uint8_t>(adler >> 8);
+    writer_.ptr[3] = static_cast<uint8_t>(adler);
+    return static_cast<size_t>(writer_.ptr + 4 - dst);
+  }
+
+private:
+  int level_;
+  int good_length_;
+  int max_lazy_;
+  int nice_length_;
+  int max_chain_;
+
+  const DeflateEncodeTables* tables_;
+
+  const uint8_t* src_;
+  size_t src_len_;
+  int hash_shift_;
+  std::vector<int32_t> head_;
+  std::vector<int32_t> prev_;
+
+  // Pending block: literals as the byte value, matches as
+  // 0x80000000 | length << 16 | (distance - 1)
+  std::vector<uint32_t> items_;
+  int block_items_;
+  int num_items_;
+  size_t block_start_;
+  size_t block_len_;
+  uint32_t litlen_freq_[DEFLATE_LITLEN_CODES];
+  uint32_t dist_freq_[DEFLATE_DIST_CODES];
+
+  DeflateBitWriter writer_;
+
+  TINYEXR_ALWAYS_INLINE uint32_t hash(size_t pos) const {
+    uint32_t v;
+    std::memcpy(&v, src_ + pos, 4);
+    return (v * 0x1E35A7BDu) >> hash_shift_;
+  }
+
+  TINYEXR_ALWAYS_INLINE int dist_sym(uint32_t dist) const {
+    return dist <= 256 ? tables_->dist_sym_lo[dist - 1] : tables_->dist_sym_hi[(dist - 1) >> 7];
+  }
+
+  // Length of the common prefix of a and b, up to max_len
+  static TINYEXR_ALWAYS_INLINE int match_length(const uint8_t* a, const uint8_t* b, int max_len) {
+    int len = 0;
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    // Byte compare only; the word trick below assumes little endian
+#elif defined(TINYEXR_ENABLE_SIMD) && TINYEXR_ENABLE_SIMD && defined(TINYEXR_SIMD_SSE2) && TINYEXR_SIMD_SSE2
+    for (; len + 16 <= max_len; len += 16) {
+      __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + len));
+      __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + len));
+      uint32_t diff = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb))) ^ 0xFFFFu;
+      if (diff) {
+        return len + static_cast<int>(ctz32(diff));
+      }
+    }
+#else
+    for (; len + 8 <= max_len; len += 8) {
+      uint64_t va, vb;
+      std::memcpy(&va, a + len, 8);
+      std::memcpy(&vb, b + len, 8);
+      if (va != vb) {
+        return len + static_cast<int>(ctz64(va ^ vb) >> 3);
+      }
+    }
+#endif
+    while (len < max_len && a[len] == b[len]) {
+      len++;
+    }
+    return len;
+  }
+
+  TINYEXR_ALWAYS_INLINE void insert(size_t pos, uint32_t h) {
+    prev_[pos & (DEFLATE_HISTORY - 1)] = head_[h];
+    head_[h] = static_cast<int32_t>(pos);
+  }
+
+  // Walk the hash chain from `cand` for a match longer than best_len.
+  // Returns the best length found (best_len if none) and its distance.
+  int longest_match(size_t pos, int32_t cand, int best_len, uint32_t* best_dist) const {
+    size_t avail = src_len_ - pos;
+    int max_len = avail < static_cast<size_t>(DEFLATE_MAX_MATCH) ? static_cast<int>(avail) : DEFLATE_MAX_MATCH;
+    if (best_len >= max_len) return best_len;
+
+    int chain = max_chain_;
+    if (best_len >= good_length_) chain >>= 2;
+    int nice = nice_length_ < max_len ? nice_length_ : max_len;
+    int64_t limit = static_cast<int64_t>(pos) - static_cast<int64_t>(DEFLATE_HISTORY);
+    const uint8_t* cur = src_ + pos;
+
+    while (cand >= 0 && cand > limit - 1 && chain-- > 0) {
+      const uint8_t* m = src_ + cand;
+      // Cheap rejects: the byte that would extend the best match, then
+      // the first four bytes (hash collisions)
+      if (m[best_len] == cur[best_len] && std::memcmp(m, cur, 4) == 0) {
+        int len = 4 + match_length(m + 4, cur + 4, max_len - 4);
+        if (len > best_len) {
+          best_len = len;
+          *best_dist = static_cast<uint32_t>(pos - static_cast<size_t>(cand));
+          if (len >= nice) break;
+        }
+      }
+      int32_t next = prev_[static_cast<size_t>(cand) & (DEFLATE_HISTORY - 1)];
+      if (next >= cand) break;  // Slot reused by a newer position
+      cand = next;
+    }
+    return best_len;
+  }
+
+  TINYEXR_ALWAYS_INLINE void emit_literal(uint8_t c) {
+    items_[num_items_++] = c;
+    litlen_freq_[c]++;
+    block_len_++;
+    if (num_items_ == block_items_) flush_block(false);
+  }
+
+  TINYEXR_ALWAYS_INLINE void emit_match(int len, uint32_t dist) {
+    items_[num_items_++] = 0x80000000u | (static_cast<uint32_t>(len) << 16) | (dist - 1);
+    litlen_freq_[257 + tables_->length_sym[len]]++;
+    dist_freq_[dist_sym(dist)]++;
+    block_len_ += static_cast<size_t>(len);
+    if (num_items_ == block_items_) flush_block(false);
+  }
+
+  // Level 1: one probe of the hash head per position, no chains. After a
+  // run of misses the scan skips ahead (emitting the bytes as literals),
+  // which keeps incompressible float data close to memcpy speed.
+  void compress_fast() {
+    const size_t n = src_len_;
+    size_t pos = 0;
+    size_t literal_start = 0;
+    uint32_t misses = 0;
+    while (pos + 4 <= n) {
+      uint32_t h = hash(pos);
+      int32_t cand = head_[h];
+      head_[h] = static_cast<int32_t>(pos);
+      uint32_t dist = static_cast<uint32_t>(pos - static_cast<size_t>(cand));
+      if (cand < 0 || dist > static_cast<uint32_t>(DEFLATE_HISTORY) ||
+          std::memcmp(src_ + cand, src_ + pos, 4) != 0) {
+        pos += 1 + (misses++ >> 6);
+        continue;
+      }
+      misses = 0;
+      for (; literal_start < pos; literal_start++) {
+        emit_literal(src_[literal_start]);
+      }
+      size_t avail = n - pos;
+      int max_len = avail < static_cast<size_t>(DEFLATE_MAX_MATCH) ? static_cast<int>(avail) : DEFLATE_MAX_MATCH;
+      int len = 4 + match_length(src_ + cand + 4, src_ + pos + 4, max_len - 4);
+      emit_match(len, dist);
+      pos += static_cast<size_t>(len);
+      literal_start = pos;
+      // Seed the table with the match's last position for the next probe
+      if (pos + 4 <= n) {
+        head_[hash(pos - 1)] = static_cast<int32_t>(pos - 1);
+      }
+    }
+    for (; literal_start < n; literal_start++) {
+      emit_literal(src_[literal_start]);
+    }
+  }
+
+  // Levels 2-3 (zlib's deflate_fast): take the longest match at each
+  // position; short matches also hash the positions they cover
+  void compress_greedy() {
+    const size_t n = src_len_;
+    size_t pos = 0;
+    while (pos + 4 <= n) {
+      uint32_t h = hash(pos);
+      int32_t cand = head_[h];
+      uint32_t dist = 0;
+      int len = longest_match(pos, cand, DEFLATE_MIN_MATCH - 1, &dist);
+      insert(pos, h);
+      if (len == DEFLATE_MIN_MATCH && dist > 4096) len = 0;
+
+      if (len >= DEFLATE_MIN_MATCH) {
+        emit_match(len, dist);
+        size_t end = pos + static_cast<size_t>(len);
+        if (len <= max_lazy_) {
+          for (pos++; pos < end && pos + 4 <= n; pos++) {
+            insert(pos, hash(pos));
+          }
+        }
+        pos = end;
+      } else {
+        emit_literal(src_[pos]);
+        pos++;
+      }
+    }
+    for (; pos < n; pos++) {
+      emit_literal(src_[pos]);
+    }
+  }
+
+  // Levels 4-9 (zlib's deflate_slow): keep a match pending for one byte
+  // and emit it only if the next position does not start a longer one
+  void compress_lazy() {
+    const size_t n = src_len_;
+    size_t pos = 0;
+    int prev_len = DEFLATE_MIN_MATCH - 1;
+    uint32_t prev_dist = 0;
+    bool pending_literal = false;
+
+    while (pos < n) {
+      int len = DEFLATE_MIN_MATCH - 1;
+      uint32_t dist = 0;
+      if (pos + 4 <= n) {
+        uint32_t h = hash(pos);
+        if (prev_len < max_lazy_) {
+          len = longest_match(pos, head_[h], prev_len, &dist);
+          if (len == prev_len) len = DEFLATE_MIN_MATCH - 1;
+          if (len == DEFLATE_MIN_MATCH && dist > 4096) len = DEFLATE_MIN_MATCH - 1;
+        }
+        insert(pos, h);
+      }
+
+      if (prev_len >= DEFLATE_MIN_MATCH && len <= prev_len) {
+        // The match at pos - 1 wins
+        emit_match(prev_len, prev_dist);
+        size_t end = pos - 1 + static_cast<size_t>(prev_len);
+        for (pos++; pos < end && pos + 4 <= n; pos++) {
+          insert(pos, hash(pos));
+        }
+        pos = end;
+        prev_len = DEFLATE_MIN_MATCH - 1;
+        pending_literal = false;
+      } else {
+        if (pending_literal) {
+          emit_literal(src_[pos - 1]);
+        }
+        pending_literal = true;
+        prev_len = len;
+        prev_dist = dist;
+        pos++;
+      }
+    }
+    if (pending_literal) {
+      emit_literal(src_[pos - 1]);
+    }
+  }
+
+  void write_stored(const uint8_t* data, size_t len, bool final_block) {
+    do {
+      size_t n = len < 65535 ? len : 65535;
+      len -= n;
+      writer_.put((final_block && len == 0) ? 1 : 0, 3);
+      writer_.align_to_byte();
+      uint8_t* p = writer_.ptr;
+      p[0] = static_cast<uint8_t>(n);
+      p[1] = static_cast<uint8_t>(n >> 8);
+      p[2] = static_cast<uint8_t>(~n);
+      p[3] = static_cast<uint8_t>(~n >> 8);
+      std::memcpy(p + 4, data, n);
+      writer_.ptr = p + 4 + n;
+      data += n;
+    } while (len > 0);
+  }
+
+  // Write the pending symbols as one block in its cheapest form
+  void flush_block(bool final_block) {
+    litlen_freq_[256]++;
+
+    uint8_t litlen_lens[DEFLATE_LITLEN_CODES];
+    uint8_t dist_lens[DEFLATE_DIST_CODES];
+    deflate_build_lengths(litlen_freq_, 286, DEFLATE_MAX_BITS, litlen_lens);
+    deflate_build_lengths(dist_freq_, 30, DEFLATE_MAX_BITS, dist_lens);
+    litlen_lens[286] = litlen_lens[287] = 0;
+    dist_lens[30] = dist_lens[31] = 0;
+
+    int hlit = 286;
+    while (hlit > 257 && litlen_lens[hlit - 1] == 0) hlit--;
+    int hdist = 30;
+    while (hdist > 1 && dist_lens[hdist - 1] == 0) hdist--;
+
+    // Run-length code the code lengths (symbols 16/17/18)
+    uint8_t all_lens[DEFLATE_LITLEN_CODES + DEFLATE_DIST_CODES];
+    std::memcpy(all_lens, litlen_lens, static_cast<size_t>(hlit));
+    std::memcpy(all_lens + hlit, dist_lens, static_cast<size_t>(hdist));
+    int total = hlit + hdist;
+    uint8_t rle_sym[DEFLATE_LITLEN_CODES + DEFLATE_DIST_CODES];
+    uint8_t rle_extra[DEFLATE_LITLEN_CODES + DEFLATE_DIST_CODES];
+    int num_rle = 0;
+    uint32_t codelen_freq[DEFLATE_CODELEN_CODES] = {0};
+    for (int i = 0; i < total;) {
+      uint8_t v = all_lens[i];
+      int run = 1;
+      while (i + run < total && all_lens[i + run] == v) run++;
+      i += run;
+      if (v == 0) {
+        while (run >= 11) {
+          int r = run < 138 ? run : 138;
+          rle_sym[num_rle] = 18;
+          rle_extra[num_rle++] = static_cast<uint8_t>(r - 11);
+          run -= r;
+        }
+        if (run >= 3) {
+          rle_sym[num_rle] = 17;
+          rle_extra[num_rle++] = static_cast<uint8_t>(run - 3);
+          run = 0;
+        }
+      } else {
+        rle_sym[num_rle] = v;
+        rle_extra[num_rle++] = 0;
+        run--;
+        while (run >= 3) {
+          int r = run < 6 ? run : 6;
+          rle_sym[num_rle] = 16;
+          rle_extra[num_rle++] = static_cast<uint8_t>(r - 3);
+          run -= r;
+        }
+      }
+      while (run-- > 0) {
+        rle_sym[num_rle] = v;
+        rle_extra[num_rle++] = 0;
+      }
+    }
+    for (int i = 0; i < num_rle; i++) {
+      codelen_freq[rle_sym[i]]++;
+    }
+    uint8_t codelen_lens[DEFLATE_CODELEN_CODES];
+    deflate_build_lengths(codelen_freq, DEFLATE_CODELEN_CODES, 7, codelen_lens);
+    int hclen = DEFLATE_CODELEN_CODES;
+    while (hclen > 4 && codelen_lens[DEFLATE_CODELEN_ORDER[hclen - 1]] == 0) hclen--;
+
+    // Block sizes in bits
+    static const uint8_t kRleExtraBits[3] = {2, 3, 7};
+    uint64_t header_bits = 5 + 5 + 4 + 3 * static_cast<uint64_t>(hclen);
+    for (int i = 0; i < DEFLATE_CODELEN_CODES; i++) {
+      header_bits += static_cast<uint64_t>(codelen_freq[i]) *
+                     (codelen_lens[i] + (i >= 16 ? kRleExtraBits[i - 16] : 0));
+    }
+    uint64_t extra_bits = 0;
+    uint64_t dynamic_bits = header_bits;
+    uint64_t fixed_bits = 0;
+    for (int i = 0; i < 286; i++) {
+      uint32_t f = litlen_freq_[i];
+      if (!f) continue;
+      dynamic_bits += static_cast<uint64_t>(f) * litlen_lens[i];
+      fixed_bits += static_cast<uint64_t>(f) * tables_->fixed_litlen_lens[i];
+      if (i >= 257) extra_bits += static_cast<uint64_t>(f) * LENGTH_EXTRA[i - 257];
+    }
+    for (int i = 0; i < 30; i++) {
+      uint32_t f = dist_freq_[i];
+      if (!f) continue;
+      dynamic_bits += static_cast<uint64_t>(f) * dist_lens[i];
+      fixed_bits += static_cast<uint64_t>(f) * 5;
+      extra_bits += static_cast<uint64_t>(f) * DIST_EXTRA[i];
+    }
+    dynamic_bits += extra_bits;
+    fixed_bits += extra_bits;
+    uint64_t stored_bits = 8 * static_cast<uint64_t>(block_len_) +
+                           (3 + 7 + 32) * (block_len_ / 65535 + 1);
+
+    if (stored_bits <= dynamic_bits + 3 && stored_bits <= fixed_bits + 3) {
+      write_stored(src_ + block_start_, block_len_, final_block);
+    } else if (fixed_bits <= dynamic_bits) {
+      writer_.put(final_block ? 3 : 2, 3);
+      write_symbols(tables_->fixed_litlen_lens, tables_->fixed_dist_lens);
+    } else {
+      writer_.put(final_block ? 5 : 4, 3);
+      writer_.put(static_cast<uint32_t>(hlit - 257), 5);
+      writer_.put(static_cast<uint32_t>(hdist - 1), 5);
+      writer_.put(static_cast<uint32_t>(hclen - 4), 4);
+      for (int i = 0; i < hclen; i++) {
+        writer_.put(codelen_lens[DEFLATE_CODELEN_ORDER[i]], 3);
+      }
+      uint16_t codelen_codes[DEFLATE_CODELEN_CODES];
+      deflate_make_codes(codelen_lens, DEFLATE_CODELEN_CODES, codelen_codes);
+      for (int i = 0; i < num_rle; i++) {
+        int s = rle_sym[i];
+        writer_.put(codelen_codes[s], codelen_lens[s]);
+        if (s >= 16) writer_.put(rle_extra[i], kRleExtraBits[s - 16]);
+      }
+      write_symbols(litlen_lens, dist_lens);
+    }
+
+    block_start_ += block_len_;
+    block_len_ = 0;
+    num_items_ = 0;
+    std::memset(litlen_freq_, 0, sizeof(litlen_freq_));
+    std::memset(dist_freq_, 0, sizeof(dist_freq_));
+  }
+
+  void write_symbols(const uint8_t* litlen_lens, const uint8_t* dist_lens) {
+    uint16_t litlen_codes[DEFLATE_LITLEN_CODES];
+    uint16_t dist_codes[DEFLATE_DIST_CODES];
+    deflate_make_codes(litlen_lens, DEFLATE_LITLEN_CODES, litlen_codes);
+    deflate_make_codes(dist_lens, DEFLATE_DIST_CODES, dist_codes);
+
+    DeflateBitWriter w = writer_;
+    for (int i = 0; i < num_items_; i++) {
+      uint32_t item = items_[i];
+      if (!(item & 0x80000000u)) {
+        w.put(litlen_codes[item], litlen_lens[item]);
+        continue;
+      }
+      int len = static_cast<int>((item >> 16) & 0x1FF);
+      uint32_t dist = (item & 0xFFFF) + 1;
+      int ls = tables_->length_sym[len];
+      w.put(litlen_codes[257 + ls] |
+                (static_cast<uint32_t>(len - LENGTH_BASE[ls]) << litlen_lens[257 + ls]),
+            litlen_lens[257 + ls] + LENGTH_EXTRA[ls]);
+      int ds = dist_sym(dist);
+      w.put(dist_codes[ds] | ((dist - DIST_BASE[ds]) << dist_lens[ds]),
+            dist_lens[ds] + DIST_EXTRA[ds]);
+    }
+    w.put(litlen_codes[256], litlen_lens[256]);
+    writer_ = w;
+  }
+};
+
+// Compress src as a zlib stream at `level` (0-9; out-of-range means 6).
+// dst must hold deflate_zlib_bound(src_len) bytes. Returns the compressed
+// size, or 0 on failure.
+inline size_t deflate_zlib(const uint8_t* src, size_t src_len,
+                           uint8_t* dst, size_t dst_capacity, int level = 6) {
+  FastDeflateEncoder encoder(level);
+  return encoder.compress_zlib(src, src_len, dst, dst_capacity);
 }
 
 // ============================================================================
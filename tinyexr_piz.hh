@@ -7,9 +7,10 @@
 // Part of TinyEXR V2 API (EXPERIMENTAL)
 //
 // Provides PIZ compression/decompression with:
-// - Optimized Huffman decoding via FastHuffmanDecoder
+// - Table-driven Huffman decoding via tinyexr::huffman::FastHuffmanDecoder
 // - SIMD-accelerated wavelet transform (SSE2/NEON)
 // - Range compression via bitmap/LUT
+// - Optional per-channel parallel decode of large chunks (PizParallelFor)
 //
 // Usage:
 //   #define TINYEXR_ENABLE_SIMD 1
@@ -230,6 +231,53 @@ inline void wdec16(uint16_t l, uint16_t h, uint16_t& a, uint16_t& b) {
   a = static_cast<uint16_t>(aa);
 }
 
+#if defined(TINYEXR_ENABLE_SIMD) && TINYEXR_ENABLE_SIMD
+// SIMD row kernel: two rows of `width` samples holding width / 2 adjacent
+// 2x2 blocks (see tinyexr::simd::wavelet_decode_row)
+typedef void (*WaveletRowKernel)(uint16_t* row0, uint16_t* row1, size_t width);
+
+inline void wavDecode14Row(uint16_t* row0, uint16_t* row1, size_t width) {
+  tinyexr::simd::wavelet_decode_row(row0, row1, width, 0);
+}
+
+// Blocks per scratch batch when a level is not contiguous (2 x 512 bytes)
+static const int WAV_BATCH = 128;
+
+// Apply `kernel` to the `n` 2x2 blocks starting at rows r0 and r1. At level
+// 1 of a 16-bit channel the blocks are contiguous and are processed in place;
+// coarser levels and 32-bit channels (ox = 2) are gathered into scratch
+// rows in cache-sized batches and scattered back.
+inline void wav2Blocks(WaveletRowKernel kernel, uint16_t* r0, uint16_t* r1,
+                       int n, int ox1, int ox2) {
+  if (ox1 == 1) {
+    kernel(r0, r1, 2 * static_cast<size_t>(n));
+    return;
+  }
+  uint16_t t0[2 * WAV_BATCH];
+  uint16_t t1[2 * WAV_BATCH];
+  for (int k0 = 0; k0 < n; k0 += WAV_BATCH) {
+    const int m = std::min(WAV_BATCH, n - k0);
+    uint16_t* p0 = r0 + static_cast<ptrdiff_t>(k0) * ox2;
+    uint16_t* p1 = r1 + static_cast<ptrdiff_t>(k0) * ox2;
+    for (int k = 0; k < m; k++) {
+      const ptrdiff_t o = static_cast<ptrdiff_t>(k) * ox2;
+      t0[2 * k] = p0[o];
+      t0[2 * k + 1] = p0[o + ox1];
+      t1[2 * k] = p1[o];
+      t1[2 * k + 1] = p1[o + ox1];
+    }
+    kernel(t0, t1, 2 * static_cast<size_t>(m));
+    for (int k = 0; k < m; k++) {
+      const ptrdiff_t o = static_cast<ptrdiff_t>(k) * ox2;
+      p0[o] = t0[2 * k];
+      p0[o + ox1] = t0[2 * k + 1];
+      p1[o] = t1[2 * k];
+      p1[o + ox1] = t1[2 * k + 1];
+    }
+  }
+}
+#endif
+
 // 2D Wavelet encoding
 inline void wav2Encode(uint16_t* in, int nx, int ox, int ny, int oy, uint16_t mx) {
   bool w14 = (mx < (1 << 14));
@@ -244,7 +292,7 @@ inline void wav2Encode(uint16_t* in, int nx, int ox, int ny, int oy, uint16_t mx
     int oy2 = oy * p2;
     int ox1 = ox * p;
     int ox2 = ox * p2;
-    uint16_t i00, i01, i10, i11;
+    uint16_t i00;
 
     // Y loop
     for (; py <= ey; py += oy2) {
@@ -252,10 +300,19 @@ inline void wav2Encode(uint16_t* in, int nx, int ox, int ny, int oy, uint16_t mx
       uint16_t* ex = py + ox * (nx - p2);
 
       // X loop
+#if defined(TINYEXR_ENABLE_SIMD) && TINYEXR_ENABLE_SIMD
+      const int nblocks = nx / p2;
+      wav2Blocks(w14 ? tinyexr::simd::wavelet_encode_row
+                     : tinyexr::simd::wavelet_encode16_row,
+                 px, px + oy1, nblocks, ox1, ox2);
+      px += static_cast<ptrdiff_t>(nblocks) * ox2;
+      (void)ex;
+#else
       for (; px <= ex; px += ox2) {
         uint16_t* p01 = px + ox1;
         uint16_t* p10 = px + oy1;
         uint16_t* p11 = p10 + ox1;
+        uint16_t i01, i10, i11;
 
         if (w14) {
           wenc14(*px, *p01, i00, i01);
@@ -269,6 +326,7 @@ inline void wav2Encode(uint16_t* in, int nx, int ox, int ny, int oy, uint16_t mx
           wenc16(i01, i11, *p01, *p11);
         }
       }
+#endif
 
       // Encode odd column
       if (nx & p) {
@@ -339,7 +397,7 @@ inline bool wav2Decode(uint16_t* in, int nx, int ox, int ny, int oy, uint16_t mx
       const int oy2 = oy * p2;
       const int ox1 = ox * p;
       const int ox2 = ox * p2;
-      uint16_t i00, i01, i10, i11;
+      uint16_t i00;
 
       // Validate stride calculations don't overflow
       if (PIZ_UNLIKELY(oy1 < 0 || oy2 < 0 || ox1 < 0 || ox2 < 0)) return false;
@@ -354,10 +412,17 @@ inline bool wav2Decode(uint16_t* in, int nx, int ox, int ny, int oy, uint16_t mx
         PIZ_PREFETCH(py + oy2);
 
         // X loop (unrolled inner decode)
+#if defined(TINYEXR_ENABLE_SIMD) && TINYEXR_ENABLE_SIMD
+        const int nblocks = nx / p2;
+        wav2Blocks(wavDecode14Row, px, px + oy1, nblocks, ox1, ox2);
+        px += static_cast<ptrdiff_t>(nblocks) * ox2;
+        (void)ex;
+#else
         for (; px <= ex; px += ox2) {
           uint16_t* p01 = px + ox1;
           uint16_t* p10 = px + oy1;
           uint16_t* p11 = p10 + ox1;
+          uint16_t i01, i10, i11;
 
           // Prefetch ahead in row
           PIZ_PREFETCH(px + ox2 + ox2);
@@ -367,6 +432,7 @@ inline bool wav2Decode(uint16_t* in, int nx, int ox, int ny, int oy, uint16_t mx
           wdec14(i00, i01, *px, *p01);
           wdec14(i10, i11, *p10, *p11);
         }
+#endif
 
         // Decode odd column
         if (nx & p) {
@@ -400,7 +466,7 @@ inline bool wav2Decode(uint16_t* in, int nx, int ox, int ny, int oy, uint16_t mx
       const int oy2 = oy * p2;
       const int ox1 = ox * p;
       const int ox2 = ox * p2;
-      uint16_t i00, i01, i10, i11;
+      uint16_t i00;
 
       // Validate stride calculations don't overflow
       if (PIZ_UNLIKELY(oy1 < 0 || oy2 < 0 || ox1 < 0 || ox2 < 0)) return false;
@@ -415,10 +481,17 @@ inline bool wav2Decode(uint16_t* in, int nx, int ox, int ny, int oy, uint16_t mx
         PIZ_PREFETCH(py + oy2);
 
         // X loop
+#if defined(TINYEXR_ENABLE_SIMD) && TINYEXR_ENABLE_SIMD
+        const int nblocks = nx / p2;
+        wav2Blocks(tinyexr::simd::wavelet_decode16_row, px, px + oy1, nblocks, ox1, ox2);
+        px += static_cast<ptrdiff_t>(nblocks) * ox2;
+        (void)ex;
+#else
         for (; px <= ex; px += ox2) {
           uint16_t* p01 = px + ox1;
           uint16_t* p10 = px + oy1;
           uint16_t* p11 = p10 + ox1;
+          uint16_t i01, i10, i11;
 
           // Prefetch ahead in row
           PIZ_PREFETCH(px + ox2 + ox2);
@@ -428,6 +501,7 @@ inline bool wav2Decode(uint16_t* in, int nx, int ox, int ny, int oy, uint16_t mx
           wdec16(i00, i01, *px, *p01);
           wdec16(i10, i11, *p10, *p11);
         }
+#endif
 
         // Decode odd column
         if (nx & p) {
@@ -461,53 +535,12 @@ inline bool wav2Decode(uint16_t* in, int nx, int ox, int ny, int oy, uint16_t mx
 // ============================================================================
 
 static const int HUF_ENCBITS = 16;
-static const int HUF_DECBITS = 14;
 static const int HUF_ENCSIZE = (1 << HUF_ENCBITS) + 1;
-static const int HUF_DECSIZE = 1 << HUF_DECBITS;
-static const int HUF_DECMASK = HUF_DECSIZE - 1;
 
 static const int SHORT_ZEROCODE_RUN = 59;
 static const int LONG_ZEROCODE_RUN = 63;
 static const int SHORTEST_LONG_RUN = 2 + LONG_ZEROCODE_RUN - SHORT_ZEROCODE_RUN;
 
-// Decoding table entry (matching V1 HufDec)
-struct HufDec {
-  int len;
-  int lit;
-  int* p;
-};
-
-// Get n bits from packed stream (big-endian bit order, like V1)
-// Returns -1 on error (bounds exceeded)
-inline int64_t getBits(int nBits, int64_t& c, int& lc, const uint8_t*& in,
-                       const uint8_t* in_end) {
-  // Validate nBits range
-  if (nBits <= 0 || nBits > 58) {
-    return -1;
-  }
-  while (lc < nBits) {
-    if (in >= in_end) {
-      return -1;  // Bounds check: prevent reading past buffer
-    }
-    // Use unsigned shift to avoid signed overflow UB
-    c = static_cast<int64_t>((static_cast<uint64_t>(c) << 8) | static_cast<uint64_t>(*in++));
-    lc += 8;
-  }
-  lc -= nBits;
-  return (c >> lc) & ((1LL << nBits) - 1);
-}
-
-// Legacy getBits without bounds check (for compatibility during transition)
-inline int64_t getBitsUnchecked(int nBits, int64_t& c, int& lc, const uint8_t*& in) {
-  while (lc < nBits) {
-    // Use unsigned shift to avoid signed overflow UB
-    c = static_cast<int64_t>((static_cast<uint64_t>(c) << 8) | static_cast<uint64_t>(*in++));
-    lc += 8;
-  }
-  lc -= nBits;
-  return (c >> lc) & ((1LL << nBits) - 1);
-}
-
 // Build canonical Huffman code table (matching V1 hufCanonicalCodeTable)
 inline void hufCanonicalCodeTable(int64_t* hcode) {
   int64_t n[59] = {0};
@@ -537,491 +570,62 @@ inline void hufCanonicalCodeTable(int64_t* hcode) {
   }
 }
 
-// Unpack encoding table (matching V1 hufUnpackEncTable)
-inline bool hufUnpackEncTable(const uint8_t*& ptr, size_t ni, int im, int iM,
-                               int64_t* hcode) {
-  // Validate input parameters
-  if (!hcode) return false;
-  if (im < 0 || im >= HUF_ENCSIZE) return false;
-  if (iM < 0 || iM >= HUF_ENCSIZE) return false;
-  if (im > iM) return false;
-  if (ni == 0) return false;
-
-  std::memset(hcode, 0, sizeof(int64_t) * HUF_ENCSIZE);
-
-  const uint8_t* start = ptr;
-  const uint8_t* end = ptr + ni;
-  int64_t c = 0;
-  int lc = 0;
-
-  for (int i = im; i <= iM; i++) {
-    // Bounds check before reading
-    if (ptr >= end && lc < 6) {
-      return false;  // Not enough data
-    }
-
-    int64_t l = getBits(6, c, lc, ptr, end);
-    if (l < 0) return false;  // getBits failed
-    hcode[i] = l;
-
-    if (l == LONG_ZEROCODE_RUN) {
-      int64_t zerun_raw = getBits(8, c, lc, ptr, end);
-      if (zerun_raw < 0) return false;  // getBits failed
-      int zerun = static_cast<int>(zerun_raw) + SHORTEST_LONG_RUN;
-      if (zerun < 0 || i + zerun > iM + 1) {
-        return false;  // Invalid run length or overflow
-      }
-      while (zerun-- > 0 && i <= iM) hcode[i++] = 0;
-      i--;
-    } else if (l >= SHORT_ZEROCODE_RUN) {
-      int zerun = static_cast<int>(l - SHORT_ZEROCODE_RUN + 2);
-      if (zerun < 0 || i + zerun > iM + 1) {
-        return false;  // Invalid run length or overflow
-      }
-      while (zerun-- > 0 && i <= iM) hcode[i++] = 0;
-      i--;
-    }
-  }
-
-  hufCanonicalCodeTable(hcode);
-  return true;
-}
-
-// Build decoding table (matching V1 hufBuildDecTable)
-// Two-pass approach to ensure long code symbols are stored contiguously
-inline bool hufBuildDecTable(const int64_t* hcode, int im, int iM,
-                              HufDec* hdecod, std::vector<int>& long_codes) {
-  // Validate input parameters
-  if (!hcode || !hdecod) return false;
-  if (im < 0 || im >= HUF_ENCSIZE) return false;
-  if (iM < 0 || iM >= HUF_ENCSIZE) return false;
-  if (im > iM) return false;
-
-  // Clear table (use memset for efficiency)
-  std::memset(hdecod, 0, sizeof(HufDec) * HUF_DECSIZE);
-
-  // Pass 1: Collect long codes per table index
-  std::vector<std::vector<int>> long_code_lists(HUF_DECSIZE);
-
-  for (int i = im; i <= iM; i++) {
-    int64_t c = hcode[i] >> 6;
-    int l = static_cast<int>(hcode[i] & 63);
-
-    // Validate code length
-    if (l < 0 || l > 58) {
-      return false;  // Invalid code length
-    }
-
-    // Validate code value fits in length
-    if (l > 0 && (c >> l) != 0) {
-      return false;  // Code value too large for specified length
-    }
-
-    if (l > HUF_DECBITS) {
-      // Long code - collect in per-index list
-      int shift = l - HUF_DECBITS;
-      if (shift < 0 || shift > 58) return false;  // Sanity check
-      int idx = static_cast<int>((c >> shift) & HUF_DECMASK);
-      if (idx < 0 || idx >= HUF_DECSIZE) return false;  // Bounds check
-      if (hdecod[idx].len != 0) {
-        // Already has a short code? Error
-        return false;
-      }
-      long_code_lists[idx].push_back(i);
-    } else if (l > 0) {
-      // Short code - fill all matching entries
-      int shift = HUF_DECBITS - l;
-      if (shift < 0 || shift > HUF_DECBITS) return false;  // Sanity check
-      int j = static_cast<int>(c << shift);
-      if (j < 0 || j >= HUF_DECSIZE) return false;  // Bounds check
-      int count = 1 << shift;
-      if (j + count > HUF_DECSIZE) return false;  // Bounds check
-      for (int k = 0; k < count; k++) {
-        int idx = j + k;
-        if (idx < 0 || idx >= HUF_DECSIZE) return false;  // Defensive
-        HufDec* pl = &hdecod[idx];
-        if (pl->len != 0 || !long_code_lists[idx].empty()) {
-          // Already assigned? Error
-          return false;
-        }
-        pl->len = l;
-        pl->lit = i;
-      }
-    }
-  }
-
-  // Pass 2: Flatten long code lists into contiguous array
-  long_codes.clear();
-
-  // Calculate total size needed and check for overflow
-  size_t total_long_codes = 0;
-  for (int i = 0; i < HUF_DECSIZE; i++) {
-    total_long_codes += long_code_lists[i].size();
-    if (total_long_codes > static_cast<size_t>(HUF_ENCSIZE)) {
-      return false;  // Too many long codes (shouldn't happen with valid data)
-    }
-  }
-  long_codes.reserve(total_long_codes);
-
-  for (int i = 0; i < HUF_DECSIZE; i++) {
-    if (!long_code_lists[i].empty()) {
-      hdecod[i].lit = static_cast<int>(long_code_lists[i].size());
-      size_t start_idx = long_codes.size();
-      for (int sym : long_code_lists[i]) {
-        if (sym < 0 || sym >= HUF_ENCSIZE) return false;  // Validate symbol
-        long_codes.push_back(sym);
-      }
-      // Store offset temporarily (will convert to pointer after)
-      hdecod[i].p = reinterpret_cast<int*>(start_idx + 1);  // +1 so 0 means nullptr
-    }
-  }
-
-  // Pass 3: Convert offsets to actual pointers
-  for (int i = 0; i < HUF_DECSIZE; i++) {
-    if (hdecod[i].p != nullptr) {
-      size_t idx = reinterpret_cast<size_t>(hdecod[i].p) - 1;
-      if (idx >= long_codes.size()) return false;  // Bounds check
-      hdecod[i].p = &long_codes[idx];
-    }
-  }
-
-  return true;
-}
-
-// Extract code from hcode entry
-inline int64_t hufCode(int64_t hcode) { return hcode >> 6; }
-inline int hufLength(int64_t hcode) { return static_cast<int>(hcode & 63); }
-
-// Get one character and update bit buffer (with bounds check)
-// Returns false if bounds exceeded
-inline bool hufGetCharSafe(int64_t& c, int& lc, const uint8_t*& in, const uint8_t* ie) {
-  if (in >= ie) return false;
-  // Use unsigned shift to avoid signed overflow UB
-  c = static_cast<int64_t>((static_cast<uint64_t>(c) << 8) | static_cast<uint64_t>(*in++));
-  lc += 8;
-  // Check for bit accumulator overflow (shouldn't happen in normal use)
-  if (lc > 64) return false;
-  return true;
-}
-
-// Get one character and update bit buffer (unchecked, for hot paths)
-inline void hufGetChar(int64_t& c, int& lc, const uint8_t*& in) {
-  // Use unsigned shift to avoid signed overflow UB
-  c = static_cast<int64_t>((static_cast<uint64_t>(c) << 8) | static_cast<uint64_t>(*in++));
-  lc += 8;
-}
-
-// Get code from decoder output (optimized version)
-// Note: RLE run length is just the 8-bit value, NOT value + 2 (matching V1)
-PIZ_ALWAYS_INLINE bool hufGetCode(int lit, int rlc, int64_t& c, int& lc,
-                       const uint8_t*& in, const uint8_t* ie,
-                       uint16_t*& out, const uint16_t* outb, const uint16_t* oe) {
-  // Validate lc is in reasonable range (unlikely to fail)
-  if (PIZ_UNLIKELY(lc < 0 || lc > 64)) return false;
-
-  if (PIZ_UNLIKELY(lit == rlc)) {
-    // Run-length encoded (relatively rare path)
-    if (lc < 8) {
-      if (PIZ_UNLIKELY(in >= ie)) return false;  // Bounds check
-      hufGetChar(c, lc, in);
-    }
-    if (PIZ_UNLIKELY(lc < 8)) return false;  // Still not enough bits
-    lc -= 8;
-    int run = static_cast<int>((c >> lc) & 0xFF);  // No +2, matching V1
-
-    // Validate RLE operation (unlikely to fail with valid data)
-    if (PIZ_UNLIKELY(out <= outb)) return false;  // Need at least one previous value
-    if (PIZ_UNLIKELY(out + run > oe)) return false;  // Would overflow output buffer
-
-    // Optimized RLE fill using SIMD when available
-    uint16_t prev = out[-1];
-    if (run > 0) {
-#if defined(TINYEXR_ENABLE_SIMD) && TINYEXR_ENABLE_SIMD
-      // Use SIMD-accelerated fill for larger runs
-      out = tinyexr::simd::fill_u16_simd(out, prev, static_cast<size_t>(run));
-#else
-      // Scalar fallback with loop unrolling
-      if (run >= 8) {
-        uint16_t* end = out + run;
-        while (out + 8 <= end) {
-          out[0] = prev; out[1] = prev; out[2] = prev; out[3] = prev;
-          out[4] = prev; out[5] = prev; out[6] = prev; out[7] = prev;
-          out += 8;
-        }
-        while (out < end) *out++ = prev;
-      } else {
-        while (run-- > 0) *out++ = prev;
-      }
-#endif
-    }
-  } else {
-    // Literal value (common path)
-    if (PIZ_UNLIKELY(lit < 0 || lit > 65535)) return false;
-    if (PIZ_UNLIKELY(out >= oe)) return false;  // Output buffer full
-    *out++ = static_cast<uint16_t>(lit);
-  }
-  return true;
-}
-
-// Decode Huffman data (matching V1 hufDecode)
-// Optimized with branch prediction hints while preserving bounds checking
-inline bool hufDecode(const int64_t* hcode, const HufDec* hdecod,
-                      const uint8_t* in, int ni, int rlc, int no,
-                      uint16_t* out, bool debug = false) {
-  // Validate input parameters (only once at start)
-  if (PIZ_UNLIKELY(!hcode || !hdecod || !in || !out)) return false;
-  if (PIZ_UNLIKELY(ni < 0 || no < 0)) return false;
-  if (PIZ_UNLIKELY(rlc < 0 || rlc >= HUF_ENCSIZE)) return false;
-
-  int64_t c = 0;
-  int lc = 0;
-  const uint16_t* outb = out;
-  const uint16_t* oe = out + no;
-  const uint8_t* ie = in + (ni + 7) / 8;
-  [[maybe_unused]] const uint8_t* in_start = in;  // For debug only
-
-  // Prefetch decode table (likely to be accessed soon)
-  PIZ_PREFETCH(hdecod);
-
-  // Main decode loop - optimized for the common case (short codes)
-  while (PIZ_LIKELY(in < ie)) {
-    // Inline byte read for speed (bounds already checked by loop condition)
-    // Use unsigned shift to avoid signed overflow UB
-    c = static_cast<int64_t>((static_cast<uint64_t>(c) << 8) | static_cast<uint64_t>(*in++));
-    lc += 8;
-    if (PIZ_UNLIKELY(lc > 64)) {
-      if (debug) fprintf(stderr, "Bit accumulator overflow\n");
-      return false;
-    }
-
-    // Process as many codes as possible from current bits
-    while (PIZ_LIKELY(lc >= HUF_DECBITS)) {
-      // Fast path: check output buffer
-      if (PIZ_UNLIKELY(out >= oe)) {
-        goto done;
-      }
-
-      // Table lookup (mask guarantees valid index)
-      const int tableIndex = static_cast<int>((c >> (lc - HUF_DECBITS)) & HUF_DECMASK);
-      const HufDec& pl = hdecod[tableIndex];
-
-      // Prefetch next table entry (only if enough bits available to avoid negative shift)
-      if (lc >= HUF_DECBITS + 8) {
-        PIZ_PREFETCH(&hdecod[(c >> (lc - HUF_DECBITS - 8)) & HUF_DECMASK]);
-      }
-
-      if (PIZ_LIKELY(pl.len > 0)) {
-        // Short code path (most common case - ~95% of codes)
-        // Bounds check: pl.len validated during table build
-        lc -= pl.len;
-        c &= (1LL << lc) - 1;  // Clear consumed bits
-
-        // Inline literal output (most common)
-        if (PIZ_LIKELY(pl.lit != rlc)) {
-          if (PIZ_UNLIKELY(out >= oe)) goto done;
-          *out++ = static_cast<uint16_t>(pl.lit);
-        } else {
-          // RLE path (less common)
-          if (PIZ_UNLIKELY(!hufGetCode(pl.lit, rlc, c, lc, in, ie, out, outb, oe))) {
-            if (debug) fprintf(stderr, "getCode failed (short)\n");
-            return false;
-          }
-        }
-      } else if (pl.p) {
-        // Long code path (rare - <5% of codes)
-        // Validate pl.lit bounds
-        if (PIZ_UNLIKELY(pl.lit <= 0 || pl.lit > HUF_ENCSIZE)) {
-          if (debug) fprintf(stderr, "Invalid long code count\n");
-          return false;
-        }
-
-        bool found = false;
-        const int numCandidates = pl.lit;
-
-        for (int j = 0; j < numCandidates; j++) {
-          // Prefetch next candidate's code entry
-          if (j + 1 < numCandidates) {
-            PIZ_PREFETCH(&hcode[pl.p[j + 1]]);
-          }
-          const int sym = pl.p[j];
-          if (PIZ_UNLIKELY(sym < 0 || sym >= HUF_ENCSIZE)) {
-            if (debug) fprintf(stderr, "Invalid symbol in long code list\n");
-            return false;
-          }
-
-          const int l = hufLength(hcode[sym]);
-          if (PIZ_UNLIKELY(l <= 0 || l > 58)) {
-            if (debug) fprintf(stderr, "Invalid code length\n");
-            return false;
-          }
-
-          // Read more bytes if needed
-          while (lc < l && in < ie) {
-            // Use unsigned shift to avoid signed overflow UB
-            c = static_cast<int64_t>((static_cast<uint64_t>(c) << 8) | static_cast<uint64_t>(*in++));
-            lc += 8;
-          }
-
-          if (lc >= l) {
-            const int shift = lc - l;
-            const int64_t expected = hufCode(hcode[sym]);
-            const int64_t actual = (c >> shift) & ((1LL << l) - 1);
-
-            if (expected == actual) {
-              lc = shift;
-              c &= (1LL << lc) - 1;
-
-              // Output symbol
-              if (PIZ_LIKELY(sym != rlc)) {
-                if (PIZ_UNLIKELY(out >= oe)) goto done;
-                *out++ = static_cast<uint16_t>(sym);
-              } else {
-                if (PIZ_UNLIKELY(!hufGetCode(sym, rlc, c, lc, in, ie, out, outb, oe))) {
-                  if (debug) fprintf(stderr, "getCode failed (long)\n");
-                  return false;
-                }
-              }
-              found = true;
-              break;
-            }
-          }
-        }
-
-        if (PIZ_UNLIKELY(!found)) {
-          if (debug) fprintf(stderr, "Long code not found\n");
-          return false;
-        }
-      } else {
-        // Invalid code
-        if (debug) fprintf(stderr, "Invalid code (no entry)\n");
-        return false;
-      }
-    }
-  }
-
-done:
-  // Process remaining bits (rare path)
-  {
-    const int padding = (8 - ni) & 7;
-    c >>= padding;
-    lc -= padding;
-    if (lc < 0) lc = 0;
-  }
-
-  while (lc > 0 && out < oe) {
-    const int shift = HUF_DECBITS - lc;
-    if (PIZ_UNLIKELY(shift < 0 || shift > HUF_DECBITS)) break;
-
-    const int tableIndex = static_cast<int>((c << shift) & HUF_DECMASK);
-    const HufDec& pl = hdecod[tableIndex];
-
-    if (PIZ_LIKELY(pl.len > 0 && pl.len <= lc)) {
-      lc -= pl.len;
-      c &= (1LL << lc) - 1;
-
-      if (PIZ_LIKELY(pl.lit != rlc)) {
-        *out++ = static_cast<uint16_t>(pl.lit);
-      } else {
-        if (PIZ_UNLIKELY(!hufGetCode(pl.lit, rlc, c, lc, in, ie, out, outb, oe))) {
-          if (debug) fprintf(stderr, "getCode failed (remainder)\n");
-          return false;
-        }
-      }
-    } else {
-      break;  // Can't decode more
-    }
-  }
-
-  if (debug) {
-    fprintf(stderr, "Decode complete: output %ld (expected %d)\n",
-            (long)(out - outb), no);
-  }
-  return (out - outb) == no;
-}
-
 // Decompress Huffman-encoded data (matching V1 hufUncompress)
-// With comprehensive bounds checking for safety
+// Decoding is shared with V1 and V3 through tinyexr::huffman.
 inline bool hufUncompress(const uint8_t* compressed, size_t nCompressed,
                           uint16_t* raw, size_t nRaw) {
-  // Validate input pointers
-  if (!compressed || !raw) return false;
-
-  if (nCompressed == 0) {
-    return nRaw == 0;
-  }
-
-  // Must have at least 20-byte header
-  if (nCompressed < 20) return false;
-
-  // Validate output size is reasonable (prevent overflow)
-  if (nRaw > static_cast<size_t>(INT32_MAX)) return false;
-
-  // Read header (V1 format: im(4), iM(4), tableLength(4), nBits(4), reserved(4))
-  // nBits is at offset 12, NOT offset 8 (offset 8 is tableLength which is unused)
-  uint32_t im_val, iM_val, nBits_val;
-  std::memcpy(&im_val, compressed, 4);
-  std::memcpy(&iM_val, compressed + 4, 4);
-  // offset 8: tableLength (unused)
-  std::memcpy(&nBits_val, compressed + 12, 4);  // nBits at offset 12!
-
-  int im = static_cast<int>(im_val);
-  int iM = static_cast<int>(iM_val);
-  int nBits = static_cast<int>(nBits_val);
-
-  // Validate symbol range
-  if (im < 0 || im >= HUF_ENCSIZE || iM < 0 || iM >= HUF_ENCSIZE) {
-    return false;
-  }
-  if (im > iM) return false;
+  return tinyexr::huffman::huf_uncompress(compressed, nCompressed, raw, nRaw);
+}
 
-  // Validate nBits is reasonable
-  if (nBits < 0) return false;
+// ============================================================================
+// Intra-chunk Parallelism
+// ============================================================================
 
-  const uint8_t* ptr = compressed + 20;
-  size_t remaining = nCompressed - 20;
+// Run task(userdata, i) for every i in [0, count) and return once all of them
+// have finished. Same shape as the V3 context pool's parallel-for, so callers
+// can lend DecompressPizV2 whatever workers they already own.
+typedef void (*PizTaskFunc)(void* userdata, uint32_t index);
+typedef void (*PizParallelForFunc)(void* pool, uint32_t count,
+                                   PizTaskFunc task, void* userdata);
 
-  // Unpack encoding table
-  std::vector<int64_t> freq(HUF_ENCSIZE);
-  if (!hufUnpackEncTable(ptr, remaining, im, iM, freq.data())) {
-    return false;
-  }
+struct PizParallelFor {
+  PizParallelForFunc func;  // nullptr: run everything on the calling thread
+  void* pool;
 
-  // Validate ptr didn't go past end
-  if (ptr > compressed + nCompressed) {
-    return false;
-  }
-
-  // Update remaining
-  remaining = nCompressed - static_cast<size_t>(ptr - compressed);
+  PizParallelFor() : func(nullptr), pool(nullptr) {}
+  PizParallelFor(PizParallelForFunc f, void* p) : func(f), pool(p) {}
+};
 
-  // Validate nBits against remaining data
-  if (nBits < 0 || static_cast<size_t>(nBits) > 8 * remaining) {
-    return false;
-  }
+// Chunks with fewer 16-bit samples than this are not worth dispatching
+static const size_t PIZ_PARALLEL_MIN_SAMPLES = 64 * 1024;
+
+// Per-channel stage of DecompressPizV2: the inverse wavelet of every
+// component followed by the reverse LUT over the channel's samples. Channels
+// occupy disjoint ranges of the Huffman output, so they run independently.
+struct PizChannelDecodeJob {
+  const PIZChannelData* channelData;
+  const uint16_t* lut;
+  uint16_t maxValue;
+  int* failed;  // per channel: -1 ok, j = wavelet component j, size = LUT
+
+  static void run(void* userdata, uint32_t index) {
+    PizChannelDecodeJob* job = static_cast<PizChannelDecodeJob*>(userdata);
+    const PIZChannelData& cd = job->channelData[index];
+    size_t channelBufSize = static_cast<size_t>(cd.nx) * cd.ny * cd.size;
 
-  // Special case: nBits=0 means all values are the same (symbol im)
-  // This happens when im==iM (only one unique symbol in the data)
-  if (nBits == 0) {
-    for (size_t i = 0; i < nRaw; i++) {
-      raw[i] = static_cast<uint16_t>(im);
+    for (int j = 0; j < cd.size; ++j) {
+      if (!wav2Decode(cd.start + j, cd.nx, cd.size, cd.ny, cd.nx * cd.size,
+                      job->maxValue, channelBufSize)) {
+        job->failed[index] = j;
+        return;
+      }
+    }
+    if (!applyLut(job->lut, cd.start, static_cast<int>(channelBufSize),
+                  USHORT_RANGE)) {
+      job->failed[index] = cd.size;
     }
-    return true;
-  }
-
-  // Build decode table
-  std::vector<HufDec> hdec(HUF_DECSIZE);
-  std::vector<int> long_codes;
-  if (!hufBuildDecTable(freq.data(), im, iM, hdec.data(), long_codes)) {
-    return false;
   }
-
-  // Decode data
-  bool result = hufDecode(freq.data(), hdec.data(), ptr,
-                          nBits, iM,
-                          static_cast<int>(nRaw), raw);
-
-  return result;
-}
+};
 
 // ============================================================================
 // PIZ Decompression (V2 API)
@@ -1030,11 +634,13 @@ inline bool hufUncompress(const uint8_t* compressed, size_t nCompressed,
 // Decompress PIZ-compressed block
 // Returns Result<void> with success/error status
 // With comprehensive bounds checking for safety
+// When `parallel` is set, large chunks decode their channels concurrently.
 inline tinyexr::v2::Result<void> DecompressPizV2(
     uint8_t* dst, size_t dstSize,
     const uint8_t* src, size_t srcSize,
     int numChannels, const tinyexr::v2::Channel* channels,
-    int dataWidth, int numLines) {
+    int dataWidth, int numLines,
+    const PizParallelFor& parallel = PizParallelFor()) {
 
   using namespace tinyexr::v2;
 
@@ -1302,30 +908,38 @@ inline tinyexr::v2::Result<void> DecompressPizV2(
     tmpBufferEnd += channelElements;
   }
 
-  // Wavelet decode each channel (with bounds checking)
-  for (size_t i = 0; i < numChan; ++i) {
-    PIZChannelData& cd = channelData[i];
-
-    // Calculate buffer size for this channel
-    size_t channelBufSize = static_cast<size_t>(cd.nx) * cd.ny * cd.size;
+  // Wavelet decode and expand each channel to its original range through the
+  // reverse LUT (with bounds checking)
+  std::vector<int> failed(numChan, -1);
+  PizChannelDecodeJob job;
+  job.channelData = channelData;
+  job.lut = lut.data();
+  job.maxValue = maxValue;
+  job.failed = failed.data();
 
-    for (int j = 0; j < cd.size; ++j) {
-      if (!wav2Decode(cd.start + j, cd.nx, cd.size, cd.ny, cd.nx * cd.size, maxValue, channelBufSize)) {
-        return Result<void>::error(ErrorInfo(
-          ErrorCode::CompressionError,
-          "PIZ wavelet decode failed at channel " + std::to_string(i) + " component " + std::to_string(j),
-          "DecompressPizV2",
-          0
-        ));
-      }
+  if (parallel.func && numChan > 1 && tmpBufSize >= PIZ_PARALLEL_MIN_SAMPLES) {
+    parallel.func(parallel.pool, static_cast<uint32_t>(numChan),
+                  &PizChannelDecodeJob::run, &job);
+  } else {
+    for (size_t i = 0; i < numChan; ++i) {
+      PizChannelDecodeJob::run(&job, static_cast<uint32_t>(i));
+      if (failed[i] >= 0) break;
     }
   }
 
-  // Expand pixel data to original range using reverse LUT (with bounds checking)
-  if (!applyLut(lut.data(), tmpBuffer.data(), static_cast<int>(tmpBufSize), USHORT_RANGE)) {
+  for (size_t i = 0; i < numChan; ++i) {
+    if (failed[i] < 0) continue;
+    if (failed[i] == channelData[i].size) {
+      return Result<void>::error(ErrorInfo(
+        ErrorCode::CompressionError,
+        "PIZ LUT application failed",
+        "DecompressPizV2",
+        0
+      ));
+    }
     return Result<void>::error(ErrorInfo(
       ErrorCode::CompressionError,
-      "PIZ LUT application failed",
+      "PIZ wavelet decode failed at channel " + std::to_string(i) + " component " + std::to_string(failed[i]),
       "DecompressPizV2",
       0
     ));
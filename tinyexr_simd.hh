@@ -20,7 +20,10 @@
 //   #define TINYEXR_ENABLE_SIMD 1
 //   #include "tinyexr_simd.hh"
 //
-// The SIMD layer automatically detects available instruction sets at compile time.
+// The SIMD layer detects available instruction sets at compile time. On x86
+// it additionally builds AVX2+F16C kernels with target attributes and selects
+// them at runtime (once, from CPUID), so a baseline SSE2 binary still uses them
+// on CPUs that support them. Define TINYEXR_SIMD_DISPATCH=0 to disable this.
 
 #ifndef TINYEXR_SIMD_HH_
 #define TINYEXR_SIMD_HH_
@@ -28,6 +31,7 @@
 #include <cstdint>
 #include <cstddef>
 #include <cstring>
+#include <cmath>
 
 // ============================================================================
 // Configuration and Feature Detection
@@ -179,6 +183,40 @@
 #define TINYEXR_SIMD_A64FX 0
 #endif
 
+// Runtime dispatch is only useful when the compile flags do not already
+// enable the best tier.
+#ifndef TINYEXR_SIMD_DISPATCH
+#if TINYEXR_SIMD_X86 && TINYEXR_SIMD_SSE2 && !(TINYEXR_SIMD_AVX2 && TINYEXR_SIMD_F16C) && \
+    (defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER))
+#define TINYEXR_SIMD_DISPATCH 1
+#else
+#define TINYEXR_SIMD_DISPATCH 0
+#endif
+#endif
+
+#if TINYEXR_SIMD_DISPATCH
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+// MSVC compiles any intrinsic without per-function target flags
+#define TINYEXR_SIMD_TARGET_AVX2
+#else
+#include <cpuid.h>
+#define TINYEXR_SIMD_TARGET_AVX2 __attribute__((target("avx2,f16c")))
+#endif
+#endif
+
+// AVX2+F16C kernels exist when dispatching, or when the compile flags
+// enable them (then they are selected statically)
+#if TINYEXR_SIMD_DISPATCH
+#define TINYEXR_SIMD_AVX2_KERNELS 1
+#elif TINYEXR_SIMD_AVX2 && TINYEXR_SIMD_F16C
+#define TINYEXR_SIMD_AVX2_KERNELS 1
+#define TINYEXR_SIMD_TARGET_AVX2
+#else
+#define TINYEXR_SIMD_AVX2_KERNELS 0
+#endif
+
 // ============================================================================
 // Namespace and utilities
 // ============================================================================
@@ -186,6 +224,46 @@
 namespace tinyexr {
 namespace simd {
 
+#if TINYEXR_SIMD_DISPATCH
+
+// True if the CPU and OS support AVX2 and F16C (YMM state enabled by XSAVE)
+inline bool cpu_has_avx2_f16c() {
+  uint32_t ecx1, ebx7;
+#if defined(_MSC_VER) && !defined(__clang__)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7) return false;
+  __cpuid(info, 1);
+  ecx1 = static_cast<uint32_t>(info[2]);
+  __cpuidex(info, 7, 0);
+  ebx7 = static_cast<uint32_t>(info[1]);
+#else
+  unsigned int eax, ebx, ecx, edx;
+  if (__get_cpuid_max(0, 0) < 7) return false;
+  __cpuid(1, eax, ebx, ecx, edx);
+  ecx1 = ecx;
+  __cpuid_count(7, 0, eax, ebx, ecx, edx);
+  ebx7 = ebx;
+#endif
+  const bool osxsave = (ecx1 & (1u << 27)) != 0;
+  const bool avx = (ecx1 & (1u << 28)) != 0;
+  const bool f16c = (ecx1 & (1u << 29)) != 0;
+  const bool avx2 = (ebx7 & (1u << 5)) != 0;
+  if (!(osxsave && avx && f16c && avx2)) return false;
+
+  uint64_t xcr0;
+#if defined(_MSC_VER) && !defined(__clang__)
+  xcr0 = _xgetbv(0);
+#else
+  uint32_t xcr0_lo, xcr0_hi;
+  __asm__ __volatile__("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+  xcr0 = (static_cast<uint64_t>(xcr0_hi) << 32) | xcr0_lo;
+#endif
+  return (xcr0 & 6) == 6;  // XMM and YMM state
+}
+
+#endif  // TINYEXR_SIMD_DISPATCH
+
 // SIMD capability flags (can be queried at runtime)
 struct SIMDCapabilities {
   bool sse2;
@@ -214,6 +292,11 @@ struct SIMDCapabilities {
       sve2(TINYEXR_SIMD_SVE2),
       a64fx(TINYEXR_SIMD_A64FX),
       sve_vector_length(0) {
+#if TINYEXR_SIMD_DISPATCH
+    if (cpu_has_avx2_f16c()) {
+      avx = avx2 = f16c = true;
+    }
+#endif
 #if TINYEXR_SIMD_SVE
     // Get SVE vector length at runtime
     sve_vector_length = static_cast<uint32_t>(svcntb() * 8);
@@ -692,11 +775,11 @@ inline void float_to_half_32_a64fx(const float* src, uint16_t* dst) {
 #endif  // TINYEXR_SIMD_A64FX
 
 // ============================================================================
-// Generic Batch Conversion Functions (auto-dispatch)
+// Generic Batch Conversion Functions (compile-time selection)
 // ============================================================================
 
 // Convert an array of half-precision values to float
-inline void half_to_float_batch(const uint16_t* src, float* dst, size_t count) {
+inline void half_to_float_batch_baseline(const uint16_t* src, float* dst, size_t count) {
   size_t i = 0;
 
 #if TINYEXR_SIMD_A64FX || (TINYEXR_SIMD_SVE && defined(TINYEXR_A64FX_OPTIMIZED))
@@ -752,7 +835,7 @@ inline void half_to_float_batch(const uint16_t* src, float* dst, size_t count) {
 }
 
 // Convert an array of float values to half-precision
-inline void float_to_half_batch(const float* src, uint16_t* dst, size_t count) {
+inline void float_to_half_batch_baseline(const float* src, uint16_t* dst, size_t count) {
   size_t i = 0;
 
 #if TINYEXR_SIMD_A64FX || (TINYEXR_SIMD_SVE && defined(TINYEXR_A64FX_OPTIMIZED))
@@ -873,8 +956,8 @@ inline void memcpy_simd(void* dst, const void* src, size_t bytes) {
 // Interleave separate R, G, B, A channels into RGBA format
 // Input: 4 separate float arrays (R, G, B, A), each of length 'count'
 // Output: Interleaved RGBA array of length 'count * 4'
-inline void interleave_rgba_float(const float* r, const float* g, const float* b, const float* a,
-                                  float* rgba, size_t count) {
+inline void interleave_rgba_float_baseline(const float* r, const float* g, const float* b,
+                                           const float* a, float* rgba, size_t count) {
   size_t i = 0;
 
 #if TINYEXR_SIMD_AVX
@@ -956,8 +1039,8 @@ inline void interleave_rgba_float(const float* r, const float* g, const float* b
 }
 
 // Deinterleave RGBA format into separate R, G, B, A channels
-inline void deinterleave_rgba_float(const float* rgba, float* r, float* g, float* b, float* a,
-                                    size_t count) {
+inline void deinterleave_rgba_float_baseline(const float* rgba, float* r, float* g, float* b,
+                                             float* a, size_t count) {
   size_t i = 0;
 
 #if TINYEXR_SIMD_AVX
@@ -1045,7 +1128,8 @@ inline void deinterleave_rgba_float(const float* rgba, float* r, float* g, float
 
 // Optimized byte reordering for EXR scanline data
 // This reorders bytes for better compression (separates MSB and LSB)
-inline void reorder_bytes_for_compression(const uint8_t* src, uint8_t* dst, size_t count) {
+inline void reorder_bytes_for_compression_baseline(const uint8_t* src, uint8_t* dst,
+                                                   size_t count) {
   size_t half = count / 2;
 
   // Reorder: alternating bytes to separate channels
@@ -1089,7 +1173,8 @@ inline void reorder_bytes_for_compression(const uint8_t* src, uint8_t* dst, size
 }
 
 // Reverse byte reordering after decompression
-inline void unreorder_bytes_after_decompression(const uint8_t* src, uint8_t* dst, size_t count) {
+inline void unreorder_bytes_after_decompression_baseline(const uint8_t* src, uint8_t* dst,
+                                                        size_t count) {
   size_t half = count / 2;
   size_t i = 0;
 
@@ -1189,7 +1274,7 @@ inline void reverse_delta_predictor(uint8_t* data, size_t count) {
 // Sequential dependency limits SIMD, but we can still optimize with:
 // - Loop unrolling (4x) to hide instruction latency
 // - Prefetching to reduce memory stalls
-inline void apply_delta_predictor_fast(uint8_t* data, size_t count) {
+inline void apply_delta_predictor_fast_baseline(uint8_t* data, size_t count) {
   if (count < 2) return;
 
   // Prefetch ahead
@@ -1224,7 +1309,7 @@ inline void apply_delta_predictor_fast(uint8_t* data, size_t count) {
 
 // Optimized delta predictor encode with loop unrolling
 // This is the encode operation: d[i] = d[i] - d[i-1] + 128
-inline void reverse_delta_predictor_fast(uint8_t* data, size_t count) {
+inline void reverse_delta_predictor_fast_baseline(uint8_t* data, size_t count) {
   if (count < 2) return;
 
   // Work backwards to avoid overwriting data we need
@@ -1244,6 +1329,102 @@ inline void reverse_delta_predictor_fast(uint8_t* data, size_t count) {
   }
 }
 
+// ============================================================================
+// Fused ZIP/RLE Post-processing
+// ============================================================================
+
+// Sum of bytes modulo 256
+inline uint8_t byte_sum(const uint8_t* data, size_t count) {
+  size_t i = 0;
+  uint32_t sum = 0;
+#if TINYEXR_SIMD_SSE2
+  __m128i acc = _mm_setzero_si128();
+  for (; i + 16 <= count; i += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    acc = _mm_add_epi64(acc, _mm_sad_epu8(v, _mm_setzero_si128()));
+  }
+  sum = static_cast<uint32_t>(_mm_cvtsi128_si32(acc)) +
+        static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_unpackhi_epi64(acc, acc)));
+#endif
+  for (; i < count; i++) {
+    sum += data[i];
+  }
+  return static_cast<uint8_t>(sum);
+}
+
+// Initial predictor state of the two halves of a `count`-byte buffer.
+// Decoded byte i is 128 + sum(src[0..i] - 128), so the second half starts
+// from the decoded value of the last byte of the first half.
+inline void predictor_unreorder_carries(const uint8_t* src, size_t count,
+                                        uint8_t* carry_a, uint8_t* carry_b) {
+  size_t half_a = (count + 1) / 2;
+  *carry_a = 128;
+  *carry_b = static_cast<uint8_t>(byte_sum(src, half_a) + 128 - 128 * (half_a & 1));
+}
+
+// Scalar tail of the fused kernel, starting at pair `i`
+inline void predictor_unreorder_tail(const uint8_t* src, uint8_t* dst, size_t count,
+                                     size_t i, uint8_t a, uint8_t b) {
+  size_t half_a = (count + 1) / 2;
+  size_t half_b = count / 2;
+  for (; i < half_b; i++) {
+    a = static_cast<uint8_t>(a + src[i] - 128);
+    b = static_cast<uint8_t>(b + src[half_a + i] - 128);
+    dst[i * 2] = a;
+    dst[i * 2 + 1] = b;
+  }
+  if (half_a > half_b) {
+    dst[count - 1] = static_cast<uint8_t>(a + src[half_b] - 128);
+  }
+}
+
+// ZIP/RLE decode post-processing in one pass: the delta predictor
+// (apply_delta_predictor_fast) followed by the byte interleave of the two
+// halves (unreorder_bytes_after_decompression, split at (count + 1) / 2).
+// `src` is not modified.
+inline void predictor_unreorder_baseline(const uint8_t* src, uint8_t* dst, size_t count) {
+  uint8_t a, b;
+  predictor_unreorder_carries(src, count, &a, &b);
+  size_t i = 0;
+
+#if TINYEXR_SIMD_SSE2
+  const uint8_t* src_b = src + (count + 1) / 2;
+  const __m128i bias = _mm_set1_epi8(static_cast<char>(0x80));
+  __m128i carry_a = _mm_set1_epi8(static_cast<char>(a));
+  __m128i carry_b = _mm_set1_epi8(static_cast<char>(b));
+  for (; i + 16 <= count / 2; i += 16) {
+    __m128i va = _mm_add_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), bias);
+    __m128i vb = _mm_add_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src_b + i)), bias);
+    // Running byte sums (log-step shifts)
+    va = _mm_add_epi8(va, _mm_slli_si128(va, 1));
+    vb = _mm_add_epi8(vb, _mm_slli_si128(vb, 1));
+    va = _mm_add_epi8(va, _mm_slli_si128(va, 2));
+    vb = _mm_add_epi8(vb, _mm_slli_si128(vb, 2));
+    va = _mm_add_epi8(va, _mm_slli_si128(va, 4));
+    vb = _mm_add_epi8(vb, _mm_slli_si128(vb, 4));
+    va = _mm_add_epi8(va, _mm_slli_si128(va, 8));
+    vb = _mm_add_epi8(vb, _mm_slli_si128(vb, 8));
+    va = _mm_add_epi8(va, carry_a);
+    vb = _mm_add_epi8(vb, carry_b);
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 2), _mm_unpacklo_epi8(va, vb));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 2 + 16), _mm_unpackhi_epi8(va, vb));
+
+    // Broadcast byte 15 (SSE2 has no byte shuffle)
+    __m128i ha = _mm_shufflehi_epi16(_mm_unpackhi_epi8(va, va), 0xFF);
+    __m128i hb = _mm_shufflehi_epi16(_mm_unpackhi_epi8(vb, vb), 0xFF);
+    carry_a = _mm_shuffle_epi32(ha, 0xFF);
+    carry_b = _mm_shuffle_epi32(hb, 0xFF);
+  }
+  if (i > 0) {
+    a = dst[i * 2 - 2];
+    b = dst[i * 2 - 1];
+  }
+#endif
+
+  predictor_unreorder_tail(src, dst, count, i, a, b);
+}
+
 // ============================================================================
 // RLE SIMD Optimizations (P2 optimization)
 // ============================================================================
@@ -1501,6 +1682,44 @@ inline void wavelet_encode_2x2(uint16_t* p00, uint16_t* p01,
   *p11 = static_cast<uint16_t>(h1);
 }
 
+// 16-bit wavelet decode helper (wdec16), modulo 2^16
+// b = l - (h >> 1), a = h + b - 0x8000
+inline void wdec16_scalar(uint16_t l, uint16_t h, uint16_t& a, uint16_t& b) {
+  int bb = (l - (h >> 1)) & 0xFFFF;
+  a = static_cast<uint16_t>((h + bb - 0x8000) & 0xFFFF);
+  b = static_cast<uint16_t>(bb);
+}
+
+// 16-bit wavelet encode helper (wenc16), modulo 2^16
+inline void wenc16_scalar(uint16_t a, uint16_t b, uint16_t& l, uint16_t& h) {
+  int ao = (a + 0x8000) & 0xFFFF;
+  int m = (ao + b) >> 1;
+  int d = ao - b;
+  if (d < 0) m = (m + 0x8000) & 0xFFFF;
+  l = static_cast<uint16_t>(m);
+  h = static_cast<uint16_t>(d & 0xFFFF);
+}
+
+// Decode a 2x2 wavelet block with wdec16
+inline void wavelet_decode16_2x2(uint16_t* p00, uint16_t* p01,
+                                 uint16_t* p10, uint16_t* p11) {
+  uint16_t a0, b0, a1, b1;
+  wdec16_scalar(*p00, *p10, a0, b0);
+  wdec16_scalar(*p01, *p11, a1, b1);
+  wdec16_scalar(a0, a1, *p00, *p01);
+  wdec16_scalar(b0, b1, *p10, *p11);
+}
+
+// Encode a 2x2 pixel block with wenc16
+inline void wavelet_encode16_2x2(uint16_t* p00, uint16_t* p01,
+                                 uint16_t* p10, uint16_t* p11) {
+  uint16_t a0, a1, b0, b1;
+  wenc16_scalar(*p00, *p01, a0, a1);
+  wenc16_scalar(*p10, *p11, b0, b1);
+  wenc16_scalar(a0, b0, *p00, *p10);
+  wenc16_scalar(a1, b1, *p01, *p11);
+}
+
 #if TINYEXR_SIMD_SSE2
 
 // SSE2: Process 4 2x2 blocks in parallel (8 pixels per row)
@@ -1516,20 +1735,12 @@ inline void wavelet_decode_4blocks_sse2(uint16_t* row0, uint16_t* row1, size_t s
   // r0 = [L0 HL0 L1 HL1 L2 HL2 L3 HL3]
   // r1 = [LH0 HH0 LH1 HH1 LH2 HH2 LH3 HH3]
 
-  // Shuffle to separate even/odd positions
-  // Even positions (L, L, L, L): indices 0, 2, 4, 6
-  // Odd positions (HL, HL, HL, HL): indices 1, 3, 5, 7
-  __m128i mask_even = _mm_set_epi8(-1, -1, -1, -1, -1, -1, -1, -1,
-                                   13, 12, 9, 8, 5, 4, 1, 0);
-  __m128i mask_odd = _mm_set_epi8(-1, -1, -1, -1, -1, -1, -1, -1,
-                                  15, 14, 11, 10, 7, 6, 3, 2);
-
-  // For SSE2 we need to use shuffle differently
-  // Use unpack to separate even/odd 16-bit values
-  __m128i L = _mm_and_si128(r0, _mm_set1_epi32(0x0000FFFF));
-  __m128i HL = _mm_srli_epi32(r0, 16);
-  __m128i LH = _mm_and_si128(r1, _mm_set1_epi32(0x0000FFFF));
-  __m128i HH = _mm_srli_epi32(r1, 16);
+  // Separate even/odd 16-bit values, sign-extended to 32 bits so that the
+  // saturating pack below is exact
+  __m128i L = _mm_srai_epi32(_mm_slli_epi32(r0, 16), 16);
+  __m128i HL = _mm_srai_epi32(r0, 16);
+  __m128i LH = _mm_srai_epi32(_mm_slli_epi32(r1, 16), 16);
+  __m128i HH = _mm_srai_epi32(r1, 16);
 
   // Pack to get 4 values each
   L = _mm_packs_epi32(L, _mm_setzero_si128());
@@ -1642,8 +1853,8 @@ inline void wavelet_decode_4blocks_neon(uint16_t* row0, uint16_t* row1, size_t s
 
 // Generic wavelet decode for a row of 2x2 blocks
 // Processes as many blocks as possible with SIMD, falls back to scalar
-inline void wavelet_decode_row(uint16_t* row0, uint16_t* row1,
-                               size_t width, size_t stride) {
+inline void wavelet_decode_row_baseline(uint16_t* row0, uint16_t* row1,
+                                        size_t width, size_t stride) {
   size_t x = 0;
 
 #if TINYEXR_SIMD_SSE2
@@ -1656,6 +1867,8 @@ inline void wavelet_decode_row(uint16_t* row0, uint16_t* row1,
   for (; x + 8 <= width; x += 8) {
     wavelet_decode_4blocks_neon(row0 + x, row1 + x, stride);
   }
+#else
+  (void)stride;
 #endif
 
   // Scalar fallback for remaining blocks
@@ -1664,6 +1877,1491 @@ inline void wavelet_decode_row(uint16_t* row0, uint16_t* row1,
   }
 }
 
+// Row kernels for the other PIZ wavelet steps. Like wavelet_decode_row they
+// take two rows of `width` samples holding width / 2 horizontally adjacent
+// 2x2 blocks. The horizontal step pairs each even lane with the odd lane
+// above it in the same 32-bit lane, so no shuffles are needed.
+
+#if TINYEXR_SIMD_SSE2
+
+// Odd lanes moved down onto the even lanes
+inline __m128i wavelet_odd_sse2(__m128i v) { return _mm_srli_epi32(v, 16); }
+
+// Even lanes from `a`, odd lanes from the even lanes of `b`
+inline __m128i wavelet_merge_sse2(__m128i a, __m128i b) {
+  return _mm_or_si128(_mm_and_si128(a, _mm_set1_epi32(0x0000FFFF)),
+                      _mm_slli_epi32(b, 16));
+}
+
+inline void wdec16_sse2(__m128i l, __m128i h, __m128i* a, __m128i* b) {
+  const __m128i bias = _mm_set1_epi16(static_cast<short>(0x8000));
+  *b = _mm_sub_epi16(l, _mm_srli_epi16(h, 1));
+  *a = _mm_add_epi16(_mm_add_epi16(h, *b), bias);
+}
+
+inline void wenc14_sse2(__m128i a, __m128i b, __m128i* l, __m128i* h) {
+  // (a + b) >> 1 without leaving 16 bits
+  *l = _mm_add_epi16(_mm_and_si128(a, b), _mm_srai_epi16(_mm_xor_si128(a, b), 1));
+  *h = _mm_sub_epi16(a, b);
+}
+
+inline void wenc16_sse2(__m128i a, __m128i b, __m128i* l, __m128i* h) {
+  const __m128i bias = _mm_set1_epi16(static_cast<short>(0x8000));
+  __m128i ao = _mm_xor_si128(a, bias);
+  __m128i m = _mm_add_epi16(_mm_and_si128(ao, b), _mm_srli_epi16(_mm_xor_si128(ao, b), 1));
+  // ao < b (unsigned) <=> a < b ^ 0x8000 (signed)
+  __m128i neg = _mm_cmplt_epi16(a, _mm_xor_si128(b, bias));
+  *l = _mm_add_epi16(m, _mm_and_si128(neg, bias));
+  *h = _mm_sub_epi16(ao, b);
+}
+
+#elif TINYEXR_SIMD_NEON
+
+inline uint16x8_t wavelet_odd_neon(uint16x8_t v) {
+  return vreinterpretq_u16_u32(vshrq_n_u32(vreinterpretq_u32_u16(v), 16));
+}
+
+inline uint16x8_t wavelet_merge_neon(uint16x8_t a, uint16x8_t b) {
+  return vreinterpretq_u16_u32(
+      vsliq_n_u32(vreinterpretq_u32_u16(a), vreinterpretq_u32_u16(b), 16));
+}
+
+inline void wdec16_neon(uint16x8_t l, uint16x8_t h, uint16x8_t* a, uint16x8_t* b) {
+  *b = vsubq_u16(l, vshrq_n_u16(h, 1));
+  *a = vaddq_u16(vaddq_u16(h, *b), vdupq_n_u16(0x8000));
+}
+
+inline void wenc14_neon(uint16x8_t a, uint16x8_t b, uint16x8_t* l, uint16x8_t* h) {
+  *l = vreinterpretq_u16_s16(vhaddq_s16(vreinterpretq_s16_u16(a), vreinterpretq_s16_u16(b)));
+  *h = vsubq_u16(a, b);
+}
+
+inline void wenc16_neon(uint16x8_t a, uint16x8_t b, uint16x8_t* l, uint16x8_t* h) {
+  const uint16x8_t bias = vdupq_n_u16(0x8000);
+  uint16x8_t ao = veorq_u16(a, bias);
+  *l = vaddq_u16(vhaddq_u16(ao, b), vandq_u16(vcltq_u16(ao, b), bias));
+  *h = vsubq_u16(ao, b);
+}
+
+#endif
+
+inline void wavelet_decode16_row_baseline(uint16_t* row0, uint16_t* row1, size_t width) {
+  size_t x = 0;
+#if TINYEXR_SIMD_SSE2
+  for (; x + 8 <= width; x += 8) {
+    __m128i r0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x));
+    __m128i r1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x));
+    __m128i a, b, aa, ab, ba, bb;
+    wdec16_sse2(r0, r1, &a, &b);
+    wdec16_sse2(a, wavelet_odd_sse2(a), &aa, &ab);
+    wdec16_sse2(b, wavelet_odd_sse2(b), &ba, &bb);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(row0 + x), wavelet_merge_sse2(aa, ab));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(row1 + x), wavelet_merge_sse2(ba, bb));
+  }
+#elif TINYEXR_SIMD_NEON
+  for (; x + 8 <= width; x += 8) {
+    uint16x8_t a, b, aa, ab, ba, bb;
+    wdec16_neon(vld1q_u16(row0 + x), vld1q_u16(row1 + x), &a, &b);
+    wdec16_neon(a, wavelet_odd_neon(a), &aa, &ab);
+    wdec16_neon(b, wavelet_odd_neon(b), &ba, &bb);
+    vst1q_u16(row0 + x, wavelet_merge_neon(aa, ab));
+    vst1q_u16(row1 + x, wavelet_merge_neon(ba, bb));
+  }
+#endif
+  for (; x + 2 <= width; x += 2) {
+    wavelet_decode16_2x2(row0 + x, row0 + x + 1, row1 + x, row1 + x + 1);
+  }
+}
+
+inline void wavelet_encode_row_baseline(uint16_t* row0, uint16_t* row1, size_t width) {
+  size_t x = 0;
+#if TINYEXR_SIMD_SSE2
+  for (; x + 8 <= width; x += 8) {
+    __m128i r0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x));
+    __m128i r1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x));
+    __m128i l, h, a, b;
+    wenc14_sse2(r0, wavelet_odd_sse2(r0), &l, &h);
+    a = wavelet_merge_sse2(l, h);
+    wenc14_sse2(r1, wavelet_odd_sse2(r1), &l, &h);
+    b = wavelet_merge_sse2(l, h);
+    wenc14_sse2(a, b, &l, &h);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(row0 + x), l);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(row1 + x), h);
+  }
+#elif TINYEXR_SIMD_NEON
+  for (; x + 8 <= width; x += 8) {
+    uint16x8_t r0 = vld1q_u16(row0 + x);
+    uint16x8_t r1 = vld1q_u16(row1 + x);
+    uint16x8_t l, h, a, b;
+    wenc14_neon(r0, wavelet_odd_neon(r0), &l, &h);
+    a = wavelet_merge_neon(l, h);
+    wenc14_neon(r1, wavelet_odd_neon(r1), &l, &h);
+    b = wavelet_merge_neon(l, h);
+    wenc14_neon(a, b, &l, &h);
+    vst1q_u16(row0 + x, l);
+    vst1q_u16(row1 + x, h);
+  }
+#endif
+  for (; x + 2 <= width; x += 2) {
+    wavelet_encode_2x2(row0 + x, row0 + x + 1, row1 + x, row1 + x + 1);
+  }
+}
+
+inline void wavelet_encode16_row_baseline(uint16_t* row0, uint16_t* row1, size_t width) {
+  size_t x = 0;
+#if TINYEXR_SIMD_SSE2
+  for (; x + 8 <= width; x += 8) {
+    __m128i r0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x));
+    __m128i r1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x));
+    __m128i l, h, a, b;
+    wenc16_sse2(r0, wavelet_odd_sse2(r0), &l, &h);
+    a = wavelet_merge_sse2(l, h);
+    wenc16_sse2(r1, wavelet_odd_sse2(r1), &l, &h);
+    b = wavelet_merge_sse2(l, h);
+    wenc16_sse2(a, b, &l, &h);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(row0 + x), l);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(row1 + x), h);
+  }
+#elif TINYEXR_SIMD_NEON
+  for (; x + 8 <= width; x += 8) {
+    uint16x8_t r0 = vld1q_u16(row0 + x);
+    uint16x8_t r1 = vld1q_u16(row1 + x);
+    uint16x8_t l, h, a, b;
+    wenc16_neon(r0, wavelet_odd_neon(r0), &l, &h);
+    a = wavelet_merge_neon(l, h);
+    wenc16_neon(r1, wavelet_odd_neon(r1), &l, &h);
+    b = wavelet_merge_neon(l, h);
+    wenc16_neon(a, b, &l, &h);
+    vst1q_u16(row0 + x, l);
+    vst1q_u16(row1 + x, h);
+  }
+#endif
+  for (; x + 2 <= width; x += 2) {
+    wavelet_encode16_2x2(row0 + x, row0 + x + 1, row1 + x, row1 + x + 1);
+  }
+}
+
+// ============================================================================
+// DWA Lossy DCT
+// ============================================================================
+
+// DWAA/DWAB store 8x8 blocks of perceptually encoded half values as float DCT
+// coefficients. These kernels keep OpenEXR's constants and order of
+// operations, so every tier reconstructs the same half values as the
+// reference decoder.
+
+// 0.5 * cos(k * pi / 16) factors of the 8-point DCT (pi as 3.14159, as in
+// OpenEXR)
+struct DctCoefficients {
+  float a, b, c, d, e, f, g;
+  DctCoefficients()
+      : a(0.5f * std::cos(3.14159f / 4.0f)),
+        b(0.5f * std::cos(3.14159f / 16.0f)),
+        c(0.5f * std::cos(3.14159f / 8.0f)),
+        d(0.5f * std::cos(3.0f * 3.14159f / 16.0f)),
+        e(0.5f * std::cos(5.0f * 3.14159f / 16.0f)),
+        f(0.5f * std::cos(3.0f * 3.14159f / 8.0f)),
+        g(0.5f * std::cos(7.0f * 3.14159f / 16.0f)) {}
+};
+
+inline const DctCoefficients& dct_coefficients() {
+  static const DctCoefficients k;
+  return k;
+}
+
+// 8-point inverse DCT of x[0], x[s], ..., x[7s] in place
+inline void dct_inverse_1d_scalar(float* x, size_t s, const DctCoefficients& k) {
+  float alpha[4], beta[4], theta[4], gamma[4];
+  alpha[0] = k.c * x[2 * s];
+  alpha[1] = k.f * x[2 * s];
+  alpha[2] = k.c * x[6 * s];
+  alpha[3] = k.f * x[6 * s];
+  beta[0] = k.b * x[s] + k.d * x[3 * s] + k.e * x[5 * s] + k.g * x[7 * s];
+  beta[1] = k.d * x[s] - k.g * x[3 * s] - k.b * x[5 * s] - k.e * x[7 * s];
+  beta[2] = k.e * x[s] - k.b * x[3 * s] + k.g * x[5 * s] + k.d * x[7 * s];
+  beta[3] = k.g * x[s] - k.e * x[3 * s] + k.d * x[5 * s] - k.b * x[7 * s];
+  theta[0] = k.a * (x[0] + x[4 * s]);
+  theta[3] = k.a * (x[0] - x[4 * s]);
+  theta[1] = alpha[0] + alpha[3];
+  theta[2] = alpha[1] - alpha[2];
+  gamma[0] = theta[0] + theta[1];
+  gamma[1] = theta[3] + theta[2];
+  gamma[2] = theta[3] - theta[2];
+  gamma[3] = theta[0] - theta[1];
+  x[0] = gamma[0] + beta[0];
+  x[s] = gamma[1] + beta[1];
+  x[2 * s] = gamma[2] + beta[2];
+  x[3 * s] = gamma[3] + beta[3];
+  x[4 * s] = gamma[3] - beta[3];
+  x[5 * s] = gamma[2] - beta[2];
+  x[6 * s] = gamma[1] - beta[1];
+  x[7 * s] = gamma[0] - beta[0];
+}
+
+// 8-point forward DCT of x[0], x[s], ..., x[7s] in place, the transpose of
+// dct_inverse_1d_scalar
+inline void dct_forward_1d_scalar(float* x, size_t s, const DctCoefficients& k) {
+  float sum[4], diff[4];
+  for (size_t i = 0; i < 4; i++) {
+    sum[i] = x[i * s] + x[(7 - i) * s];
+    diff[i] = x[i * s] - x[(7 - i) * s];
+  }
+  float even0 = sum[0] + sum[3], even1 = sum[1] + sum[2];
+  float odd0 = sum[0] - sum[3], odd1 = sum[1] - sum[2];
+  x[0] = k.a * (even0 + even1);
+  x[4 * s] = k.a * (even0 - even1);
+  x[2 * s] = k.c * odd0 + k.f * odd1;
+  x[6 * s] = k.f * odd0 - k.c * odd1;
+  x[s] = k.b * diff[0] + k.d * diff[1] + k.e * diff[2] + k.g * diff[3];
+  x[3 * s] = k.d * diff[0] - k.g * diff[1] - k.b * diff[2] - k.e * diff[3];
+  x[5 * s] = k.e * diff[0] - k.b * diff[1] + k.g * diff[2] + k.d * diff[3];
+  x[7 * s] = k.g * diff[0] - k.e * diff[1] + k.d * diff[2] - k.b * diff[3];
+}
+
+#if TINYEXR_SIMD_SSE2
+
+// The same butterflies on four rows (or columns) at once
+inline void dct_inverse_1d_sse2(__m128* v, const DctCoefficients& k) {
+  const __m128 a = _mm_set1_ps(k.a), b = _mm_set1_ps(k.b), c = _mm_set1_ps(k.c);
+  const __m128 d = _mm_set1_ps(k.d), e = _mm_set1_ps(k.e), f = _mm_set1_ps(k.f);
+  const __m128 g = _mm_set1_ps(k.g);
+  __m128 alpha0 = _mm_mul_ps(c, v[2]);
+  __m128 alpha1 = _mm_mul_ps(f, v[2]);
+  __m128 alpha2 = _mm_mul_ps(c, v[6]);
+  __m128 alpha3 = _mm_mul_ps(f, v[6]);
+  __m128 beta0 = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(b, v[1]), _mm_mul_ps(d, v[3])),
+                                       _mm_mul_ps(e, v[5])), _mm_mul_ps(g, v[7]));
+  __m128 beta1 = _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(_mm_mul_ps(d, v[1]), _mm_mul_ps(g, v[3])),
+                                       _mm_mul_ps(b, v[5])), _mm_mul_ps(e, v[7]));
+  __m128 beta2 = _mm_add_ps(_mm_add_ps(_mm_sub_ps(_mm_mul_ps(e, v[1]), _mm_mul_ps(b, v[3])),
+                                       _mm_mul_ps(g, v[5])), _mm_mul_ps(d, v[7]));
+  __m128 beta3 = _mm_sub_ps(_mm_add_ps(_mm_sub_ps(_mm_mul_ps(g, v[1]), _mm_mul_ps(e, v[3])),
+                                       _mm_mul_ps(d, v[5])), _mm_mul_ps(b, v[7]));
+  __m128 theta0 = _mm_mul_ps(a, _mm_add_ps(v[0], v[4]));
+  __m128 theta3 = _mm_mul_ps(a, _mm_sub_ps(v[0], v[4]));
+  __m128 theta1 = _mm_add_ps(alpha0, alpha3);
+  __m128 theta2 = _mm_sub_ps(alpha1, alpha2);
+  __m128 gamma0 = _mm_add_ps(theta0, theta1);
+  __m128 gamma1 = _mm_add_ps(theta3, theta2);
+  __m128 gamma2 = _mm_sub_ps(theta3, theta2);
+  __m128 gamma3 = _mm_sub_ps(theta0, theta1);
+  v[0] = _mm_add_ps(gamma0, beta0);
+  v[1] = _mm_add_ps(gamma1, beta1);
+  v[2] = _mm_add_ps(gamma2, beta2);
+  v[3] = _mm_add_ps(gamma3, beta3);
+  v[4] = _mm_sub_ps(gamma3, beta3);
+  v[5] = _mm_sub_ps(gamma2, beta2);
+  v[6] = _mm_sub_ps(gamma1, beta1);
+  v[7] = _mm_sub_ps(gamma0, beta0);
+}
+
+// Row pass over rows [row, row + 4): transpose so each register holds one
+// coefficient of the four rows, transform, transpose back
+inline void dct_inverse_rows4_sse2(float* data, int row, const DctCoefficients& k) {
+  float* p = data + row * 8;
+  __m128 v[8];
+  for (int h = 0; h < 2; h++) {
+    __m128 r0 = _mm_loadu_ps(p + h * 4);
+    __m128 r1 = _mm_loadu_ps(p + 8 + h * 4);
+    __m128 r2 = _mm_loadu_ps(p + 16 + h * 4);
+    __m128 r3 = _mm_loadu_ps(p + 24 + h * 4);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    v[h * 4 + 0] = r0;
+    v[h * 4 + 1] = r1;
+    v[h * 4 + 2] = r2;
+    v[h * 4 + 3] = r3;
+  }
+  dct_inverse_1d_sse2(v, k);
+  for (int h = 0; h < 2; h++) {
+    _MM_TRANSPOSE4_PS(v[h * 4 + 0], v[h * 4 + 1], v[h * 4 + 2], v[h * 4 + 3]);
+    _mm_storeu_ps(p + h * 4, v[h * 4 + 0]);
+    _mm_storeu_ps(p + 8 + h * 4, v[h * 4 + 1]);
+    _mm_storeu_ps(p + 16 + h * 4, v[h * 4 + 2]);
+    _mm_storeu_ps(p + 24 + h * 4, v[h * 4 + 3]);
+  }
+}
+
+inline void dct_forward_1d_sse2(__m128* v, const DctCoefficients& k) {
+  const __m128 a = _mm_set1_ps(k.a), b = _mm_set1_ps(k.b), c = _mm_set1_ps(k.c);
+  const __m128 d = _mm_set1_ps(k.d), e = _mm_set1_ps(k.e), f = _mm_set1_ps(k.f);
+  const __m128 g = _mm_set1_ps(k.g);
+  __m128 sum0 = _mm_add_ps(v[0], v[7]), diff0 = _mm_sub_ps(v[0], v[7]);
+  __m128 sum1 = _mm_add_ps(v[1], v[6]), diff1 = _mm_sub_ps(v[1], v[6]);
+  __m128 sum2 = _mm_add_ps(v[2], v[5]), diff2 = _mm_sub_ps(v[2], v[5]);
+  __m128 sum3 = _mm_add_ps(v[3], v[4]), diff3 = _mm_sub_ps(v[3], v[4]);
+  __m128 even0 = _mm_add_ps(sum0, sum3), even1 = _mm_add_ps(sum1, sum2);
+  __m128 odd0 = _mm_sub_ps(sum0, sum3), odd1 = _mm_sub_ps(sum1, sum2);
+  v[0] = _mm_mul_ps(a, _mm_add_ps(even0, even1));
+  v[4] = _mm_mul_ps(a, _mm_sub_ps(even0, even1));
+  v[2] = _mm_add_ps(_mm_mul_ps(c, odd0), _mm_mul_ps(f, odd1));
+  v[6] = _mm_sub_ps(_mm_mul_ps(f, odd0), _mm_mul_ps(c, odd1));
+  v[1] = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(b, diff0), _mm_mul_ps(d, diff1)),
+                               _mm_mul_ps(e, diff2)), _mm_mul_ps(g, diff3));
+  v[3] = _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(_mm_mul_ps(d, diff0), _mm_mul_ps(g, diff1)),
+                               _mm_mul_ps(b, diff2)), _mm_mul_ps(e, diff3));
+  v[5] = _mm_add_ps(_mm_add_ps(_mm_sub_ps(_mm_mul_ps(e, diff0), _mm_mul_ps(b, diff1)),
+                               _mm_mul_ps(g, diff2)), _mm_mul_ps(d, diff3));
+  v[7] = _mm_sub_ps(_mm_add_ps(_mm_sub_ps(_mm_mul_ps(g, diff0), _mm_mul_ps(e, diff1)),
+                               _mm_mul_ps(d, diff2)), _mm_mul_ps(b, diff3));
+}
+
+#elif TINYEXR_SIMD_NEON
+
+inline void dct_inverse_1d_neon(float32x4_t* v, const DctCoefficients& k) {
+  const float32x4_t a = vdupq_n_f32(k.a), b = vdupq_n_f32(k.b), c = vdupq_n_f32(k.c);
+  const float32x4_t d = vdupq_n_f32(k.d), e = vdupq_n_f32(k.e), f = vdupq_n_f32(k.f);
+  const float32x4_t g = vdupq_n_f32(k.g);
+  // Separate multiplies and adds (no vmla/vfma) to round like the scalar code
+  float32x4_t alpha0 = vmulq_f32(c, v[2]);
+  float32x4_t alpha1 = vmulq_f32(f, v[2]);
+  float32x4_t alpha2 = vmulq_f32(c, v[6]);
+  float32x4_t alpha3 = vmulq_f32(f, v[6]);
+  float32x4_t beta0 = vaddq_f32(vaddq_f32(vaddq_f32(vmulq_f32(b, v[1]), vmulq_f32(d, v[3])),
+                                          vmulq_f32(e, v[5])), vmulq_f32(g, v[7]));
+  float32x4_t beta1 = vsubq_f32(vsubq_f32(vsubq_f32(vmulq_f32(d, v[1]), vmulq_f32(g, v[3])),
+                                          vmulq_f32(b, v[5])), vmulq_f32(e, v[7]));
+  float32x4_t beta2 = vaddq_f32(vaddq_f32(vsubq_f32(vmulq_f32(e, v[1]), vmulq_f32(b, v[3])),
+                                          vmulq_f32(g, v[5])), vmulq_f32(d, v[7]));
+  float32x4_t beta3 = vsubq_f32(vaddq_f32(vsubq_f32(vmulq_f32(g, v[1]), vmulq_f32(e, v[3])),
+                                          vmulq_f32(d, v[5])), vmulq_f32(b, v[7]));
+  float32x4_t theta0 = vmulq_f32(a, vaddq_f32(v[0], v[4]));
+  float32x4_t theta3 = vmulq_f32(a, vsubq_f32(v[0], v[4]));
+  float32x4_t theta1 = vaddq_f32(alpha0, alpha3);
+  float32x4_t theta2 = vsubq_f32(alpha1, alpha2);
+  float32x4_t gamma0 = vaddq_f32(theta0, theta1);
+  float32x4_t gamma1 = vaddq_f32(theta3, theta2);
+  float32x4_t gamma2 = vsubq_f32(theta3, theta2);
+  float32x4_t gamma3 = vsubq_f32(theta0, theta1);
+  v[0] = vaddq_f32(gamma0, beta0);
+  v[1] = vaddq_f32(gamma1, beta1);
+  v[2] = vaddq_f32(gamma2, beta2);
+  v[3] = vaddq_f32(gamma3, beta3);
+  v[4] = vsubq_f32(gamma3, beta3);
+  v[5] = vsubq_f32(gamma2, beta2);
+  v[6] = vsubq_f32(gamma1, beta1);
+  v[7] = vsubq_f32(gamma0, beta0);
+}
+
+inline void transpose4_neon(float32x4_t* r0, float32x4_t* r1, float32x4_t* r2,
+                            float32x4_t* r3) {
+  float32x4x2_t t01 = vtrnq_f32(*r0, *r1);
+  float32x4x2_t t23 = vtrnq_f32(*r2, *r3);
+  *r0 = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+  *r1 = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+  *r2 = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+  *r3 = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+}
+
+inline void dct_inverse_rows4_neon(float* data, int row, const DctCoefficients& k) {
+  float* p = data + row * 8;
+  float32x4_t v[8];
+  for (int h = 0; h < 2; h++) {
+    v[h * 4 + 0] = vld1q_f32(p + h * 4);
+    v[h * 4 + 1] = vld1q_f32(p + 8 + h * 4);
+    v[h * 4 + 2] = vld1q_f32(p + 16 + h * 4);
+    v[h * 4 + 3] = vld1q_f32(p + 24 + h * 4);
+    transpose4_neon(&v[h * 4 + 0], &v[h * 4 + 1], &v[h * 4 + 2], &v[h * 4 + 3]);
+  }
+  dct_inverse_1d_neon(v, k);
+  for (int h = 0; h < 2; h++) {
+    transpose4_neon(&v[h * 4 + 0], &v[h * 4 + 1], &v[h * 4 + 2], &v[h * 4 + 3]);
+    vst1q_f32(p + h * 4, v[h * 4 + 0]);
+    vst1q_f32(p + 8 + h * 4, v[h * 4 + 1]);
+    vst1q_f32(p + 16 + h * 4, v[h * 4 + 2]);
+    vst1q_f32(p + 24 + h * 4, v[h * 4 + 3]);
+  }
+}
+
+inline void dct_forward_1d_neon(float32x4_t* v, const DctCoefficients& k) {
+  const float32x4_t a = vdupq_n_f32(k.a), b = vdupq_n_f32(k.b), c = vdupq_n_f32(k.c);
+  const float32x4_t d = vdupq_n_f32(k.d), e = vdupq_n_f32(k.e), f = vdupq_n_f32(k.f);
+  const float32x4_t g = vdupq_n_f32(k.g);
+  float32x4_t sum0 = vaddq_f32(v[0], v[7]), diff0 = vsubq_f32(v[0], v[7]);
+  float32x4_t sum1 = vaddq_f32(v[1], v[6]), diff1 = vsubq_f32(v[1], v[6]);
+  float32x4_t sum2 = vaddq_f32(v[2], v[5]), diff2 = vsubq_f32(v[2], v[5]);
+  float32x4_t sum3 = vaddq_f32(v[3], v[4]), diff3 = vsubq_f32(v[3], v[4]);
+  float32x4_t even0 = vaddq_f32(sum0, sum3), even1 = vaddq_f32(sum1, sum2);
+  float32x4_t odd0 = vsubq_f32(sum0, sum3), odd1 = vsubq_f32(sum1, sum2);
+  v[0] = vmulq_f32(a, vaddq_f32(even0, even1));
+  v[4] = vmulq_f32(a, vsubq_f32(even0, even1));
+  v[2] = vaddq_f32(vmulq_f32(c, odd0), vmulq_f32(f, odd1));
+  v[6] = vsubq_f32(vmulq_f32(f, odd0), vmulq_f32(c, odd1));
+  v[1] = vaddq_f32(vaddq_f32(vaddq_f32(vmulq_f32(b, diff0), vmulq_f32(d, diff1)),
+                             vmulq_f32(e, diff2)), vmulq_f32(g, diff3));
+  v[3] = vsubq_f32(vsubq_f32(vsubq_f32(vmulq_f32(d, diff0), vmulq_f32(g, diff1)),
+                             vmulq_f32(b, diff2)), vmulq_f32(e, diff3));
+  v[5] = vaddq_f32(vaddq_f32(vsubq_f32(vmulq_f32(e, diff0), vmulq_f32(b, diff1)),
+                             vmulq_f32(g, diff2)), vmulq_f32(d, diff3));
+  v[7] = vsubq_f32(vaddq_f32(vsubq_f32(vmulq_f32(g, diff0), vmulq_f32(e, diff1)),
+                             vmulq_f32(d, diff2)), vmulq_f32(b, diff3));
+}
+
+#endif
+
+// Inverse 8x8 DCT in place, rows first. The last `zeroed_rows` rows are known
+// to be zero and stay zero through the row pass.
+inline void dct_inverse_8x8_baseline(float* data, int zeroed_rows) {
+  const DctCoefficients& k = dct_coefficients();
+#if TINYEXR_SIMD_SSE2
+  dct_inverse_rows4_sse2(data, 0, k);
+  if (zeroed_rows < 4) dct_inverse_rows4_sse2(data, 4, k);
+  for (int h = 0; h < 2; h++) {
+    __m128 v[8];
+    for (int r = 0; r < 8; r++) v[r] = _mm_loadu_ps(data + r * 8 + h * 4);
+    dct_inverse_1d_sse2(v, k);
+    for (int r = 0; r < 8; r++) _mm_storeu_ps(data + r * 8 + h * 4, v[r]);
+  }
+#elif TINYEXR_SIMD_NEON
+  dct_inverse_rows4_neon(data, 0, k);
+  if (zeroed_rows < 4) dct_inverse_rows4_neon(data, 4, k);
+  for (int h = 0; h < 2; h++) {
+    float32x4_t v[8];
+    for (int r = 0; r < 8; r++) v[r] = vld1q_f32(data + r * 8 + h * 4);
+    dct_inverse_1d_neon(v, k);
+    for (int r = 0; r < 8; r++) vst1q_f32(data + r * 8 + h * 4, v[r]);
+  }
+#else
+  for (int row = 0; row < 8 - zeroed_rows; row++) {
+    dct_inverse_1d_scalar(data + row * 8, 1, k);
+  }
+  for (int col = 0; col < 8; col++) {
+    dct_inverse_1d_scalar(data + col, 8, k);
+  }
+#endif
+}
+
+// Rec.709 Y'CbCr to R'G'B' over a 64-value block, in place
+inline void csc709_inverse_64_baseline(float* comp0, float* comp1, float* comp2) {
+  size_t i = 0;
+#if TINYEXR_SIMD_SSE2
+  const __m128 cr_r = _mm_set1_ps(1.5747f);
+  const __m128 cb_g = _mm_set1_ps(0.1873f);
+  const __m128 cr_g = _mm_set1_ps(0.4682f);
+  const __m128 cb_b = _mm_set1_ps(1.8556f);
+  for (; i < 64; i += 4) {
+    __m128 y = _mm_loadu_ps(comp0 + i);
+    __m128 cb = _mm_loadu_ps(comp1 + i);
+    __m128 cr = _mm_loadu_ps(comp2 + i);
+    _mm_storeu_ps(comp0 + i, _mm_add_ps(y, _mm_mul_ps(cr_r, cr)));
+    _mm_storeu_ps(comp1 + i, _mm_sub_ps(_mm_sub_ps(y, _mm_mul_ps(cb_g, cb)),
+                                        _mm_mul_ps(cr_g, cr)));
+    _mm_storeu_ps(comp2 + i, _mm_add_ps(y, _mm_mul_ps(cb_b, cb)));
+  }
+#elif TINYEXR_SIMD_NEON
+  const float32x4_t cr_r = vdupq_n_f32(1.5747f);
+  const float32x4_t cb_g = vdupq_n_f32(0.1873f);
+  const float32x4_t cr_g = vdupq_n_f32(0.4682f);
+  const float32x4_t cb_b = vdupq_n_f32(1.8556f);
+  for (; i < 64; i += 4) {
+    float32x4_t y = vld1q_f32(comp0 + i);
+    float32x4_t cb = vld1q_f32(comp1 + i);
+    float32x4_t cr = vld1q_f32(comp2 + i);
+    vst1q_f32(comp0 + i, vaddq_f32(y, vmulq_f32(cr_r, cr)));
+    vst1q_f32(comp1 + i, vsubq_f32(vsubq_f32(y, vmulq_f32(cb_g, cb)), vmulq_f32(cr_g, cr)));
+    vst1q_f32(comp2 + i, vaddq_f32(y, vmulq_f32(cb_b, cb)));
+  }
+#endif
+  for (; i < 64; i++) {
+    float y = comp0[i], cb = comp1[i], cr = comp2[i];
+    comp0[i] = y + 1.5747f * cr;
+    comp1[i] = y - 0.1873f * cb - 0.4682f * cr;
+    comp2[i] = y + 1.8556f * cb;
+  }
+}
+
+// Forward 8x8 DCT in place: columns, then rows through a transpose
+inline void dct_forward_8x8_baseline(float* data) {
+  const DctCoefficients& k = dct_coefficients();
+#if TINYEXR_SIMD_SSE2
+  __m128 v[16];
+  for (int h = 0; h < 2; h++) {
+    for (int r = 0; r < 8; r++) v[h * 8 + r] = _mm_loadu_ps(data + r * 8 + h * 4);
+    dct_forward_1d_sse2(v + h * 8, k);
+  }
+  // Rows [4q, 4q + 4) of both halves, transposed into eight registers
+  for (int q = 0; q < 2; q++) {
+    __m128 t[8];
+    for (int h = 0; h < 2; h++) {
+      __m128 r0 = v[h * 8 + q * 4 + 0], r1 = v[h * 8 + q * 4 + 1];
+      __m128 r2 = v[h * 8 + q * 4 + 2], r3 = v[h * 8 + q * 4 + 3];
+      _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+      t[h * 4 + 0] = r0;
+      t[h * 4 + 1] = r1;
+      t[h * 4 + 2] = r2;
+      t[h * 4 + 3] = r3;
+    }
+    dct_forward_1d_sse2(t, k);
+    for (int h = 0; h < 2; h++) {
+      _MM_TRANSPOSE4_PS(t[h * 4 + 0], t[h * 4 + 1], t[h * 4 + 2], t[h * 4 + 3]);
+      for (int r = 0; r < 4; r++) _mm_storeu_ps(data + (q * 4 + r) * 8 + h * 4, t[h * 4 + r]);
+    }
+  }
+#elif TINYEXR_SIMD_NEON
+  float32x4_t v[16];
+  for (int h = 0; h < 2; h++) {
+    for (int r = 0; r < 8; r++) v[h * 8 + r] = vld1q_f32(data + r * 8 + h * 4);
+    dct_forward_1d_neon(v + h * 8, k);
+  }
+  for (int q = 0; q < 2; q++) {
+    float32x4_t t[8];
+    for (int h = 0; h < 2; h++) {
+      for (int r = 0; r < 4; r++) t[h * 4 + r] = v[h * 8 + q * 4 + r];
+      transpose4_neon(&t[h * 4 + 0], &t[h * 4 + 1], &t[h * 4 + 2], &t[h * 4 + 3]);
+    }
+    dct_forward_1d_neon(t, k);
+    for (int h = 0; h < 2; h++) {
+      transpose4_neon(&t[h * 4 + 0], &t[h * 4 + 1], &t[h * 4 + 2], &t[h * 4 + 3]);
+      for (int r = 0; r < 4; r++) vst1q_f32(data + (q * 4 + r) * 8 + h * 4, t[h * 4 + r]);
+    }
+  }
+#else
+  for (int col = 0; col < 8; col++) {
+    dct_forward_1d_scalar(data + col, 8, k);
+  }
+  for (int row = 0; row < 8; row++) {
+    dct_forward_1d_scalar(data + row * 8, 1, k);
+  }
+#endif
+}
+
+// Rec.709 R'G'B' to Y'CbCr over a 64-value block, in place
+inline void csc709_forward_64_baseline(float* comp0, float* comp1, float* comp2) {
+  size_t i = 0;
+#if TINYEXR_SIMD_SSE2
+  const __m128 r_y = _mm_set1_ps(0.2126f), g_y = _mm_set1_ps(0.7152f), b_y = _mm_set1_ps(0.0722f);
+  const __m128 r_cb = _mm_set1_ps(0.1146f), g_cb = _mm_set1_ps(0.3854f);
+  const __m128 g_cr = _mm_set1_ps(0.4542f), b_cr = _mm_set1_ps(0.0458f);
+  const __m128 half = _mm_set1_ps(0.5f);
+  for (; i < 64; i += 4) {
+    __m128 r = _mm_loadu_ps(comp0 + i);
+    __m128 g = _mm_loadu_ps(comp1 + i);
+    __m128 b = _mm_loadu_ps(comp2 + i);
+    _mm_storeu_ps(comp0 + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(r_y, r), _mm_mul_ps(g_y, g)),
+                                        _mm_mul_ps(b_y, b)));
+    _mm_storeu_ps(comp1 + i, _mm_add_ps(_mm_sub_ps(_mm_sub_ps(_mm_setzero_ps(), _mm_mul_ps(r_cb, r)),
+                                                   _mm_mul_ps(g_cb, g)), _mm_mul_ps(half, b)));
+    _mm_storeu_ps(comp2 + i, _mm_sub_ps(_mm_sub_ps(_mm_mul_ps(half, r), _mm_mul_ps(g_cr, g)),
+                                        _mm_mul_ps(b_cr, b)));
+  }
+#elif TINYEXR_SIMD_NEON
+  const float32x4_t r_y = vdupq_n_f32(0.2126f), g_y = vdupq_n_f32(0.7152f);
+  const float32x4_t b_y = vdupq_n_f32(0.0722f);
+  const float32x4_t r_cb = vdupq_n_f32(0.1146f), g_cb = vdupq_n_f32(0.3854f);
+  const float32x4_t g_cr = vdupq_n_f32(0.4542f), b_cr = vdupq_n_f32(0.0458f);
+  const float32x4_t half = vdupq_n_f32(0.5f);
+  for (; i < 64; i += 4) {
+    float32x4_t r = vld1q_f32(comp0 + i);
+    float32x4_t g = vld1q_f32(comp1 + i);
+    float32x4_t b = vld1q_f32(comp2 + i);
+    vst1q_f32(comp0 + i, vaddq_f32(vaddq_f32(vmulq_f32(r_y, r), vmulq_f32(g_y, g)),
+                                   vmulq_f32(b_y, b)));
+    vst1q_f32(comp1 + i, vaddq_f32(vsubq_f32(vsubq_f32(vdupq_n_f32(0.0f), vmulq_f32(r_cb, r)),
+                                             vmulq_f32(g_cb, g)), vmulq_f32(half, b)));
+    vst1q_f32(comp2 + i, vsubq_f32(vsubq_f32(vmulq_f32(half, r), vmulq_f32(g_cr, g)),
+                                   vmulq_f32(b_cr, b)));
+  }
+#endif
+  for (; i < 64; i++) {
+    float r = comp0[i], g = comp1[i], b = comp2[i];
+    comp0[i] = 0.2126f * r + 0.7152f * g + 0.0722f * b;
+    comp1[i] = 0.0f - 0.1146f * r - 0.3854f * g + 0.5f * b;
+    comp2[i] = 0.5f * r - 0.4542f * g - 0.0458f * b;
+  }
+}
+
+// Round each of 64 DCT coefficients to the nearest multiple of its step
+// (ties to even). Steps are powers of two, so the scaling is exact and the
+// result keeps few mantissa bits once converted to half.
+inline void dct_quantize_64_baseline(float* data, const float* step, const float* inv_step) {
+  size_t i = 0;
+#if TINYEXR_SIMD_SSE2
+  // |x| + 2^23 - 2^23 rounds to an integer; larger values already are
+  const __m128 sign_mask = _mm_castsi128_ps(_mm_set1_epi32(static_cast<int>(0x80000000u)));
+  const __m128 magic = _mm_set1_ps(8388608.0f);
+  for (; i < 64; i += 4) {
+    __m128 y = _mm_mul_ps(_mm_loadu_ps(data + i), _mm_loadu_ps(inv_step + i));
+    __m128 sign = _mm_and_ps(y, sign_mask);
+    __m128 ay = _mm_xor_ps(y, sign);
+    __m128 rounded = _mm_sub_ps(_mm_add_ps(ay, magic), magic);
+    __m128 small = _mm_cmplt_ps(ay, magic);
+    ay = _mm_or_ps(_mm_and_ps(small, rounded), _mm_andnot_ps(small, ay));
+    _mm_storeu_ps(data + i, _mm_mul_ps(_mm_or_ps(ay, sign), _mm_loadu_ps(step + i)));
+  }
+#elif TINYEXR_SIMD_NEON
+  const float32x4_t magic = vdupq_n_f32(8388608.0f);
+  for (; i < 64; i += 4) {
+    float32x4_t y = vmulq_f32(vld1q_f32(data + i), vld1q_f32(inv_step + i));
+    float32x4_t ay = vabsq_f32(y);
+    float32x4_t rounded = vsubq_f32(vaddq_f32(ay, magic), magic);
+    ay = vbslq_f32(vcltq_f32(ay, magic), rounded, ay);
+    uint32x4_t sign = vandq_u32(vreinterpretq_u32_f32(y), vdupq_n_u32(0x80000000u));
+    float32x4_t q = vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(ay), sign));
+    vst1q_f32(data + i, vmulq_f32(q, vld1q_f32(step + i)));
+  }
+#endif
+  for (; i < 64; i++) {
+    float y = data[i] * inv_step[i];
+    float ay = std::fabs(y);
+    if (ay < 8388608.0f) ay = (ay + 8388608.0f) - 8388608.0f;
+    data[i] = std::copysign(ay, y) * step[i];
+  }
+}
+
+// Float to half rounding to nearest even, like OpenEXR's half. NaNs become
+// quiet NaNs.
+inline uint16_t float_to_half_rne_scalar(float f) {
+  union { uint32_t u; float f; } v;
+  v.f = f;
+  uint32_t sign = (v.u >> 16) & 0x8000u;
+  v.u &= 0x7fffffffu;
+  uint16_t h;
+  if (v.u >= (143u << 23)) {
+    // Overflow to infinity, or Inf/NaN
+    h = (v.u > 0x7f800000u) ? 0x7e00 : 0x7c00;
+  } else if (v.u < (113u << 23)) {
+    // Denormal or zero: align the 10 mantissa bits at the bottom of a float
+    // and let the FPU round
+    union { uint32_t u; float f; } magic = {126u << 23};
+    v.f += magic.f;
+    h = static_cast<uint16_t>(v.u - magic.u);
+  } else {
+    uint32_t mant_odd = (v.u >> 13) & 1;
+    v.u += (static_cast<uint32_t>(15 - 127) << 23) + 0xfff + mant_odd;
+    h = static_cast<uint16_t>(v.u >> 13);
+  }
+  return static_cast<uint16_t>(h | sign);
+}
+
+#if TINYEXR_SIMD_SSE2
+
+inline void float_to_half_rne_4_sse2(const float* src, uint16_t* dst) {
+  const __m128i f16max = _mm_set1_epi32(143 << 23);
+  const __m128i min_normal = _mm_set1_epi32(113 << 23);
+  const __m128i infinity = _mm_set1_epi32(0x7f800000);
+  const __m128i magic = _mm_set1_epi32(126 << 23);
+  const __m128i normal_bias = _mm_set1_epi32(0xfff - (112 << 23));
+
+  __m128 f = _mm_loadu_ps(src);
+  __m128 sign = _mm_and_ps(f, _mm_castsi128_ps(_mm_set1_epi32(static_cast<int>(0x80000000u))));
+  __m128 absf = _mm_xor_ps(f, sign);
+  __m128i absi = _mm_castps_si128(absf);
+
+  __m128i is_regular = _mm_cmpgt_epi32(f16max, absi);
+  __m128i is_sub = _mm_cmpgt_epi32(min_normal, absi);
+  __m128i is_nan = _mm_cmpgt_epi32(absi, infinity);
+  __m128i special = _mm_or_si128(_mm_and_si128(is_nan, _mm_set1_epi32(0x200)),
+                                 _mm_set1_epi32(0x7c00));
+
+  __m128i sub = _mm_sub_epi32(
+      _mm_castps_si128(_mm_add_ps(absf, _mm_castsi128_ps(magic))), magic);
+  __m128i mant_odd = _mm_srai_epi32(_mm_slli_epi32(absi, 31 - 13), 31);
+  __m128i normal = _mm_srli_epi32(
+      _mm_sub_epi32(_mm_add_epi32(absi, normal_bias), mant_odd), 13);
+
+  __m128i h = _mm_or_si128(_mm_and_si128(is_sub, sub), _mm_andnot_si128(is_sub, normal));
+  h = _mm_or_si128(_mm_and_si128(is_regular, h), _mm_andnot_si128(is_regular, special));
+  // The sign is sign-extended, so the signed 16-bit pack keeps every value
+  h = _mm_or_si128(h, _mm_srai_epi32(_mm_castps_si128(sign), 16));
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), _mm_packs_epi32(h, h));
+}
+
+#endif
+
+// Convert an array of floats to half, always rounding to nearest even
+inline void float_to_half_rne_batch_baseline(const float* src, uint16_t* dst, size_t count) {
+  size_t i = 0;
+#if TINYEXR_SIMD_F16C
+  for (; i + 4 <= count; i += 4) {
+    float_to_half_4_f16c(src + i, dst + i);
+  }
+#elif TINYEXR_SIMD_NEON_FP16
+  for (; i + 8 <= count; i += 8) {
+    float_to_half_8_neon_fp16(src + i, dst + i);
+  }
+#elif TINYEXR_SIMD_SSE2
+  for (; i + 4 <= count; i += 4) {
+    float_to_half_rne_4_sse2(src + i, dst + i);
+  }
+#endif
+  for (; i < count; i++) {
+    dst[i] = float_to_half_rne_scalar(src[i]);
+  }
+}
+
+// ============================================================================
+// Runtime CPU Dispatch (x86)
+// ============================================================================
+
+#if TINYEXR_SIMD_AVX2_KERNELS
+
+// AVX2+F16C kernels. When dispatching they are compiled for that target
+// regardless of the compile flags and only called through the table below.
+
+TINYEXR_SIMD_TARGET_AVX2
+inline void half_to_float_batch_avx2(const uint16_t* src, float* dst, size_t count) {
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    __m128i h0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i h1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 8));
+    _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h0));
+    _mm256_storeu_ps(dst + i + 8, _mm256_cvtph_ps(h1));
+  }
+  for (; i + 8 <= count; i += 8) {
+    __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+  }
+  for (; i < count; i++) {
+    dst[i] = half_to_float_scalar(src[i]);
+  }
+}
+
+TINYEXR_SIMD_TARGET_AVX2
+inline void float_to_half_batch_avx2(const float* src, uint16_t* dst, size_t count) {
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256 f = _mm256_loadu_ps(src + i);
+    __m128i h = _mm256_cvtps_ph(f, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), h);
+  }
+  // Convert the tail through a padded block so it rounds like the rest
+  if (i < count) {
+    float tail_in[8] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    uint16_t tail_out[8];
+    std::memcpy(tail_in, src + i, (count - i) * sizeof(float));
+    __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(tail_in),
+                                _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(tail_out), h);
+    std::memcpy(dst + i, tail_out, (count - i) * sizeof(uint16_t));
+  }
+}
+
+TINYEXR_SIMD_TARGET_AVX2
+inline void interleave_rgba_float_avx2(const float* r, const float* g, const float* b,
+                                       const float* a, float* rgba, size_t count) {
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256 vr = _mm256_loadu_ps(r + i);
+    __m256 vg = _mm256_loadu_ps(g + i);
+    __m256 vb = _mm256_loadu_ps(b + i);
+    __m256 va = _mm256_loadu_ps(a + i);
+
+    __m256 rg_lo = _mm256_unpacklo_ps(vr, vg);  // r0 g0 r1 g1 | r4 g4 r5 g5
+    __m256 rg_hi = _mm256_unpackhi_ps(vr, vg);  // r2 g2 r3 g3 | r6 g6 r7 g7
+    __m256 ba_lo = _mm256_unpacklo_ps(vb, va);
+    __m256 ba_hi = _mm256_unpackhi_ps(vb, va);
+
+    __m256 rgba0 = _mm256_shuffle_ps(rg_lo, ba_lo, 0x44);  // pixel 0 | pixel 4
+    __m256 rgba1 = _mm256_shuffle_ps(rg_lo, ba_lo, 0xEE);  // pixel 1 | pixel 5
+    __m256 rgba2 = _mm256_shuffle_ps(rg_hi, ba_hi, 0x44);  // pixel 2 | pixel 6
+    __m256 rgba3 = _mm256_shuffle_ps(rg_hi, ba_hi, 0xEE);  // pixel 3 | pixel 7
+
+    _mm256_storeu_ps(rgba + i * 4, _mm256_permute2f128_ps(rgba0, rgba1, 0x20));
+    _mm256_storeu_ps(rgba + i * 4 + 8, _mm256_permute2f128_ps(rgba2, rgba3, 0x20));
+    _mm256_storeu_ps(rgba + i * 4 + 16, _mm256_permute2f128_ps(rgba0, rgba1, 0x31));
+    _mm256_storeu_ps(rgba + i * 4 + 24, _mm256_permute2f128_ps(rgba2, rgba3, 0x31));
+  }
+  for (; i < count; i++) {
+    rgba[i * 4 + 0] = r[i];
+    rgba[i * 4 + 1] = g[i];
+    rgba[i * 4 + 2] = b[i];
+    rgba[i * 4 + 3] = a[i];
+  }
+}
+
+TINYEXR_SIMD_TARGET_AVX2
+inline void deinterleave_rgba_float_avx2(const float* rgba, float* r, float* g, float* b,
+                                         float* a, size_t count) {
+  const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256 rgba0 = _mm256_loadu_ps(rgba + i * 4);
+    __m256 rgba1 = _mm256_loadu_ps(rgba + i * 4 + 8);
+    __m256 rgba2 = _mm256_loadu_ps(rgba + i * 4 + 16);
+    __m256 rgba3 = _mm256_loadu_ps(rgba + i * 4 + 24);
+
+    __m256 t0 = _mm256_unpacklo_ps(rgba0, rgba1);
+    __m256 t1 = _mm256_unpackhi_ps(rgba0, rgba1);
+    __m256 t2 = _mm256_unpacklo_ps(rgba2, rgba3);
+    __m256 t3 = _mm256_unpackhi_ps(rgba2, rgba3);
+
+    _mm256_storeu_ps(r + i, _mm256_permutevar8x32_ps(_mm256_shuffle_ps(t0, t2, 0x44), order));
+    _mm256_storeu_ps(g + i, _mm256_permutevar8x32_ps(_mm256_shuffle_ps(t0, t2, 0xEE), order));
+    _mm256_storeu_ps(b + i, _mm256_permutevar8x32_ps(_mm256_shuffle_ps(t1, t3, 0x44), order));
+    _mm256_storeu_ps(a + i, _mm256_permutevar8x32_ps(_mm256_shuffle_ps(t1, t3, 0xEE), order));
+  }
+  for (; i < count; i++) {
+    r[i] = rgba[i * 4 + 0];
+    g[i] = rgba[i * 4 + 1];
+    b[i] = rgba[i * 4 + 2];
+    a[i] = rgba[i * 4 + 3];
+  }
+}
+
+TINYEXR_SIMD_TARGET_AVX2
+inline void reorder_bytes_for_compression_avx2(const uint8_t* src, uint8_t* dst, size_t count) {
+  size_t half = count / 2;
+  size_t i = 0;
+  const __m256i low_bytes = _mm256_set1_epi16(0x00FF);
+  for (; i + 32 <= half; i += 32) {
+    __m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 2));
+    __m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 2 + 32));
+
+    // packus works per 128-bit lane; restore linear order afterwards
+    __m256i evens = _mm256_packus_epi16(_mm256_and_si256(v0, low_bytes),
+                                        _mm256_and_si256(v1, low_bytes));
+    __m256i odds = _mm256_packus_epi16(_mm256_srli_epi16(v0, 8), _mm256_srli_epi16(v1, 8));
+    evens = _mm256_permute4x64_epi64(evens, 0xD8);
+    odds = _mm256_permute4x64_epi64(odds, 0xD8);
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), evens);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + half + i), odds);
+  }
+  for (; i < half; i++) {
+    dst[i] = src[i * 2];
+    dst[half + i] = src[i * 2 + 1];
+  }
+}
+
+TINYEXR_SIMD_TARGET_AVX2
+inline void unreorder_bytes_after_decompression_avx2(const uint8_t* src, uint8_t* dst,
+                                                     size_t count) {
+  size_t half = count / 2;
+  size_t i = 0;
+  for (; i + 32 <= half; i += 32) {
+    __m256i evens = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    __m256i odds = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + half + i));
+
+    // unpack works per 128-bit lane; pre-permute so the output is linear
+    evens = _mm256_permute4x64_epi64(evens, 0xD8);
+    odds = _mm256_permute4x64_epi64(odds, 0xD8);
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 2),
+                        _mm256_unpacklo_epi8(evens, odds));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 2 + 32),
+                        _mm256_unpackhi_epi8(evens, odds));
+  }
+  for (; i < half; i++) {
+    dst[i * 2] = src[i];
+    dst[i * 2 + 1] = src[half + i];
+  }
+}
+
+// Predictor decode d[i] = d[i-1] + d[i] - 128 as a running byte sum:
+// prefix-sum 32 bytes at a time (log-step shifts per lane, then carry the
+// low lane into the high lane and the previous block into both).
+TINYEXR_SIMD_TARGET_AVX2
+inline void apply_delta_predictor_fast_avx2(uint8_t* data, size_t count) {
+  if (count < 2) return;
+
+  const __m256i bias = _mm256_set1_epi8(static_cast<char>(0x80));
+  const __m256i last_byte = _mm256_set1_epi8(15);
+  __m256i carry = _mm256_set1_epi8(static_cast<char>(data[0]));
+  size_t i = 1;
+  for (; i + 32 <= count; i += 32) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+    v = _mm256_add_epi8(v, bias);  // d - 128 (mod 256)
+    v = _mm256_add_epi8(v, _mm256_slli_si256(v, 1));
+    v = _mm256_add_epi8(v, _mm256_slli_si256(v, 2));
+    v = _mm256_add_epi8(v, _mm256_slli_si256(v, 4));
+    v = _mm256_add_epi8(v, _mm256_slli_si256(v, 8));
+
+    __m256i lane_totals = _mm256_shuffle_epi8(v, last_byte);
+    v = _mm256_add_epi8(v, _mm256_permute2x128_si256(lane_totals, lane_totals, 0x08));
+    v = _mm256_add_epi8(v, carry);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i), v);
+
+    __m256i totals = _mm256_shuffle_epi8(v, last_byte);
+    carry = _mm256_permute2x128_si256(totals, totals, 0x11);
+  }
+  for (; i < count; i++) {
+    data[i] = static_cast<uint8_t>(data[i - 1] + data[i] - 128);
+  }
+}
+
+// Predictor encode d[i] = d[i] - d[i-1] + 128 has no dependency chain;
+// walk backwards so every block still reads unmodified inputs.
+TINYEXR_SIMD_TARGET_AVX2
+inline void reverse_delta_predictor_fast_avx2(uint8_t* data, size_t count) {
+  if (count < 2) return;
+
+  const __m256i bias = _mm256_set1_epi8(static_cast<char>(0x80));
+  size_t i = count;
+  for (; i >= 33; i -= 32) {
+    __m256i cur = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i - 32));
+    __m256i prev = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i - 33));
+    __m256i v = _mm256_add_epi8(_mm256_sub_epi8(cur, prev), bias);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i - 32), v);
+  }
+  for (i = i - 1; i >= 1; i--) {
+    data[i] = static_cast<uint8_t>(data[i] - data[i - 1] + 128);
+  }
+}
+
+// 8 2x2 blocks (16 pixels per row) per iteration. Values are kept as
+// sign-extended 32-bit lanes; A1/B1 are wrapped to 16 bits before they are
+// used as the high coefficient, matching the int16 arithmetic of wdec14.
+TINYEXR_SIMD_TARGET_AVX2
+inline void wavelet_decode_row_avx2(uint16_t* row0, uint16_t* row1,
+                                    size_t width, size_t stride) {
+  const __m256i one = _mm256_set1_epi32(1);
+  const __m256i low16 = _mm256_set1_epi32(0x0000FFFF);
+  size_t x = 0;
+  for (; x + 16 <= width; x += 16) {
+    __m256i r0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row0 + x));
+    __m256i r1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row1 + x));
+
+    __m256i L = _mm256_srai_epi32(_mm256_slli_epi32(r0, 16), 16);
+    __m256i HL = _mm256_srai_epi32(r0, 16);
+    __m256i LH = _mm256_srai_epi32(_mm256_slli_epi32(r1, 16), 16);
+    __m256i HH = _mm256_srai_epi32(r1, 16);
+
+    // Vertical pass
+    __m256i A0 = _mm256_add_epi32(_mm256_add_epi32(L, _mm256_and_si256(LH, one)),
+                                  _mm256_srai_epi32(LH, 1));
+    __m256i B0 = _mm256_sub_epi32(A0, LH);
+    __m256i A1 = _mm256_add_epi32(_mm256_add_epi32(HL, _mm256_and_si256(HH, one)),
+                                  _mm256_srai_epi32(HH, 1));
+    __m256i B1 = _mm256_sub_epi32(A1, HH);
+    A1 = _mm256_srai_epi32(_mm256_slli_epi32(A1, 16), 16);
+    B1 = _mm256_srai_epi32(_mm256_slli_epi32(B1, 16), 16);
+
+    // Horizontal pass
+    __m256i AA = _mm256_add_epi32(_mm256_add_epi32(A0, _mm256_and_si256(A1, one)),
+                                  _mm256_srai_epi32(A1, 1));
+    __m256i AB = _mm256_sub_epi32(AA, A1);
+    __m256i BA = _mm256_add_epi32(_mm256_add_epi32(B0, _mm256_and_si256(B1, one)),
+                                  _mm256_srai_epi32(B1, 1));
+    __m256i BB = _mm256_sub_epi32(BA, B1);
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(row0 + x),
+                        _mm256_or_si256(_mm256_and_si256(AA, low16), _mm256_slli_epi32(AB, 16)));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(row1 + x),
+                        _mm256_or_si256(_mm256_and_si256(BA, low16), _mm256_slli_epi32(BB, 16)));
+  }
+  wavelet_decode_row_baseline(row0 + x, row1 + x, width - x, stride);
+}
+
+TINYEXR_SIMD_TARGET_AVX2
+inline __m256i wavelet_odd_avx2(__m256i v) { return _mm256_srli_epi32(v, 16); }
+
+TINYEXR_SIMD_TARGET_AVX2
+inline __m256i wavelet_merge_avx2(__m256i a, __m256i b) {
+  return _mm256_or_si256(_mm256_and_si256(a, _mm256_set1_epi32(0x0000FFFF)),
+                         _mm256_slli_epi32(b, 16));
+}
+
+TINYEXR_SIMD_TARGET_AVX2
+inline void wdec16_avx2(__m256i l, __m256i h, __m256i* a, __m256i* b) {
+  const __m256i bias = _mm256_set1_epi16(static_cast<short>(0x8000));
+  *b = _mm256_sub_epi16(l, _mm256_srli_epi16(h, 1));
+  *a = _mm256_add_epi16(_mm256_add_epi16(h, *b), bias);
+}
+
+TINYEXR_SIMD_TARGET_AVX2
+inline void wenc14_avx2(__m256i a, __m256i b, __m256i* l, __m256i* h) {
+  *l = _mm256_add_epi16(_mm256_and_si256(a, b),
+                        _mm256_srai_epi16(_mm256_xor_si256(a, b), 1));
+  *h = _mm256_sub_epi16(a, b);
+}
+
+TINYEXR_SIMD_TARGET_AVX2
+inline void wenc16_avx2(__m256i a, __m256i b, __m256i* l, __m256i* h) {
+  const __m256i bias = _mm256_set1_epi16(static_cast<short>(0x8000));
+  __m256i ao = _mm256_xor_si256(a, bias);
+  __m256i m = _mm256_add_epi16(_mm256_and_si256(ao, b),
+                               _mm256_srli_epi16(_mm256_xor_si256(ao, b), 1));
+  __m256i neg = _mm256_cmpgt_epi16(_mm256_xor_si256(b, bias), a);
+  *l = _mm256_add_epi16(m, _mm256_and_si256(neg, bias));
+  *h = _mm256_sub_epi16(ao, b);
+}
+
+TINYEXR_SIMD_TARGET_AVX2
+inline void wavelet_decode16_row_avx2(uint16_t* row0, uint16_t* row1, size_t width) {
+  size_t x = 0;
+  for (; x + 16 <= width; x += 16) {
+    __m256i r0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row0 + x));
+    __m256i r1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row1 + x));
+    __m256i a, b, aa, ab, ba, bb;
+    wdec16_avx2(r0, r1, &a, &b);
+    wdec16_avx2(a, wavelet_odd_avx2(a), &aa, &ab);
+    wdec16_avx2(b, wavelet_odd_avx2(b), &ba, &bb);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(row0 + x), wavelet_merge_avx2(aa, ab));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(row1 + x), wavelet_merge_avx2(ba, bb));
+  }
+  wavelet_decode16_row_baseline(row0 + x, row1 + x, width - x);
+}
+
+TINYEXR_SIMD_TARGET_AVX2
+inline void wavelet_encode_row_avx2(uint16_t* row0, uint16_t* row1, size_t width) {
+  size_t x = 0;
+  for (; x + 16 <= width; x += 16) {
+    __m256i r0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row0 + x));
+    __m256i r1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row1 + x));
+    __m256i l, h, a, b;
+    wenc14_avx2(r0, wavelet_odd_avx2(r0), &l, &h);
+    a = wavelet_merge_avx2(l, h);
+    wenc14_avx2(r1, wavelet_odd_avx2(r1), &l, &h);
+    b = wavelet_merge_avx2(l, h);
+    wenc14_avx2(a, b, &l, &h);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(row0 + x), l);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(row1 + x), h);
+  }
+  wavelet_encode_row_baseline(row0 + x, row1 + x, width - x);
+}
+
+TINYEXR_SIMD_TARGET_AVX2
+inline void wavelet_encode16_row_avx2(uint16_t* row0, uint16_t* row1, size_t width) {
+  size_t x = 0;
+  for (; x + 16 <= width; x += 16) {
+    __m256i r0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row0 + x));
+    __m256i r1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row1 + x));
+    __m256i l, h, a, b;
+    wenc16_avx2(r0, wavelet_odd_avx2(r0), &l, &h);
+    a = wavelet_merge_avx2(l, h);
+    wenc16_avx2(r1, wavelet_odd_avx2(r1), &l, &h);
+    b = wavelet_merge_avx2(l, h);
+    wenc16_avx2(a, b, &l, &h);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(row0 + x), l);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(row1 + x), h);
+  }
+  wavelet_encode16_row_baseline(row0 + x, row1 + x, width - x);
+}
+
+TINYEXR_SIMD_TARGET_AVX2
+inline void predictor_unreorder_avx2(const uint8_t* src, uint8_t* dst, size_t count) {
+  uint8_t a, b;
+  predictor_unreorder_carries(src, count, &a, &b);
+
+  const uint8_t* src_b = src + (count + 1) / 2;
+  const __m256i bias = _mm256_set1_epi8(static_cast<char>(0x80));
+  const __m256i last_byte = _mm256_set1_epi8(15);
+  __m256i carry_a = _mm256_set1_epi8(static_cast<char>(a));
+  __m256i carry_b = _mm256_set1_epi8(static_cast<char>(b));
+  size_t i = 0;
+  for (; i + 32 <= count / 2; i += 32) {
+    __m256i va = _mm256_add_epi8(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i)), bias);
+    __m256i vb = _mm256_add_epi8(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src_b + i)), bias);
+    va = _mm256_add_epi8(va, _mm256_slli_si256(va, 1));
+    vb = _mm256_add_epi8(vb, _mm256_slli_si256(vb, 1));
+    va = _mm256_add_epi8(va, _mm256_slli_si256(va, 2));
+    vb = _mm256_add_epi8(vb, _mm256_slli_si256(vb, 2));
+    va = _mm256_add_epi8(va, _mm256_slli_si256(va, 4));
+    vb = _mm256_add_epi8(vb, _mm256_slli_si256(vb, 4));
+    va = _mm256_add_epi8(va, _mm256_slli_si256(va, 8));
+    vb = _mm256_add_epi8(vb, _mm256_slli_si256(vb, 8));
+
+    // Carry the low lane into the high lane, then the previous block in
+    __m256i ta = _mm256_shuffle_epi8(va, last_byte);
+    __m256i tb = _mm256_shuffle_epi8(vb, last_byte);
+    va = _mm256_add_epi8(va, _mm256_permute2x128_si256(ta, ta, 0x08));
+    vb = _mm256_add_epi8(vb, _mm256_permute2x128_si256(tb, tb, 0x08));
+    va = _mm256_add_epi8(va, carry_a);
+    vb = _mm256_add_epi8(vb, carry_b);
+
+    __m256i lo = _mm256_unpacklo_epi8(va, vb);  // pairs 0-7 | 16-23
+    __m256i hi = _mm256_unpackhi_epi8(va, vb);  // pairs 8-15 | 24-31
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 2),
+                        _mm256_permute2x128_si256(lo, hi, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 2 + 32),
+                        _mm256_permute2x128_si256(lo, hi, 0x31));
+
+    ta = _mm256_shuffle_epi8(va, last_byte);
+    tb = _mm256_shuffle_epi8(vb, last_byte);
+    carry_a = _mm256_permute2x128_si256(ta, ta, 0x11);
+    carry_b = _mm256_permute2x128_si256(tb, tb, 0x11);
+  }
+  if (i > 0) {
+    a = dst[i * 2 - 2];
+    b = dst[i * 2 - 1];
+  }
+  predictor_unreorder_tail(src, dst, count, i, a, b);
+}
+
+
+TINYEXR_SIMD_TARGET_AVX2
+inline void transpose8_avx2(__m256* r) {
+  __m256 t0 = _mm256_unpacklo_ps(r[0], r[1]);
+  __m256 t1 = _mm256_unpackhi_ps(r[0], r[1]);
+  __m256 t2 = _mm256_unpacklo_ps(r[2], r[3]);
+  __m256 t3 = _mm256_unpackhi_ps(r[2], r[3]);
+  __m256 t4 = _mm256_unpacklo_ps(r[4], r[5]);
+  __m256 t5 = _mm256_unpackhi_ps(r[4], r[5]);
+  __m256 t6 = _mm256_unpacklo_ps(r[6], r[7]);
+  __m256 t7 = _mm256_unpackhi_ps(r[6], r[7]);
+  __m256 s0 = _mm256_shuffle_ps(t0, t2, 0x44);
+  __m256 s1 = _mm256_shuffle_ps(t0, t2, 0xee);
+  __m256 s2 = _mm256_shuffle_ps(t1, t3, 0x44);
+  __m256 s3 = _mm256_shuffle_ps(t1, t3, 0xee);
+  __m256 s4 = _mm256_shuffle_ps(t4, t6, 0x44);
+  __m256 s5 = _mm256_shuffle_ps(t4, t6, 0xee);
+  __m256 s6 = _mm256_shuffle_ps(t5, t7, 0x44);
+  __m256 s7 = _mm256_shuffle_ps(t5, t7, 0xee);
+  r[0] = _mm256_permute2f128_ps(s0, s4, 0x20);
+  r[1] = _mm256_permute2f128_ps(s1, s5, 0x20);
+  r[2] = _mm256_permute2f128_ps(s2, s6, 0x20);
+  r[3] = _mm256_permute2f128_ps(s3, s7, 0x20);
+  r[4] = _mm256_permute2f128_ps(s0, s4, 0x31);
+  r[5] = _mm256_permute2f128_ps(s1, s5, 0x31);
+  r[6] = _mm256_permute2f128_ps(s2, s6, 0x31);
+  r[7] = _mm256_permute2f128_ps(s3, s7, 0x31);
+}
+
+// Multiplies and adds stay separate (no FMA) to round like the scalar code
+TINYEXR_SIMD_TARGET_AVX2
+inline void dct_inverse_1d_avx2(__m256* v, const DctCoefficients& k) {
+  const __m256 a = _mm256_set1_ps(k.a), b = _mm256_set1_ps(k.b), c = _mm256_set1_ps(k.c);
+  const __m256 d = _mm256_set1_ps(k.d), e = _mm256_set1_ps(k.e), f = _mm256_set1_ps(k.f);
+  const __m256 g = _mm256_set1_ps(k.g);
+  __m256 alpha0 = _mm256_mul_ps(c, v[2]);
+  __m256 alpha1 = _mm256_mul_ps(f, v[2]);
+  __m256 alpha2 = _mm256_mul_ps(c, v[6]);
+  __m256 alpha3 = _mm256_mul_ps(f, v[6]);
+  __m256 beta0 = _mm256_add_ps(
+      _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(b, v[1]), _mm256_mul_ps(d, v[3])),
+                    _mm256_mul_ps(e, v[5])), _mm256_mul_ps(g, v[7]));
+  __m256 beta1 = _mm256_sub_ps(
+      _mm256_sub_ps(_mm256_sub_ps(_mm256_mul_ps(d, v[1]), _mm256_mul_ps(g, v[3])),
+                    _mm256_mul_ps(b, v[5])), _mm256_mul_ps(e, v[7]));
+  __m256 beta2 = _mm256_add_ps(
+      _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(e, v[1]), _mm256_mul_ps(b, v[3])),
+                    _mm256_mul_ps(g, v[5])), _mm256_mul_ps(d, v[7]));
+  __m256 beta3 = _mm256_sub_ps(
+      _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(g, v[1]), _mm256_mul_ps(e, v[3])),
+                    _mm256_mul_ps(d, v[5])), _mm256_mul_ps(b, v[7]));
+  __m256 theta0 = _mm256_mul_ps(a, _mm256_add_ps(v[0], v[4]));
+  __m256 theta3 = _mm256_mul_ps(a, _mm256_sub_ps(v[0], v[4]));
+  __m256 theta1 = _mm256_add_ps(alpha0, alpha3);
+  __m256 theta2 = _mm256_sub_ps(alpha1, alpha2);
+  __m256 gamma0 = _mm256_add_ps(theta0, theta1);
+  __m256 gamma1 = _mm256_add_ps(theta3, theta2);
+  __m256 gamma2 = _mm256_sub_ps(theta3, theta2);
+  __m256 gamma3 = _mm256_sub_ps(theta0, theta1);
+  v[0] = _mm256_add_ps(gamma0, beta0);
+  v[1] = _mm256_add_ps(gamma1, beta1);
+  v[2] = _mm256_add_ps(gamma2, beta2);
+  v[3] = _mm256_add_ps(gamma3, beta3);
+  v[4] = _mm256_sub_ps(gamma3, beta3);
+  v[5] = _mm256_sub_ps(gamma2, beta2);
+  v[6] = _mm256_sub_ps(gamma1, beta1);
+  v[7] = _mm256_sub_ps(gamma0, beta0);
+}
+
+// Whole block in registers: transpose for the row pass, back for the columns.
+// Zero rows cost nothing extra here, so `zeroed_rows` is not needed.
+TINYEXR_SIMD_TARGET_AVX2
+inline void dct_inverse_8x8_avx2(float* data, int zeroed_rows) {
+  (void)zeroed_rows;
+  const DctCoefficients& k = dct_coefficients();
+  __m256 v[8];
+  for (int r = 0; r < 8; r++) v[r] = _mm256_loadu_ps(data + r * 8);
+  transpose8_avx2(v);
+  dct_inverse_1d_avx2(v, k);
+  transpose8_avx2(v);
+  dct_inverse_1d_avx2(v, k);
+  for (int r = 0; r < 8; r++) _mm256_storeu_ps(data + r * 8, v[r]);
+}
+
+// F16C conversion already rounds to nearest even
+TINYEXR_SIMD_TARGET_AVX2
+inline void float_to_half_rne_batch_avx2(const float* src, uint16_t* dst, size_t count) {
+  float_to_half_batch_avx2(src, dst, count);
+}
+
+TINYEXR_SIMD_TARGET_AVX2
+inline void csc709_inverse_64_avx2(float* comp0, float* comp1, float* comp2) {
+  const __m256 cr_r = _mm256_set1_ps(1.5747f);
+  const __m256 cb_g = _mm256_set1_ps(0.1873f);
+  const __m256 cr_g = _mm256_set1_ps(0.4682f);
+  const __m256 cb_b = _mm256_set1_ps(1.8556f);
+  for (size_t i = 0; i < 64; i += 8) {
+    __m256 y = _mm256_loadu_ps(comp0 + i);
+    __m256 cb = _mm256_loadu_ps(comp1 + i);
+    __m256 cr = _mm256_loadu_ps(comp2 + i);
+    _mm256_storeu_ps(comp0 + i, _mm256_add_ps(y, _mm256_mul_ps(cr_r, cr)));
+    _mm256_storeu_ps(comp1 + i, _mm256_sub_ps(_mm256_sub_ps(y, _mm256_mul_ps(cb_g, cb)),
+                                              _mm256_mul_ps(cr_g, cr)));
+    _mm256_storeu_ps(comp2 + i, _mm256_add_ps(y, _mm256_mul_ps(cb_b, cb)));
+  }
+}
+
+TINYEXR_SIMD_TARGET_AVX2
+inline void dct_forward_1d_avx2(__m256* v, const DctCoefficients& k) {
+  const __m256 a = _mm256_set1_ps(k.a), b = _mm256_set1_ps(k.b), c = _mm256_set1_ps(k.c);
+  const __m256 d = _mm256_set1_ps(k.d), e = _mm256_set1_ps(k.e), f = _mm256_set1_ps(k.f);
+  const __m256 g = _mm256_set1_ps(k.g);
+  __m256 sum0 = _mm256_add_ps(v[0], v[7]), diff0 = _mm256_sub_ps(v[0], v[7]);
+  __m256 sum1 = _mm256_add_ps(v[1], v[6]), diff1 = _mm256_sub_ps(v[1], v[6]);
+  __m256 sum2 = _mm256_add_ps(v[2], v[5]), diff2 = _mm256_sub_ps(v[2], v[5]);
+  __m256 sum3 = _mm256_add_ps(v[3], v[4]), diff3 = _mm256_sub_ps(v[3], v[4]);
+  __m256 even0 = _mm256_add_ps(sum0, sum3), even1 = _mm256_add_ps(sum1, sum2);
+  __m256 odd0 = _mm256_sub_ps(sum0, sum3), odd1 = _mm256_sub_ps(sum1, sum2);
+  v[0] = _mm256_mul_ps(a, _mm256_add_ps(even0, even1));
+  v[4] = _mm256_mul_ps(a, _mm256_sub_ps(even0, even1));
+  v[2] = _mm256_add_ps(_mm256_mul_ps(c, odd0), _mm256_mul_ps(f, odd1));
+  v[6] = _mm256_sub_ps(_mm256_mul_ps(f, odd0), _mm256_mul_ps(c, odd1));
+  v[1] = _mm256_add_ps(
+      _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(b, diff0), _mm256_mul_ps(d, diff1)),
+                    _mm256_mul_ps(e, diff2)), _mm256_mul_ps(g, diff3));
+  v[3] = _mm256_sub_ps(
+      _mm256_sub_ps(_mm256_sub_ps(_mm256_mul_ps(d, diff0), _mm256_mul_ps(g, diff1)),
+                    _mm256_mul_ps(b, diff2)), _mm256_mul_ps(e, diff3));
+  v[5] = _mm256_add_ps(
+      _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(e, diff0), _mm256_mul_ps(b, diff1)),
+                    _mm256_mul_ps(g, diff2)), _mm256_mul_ps(d, diff3));
+  v[7] = _mm256_sub_ps(
+      _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(g, diff0), _mm256_mul_ps(e, diff1)),
+                    _mm256_mul_ps(d, diff2)), _mm256_mul_ps(b, diff3));
+}
+
+TINYEXR_SIMD_TARGET_AVX2
+inline void dct_forward_8x8_avx2(float* data) {
+  const DctCoefficients& k = dct_coefficients();
+  __m256 v[8];
+  for (int r = 0; r < 8; r++) v[r] = _mm256_loadu_ps(data + r * 8);
+  dct_forward_1d_avx2(v, k);
+  transpose8_avx2(v);
+  dct_forward_1d_avx2(v, k);
+  transpose8_avx2(v);
+  for (int r = 0; r < 8; r++) _mm256_storeu_ps(data + r * 8, v[r]);
+}
+
+TINYEXR_SIMD_TARGET_AVX2
+inline void csc709_forward_64_avx2(float* comp0, float* comp1, float* comp2) {
+  const __m256 r_y = _mm256_set1_ps(0.2126f), g_y = _mm256_set1_ps(0.7152f);
+  const __m256 b_y = _mm256_set1_ps(0.0722f);
+  const __m256 r_cb = _mm256_set1_ps(0.1146f), g_cb = _mm256_set1_ps(0.3854f);
+  const __m256 g_cr = _mm256_set1_ps(0.4542f), b_cr = _mm256_set1_ps(0.0458f);
+  const __m256 half = _mm256_set1_ps(0.5f);
+  for (size_t i = 0; i < 64; i += 8) {
+    __m256 r = _mm256_loadu_ps(comp0 + i);
+    __m256 g = _mm256_loadu_ps(comp1 + i);
+    __m256 b = _mm256_loadu_ps(comp2 + i);
+    _mm256_storeu_ps(comp0 + i, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r_y, r),
+                                                            _mm256_mul_ps(g_y, g)),
+                                              _mm256_mul_ps(b_y, b)));
+    _mm256_storeu_ps(comp1 + i, _mm256_add_ps(
+        _mm256_sub_ps(_mm256_sub_ps(_mm256_setzero_ps(), _mm256_mul_ps(r_cb, r)),
+                      _mm256_mul_ps(g_cb, g)), _mm256_mul_ps(half, b)));
+    _mm256_storeu_ps(comp2 + i, _mm256_sub_ps(_mm256_sub_ps(_mm256_mul_ps(half, r),
+                                                            _mm256_mul_ps(g_cr, g)),
+                                              _mm256_mul_ps(b_cr, b)));
+  }
+}
+
+TINYEXR_SIMD_TARGET_AVX2
+inline void dct_quantize_64_avx2(float* data, const float* step, const float* inv_step) {
+  const __m256 sign_mask = _mm256_castsi256_ps(_mm256_set1_epi32(static_cast<int>(0x80000000u)));
+  for (size_t i = 0; i < 64; i += 8) {
+    __m256 y = _mm256_mul_ps(_mm256_loadu_ps(data + i), _mm256_loadu_ps(inv_step + i));
+    __m256 sign = _mm256_and_ps(y, sign_mask);
+    __m256 rounded = _mm256_round_ps(y, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    // Keep the sign of values that round to zero, like the other tiers
+    rounded = _mm256_or_ps(rounded, sign);
+    _mm256_storeu_ps(data + i, _mm256_mul_ps(rounded, _mm256_loadu_ps(step + i)));
+  }
+}
+
+#endif  // TINYEXR_SIMD_AVX2_KERNELS
+
+// Kernels used by the public entry points below
+struct DispatchTable {
+  bool avx2_f16c;  // true if the runtime AVX2+F16C tier was selected
+  void (*half_to_float)(const uint16_t*, float*, size_t);
+  void (*float_to_half)(const float*, uint16_t*, size_t);
+  void (*interleave_rgba)(const float*, const float*, const float*, const float*,
+                          float*, size_t);
+  void (*deinterleave_rgba)(const float*, float*, float*, float*, float*, size_t);
+  void (*reorder_bytes)(const uint8_t*, uint8_t*, size_t);
+  void (*unreorder_bytes)(const uint8_t*, uint8_t*, size_t);
+  void (*delta_decode)(uint8_t*, size_t);
+  void (*delta_encode)(uint8_t*, size_t);
+  void (*predictor_unreorder)(const uint8_t*, uint8_t*, size_t);
+  void (*wavelet_decode_row)(uint16_t*, uint16_t*, size_t, size_t);
+  void (*wavelet_decode16_row)(uint16_t*, uint16_t*, size_t);
+  void (*wavelet_encode_row)(uint16_t*, uint16_t*, size_t);
+  void (*wavelet_encode16_row)(uint16_t*, uint16_t*, size_t);
+  void (*dct_inverse_8x8)(float*, int);
+  void (*csc709_inverse_64)(float*, float*, float*);
+  void (*float_to_half_rne)(const float*, uint16_t*, size_t);
+  void (*dct_forward_8x8)(float*);
+  void (*csc709_forward_64)(float*, float*, float*);
+  void (*dct_quantize_64)(float*, const float*, const float*);
+};
+
+inline DispatchTable make_dispatch_table() {
+  DispatchTable t;
+  t.avx2_f16c = false;
+  t.half_to_float = half_to_float_batch_baseline;
+  t.float_to_half = float_to_half_batch_baseline;
+  t.interleave_rgba = interleave_rgba_float_baseline;
+  t.deinterleave_rgba = deinterleave_rgba_float_baseline;
+  t.reorder_bytes = reorder_bytes_for_compression_baseline;
+  t.unreorder_bytes = unreorder_bytes_after_decompression_baseline;
+  t.delta_decode = apply_delta_predictor_fast_baseline;
+  t.delta_encode = reverse_delta_predictor_fast_baseline;
+  t.predictor_unreorder = predictor_unreorder_baseline;
+  t.wavelet_decode_row = wavelet_decode_row_baseline;
+  t.wavelet_decode16_row = wavelet_decode16_row_baseline;
+  t.wavelet_encode_row = wavelet_encode_row_baseline;
+  t.wavelet_encode16_row = wavelet_encode16_row_baseline;
+  t.dct_inverse_8x8 = dct_inverse_8x8_baseline;
+  t.csc709_inverse_64 = csc709_inverse_64_baseline;
+  t.float_to_half_rne = float_to_half_rne_batch_baseline;
+  t.dct_forward_8x8 = dct_forward_8x8_baseline;
+  t.csc709_forward_64 = csc709_forward_64_baseline;
+  t.dct_quantize_64 = dct_quantize_64_baseline;
+
+#if TINYEXR_SIMD_DISPATCH
+  const SIMDCapabilities& caps = get_capabilities();
+  if (caps.avx2 && caps.f16c) {
+    t.avx2_f16c = true;
+    t.half_to_float = half_to_float_batch_avx2;
+    t.float_to_half = float_to_half_batch_avx2;
+    t.interleave_rgba = interleave_rgba_float_avx2;
+    t.deinterleave_rgba = deinterleave_rgba_float_avx2;
+    t.reorder_bytes = reorder_bytes_for_compression_avx2;
+    t.unreorder_bytes = unreorder_bytes_after_decompression_avx2;
+    t.delta_decode = apply_delta_predictor_fast_avx2;
+    t.delta_encode = reverse_delta_predictor_fast_avx2;
+    t.predictor_unreorder = predictor_unreorder_avx2;
+    t.wavelet_decode_row = wavelet_decode_row_avx2;
+    t.wavelet_decode16_row = wavelet_decode16_row_avx2;
+    t.wavelet_encode_row = wavelet_encode_row_avx2;
+    t.wavelet_encode16_row = wavelet_encode16_row_avx2;
+    t.dct_inverse_8x8 = dct_inverse_8x8_avx2;
+    t.csc709_inverse_64 = csc709_inverse_64_avx2;
+    t.float_to_half_rne = float_to_half_rne_batch_avx2;
+    t.dct_forward_8x8 = dct_forward_8x8_avx2;
+    t.csc709_forward_64 = csc709_forward_64_avx2;
+    t.dct_quantize_64 = dct_quantize_64_avx2;
+  }
+#endif
+  return t;
+}
+
+// Selected once, on first use
+inline const DispatchTable& get_dispatch_table() {
+  static const DispatchTable table = make_dispatch_table();
+  return table;
+}
+
+// ----------------------------------------------------------------------------
+// Public entry points. Without runtime dispatch these call the kernels chosen
+// by the compile flags directly.
+// ----------------------------------------------------------------------------
+
+#if TINYEXR_SIMD_DISPATCH
+#define TINYEXR_SIMD_KERNEL(table_entry, kernel) (get_dispatch_table().table_entry)
+#elif TINYEXR_SIMD_AVX2_KERNELS
+#define TINYEXR_SIMD_KERNEL(table_entry, kernel) (kernel##_avx2)
+#else
+#define TINYEXR_SIMD_KERNEL(table_entry, kernel) (kernel##_baseline)
+#endif
+
+// Convert an array of half-precision values to float
+inline void half_to_float_batch(const uint16_t* src, float* dst, size_t count) {
+  TINYEXR_SIMD_KERNEL(half_to_float, half_to_float_batch)(src, dst, count);
+}
+
+// Convert an array of float values to half-precision. The F16C tier rounds to
+// nearest even; the software paths truncate or round half up.
+inline void float_to_half_batch(const float* src, uint16_t* dst, size_t count) {
+  TINYEXR_SIMD_KERNEL(float_to_half, float_to_half_batch)(src, dst, count);
+}
+
+// Interleave separate R, G, B, A channels into RGBA format
+inline void interleave_rgba_float(const float* r, const float* g, const float* b, const float* a,
+                                  float* rgba, size_t count) {
+  TINYEXR_SIMD_KERNEL(interleave_rgba, interleave_rgba_float)(r, g, b, a, rgba, count);
+}
+
+// Deinterleave RGBA format into separate R, G, B, A channels
+inline void deinterleave_rgba_float(const float* rgba, float* r, float* g, float* b, float* a,
+                                    size_t count) {
+  TINYEXR_SIMD_KERNEL(deinterleave_rgba, deinterleave_rgba_float)(rgba, r, g, b, a, count);
+}
+
+// Split even/odd bytes into two halves (ZIP/RLE preprocessing)
+inline void reorder_bytes_for_compression(const uint8_t* src, uint8_t* dst, size_t count) {
+  TINYEXR_SIMD_KERNEL(reorder_bytes, reorder_bytes_for_compression)(src, dst, count);
+}
+
+// Reverse byte reordering after decompression
+inline void unreorder_bytes_after_decompression(const uint8_t* src, uint8_t* dst, size_t count) {
+  TINYEXR_SIMD_KERNEL(unreorder_bytes, unreorder_bytes_after_decompression)(src, dst, count);
+}
+
+// Delta predictor decode: d[i] = d[i-1] + d[i] - 128
+inline void apply_delta_predictor_fast(uint8_t* data, size_t count) {
+  TINYEXR_SIMD_KERNEL(delta_decode, apply_delta_predictor_fast)(data, count);
+}
+
+// Delta predictor encode: d[i] = d[i] - d[i-1] + 128
+inline void reverse_delta_predictor_fast(uint8_t* data, size_t count) {
+  TINYEXR_SIMD_KERNEL(delta_encode, reverse_delta_predictor_fast)(data, count);
+}
+
+// Delta predictor decode and byte unreorder of a ZIP/RLE chunk in one pass,
+// from `src` (left unmodified) into `dst`
+inline void predictor_unreorder(const uint8_t* src, uint8_t* dst, size_t count) {
+  TINYEXR_SIMD_KERNEL(predictor_unreorder, predictor_unreorder)(src, dst, count);
+}
+
+// Wavelet decode for a row of 2x2 blocks
+inline void wavelet_decode_row(uint16_t* row0, uint16_t* row1,
+                               size_t width, size_t stride) {
+  TINYEXR_SIMD_KERNEL(wavelet_decode_row, wavelet_decode_row)(row0, row1, width, stride);
+}
+
+// Same for the 16-bit (wdec16) transform
+inline void wavelet_decode16_row(uint16_t* row0, uint16_t* row1, size_t width) {
+  TINYEXR_SIMD_KERNEL(wavelet_decode16_row, wavelet_decode16_row)(row0, row1, width);
+}
+
+// Wavelet encode for a row of 2x2 blocks (wenc14)
+inline void wavelet_encode_row(uint16_t* row0, uint16_t* row1, size_t width) {
+  TINYEXR_SIMD_KERNEL(wavelet_encode_row, wavelet_encode_row)(row0, row1, width);
+}
+
+// Same for the 16-bit (wenc16) transform
+inline void wavelet_encode16_row(uint16_t* row0, uint16_t* row1, size_t width) {
+  TINYEXR_SIMD_KERNEL(wavelet_encode16_row, wavelet_encode16_row)(row0, row1, width);
+}
+
+// Inverse 8x8 DCT of a DWA block in place; the last `zeroed_rows` rows are zero
+inline void dct_inverse_8x8(float* data, int zeroed_rows) {
+  TINYEXR_SIMD_KERNEL(dct_inverse_8x8, dct_inverse_8x8)(data, zeroed_rows);
+}
+
+// DWA Y'CbCr to R'G'B' (Rec.709) over one 64-value block of each component
+inline void csc709_inverse_64(float* comp0, float* comp1, float* comp2) {
+  TINYEXR_SIMD_KERNEL(csc709_inverse_64, csc709_inverse_64)(comp0, comp1, comp2);
+}
+
+// Float to half with round-to-nearest-even on every tier
+inline void float_to_half_rne_batch(const float* src, uint16_t* dst, size_t count) {
+  TINYEXR_SIMD_KERNEL(float_to_half_rne, float_to_half_rne_batch)(src, dst, count);
+}
+
+// Forward 8x8 DCT of a DWA block in place
+inline void dct_forward_8x8(float* data) {
+  TINYEXR_SIMD_KERNEL(dct_forward_8x8, dct_forward_8x8)(data);
+}
+
+// DWA R'G'B' to Y'CbCr (Rec.709) over one 64-value block of each component
+inline void csc709_forward_64(float* comp0, float* comp1, float* comp2) {
+  TINYEXR_SIMD_KERNEL(csc709_forward_64, csc709_forward_64)(comp0, comp1, comp2);
+}
+
+// Round 64 DCT coefficients to multiples of their power-of-two steps
+inline void dct_quantize_64(float* data, const float* step, const float* inv_step) {
+  TINYEXR_SIMD_KERNEL(dct_quantize_64, dct_quantize_64)(data, step, inv_step);
+}
+
+#undef TINYEXR_SIMD_KERNEL
+
 // ============================================================================
 // LUT Application with Prefetching (P2 optimization)
 // ============================================================================
@@ -1759,6 +3457,11 @@ inline size_t get_optimal_batch_size() {
 
 // Get SIMD capability string for debugging
 inline const char* get_simd_info() {
+#if TINYEXR_SIMD_DISPATCH
+  if (get_dispatch_table().avx2_f16c) {
+    return "AVX2+F16C (runtime)";
+  }
+#endif
 #if TINYEXR_SIMD_AVX512F
   return "AVX-512F";
 #elif TINYEXR_SIMD_AVX2 && TINYEXR_SIMD_F16C
@@ -71,12 +71,16 @@ void exr_simd_delta_encode(uint8_t* data, size_t count);
 // Apply delta predictor decoding (forward pass)
 void exr_simd_delta_decode(uint8_t* data, size_t count);
 
+// Delta predictor decoding followed by exr_simd_unreorder_bytes, fused into
+// one pass from src (not modified) to dst. Odd counts are supported.
+void exr_simd_delta_decode_unreorder(const uint8_t* src, uint8_t* dst, size_t count);
+
 // ============================================================================
 // Query Functions
 // ============================================================================
 
 // Get string describing active SIMD backend
-// Returns e.g. "AVX2+F16C", "SSE2", "NEON", "Scalar"
+// Returns e.g. "AVX2+F16C", "AVX2+F16C (runtime)", "SSE2", "NEON", "Scalar"
 const char* exr_simd_get_info(void);
 
 // Check if SIMD is available (non-zero if enabled)
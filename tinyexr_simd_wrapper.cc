@@ -11,6 +11,9 @@
 //   g++ -O2 -msse2 -DTINYEXR_ENABLE_SIMD=1 -c tinyexr_simd_wrapper.cc
 //   g++ -O2 -mavx2 -mf16c -DTINYEXR_ENABLE_SIMD=1 -c tinyexr_simd_wrapper.cc
 //
+// An -msse2 build still uses AVX2+F16C kernels on CPUs that have them
+// (runtime dispatch in tinyexr_simd.hh).
+//
 
 #define TINYEXR_ENABLE_SIMD 1
 #include "tinyexr_simd.hh"
@@ -68,6 +71,10 @@ void exr_simd_delta_decode(uint8_t* data, size_t count) {
     tinyexr::simd::apply_delta_predictor_fast(data, count);
 }
 
+void exr_simd_delta_decode_unreorder(const uint8_t* src, uint8_t* dst, size_t count) {
+    tinyexr::simd::predictor_unreorder(src, dst, count);
+}
+
 // ============================================================================
 // Query Functions
 // ============================================================================
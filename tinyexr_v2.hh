@@ -1077,7 +1077,12 @@ struct LoadOptions {
   // Default: true
   bool convert_to_rgba = true;
 
-  LoadOptions() : preserve_raw_channels(false), convert_to_rgba(true) {}
+  // Number of threads decoding chunks (scanline blocks or tiles) concurrently.
+  // 1 decodes on the calling thread, 0 uses one thread per hardware thread.
+  // Default: 1
+  int num_threads = 1;
+
+  LoadOptions() : preserve_raw_channels(false), convert_to_rgba(true), num_threads(1) {}
 };
 
 // Load full EXR from memory (simplified API)
@@ -13,6 +13,17 @@
 #include <cmath>
 #include <algorithm>
 
+// Multi-threaded chunk decoding (LoadOptions::num_threads).
+// Define TINYEXR_V2_USE_THREAD 0 for targets without std::thread.
+#ifndef TINYEXR_V2_USE_THREAD
+#define TINYEXR_V2_USE_THREAD 1
+#endif
+
+#if TINYEXR_V2_USE_THREAD
+#include <atomic>
+#include <thread>
+#endif
+
 // Include compression library
 #if defined(TINYEXR_USE_MINIZ) && TINYEXR_USE_MINIZ
 #if __has_include("miniz.h")
@@ -28,7 +39,7 @@
 // Decompression backend configuration
 // ============================================================================
 //
-// V2 API decompression backend priority:
+// V2 API compression backend priority (ZIP reads and writes):
 //   1. TINYEXR_V2_USE_CUSTOM_DEFLATE (default=1) - Custom SIMD-optimized deflate
 //   2. TINYEXR_USE_ZLIB - System zlib
 //   3. TINYEXR_USE_MINIZ - Miniz (bundled)
@@ -50,6 +61,7 @@
 #if TINYEXR_V2_USE_CUSTOM_DEFLATE
 #include "tinyexr_huffman.hh"
 #include "tinyexr_piz.hh"
+#include "tinyexr_dwa.hh"
 #endif
 
 // Fallback: miniz or zlib for when custom deflate is disabled
@@ -161,6 +173,21 @@ static bool DecompressZipV2(uint8_t* dst, size_t* uncompressed_size,
     return true;
   }
 
+#if TINYEXR_V2_USE_CUSTOM_DEFLATE
+  // Inflate straight into dst through a bounded window, undoing the
+  // predictor and reorder on the fly. Falls through to the buffered path
+  // for malformed or short streams.
+  {
+    size_t window_size = std::min(*uncompressed_size,
+                                  tinyexr::huffman::DEFLATE_UNPREDICT_WINDOW);
+    if (tinyexr::huffman::inflate_zlib_unpredict(
+            src, src_size, dst, *uncompressed_size,
+            pool.get_buffer(window_size), window_size)) {
+      return true;
+    }
+  }
+#endif
+
   uint8_t* tmpBuf = pool.get_buffer(*uncompressed_size);
 
 #if TINYEXR_V2_USE_CUSTOM_DEFLATE
@@ -193,10 +220,11 @@ static bool DecompressZipV2(uint8_t* dst, size_t* uncompressed_size,
   return false;
 #endif
 
-  // Predictor (using optimized version if available)
 #if defined(TINYEXR_ENABLE_SIMD) && TINYEXR_ENABLE_SIMD
-  tinyexr::simd::apply_delta_predictor_fast(tmpBuf, *uncompressed_size);
+  // Predictor and reorder in one pass
+  tinyexr::simd::predictor_unreorder(tmpBuf, dst, *uncompressed_size);
 #else
+  // Predictor
   if (*uncompressed_size > 1) {
     uint8_t* t = tmpBuf + 1;
     uint8_t* stop = tmpBuf + *uncompressed_size;
@@ -206,12 +234,8 @@ static bool DecompressZipV2(uint8_t* dst, size_t* uncompressed_size,
       ++t;
     }
   }
-#endif
 
-  // Reorder (using optimized version if available)
-#if defined(TINYEXR_ENABLE_SIMD) && TINYEXR_ENABLE_SIMD
-  tinyexr::simd::unreorder_bytes_after_decompression(tmpBuf, dst, *uncompressed_size);
-#else
+  // Reorder
   {
     const uint8_t* t1 = tmpBuf;
     const uint8_t* t2 = tmpBuf + (*uncompressed_size + 1) / 2;
@@ -249,10 +273,11 @@ static bool DecompressRleV2(uint8_t* dst, size_t uncompressed_size,
     return false;
   }
 
-  // Predictor
 #if defined(TINYEXR_ENABLE_SIMD) && TINYEXR_ENABLE_SIMD
-  tinyexr::simd::apply_delta_predictor_fast(tmpBuf, uncompressed_size);
+  // Predictor and reorder in one pass
+  tinyexr::simd::predictor_unreorder(tmpBuf, dst, uncompressed_size);
 #else
+  // Predictor
   if (uncompressed_size > 1) {
     uint8_t* t = tmpBuf + 1;
     uint8_t* stop = tmpBuf + uncompressed_size;
@@ -262,12 +287,8 @@ static bool DecompressRleV2(uint8_t* dst, size_t uncompressed_size,
       ++t;
     }
   }
-#endif
 
   // Reorder
-#if defined(TINYEXR_ENABLE_SIMD) && TINYEXR_ENABLE_SIMD
-  tinyexr::simd::unreorder_bytes_after_decompression(tmpBuf, dst, uncompressed_size);
-#else
   {
     const uint8_t* t1 = tmpBuf;
     const uint8_t* t2 = tmpBuf + (uncompressed_size + 1) / 2;
@@ -348,7 +369,17 @@ static bool DecompressPxr24V2(uint8_t* dst, size_t expected_size,
     // Uncompressed - copy directly
     std::memcpy(pxr24_buf.data(), src, src_size);
   } else {
-#if TINYEXR_USE_MINIZ
+#if TINYEXR_V2_USE_CUSTOM_DEFLATE
+    (void)pool;
+    tinyexr::huffman::dfl::DeflateOptions opts;
+    opts.max_output_size = pxr24_size;
+    auto result = tinyexr::huffman::dfl::inflate_zlib_safe(
+        src, src_size, pxr24_buf.data(), pxr24_size, opts);
+    if (!result.success) {
+      return false;
+    }
+    uncomp_size = result.bytes_written;
+#elif TINYEXR_USE_MINIZ
     mz_ulong dest_len = static_cast<mz_ulong>(pxr24_size);
     int ret = mz_uncompress(pxr24_buf.data(), &dest_len, src, static_cast<mz_ulong>(src_size));
     if (ret != MZ_OK) {
@@ -372,57 +403,78 @@ static bool DecompressPxr24V2(uint8_t* dst, size_t expected_size,
     return false;
   }
 
-  // Now convert PXR24 format to standard EXR format
-  // PXR24 organizes data by scanline, then by channel
+  // Now convert PXR24 format to standard EXR format. Each scanline of each
+  // channel is stored as byte planes (most significant first) of the
+  // differences between horizontally adjacent pixels.
   const uint8_t* in_ptr = pxr24_buf.data();
   uint8_t* out_ptr = dst;
 
   for (int line = 0; line < num_lines; line++) {
     for (int c = 0; c < num_channels; c++) {
-      int ch_width = width / channels[c].x_sampling;
+      const size_t w = static_cast<size_t>(width / channels[c].x_sampling);
 
       // Check if this line contains data for this channel (accounting for y_sampling)
       if ((line % channels[c].y_sampling) != 0) continue;
 
       switch (channels[c].pixel_type) {
-        case PIXEL_TYPE_UINT:
-          // UINT stored as 4 bytes, copy directly
-          for (int x = 0; x < ch_width; x++) {
-            uint32_t val;
-            std::memcpy(&val, in_ptr, 4);
-            std::memcpy(out_ptr, &val, 4);
-            in_ptr += 4;
+        case PIXEL_TYPE_UINT: {
+          // UINT: 4 byte planes
+          const uint8_t* ptr0 = in_ptr;
+          const uint8_t* ptr1 = in_ptr + w;
+          const uint8_t* ptr2 = in_ptr + w * 2;
+          const uint8_t* ptr3 = in_ptr + w * 3;
+          in_ptr += w * 4;
+
+          uint32_t pixel = 0;
+          for (size_t x = 0; x < w; x++) {
+            uint32_t diff = (static_cast<uint32_t>(ptr0[x]) << 24) |
+                            (static_cast<uint32_t>(ptr1[x]) << 16) |
+                            (static_cast<uint32_t>(ptr2[x]) << 8) |
+                            static_cast<uint32_t>(ptr3[x]);
+            pixel += diff;
+            std::memcpy(out_ptr, &pixel, 4);
             out_ptr += 4;
           }
           break;
+        }
 
-        case PIXEL_TYPE_HALF:
-          // HALF stored as 2 bytes, copy directly
-          for (int x = 0; x < ch_width; x++) {
-            uint16_t val;
-            std::memcpy(&val, in_ptr, 2);
-            std::memcpy(out_ptr, &val, 2);
-            in_ptr += 2;
+        case PIXEL_TYPE_HALF: {
+          // HALF: 2 byte planes
+          const uint8_t* ptr0 = in_ptr;
+          const uint8_t* ptr1 = in_ptr + w;
+          in_ptr += w * 2;
+
+          uint32_t pixel = 0;
+          for (size_t x = 0; x < w; x++) {
+            uint32_t diff = (static_cast<uint32_t>(ptr0[x]) << 8) |
+                            static_cast<uint32_t>(ptr1[x]);
+            pixel += diff;
+            uint16_t h = static_cast<uint16_t>(pixel);
+            std::memcpy(out_ptr, &h, 2);
             out_ptr += 2;
           }
           break;
+        }
 
-        case PIXEL_TYPE_FLOAT:
-          // FLOAT stored as 24-bit (3 bytes), expand to 32-bit
-          for (int x = 0; x < ch_width; x++) {
-            // PXR24 stores the upper 24 bits of the float
-            // (1 sign + 8 exponent + 15 mantissa)
-            // We need to pad the lower 8 mantissa bits with zeros
-            uint32_t val = 0;
-            val |= (static_cast<uint32_t>(in_ptr[0]) << 24);
-            val |= (static_cast<uint32_t>(in_ptr[1]) << 16);
-            val |= (static_cast<uint32_t>(in_ptr[2]) << 8);
-            // Lower 8 bits remain 0
-            std::memcpy(out_ptr, &val, 4);
-            in_ptr += 3;
+        case PIXEL_TYPE_FLOAT: {
+          // FLOAT: 3 byte planes of 24-bit floats, expanded to 32-bit with
+          // the lower 8 mantissa bits zero
+          const uint8_t* ptr0 = in_ptr;
+          const uint8_t* ptr1 = in_ptr + w;
+          const uint8_t* ptr2 = in_ptr + w * 2;
+          in_ptr += w * 3;
+
+          uint32_t pixel = 0;
+          for (size_t x = 0; x < w; x++) {
+            uint32_t diff = (static_cast<uint32_t>(ptr0[x]) << 24) |
+                            (static_cast<uint32_t>(ptr1[x]) << 16) |
+                            (static_cast<uint32_t>(ptr2[x]) << 8);
+            pixel += diff;
+            std::memcpy(out_ptr, &pixel, 4);
             out_ptr += 4;
           }
           break;
+        }
       }
     }
   }
@@ -762,6 +814,49 @@ static bool DecompressB44V2(uint8_t* dst, size_t expected_size,
   return true;
 }
 
+#if TINYEXR_V2_USE_CUSTOM_DEFLATE
+// ============================================================================
+// DWAA/DWAB decompression
+// ============================================================================
+
+// Lossy DCT, RLE and zlib channels (see tinyexr_dwa.hh). (x0, y0) is the
+// chunk's first pixel in data window coordinates, for subsampled channels.
+static bool DecompressDwaV2(uint8_t* dst, size_t expected_size,
+                            const uint8_t* src, size_t src_size,
+                            int x0, int y0, int width, int num_lines,
+                            int num_channels, const Channel* channels) {
+  std::vector<tinyexr::dwa::ChannelInfo> info(static_cast<size_t>(num_channels));
+  for (int c = 0; c < num_channels; c++) {
+    info[static_cast<size_t>(c)].name = channels[c].name.c_str();
+    info[static_cast<size_t>(c)].pixel_type = channels[c].pixel_type;
+    info[static_cast<size_t>(c)].x_sampling = channels[c].x_sampling;
+    info[static_cast<size_t>(c)].y_sampling = channels[c].y_sampling;
+    info[static_cast<size_t>(c)].p_linear = channels[c].p_linear;
+  }
+  return tinyexr::dwa::Decompress(dst, expected_size, src, src_size, info.data(),
+                                  num_channels, x0, y0, width, num_lines);
+}
+
+// Inverse of DecompressDwaV2. `level` is the dwaCompressionLevel attribute.
+static bool CompressDwaV2(const uint8_t* src, size_t src_size,
+                          int x0, int y0, int width, int num_lines,
+                          int num_channels, const Channel* channels,
+                          float level, int compression_level,
+                          std::vector<uint8_t>& compressed) {
+  std::vector<tinyexr::dwa::ChannelInfo> info(static_cast<size_t>(num_channels));
+  for (int c = 0; c < num_channels; c++) {
+    info[static_cast<size_t>(c)].name = channels[c].name.c_str();
+    info[static_cast<size_t>(c)].pixel_type = channels[c].pixel_type;
+    info[static_cast<size_t>(c)].x_sampling = channels[c].x_sampling;
+    info[static_cast<size_t>(c)].y_sampling = channels[c].y_sampling;
+    info[static_cast<size_t>(c)].p_linear = channels[c].p_linear;
+  }
+  return tinyexr::dwa::Compress(src, src_size, info.data(), num_channels,
+                                x0, y0, width, num_lines, level,
+                                compression_level, &compressed);
+}
+#endif
+
 // Shift and round for B44 pack (matches OpenEXR's shiftAndRound)
 static inline int B44ShiftAndRound(int x, int shift) {
   // Compute y = x * pow(2, -shift), rounded to nearest integer
@@ -1179,6 +1274,104 @@ static int GetScanlinesPerBlock(int compression) {
   }
 }
 
+// ============================================================================
+// Helper: Parallel chunk decoding
+// ============================================================================
+
+// Number of workers for decoding num_items chunks with the requested thread
+// count (0 = one per hardware thread)
+static int ResolveNumWorkers(int requested, int num_items) {
+#if TINYEXR_V2_USE_THREAD
+  int num_workers = requested;
+  if (num_workers <= 0) {
+    num_workers = static_cast<int>(std::thread::hardware_concurrency());
+  }
+  return std::max(1, std::min(num_workers, num_items));
+#else
+  (void)requested;
+  (void)num_items;
+  return 1;
+#endif
+}
+
+// Threads each of num_workers concurrent chunk decodes may use internally
+// when there are fewer chunks than requested threads
+static int ResolveThreadsPerChunk(int requested, int num_workers) {
+#if TINYEXR_V2_USE_THREAD
+  int total = requested;
+  if (total <= 0) {
+    total = static_cast<int>(std::thread::hardware_concurrency());
+  }
+  return std::max(1, total / std::max(1, num_workers));
+#else
+  (void)requested;
+  (void)num_workers;
+  return 1;
+#endif
+}
+
+// Call decode(index, worker) for every index in [0, count) on num_workers
+// threads; worker 0 is the calling thread. Chunks are handed out in order and
+// no new ones are started after a failure. Returns the worker whose failed
+// chunk has the lowest index, or -1 if every call succeeded.
+template <typename DecodeFn>
+static int ParallelDecodeChunks(int count, int num_workers, DecodeFn decode) {
+  if (num_workers <= 1) {
+    for (int i = 0; i < count; i++) {
+      if (!decode(i, 0)) return 0;
+    }
+    return -1;
+  }
+
+#if TINYEXR_V2_USE_THREAD
+  std::atomic<int> next(0);
+  std::atomic<bool> failed(false);
+  std::vector<int> failed_index(static_cast<size_t>(num_workers), -1);
+
+  auto run = [&](int worker) {
+    int i;
+    while (!failed.load(std::memory_order_relaxed) && (i = next++) < count) {
+      if (!decode(i, worker)) {
+        failed_index[static_cast<size_t>(worker)] = i;
+        failed = true;
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (int w = 1; w < num_workers; w++) {
+    threads.emplace_back(run, w);
+  }
+  run(0);
+  for (size_t t = 0; t < threads.size(); t++) {
+    threads[t].join();
+  }
+
+  int failed_worker = -1;
+  for (int w = 0; w < num_workers; w++) {
+    int i = failed_index[static_cast<size_t>(w)];
+    if (i >= 0 && (failed_worker < 0 || i < failed_index[static_cast<size_t>(failed_worker)])) {
+      failed_worker = w;
+    }
+  }
+  return failed_worker;
+#else
+  return -1;
+#endif
+}
+
+#if TINYEXR_V2_USE_CUSTOM_DEFLATE
+// tinyexr::piz::PizParallelFor backend: pool points at the thread count
+static void PizParallelForThreads(void* pool, uint32_t count,
+                                  tinyexr::piz::PizTaskFunc task, void* userdata) {
+  int num_workers = std::min(*static_cast<const int*>(pool), static_cast<int>(count));
+  ParallelDecodeChunks(static_cast<int>(count), num_workers, [&](int i, int) {
+    task(userdata, static_cast<uint32_t>(i));
+    return true;
+  });
+}
+#endif
+
 // ============================================================================
 // Implementation of parser functions
 // ============================================================================
@@ -1764,7 +1957,8 @@ Result<Header> ParseHeader(Reader& reader, const Version& version) {
 static Result<ImageData> LoadTiledFromMemory(const uint8_t* data, size_t size,
                                               Reader& reader,
                                               const Version& version,
-                                              const Header& header);
+                                              const Header& header,
+                                              const LoadOptions& opts);
 
 // Forward declaration for LoadOptions version
 Result<ImageData> LoadFromMemory(const uint8_t* data, size_t size, const LoadOptions& opts);
@@ -1895,7 +2089,8 @@ Result<ImageData> LoadFromMemory(const uint8_t* data, size_t size, const LoadOpt
 
   // Handle tiled files separately
   if (version_result.value.tiled || header_result.value.tiled) {
-    return LoadTiledFromMemory(data, size, reader, version_result.value, header_result.value);
+    return LoadTiledFromMemory(data, size, reader, version_result.value, header_result.value,
+                               opts);
   }
 
   // Setup image data
@@ -1972,7 +2167,9 @@ Result<ImageData> LoadFromMemory(const uint8_t* data, size_t size, const LoadOpt
       hdr.compression != COMPRESSION_PIZ &&
       hdr.compression != COMPRESSION_PXR24 &&
       hdr.compression != COMPRESSION_B44 &&
-      hdr.compression != COMPRESSION_B44A) {
+      hdr.compression != COMPRESSION_B44A &&
+      hdr.compression != COMPRESSION_DWAA &&
+      hdr.compression != COMPRESSION_DWAB) {
     Result<ImageData> result = Result<ImageData>::ok(img_data);
     result.warnings = version_result.warnings;
     for (size_t i = 0; i < header_result.warnings.size(); i++) {
@@ -2008,9 +2205,6 @@ Result<ImageData> LoadFromMemory(const uint8_t* data, size_t size, const LoadOpt
     offsets[static_cast<size_t>(i)] = offset;
   }
 
-  // Get scratch pool for decompression
-  ScratchPool& pool = get_scratch_pool();
-
   // Map channel names to output indices (RGBA)
   auto GetOutputIndex = [&](const std::string& name) -> int {
     if (name == "R" || name == "r") return 0;
@@ -2027,45 +2221,57 @@ Result<ImageData> LoadFromMemory(const uint8_t* data, size_t size, const LoadOpt
     channel_output_idx.push_back(GetOutputIndex(hdr.channels[i].name));
   }
 
-  // Decompress buffer
-  std::vector<uint8_t> decomp_buf(pixel_data_size * static_cast<size_t>(scanlines_per_block));
-
-  // Process each scanline block
+  // Blocks decode independently into disjoint rows, each worker with its
+  // own reader, decompression buffer and (thread-local) scratch pool.
+  // Subsampled channels are upsampled across block boundaries, so those
+  // files are decoded in order on the calling thread.
   reader.set_context("Decoding scanline data");
+  int num_workers = has_subsampled ? 1 : ResolveNumWorkers(opts.num_threads, num_blocks);
+  std::vector<Reader> readers(static_cast<size_t>(num_workers), reader);
+  std::vector<std::vector<uint8_t> > decomp_bufs(static_cast<size_t>(num_workers));
+  std::vector<ErrorInfo> errors(static_cast<size_t>(num_workers));
+#if TINYEXR_V2_USE_CUSTOM_DEFLATE
+  // Threads not busy with other blocks decode a PIZ block's channels
+  int piz_threads = ResolveThreadsPerChunk(opts.num_threads, num_workers);
+  tinyexr::piz::PizParallelFor piz_parallel;
+  if (piz_threads > 1) {
+    piz_parallel = tinyexr::piz::PizParallelFor(PizParallelForThreads, &piz_threads);
+  }
+#endif
+
+  auto decode_block = [&](int block, int worker) -> bool {
+    Reader& block_reader = readers[static_cast<size_t>(worker)];
+    std::vector<uint8_t>& decomp_buf = decomp_bufs[static_cast<size_t>(worker)];
+    decomp_buf.resize(pixel_data_size * static_cast<size_t>(scanlines_per_block));
+    ScratchPool& pool = get_scratch_pool();
+    ErrorInfo& error = errors[static_cast<size_t>(worker)];
 
-  for (int block = 0; block < num_blocks; block++) {
     // Seek to block
-    if (!reader.seek(static_cast<size_t>(offsets[static_cast<size_t>(block)]))) {
-      Result<ImageData> result;
-      result.success = false;
-      result.errors.push_back(ErrorInfo(ErrorCode::OutOfBounds,
-                                        "Failed to seek to block " + std::to_string(block),
-                                        reader.context(), reader.tell()));
-      return result;
+    if (!block_reader.seek(static_cast<size_t>(offsets[static_cast<size_t>(block)]))) {
+      error = ErrorInfo(ErrorCode::OutOfBounds,
+                        "Failed to seek to block " + std::to_string(block),
+                        block_reader.context(), block_reader.tell());
+      return false;
     }
 
     // Read y coordinate (4 bytes)
     uint32_t y_coord;
-    if (!reader.read4(&y_coord)) {
-      Result<ImageData> result;
-      result.success = false;
-      result.errors.push_back(reader.last_error());
-      return result;
+    if (!block_reader.read4(&y_coord)) {
+      error = block_reader.last_error();
+      return false;
     }
 
     // Read data size (4 bytes)
     uint32_t data_size;
-    if (!reader.read4(&data_size)) {
-      Result<ImageData> result;
-      result.success = false;
-      result.errors.push_back(reader.last_error());
-      return result;
+    if (!block_reader.read4(&data_size)) {
+      error = block_reader.last_error();
+      return false;
     }
 
     // Calculate number of scanlines in this block
     int y_start = static_cast<int>(y_coord) - hdr.data_window.min_y;
     int num_lines = std::min(scanlines_per_block, height - y_start);
-    if (num_lines <= 0) continue;
+    if (num_lines <= 0) return true;
 
     // Calculate expected size accounting for subsampling
     size_t expected_size = has_subsampled
@@ -2073,14 +2279,12 @@ Result<ImageData> LoadFromMemory(const uint8_t* data, size_t size, const LoadOpt
         : pixel_data_size * static_cast<size_t>(num_lines);
 
     // Read compressed data
-    const uint8_t* block_data = data + reader.tell();
-    if (reader.tell() + data_size > size) {
-      Result<ImageData> result;
-      result.success = false;
-      result.errors.push_back(ErrorInfo(ErrorCode::OutOfBounds,
-                                        "Block data exceeds file size",
-                                        reader.context(), reader.tell()));
-      return result;
+    const uint8_t* block_data = data + block_reader.tell();
+    if (block_reader.tell() + data_size > size) {
+      error = ErrorInfo(ErrorCode::OutOfBounds,
+                        "Block data exceeds file size",
+                        block_reader.context(), block_reader.tell());
+      return false;
     }
 
     // Decompress
@@ -2112,10 +2316,20 @@ Result<ImageData> LoadFromMemory(const uint8_t* data, size_t size, const LoadOpt
             decomp_buf.data(), expected_size,
             block_data, data_size,
             static_cast<int>(hdr.channels.size()), hdr.channels.data(),
-            width, num_lines);
+            width, num_lines, piz_parallel);
         decomp_ok = piz_result.success;
         break;
       }
+
+      case COMPRESSION_DWAA:
+      case COMPRESSION_DWAB:
+        decomp_ok = DecompressDwaV2(decomp_buf.data(), expected_size,
+                                    block_data, data_size,
+                                    hdr.data_window.min_x, static_cast<int>(y_coord),
+                                    width, num_lines,
+                                    static_cast<int>(hdr.channels.size()),
+                                    hdr.channels.data());
+        break;
 #endif
 
       case COMPRESSION_PXR24:
@@ -2148,12 +2362,10 @@ Result<ImageData> LoadFromMemory(const uint8_t* data, size_t size, const LoadOpt
     }
 
     if (!decomp_ok) {
-      Result<ImageData> result;
-      result.success = false;
-      result.errors.push_back(ErrorInfo(ErrorCode::CompressionError,
-                                        "Failed to decompress block " + std::to_string(block),
-                                        reader.context(), reader.tell()));
-      return result;
+      error = ErrorInfo(ErrorCode::CompressionError,
+                        "Failed to decompress block " + std::to_string(block),
+                        block_reader.context(), block_reader.tell());
+      return false;
     }
 
     // Copy raw channel data if requested
@@ -2363,7 +2575,15 @@ Result<ImageData> LoadFromMemory(const uint8_t* data, size_t size, const LoadOpt
       }
     }
 
-    reader.seek_relative(static_cast<int64_t>(data_size));
+    return true;
+  };
+
+  int failed_worker = ParallelDecodeChunks(num_blocks, num_workers, decode_block);
+  if (failed_worker >= 0) {
+    Result<ImageData> result;
+    result.success = false;
+    result.errors.push_back(errors[static_cast<size_t>(failed_worker)]);
+    return result;
   }
 
   Result<ImageData> result = Result<ImageData>::ok(img_data);
@@ -2384,7 +2604,8 @@ Result<ImageData> LoadFromMemory(const uint8_t* data, size_t size, const LoadOpt
 static Result<ImageData> LoadTiledFromMemory(const uint8_t* data, size_t size,
                                               Reader& reader,
                                               const Version& version,
-                                              const Header& header) {
+                                              const Header& header,
+                                              const LoadOptions& opts) {
   ImageData img_data;
   img_data.header = header;
   img_data.width = header.data_window.width();
@@ -2492,9 +2713,6 @@ static Result<ImageData> LoadTiledFromMemory(const uint8_t* data, size_t size,
     channel_output_idx.push_back(GetOutputIndex(header.channels[c].name));
   }
 
-  // Get scratch pool for decompression
-  ScratchPool& pool = get_scratch_pool();
-
   // Process level 0 only (base resolution)
   // For simplicity, we only decode the highest resolution level
   int level_x = 0, level_y = 0;
@@ -2508,182 +2726,216 @@ static Result<ImageData> LoadTiledFromMemory(const uint8_t* data, size_t size,
   int n_tiles_x = static_cast<int>(offset_data.offsets[level_idx][0].size());
   int n_tiles_y = static_cast<int>(offset_data.offsets[level_idx].size());
 
+  // Tiles decode independently into disjoint regions, each worker with its
+  // own reader, decompression buffer and (thread-local) scratch pool
   reader.set_context("Decoding tile data");
+  int num_tiles = n_tiles_x * n_tiles_y;
+  int num_workers = ResolveNumWorkers(opts.num_threads, num_tiles);
+  std::vector<Reader> readers(static_cast<size_t>(num_workers), reader);
+  std::vector<std::vector<uint8_t> > decomp_bufs(static_cast<size_t>(num_workers));
+  std::vector<ErrorInfo> errors(static_cast<size_t>(num_workers));
+#if TINYEXR_V2_USE_CUSTOM_DEFLATE
+  // Threads not busy with other tiles decode a PIZ tile's channels
+  int piz_threads = ResolveThreadsPerChunk(opts.num_threads, num_workers);
+  tinyexr::piz::PizParallelFor piz_parallel;
+  if (piz_threads > 1) {
+    piz_parallel = tinyexr::piz::PizParallelFor(PizParallelForThreads, &piz_threads);
+  }
+#endif
 
-  // Process each tile
-  for (int tile_y = 0; tile_y < n_tiles_y; ++tile_y) {
-    for (int tile_x = 0; tile_x < n_tiles_x; ++tile_x) {
-      uint64_t tile_offset = offset_data.offsets[level_idx][tile_y][tile_x];
-
-      // Seek to tile data
-      if (!reader.seek(static_cast<size_t>(tile_offset))) {
-        return Result<ImageData>::error(
-          ErrorInfo(ErrorCode::OutOfBounds,
-                    "Failed to seek to tile data",
-                    reader.context(), reader.tell()));
-      }
-
-      // Read tile header: tile_x (4), tile_y (4), level_x (4), level_y (4), data_size (4)
-      uint32_t tile_coords[4];
-      uint32_t tile_data_size;
-      if (!reader.read4(&tile_coords[0]) || !reader.read4(&tile_coords[1]) ||
-          !reader.read4(&tile_coords[2]) || !reader.read4(&tile_coords[3]) ||
-          !reader.read4(&tile_data_size)) {
-        return Result<ImageData>::error(
-          ErrorInfo(ErrorCode::InvalidData,
-                    "Failed to read tile header",
-                    reader.context(), reader.tell()));
-      }
+  auto decode_tile = [&](int tile_index, int worker) -> bool {
+    int tile_x = tile_index % n_tiles_x;
+    int tile_y = tile_index / n_tiles_x;
+    Reader& tile_reader = readers[static_cast<size_t>(worker)];
+    std::vector<uint8_t>& decomp_buf = decomp_bufs[static_cast<size_t>(worker)];
+    ScratchPool& pool = get_scratch_pool();
+    ErrorInfo& error = errors[static_cast<size_t>(worker)];
 
-      // Calculate tile pixel dimensions
-      int tile_start_x = tile_x * header.tile_size_x;
-      int tile_start_y = tile_y * header.tile_size_y;
-      int tile_width = std::min(header.tile_size_x, level_width - tile_start_x);
-      int tile_height = std::min(header.tile_size_y, level_height - tile_start_y);
+    uint64_t tile_offset = offset_data.offsets[level_idx][tile_y][tile_x];
 
-      if (tile_width <= 0 || tile_height <= 0) continue;
+    // Seek to tile data
+    if (!tile_reader.seek(static_cast<size_t>(tile_offset))) {
+      error = ErrorInfo(ErrorCode::OutOfBounds,
+                        "Failed to seek to tile data",
+                        tile_reader.context(), tile_reader.tell());
+      return false;
+    }
 
-      size_t tile_pixel_data_size = bytes_per_pixel * static_cast<size_t>(tile_width);
-      size_t expected_size = tile_pixel_data_size * static_cast<size_t>(tile_height);
+    // Read tile header: tile_x (4), tile_y (4), level_x (4), level_y (4), data_size (4)
+    uint32_t tile_coords[4];
+    uint32_t tile_data_size;
+    if (!tile_reader.read4(&tile_coords[0]) || !tile_reader.read4(&tile_coords[1]) ||
+        !tile_reader.read4(&tile_coords[2]) || !tile_reader.read4(&tile_coords[3]) ||
+        !tile_reader.read4(&tile_data_size)) {
+      error = ErrorInfo(ErrorCode::InvalidData,
+                        "Failed to read tile header",
+                        tile_reader.context(), tile_reader.tell());
+      return false;
+    }
 
-      // Read compressed tile data
-      const uint8_t* tile_data = data + reader.tell();
-      if (reader.tell() + tile_data_size > size) {
-        return Result<ImageData>::error(
-          ErrorInfo(ErrorCode::OutOfBounds,
-                    "Tile data exceeds file size",
-                    reader.context(), reader.tell()));
-      }
+    // Calculate tile pixel dimensions
+    int tile_start_x = tile_x * header.tile_size_x;
+    int tile_start_y = tile_y * header.tile_size_y;
+    int tile_width = std::min(header.tile_size_x, level_width - tile_start_x);
+    int tile_height = std::min(header.tile_size_y, level_height - tile_start_y);
 
-      // Allocate decompression buffer
-      std::vector<uint8_t> decomp_buf(expected_size);
+    if (tile_width <= 0 || tile_height <= 0) return true;
 
-      // Decompress tile
-      bool decomp_ok = false;
-      switch (header.compression) {
-        case COMPRESSION_NONE:
-          if (tile_data_size == expected_size) {
-            std::memcpy(decomp_buf.data(), tile_data, expected_size);
-            decomp_ok = true;
-          }
-          break;
+    size_t tile_pixel_data_size = bytes_per_pixel * static_cast<size_t>(tile_width);
+    size_t expected_size = tile_pixel_data_size * static_cast<size_t>(tile_height);
 
-        case COMPRESSION_RLE:
-          decomp_ok = DecompressRleV2(decomp_buf.data(), expected_size,
-                                       tile_data, tile_data_size, pool);
-          break;
+    // Read compressed tile data
+    const uint8_t* tile_data = data + tile_reader.tell();
+    if (tile_reader.tell() + tile_data_size > size) {
+      error = ErrorInfo(ErrorCode::OutOfBounds,
+                        "Tile data exceeds file size",
+                        tile_reader.context(), tile_reader.tell());
+      return false;
+    }
 
-        case COMPRESSION_ZIPS:
-        case COMPRESSION_ZIP: {
-          size_t uncomp_size = expected_size;
-          decomp_ok = DecompressZipV2(decomp_buf.data(), &uncomp_size,
-                                       tile_data, tile_data_size, pool);
-          break;
+    // Size the worker's decompression buffer
+    decomp_buf.resize(expected_size);
+
+    // Decompress tile
+    bool decomp_ok = false;
+    switch (header.compression) {
+      case COMPRESSION_NONE:
+        if (tile_data_size == expected_size) {
+          std::memcpy(decomp_buf.data(), tile_data, expected_size);
+          decomp_ok = true;
         }
+        break;
+
+      case COMPRESSION_RLE:
+        decomp_ok = DecompressRleV2(decomp_buf.data(), expected_size,
+                                     tile_data, tile_data_size, pool);
+        break;
+
+      case COMPRESSION_ZIPS:
+      case COMPRESSION_ZIP: {
+        size_t uncomp_size = expected_size;
+        decomp_ok = DecompressZipV2(decomp_buf.data(), &uncomp_size,
+                                     tile_data, tile_data_size, pool);
+        break;
+      }
 
 #if TINYEXR_V2_USE_CUSTOM_DEFLATE
-        case COMPRESSION_PIZ: {
-          auto piz_result = tinyexr::piz::DecompressPizV2(
-              decomp_buf.data(), expected_size,
-              tile_data, tile_data_size,
-              static_cast<int>(header.channels.size()), header.channels.data(),
-              tile_width, tile_height);
-          decomp_ok = piz_result.success;
-          break;
-        }
-#endif
+      case COMPRESSION_PIZ: {
+        auto piz_result = tinyexr::piz::DecompressPizV2(
+            decomp_buf.data(), expected_size,
+            tile_data, tile_data_size,
+            static_cast<int>(header.channels.size()), header.channels.data(),
+            tile_width, tile_height, piz_parallel);
+        decomp_ok = piz_result.success;
+        break;
+      }
 
-        case COMPRESSION_PXR24:
-          decomp_ok = DecompressPxr24V2(decomp_buf.data(), expected_size,
-                                         tile_data, tile_data_size,
-                                         tile_width, tile_height,
-                                         static_cast<int>(header.channels.size()),
-                                         header.channels.data(), pool);
-          break;
+      case COMPRESSION_DWAA:
+      case COMPRESSION_DWAB:
+        decomp_ok = DecompressDwaV2(decomp_buf.data(), expected_size,
+                                    tile_data, tile_data_size,
+                                    tile_start_x, tile_start_y,
+                                    tile_width, tile_height,
+                                    static_cast<int>(header.channels.size()),
+                                    header.channels.data());
+        break;
+#endif
 
-        case COMPRESSION_B44:
-          decomp_ok = DecompressB44V2(decomp_buf.data(), expected_size,
+      case COMPRESSION_PXR24:
+        decomp_ok = DecompressPxr24V2(decomp_buf.data(), expected_size,
                                        tile_data, tile_data_size,
                                        tile_width, tile_height,
                                        static_cast<int>(header.channels.size()),
-                                       header.channels.data(), false, pool);
-          break;
+                                       header.channels.data(), pool);
+        break;
 
-        case COMPRESSION_B44A:
-          decomp_ok = DecompressB44V2(decomp_buf.data(), expected_size,
-                                       tile_data, tile_data_size,
-                                       tile_width, tile_height,
-                                       static_cast<int>(header.channels.size()),
-                                       header.channels.data(), true, pool);
-          break;
+      case COMPRESSION_B44:
+        decomp_ok = DecompressB44V2(decomp_buf.data(), expected_size,
+                                     tile_data, tile_data_size,
+                                     tile_width, tile_height,
+                                     static_cast<int>(header.channels.size()),
+                                     header.channels.data(), false, pool);
+        break;
 
-        default:
-          decomp_ok = false;
-          break;
-      }
+      case COMPRESSION_B44A:
+        decomp_ok = DecompressB44V2(decomp_buf.data(), expected_size,
+                                     tile_data, tile_data_size,
+                                     tile_width, tile_height,
+                                     static_cast<int>(header.channels.size()),
+                                     header.channels.data(), true, pool);
+        break;
 
-      if (!decomp_ok) {
-        return Result<ImageData>::error(
-          ErrorInfo(ErrorCode::CompressionError,
-                    "Failed to decompress tile at (" + std::to_string(tile_x) +
-                    ", " + std::to_string(tile_y) + ")",
-                    reader.context(), reader.tell()));
-      }
+      default:
+        decomp_ok = false;
+        break;
+    }
 
-      // Convert tile pixel data to RGBA float and copy to output image
-      for (int line = 0; line < tile_height; line++) {
-        int out_y = tile_start_y + line;
-        if (out_y < 0 || out_y >= height) continue;
+    if (!decomp_ok) {
+      error = ErrorInfo(ErrorCode::CompressionError,
+                        "Failed to decompress tile at (" + std::to_string(tile_x) +
+                        ", " + std::to_string(tile_y) + ")",
+                        tile_reader.context(), tile_reader.tell());
+      return false;
+    }
 
-        const uint8_t* line_data = decomp_buf.data() + static_cast<size_t>(line) * tile_pixel_data_size;
-        float* out_line = img_data.rgba.data() + static_cast<size_t>(out_y) * static_cast<size_t>(width) * 4;
+    // Convert tile pixel data to RGBA float and copy to output image
+    for (int line = 0; line < tile_height; line++) {
+      int out_y = tile_start_y + line;
+      if (out_y < 0 || out_y >= height) continue;
 
-        // Process each channel
-        size_t ch_byte_offset = 0;
-        for (size_t c = 0; c < header.channels.size(); c++) {
-          int out_idx = channel_output_idx[c];
-          int ch_pixel_size = channel_sizes[c];
+      const uint8_t* line_data = decomp_buf.data() + static_cast<size_t>(line) * tile_pixel_data_size;
+      float* out_line = img_data.rgba.data() + static_cast<size_t>(out_y) * static_cast<size_t>(width) * 4;
 
-          const uint8_t* ch_start = line_data + ch_byte_offset;
+      // Process each channel
+      size_t ch_byte_offset = 0;
+      for (size_t c = 0; c < header.channels.size(); c++) {
+        int out_idx = channel_output_idx[c];
+        int ch_pixel_size = channel_sizes[c];
 
-          if (out_idx >= 0 && out_idx <= 3) {
-            for (int x = 0; x < tile_width; x++) {
-              int out_x = tile_start_x + x;
-              if (out_x < 0 || out_x >= width) continue;
+        const uint8_t* ch_start = line_data + ch_byte_offset;
 
-              const uint8_t* ch_data = ch_start + static_cast<size_t>(x) * static_cast<size_t>(ch_pixel_size);
-              float val = 0.0f;
+        if (out_idx >= 0 && out_idx <= 3) {
+          for (int x = 0; x < tile_width; x++) {
+            int out_x = tile_start_x + x;
+            if (out_x < 0 || out_x >= width) continue;
 
-              switch (header.channels[c].pixel_type) {
-                case PIXEL_TYPE_UINT: {
-                  uint32_t u;
-                  std::memcpy(&u, ch_data, 4);
-                  val = static_cast<float>(u) / 4294967295.0f;
-                  break;
-                }
-                case PIXEL_TYPE_HALF: {
-                  uint16_t h;
-                  std::memcpy(&h, ch_data, 2);
-                  val = HalfToFloat(h);
-                  break;
-                }
-                case PIXEL_TYPE_FLOAT: {
-                  std::memcpy(&val, ch_data, 4);
-                  break;
-                }
-              }
+            const uint8_t* ch_data = ch_start + static_cast<size_t>(x) * static_cast<size_t>(ch_pixel_size);
+            float val = 0.0f;
 
-              out_line[out_x * 4 + out_idx] = val;
+            switch (header.channels[c].pixel_type) {
+              case PIXEL_TYPE_UINT: {
+                uint32_t u;
+                std::memcpy(&u, ch_data, 4);
+                val = static_cast<float>(u) / 4294967295.0f;
+                break;
+              }
+              case PIXEL_TYPE_HALF: {
+                uint16_t h;
+                std::memcpy(&h, ch_data, 2);
+                val = HalfToFloat(h);
+                break;
+              }
+              case PIXEL_TYPE_FLOAT: {
+                std::memcpy(&val, ch_data, 4);
+                break;
+              }
             }
-          }
 
-          // Advance to next channel's data
-          ch_byte_offset += static_cast<size_t>(ch_pixel_size) * static_cast<size_t>(tile_width);
+            out_line[out_x * 4 + out_idx] = val;
+          }
         }
-      }
 
-      reader.seek_relative(static_cast<int64_t>(tile_data_size));
+        // Advance to next channel's data
+        ch_byte_offset += static_cast<size_t>(ch_pixel_size) * static_cast<size_t>(tile_width);
+      }
     }
+
+    return true;
+  };
+
+  int failed_worker = ParallelDecodeChunks(num_tiles, num_workers, decode_tile);
+  if (failed_worker >= 0) {
+    return Result<ImageData>::error(errors[static_cast<size_t>(failed_worker)]);
   }
 
   Result<ImageData> result = Result<ImageData>::ok(img_data);
@@ -3205,11 +3457,19 @@ static bool CompressRle(const uint8_t* src, size_t src_size,
   return true;
 }
 
-// ZIP compression using miniz or zlib
+// ZIP compression using the custom deflate encoder, miniz or zlib
 #if defined(TINYEXR_USE_MINIZ) || defined(TINYEXR_USE_ZLIB) || TINYEXR_V2_USE_CUSTOM_DEFLATE
 static bool CompressZip(const uint8_t* src, size_t src_size,
                         std::vector<uint8_t>& dst, int level = 6) {
-#if defined(TINYEXR_USE_MINIZ)
+#if TINYEXR_V2_USE_CUSTOM_DEFLATE
+  dst.resize(tinyexr::huffman::deflate_zlib_bound(src_size));
+  size_t compressed_size = tinyexr::huffman::deflate_zlib(src, src_size, dst.data(), dst.size(), level);
+  if (compressed_size == 0) {
+    return false;
+  }
+  dst.resize(compressed_size);
+  return true;
+#elif defined(TINYEXR_USE_MINIZ)
   unsigned long compressed_size = static_cast<unsigned long>(src_size + src_size / 1000 + 128);
   dst.resize(compressed_size);
   int ret = mz_compress2(dst.data(), &compressed_size, src, static_cast<unsigned long>(src_size), level);
@@ -3233,8 +3493,34 @@ static bool CompressZip(const uint8_t* src, size_t src_size,
 #endif
 }
 
+// Round a 32-bit float to the 24-bit float stored by PXR24
+// (1 sign + 8 exponent + 15 mantissa bits)
+static inline uint32_t FloatToFloat24(uint32_t bits) {
+  uint32_t s = bits & 0x80000000u;
+  uint32_t e = bits & 0x7f800000u;
+  uint32_t m = bits & 0x007fffffu;
+
+  if (e == 0x7f800000u) {
+    if (m) {
+      // NaN - keep the 15 leftmost mantissa bits, but never turn into Inf
+      m >>= 8;
+      return (s >> 8) | (e >> 8) | m | (m == 0 ? 1u : 0u);
+    }
+    // Infinity
+    return (s >> 8) | (e >> 8);
+  }
+
+  // Finite - round mantissa to 15 bits, truncating on overflow
+  uint32_t i = ((e | m) + (m & 0x00000080u)) >> 8;
+  if (i >= 0x7f8000u) {
+    i = (e | m) >> 8;
+  }
+  return (s >> 8) | i;
+}
+
 // PXR24 compression
-// Reverse of DecompressPxr24V2: convert FLOAT to 24-bit, then ZIP compress
+// Reverse of DecompressPxr24V2: round FLOAT to 24-bit, split each scanline
+// into delta-coded byte planes, then ZIP compress
 static bool CompressPxr24V2(const uint8_t* src, size_t src_size,
                             int width, int num_lines,
                             int num_channels, const Channel* channels,
@@ -3265,44 +3551,79 @@ static bool CompressPxr24V2(const uint8_t* src, size_t src_size,
   // Data is organized by scanline, then by channel
   for (int line = 0; line < num_lines; line++) {
     for (int c = 0; c < num_channels; c++) {
-      int ch_width = width / channels[c].x_sampling;
+      const size_t w = static_cast<size_t>(width / channels[c].x_sampling);
 
       // Check if this line contains data for this channel (accounting for y_sampling)
       if ((line % channels[c].y_sampling) != 0) continue;
 
       switch (channels[c].pixel_type) {
-        case PIXEL_TYPE_UINT:
-          // UINT stored as 4 bytes, copy directly
-          for (int x = 0; x < ch_width; x++) {
-            std::memcpy(out_ptr, in_ptr, 4);
+        case PIXEL_TYPE_UINT: {
+          // UINT: 4 byte planes
+          uint8_t* ptr0 = out_ptr;
+          uint8_t* ptr1 = out_ptr + w;
+          uint8_t* ptr2 = out_ptr + w * 2;
+          uint8_t* ptr3 = out_ptr + w * 3;
+          out_ptr += w * 4;
+
+          uint32_t prev = 0;
+          for (size_t x = 0; x < w; x++) {
+            uint32_t pixel;
+            std::memcpy(&pixel, in_ptr, 4);
             in_ptr += 4;
-            out_ptr += 4;
+            uint32_t diff = pixel - prev;
+            prev = pixel;
+
+            ptr0[x] = static_cast<uint8_t>(diff >> 24);
+            ptr1[x] = static_cast<uint8_t>(diff >> 16);
+            ptr2[x] = static_cast<uint8_t>(diff >> 8);
+            ptr3[x] = static_cast<uint8_t>(diff);
           }
           break;
+        }
 
-        case PIXEL_TYPE_HALF:
-          // HALF stored as 2 bytes, copy directly
-          for (int x = 0; x < ch_width; x++) {
-            std::memcpy(out_ptr, in_ptr, 2);
+        case PIXEL_TYPE_HALF: {
+          // HALF: 2 byte planes
+          uint8_t* ptr0 = out_ptr;
+          uint8_t* ptr1 = out_ptr + w;
+          out_ptr += w * 2;
+
+          uint32_t prev = 0;
+          for (size_t x = 0; x < w; x++) {
+            uint16_t h;
+            std::memcpy(&h, in_ptr, 2);
             in_ptr += 2;
-            out_ptr += 2;
+            uint32_t pixel = h;
+            uint32_t diff = pixel - prev;
+            prev = pixel;
+
+            ptr0[x] = static_cast<uint8_t>(diff >> 8);
+            ptr1[x] = static_cast<uint8_t>(diff);
           }
           break;
+        }
 
-        case PIXEL_TYPE_FLOAT:
-          // FLOAT stored as 24-bit (3 bytes): truncate lower 8 mantissa bits
-          for (int x = 0; x < ch_width; x++) {
-            uint32_t val;
-            std::memcpy(&val, in_ptr, 4);
-            // Extract upper 24 bits (1 sign + 8 exponent + 15 mantissa)
-            out_ptr[0] = static_cast<uint8_t>(val >> 24);
-            out_ptr[1] = static_cast<uint8_t>(val >> 16);
-            out_ptr[2] = static_cast<uint8_t>(val >> 8);
-            // Lower 8 mantissa bits are discarded
+        case PIXEL_TYPE_FLOAT: {
+          // FLOAT: round to 24 bits, then 3 byte planes
+          uint8_t* ptr0 = out_ptr;
+          uint8_t* ptr1 = out_ptr + w;
+          uint8_t* ptr2 = out_ptr + w * 2;
+          out_ptr += w * 3;
+
+          uint32_t prev = 0;
+          for (size_t x = 0; x < w; x++) {
+            uint32_t bits;
+            std::memcpy(&bits, in_ptr, 4);
             in_ptr += 4;
-            out_ptr += 3;
+            uint32_t pixel24 = FloatToFloat24(bits);
+            uint32_t diff = pixel24 - prev;
+            prev = pixel24;
+
+            ptr0[x] = static_cast<uint8_t>(diff >> 16);
+            ptr1[x] = static_cast<uint8_t>(diff >> 8);
+            ptr2[x] = static_cast<uint8_t>(diff);
           }
           break;
+        }
       }
     }
   }
@@ -3376,6 +3697,7 @@ Result<std::vector<uint8_t>> SaveToMemory(const ImageData& image, int compressio
   // Calculate scanline block parameters
   int scanlines_per_block = GetScanlinesPerBlock(header.compression);
   int num_blocks = (height + scanlines_per_block - 1) / scanlines_per_block;
+  const float dwa_level = header.get_float_attribute("dwaCompressionLevel", 45.0f);
 
   // Calculate bytes per scanline
   // For simplicity, we write HALF pixels (2 bytes per channel)
@@ -3498,7 +3820,7 @@ Result<std::vector<uint8_t>> SaveToMemory(const ImageData& image, int compressio
 
       case COMPRESSION_ZIPS:
       case COMPRESSION_ZIP: {
-#if defined(TINYEXR_USE_MINIZ) || defined(TINYEXR_USE_ZLIB)
+#if defined(TINYEXR_USE_MINIZ) || defined(TINYEXR_USE_ZLIB) || TINYEXR_V2_USE_CUSTOM_DEFLATE
         // Reorder bytes
         ReorderBytesForCompression(scanline_buffer.data(), reorder_buffer.data(), actual_bytes);
         // Apply predictor
@@ -3520,7 +3842,7 @@ Result<std::vector<uint8_t>> SaveToMemory(const ImageData& image, int compressio
       }
 
       case COMPRESSION_PXR24: {
-#if defined(TINYEXR_USE_MINIZ) || defined(TINYEXR_USE_ZLIB)
+#if defined(TINYEXR_USE_MINIZ) || defined(TINYEXR_USE_ZLIB) || TINYEXR_V2_USE_CUSTOM_DEFLATE
         if (!CompressPxr24V2(scanline_buffer.data(), actual_bytes,
                              width, num_lines,
                              static_cast<int>(sorted_channels.size()),
@@ -3596,6 +3918,28 @@ Result<std::vector<uint8_t>> SaveToMemory(const ImageData& image, int compressio
         data_to_write = compress_buffer.data();
         break;
 
+      case COMPRESSION_DWAA:
+      case COMPRESSION_DWAB:
+#if TINYEXR_V2_USE_CUSTOM_DEFLATE
+        if (!CompressDwaV2(scanline_buffer.data(), actual_bytes,
+                           header.data_window.min_x, y_start, width, num_lines,
+                           static_cast<int>(sorted_channels.size()),
+                           sorted_channels.data(), dwa_level,
+                           compression_level, compress_buffer)) {
+          return Result<std::vector<uint8_t>>::error(
+            ErrorInfo(ErrorCode::CompressionError, "DWA compression failed",
+                      "SaveToMemory", writer.tell()));
+        }
+        compressed_size = compress_buffer.size();
+        data_to_write = compress_buffer.data();
+#else
+        return Result<std::vector<uint8_t>>::error(
+          ErrorInfo(ErrorCode::UnsupportedFormat,
+                    "DWA compression requires the built-in deflate",
+                    "SaveToMemory", writer.tell()));
+#endif
+        break;
+
       default:
         // Unknown compression - write uncompressed
         compressed_size = actual_bytes;
@@ -3725,7 +4069,7 @@ static bool WriteTile(Writer& writer, const float* image_data,
                       int tx, int ty, int tile_w, int tile_h,
                       int level_x, int level_y,
                       const std::vector<Channel>& sorted_channels,
-                      int compression, int compression_level,
+                      int compression, int compression_level, float dwa_level,
                       std::vector<uint8_t>& tile_buffer,
                       std::vector<uint8_t>& reorder_buffer,
                       std::vector<uint8_t>& compress_buffer) {
@@ -3807,7 +4151,7 @@ static bool WriteTile(Writer& writer, const float* image_data,
 
     case COMPRESSION_ZIPS:
     case COMPRESSION_ZIP:
-#if defined(TINYEXR_USE_MINIZ) || defined(TINYEXR_USE_ZLIB)
+#if defined(TINYEXR_USE_MINIZ) || defined(TINYEXR_USE_ZLIB) || TINYEXR_V2_USE_CUSTOM_DEFLATE
       ReorderBytesForCompression(tile_buffer.data(), reorder_buffer.data(), actual_tile_size);
       ApplyDeltaPredictorEncode(reorder_buffer.data(), actual_tile_size);
       if (!CompressZip(reorder_buffer.data(), actual_tile_size, compress_buffer, compression_level)) {
@@ -3824,7 +4168,7 @@ static bool WriteTile(Writer& writer, const float* image_data,
       break;
 
     case COMPRESSION_PXR24:
-#if defined(TINYEXR_USE_MINIZ) || defined(TINYEXR_USE_ZLIB)
+#if defined(TINYEXR_USE_MINIZ) || defined(TINYEXR_USE_ZLIB) || TINYEXR_V2_USE_CUSTOM_DEFLATE
       if (!CompressPxr24V2(tile_buffer.data(), actual_tile_size,
                            actual_w, actual_h,
                            static_cast<int>(sorted_channels.size()),
@@ -3889,6 +4233,26 @@ static bool WriteTile(Writer& writer, const float* image_data,
       }
       break;
 
+    case COMPRESSION_DWAA:
+    case COMPRESSION_DWAB:
+#if TINYEXR_V2_USE_CUSTOM_DEFLATE
+      if (!CompressDwaV2(tile_buffer.data(), actual_tile_size,
+                         x0, y0, actual_w, actual_h,
+                         static_cast<int>(sorted_channels.size()),
+                         sorted_channels.data(), dwa_level,
+                         compression_level, compress_buffer)) {
+        compressed_size = actual_tile_size;
+        data_to_write = tile_buffer.data();
+      } else {
+        compressed_size = compress_buffer.size();
+        data_to_write = compress_buffer.data();
+      }
+#else
+      (void)dwa_level;
+      return false;
+#endif
+      break;
+
     default:
       compressed_size = actual_tile_size;
       data_to_write = tile_buffer.data();
@@ -3982,6 +4346,7 @@ Result<std::vector<uint8_t>> SaveTiledToMemory(const ImageData& image, int compr
   for (auto& ch : sorted_channels) {
     ch.pixel_type = PIXEL_TYPE_HALF;
   }
+  const float dwa_level = header.get_float_attribute("dwaCompressionLevel", 45.0f);
 
   // Determine tile level mode
   int tile_level_mode = write_header.tile_level_mode;
@@ -4083,7 +4448,7 @@ Result<std::vector<uint8_t>> SaveTiledToMemory(const ImageData& image, int compr
         offsets.push_back(writer.tell());
         if (!WriteTile(writer, image.rgba.data(), width, height,
                        tx, ty, tile_w, tile_h, 0, 0,
-                       sorted_channels, header.compression, compression_level,
+                       sorted_channels, header.compression, compression_level, dwa_level,
                        tile_buffer, reorder_buffer, compress_buffer)) {
           return Result<std::vector<uint8_t>>::error(
             ErrorInfo(ErrorCode::CompressionError, "Failed to write tile",
@@ -4105,7 +4470,7 @@ Result<std::vector<uint8_t>> SaveTiledToMemory(const ImageData& image, int compr
           offsets.push_back(writer.tell());
           if (!WriteTile(writer, level_data, level_w, level_h,
                          tx, ty, tile_w, tile_h, level, level,
-                         sorted_channels, header.compression, compression_level,
+                         sorted_channels, header.compression, compression_level, dwa_level,
                          tile_buffer, reorder_buffer, compress_buffer)) {
             return Result<std::vector<uint8_t>>::error(
               ErrorInfo(ErrorCode::CompressionError,
@@ -4149,7 +4514,7 @@ Result<std::vector<uint8_t>> SaveTiledToMemory(const ImageData& image, int compr
             offsets.push_back(writer.tell());
             if (!WriteTile(writer, level_data.data(), level_w, level_h,
                            tx, ty, tile_w, tile_h, lx, ly,
-                           sorted_channels, header.compression, compression_level,
+                           sorted_channels, header.compression, compression_level, dwa_level,
                            tile_buffer, reorder_buffer, compress_buffer)) {
               return Result<std::vector<uint8_t>>::error(
                 ErrorInfo(ErrorCode::CompressionError,
@@ -5587,7 +5952,7 @@ Result<std::vector<uint8_t>> SaveMultipartToMemory(const MultipartImageData& mul
 
             case COMPRESSION_ZIPS:
             case COMPRESSION_ZIP:
-#if defined(TINYEXR_USE_MINIZ) || defined(TINYEXR_USE_ZLIB)
+#if defined(TINYEXR_USE_MINIZ) || defined(TINYEXR_USE_ZLIB) || TINYEXR_V2_USE_CUSTOM_DEFLATE
               ReorderBytesForCompression(scanline_buffer.data(), reorder_buffer.data(), actual_bytes);
               ApplyDeltaPredictorEncode(reorder_buffer.data(), actual_bytes);
               if (CompressZip(reorder_buffer.data(), actual_bytes, compress_buffer, compression_level)) {
@@ -5682,7 +6047,7 @@ Result<std::vector<uint8_t>> SaveMultipartToMemory(const MultipartImageData& mul
 
           case COMPRESSION_ZIPS:
           case COMPRESSION_ZIP:
-#if defined(TINYEXR_USE_MINIZ) || defined(TINYEXR_USE_ZLIB)
+#if defined(TINYEXR_USE_MINIZ) || defined(TINYEXR_USE_ZLIB) || TINYEXR_V2_USE_CUSTOM_DEFLATE
             ReorderBytesForCompression(scanline_buffer.data(), reorder_buffer.data(), actual_bytes);
             ApplyDeltaPredictorEncode(reorder_buffer.data(), actual_bytes);
             if (CompressZip(reorder_buffer.data(), actual_bytes, compress_buffer, compression_level)) {
@@ -6272,6 +6637,16 @@ static Result<ImageData> LoadMultipartTiledPart(
         decomp_ok = piz_result.success;
         break;
       }
+
+      case COMPRESSION_DWAA:
+      case COMPRESSION_DWAB:
+        decomp_ok = DecompressDwaV2(decomp_buf.data(), expected_size,
+                                    tile_data, tile_data_size,
+                                    tile_start_x, tile_start_y,
+                                    tile_width, tile_height,
+                                    static_cast<int>(header.channels.size()),
+                                    header.channels.data());
+        break;
 #endif
 
       case COMPRESSION_PXR24:
@@ -6490,6 +6865,16 @@ static Result<ImageData> LoadMultipartScanlinePart(
         decomp_ok = piz_result.success;
         break;
       }
+
+      case COMPRESSION_DWAA:
+      case COMPRESSION_DWAB:
+        decomp_ok = DecompressDwaV2(decomp_buf.data(), expected_size,
+                                    block_data, data_size,
+                                    header.data_window.min_x, y_coord,
+                                    width, num_lines,
+                                    static_cast<int>(header.channels.size()),
+                                    header.channels.data());
+        break;
 #endif
 
       default:
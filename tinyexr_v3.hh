@@ -376,6 +376,7 @@ class Decoder : public detail::HandleWrapper<ExrDecoder, void(*)(ExrDecoder)> {
 
     Context* context_ = nullptr;
     std::vector<uint8_t> memory_data_;  // For memory source lifetime
+    std::shared_ptr<ExrDataSource> file_source_;  // Mapped file, closed on last release
 
 public:
     Decoder() : Base(nullptr, exr_decoder_destroy) {}
@@ -426,6 +427,47 @@ public:
         return from_memory(ctx, data.data(), data.size());
     }
 
+    /**
+     * Create decoder from file.
+     * The file is memory-mapped and read in place, not copied.
+     */
+    static Result<Decoder> from_file(Context& ctx, const char* filename) {
+        if (!ctx) {
+            return Result<Decoder>::error(EXR_ERROR_INVALID_HANDLE, "Invalid context");
+        }
+
+        ExrDataSource source{};
+        ExrResult result = exr_data_source_from_file(filename, &source);
+        if (result != EXR_SUCCESS) {
+            return Result<Decoder>::error(result, "Failed to open file");
+        }
+
+        Decoder decoder;
+        decoder.context_ = &ctx;
+        decoder.file_source_ = std::shared_ptr<ExrDataSource>(
+            new ExrDataSource(source),
+            [](ExrDataSource* s) { exr_data_source_close(s); delete s; });
+
+        ExrDecoderCreateInfo create_info{};
+        create_info.source = source;
+        create_info.scratch_pool = nullptr;
+        create_info.flags = 0;
+
+        ExrDecoder handle = nullptr;
+        result = exr_decoder_create(ctx.get(), &create_info, &handle);
+        if (result != EXR_SUCCESS) {
+            return Result<Decoder>::error(result, "Failed to create decoder");
+        }
+
+        decoder.handle_ = handle;
+        decoder.deleter_ = exr_decoder_destroy;
+        return Result<Decoder>::ok(std::move(decoder));
+    }
+
+    static Result<Decoder> from_file(Context& ctx, const std::string& filename) {
+        return from_file(ctx, filename.c_str());
+    }
+
     /**
      * Parse EXR header and return Image handle.
      */
@@ -901,12 +943,112 @@ struct ImageData {
  * High-Level Convenience Functions
  * ============================================================================ */
 
+namespace detail {
+
+// Decode the first part into RGBA float through framebuffer slices. Missing
+// color channels read as 0 and a missing alpha as 1. Like LoadEXR, a
+// single-channel image is replicated into all four components.
+inline Result<ImageData> load_image(Decoder& decoder) {
+    auto image_result = decoder.parse_header();
+    if (!image_result) {
+        return Result<ImageData>::error(image_result.first_error());
+    }
+
+    auto part_result = image_result.value.get_part(0);
+    if (!part_result) {
+        return Result<ImageData>::error(part_result.first_error());
+    }
+    const Part& part = part_result.value;
+    if (part.is_deep()) {
+        return Result<ImageData>::error(EXR_ERROR_UNSUPPORTED_FORMAT,
+                                        "Deep images have no flat RGBA form");
+    }
+
+    ImageData img_data;
+    img_data.width = part.width();
+    img_data.height = part.height();
+    img_data.num_channels = static_cast<int>(part.channel_count());
+    img_data.rgba.resize(static_cast<size_t>(img_data.width) * img_data.height * 4, 0.0f);
+
+    const char* rgba_names[4] = {nullptr, nullptr, nullptr, nullptr};
+    for (uint32_t c = 0; c < part.channel_count(); c++) {
+        auto ch = part.get_channel(c);
+        if (!ch) {
+            return Result<ImageData>::error(ch.first_error());
+        }
+        img_data.channels.push_back({ch.value.name,
+                                     static_cast<ExrPixelType>(ch.value.pixel_type),
+                                     ch.value.x_sampling, ch.value.y_sampling});
+        const std::string name = ch.value.name;
+        if (name == "R") rgba_names[0] = ch.value.name;
+        else if (name == "G") rgba_names[1] = ch.value.name;
+        else if (name == "B") rgba_names[2] = ch.value.name;
+        else if (name == "A") rgba_names[3] = ch.value.name;
+    }
+    if (img_data.channels.size() == 1) {
+        const char* name = img_data.channels[0].name.c_str();
+        rgba_names[0] = rgba_names[1] = rgba_names[2] = rgba_names[3] = name;
+    }
+
+    if (img_data.rgba.empty()) {
+        return Result<ImageData>::ok(std::move(img_data));
+    }
+
+    ExrSlice slices[4];
+    for (int c = 0; c < 4; c++) {
+        slices[c] = ExrSlice{};
+        slices[c].channel_name = rgba_names[c];
+        slices[c].base = img_data.rgba.data() + c;
+        slices[c].x_stride = static_cast<int64_t>(4 * sizeof(float));
+        slices[c].y_stride = static_cast<int64_t>(img_data.width) * 4 * sizeof(float);
+        slices[c].pixel_type = EXR_PIXEL_FLOAT;
+        slices[c].fill_value = (c == 3) ? 1.0 : 0.0;
+    }
+    ExrFrameBuffer framebuffer{};
+    framebuffer.slice_count = 4;
+    framebuffer.slices = slices;
+
+    ExrContext ctx = decoder.context()->get();
+    ExrCommandBufferCreateInfo cmd_info{};
+    cmd_info.decoder = decoder.get();
+    ExrCommandBuffer cmd = nullptr;
+    ExrResult result = exr_command_buffer_create(ctx, &cmd_info, &cmd);
+    if (result != EXR_SUCCESS) {
+        return Result<ImageData>::error(result, "Failed to create command buffer");
+    }
+
+    ExrFullImageRequest request{};
+    request.part = part.get();
+    request.output_pixel_type = EXR_PIXEL_FLOAT;
+    request.output_layout = EXR_LAYOUT_INTERLEAVED;
+    request.framebuffer = &framebuffer;
+
+    result = exr_command_buffer_begin(cmd);
+    if (result == EXR_SUCCESS) {
+        result = exr_cmd_request_full_image(cmd, &request);
+    }
+    if (result == EXR_SUCCESS) {
+        result = exr_command_buffer_end(cmd);
+    }
+    if (result == EXR_SUCCESS) {
+        ExrSubmitInfo submit{};
+        submit.command_buffer_count = 1;
+        submit.command_buffers = &cmd;
+        result = exr_submit(decoder.get(), &submit);
+    }
+    exr_command_buffer_destroy(cmd);
+
+    if (result != EXR_SUCCESS) {
+        return Result<ImageData>::error(result, "Failed to decode pixel data");
+    }
+    return Result<ImageData>::ok(std::move(img_data));
+}
+
+}  // namespace detail
+
 /**
  * Load EXR image from memory.
- * Returns RGBA float data.
- *
- * Note: Full implementation requires header parsing and decompression
- * which are not yet complete in the C API.
+ * Returns the first part as RGBA float data.
  */
 inline Result<ImageData> load(const uint8_t* data, size_t size) {
     auto ctx_result = Context::create();
@@ -919,20 +1061,7 @@ inline Result<ImageData> load(const uint8_t* data, size_t size) {
         return Result<ImageData>::error(decoder_result.first_error());
     }
 
-    auto image_result = decoder_result.value.parse_header();
-    if (!image_result) {
-        return Result<ImageData>::error(image_result.first_error());
-    }
-
-    ImageData img_data;
-    img_data.width = image_result.value.width();
-    img_data.height = image_result.value.height();
-    img_data.num_channels = image_result.value.channel_count();
-    img_data.rgba.resize(img_data.width * img_data.height * 4, 0.0f);
-
-    // TODO: Actually load pixel data once command buffer system is complete
-
-    return Result<ImageData>::ok(std::move(img_data));
+    return detail::load_image(decoder_result.value);
 }
 
 inline Result<ImageData> load(const std::vector<uint8_t>& data) {
@@ -941,25 +1070,21 @@ inline Result<ImageData> load(const std::vector<uint8_t>& data) {
 
 /**
  * Load EXR image from file.
+ * Returns the first part as RGBA float data. The file is memory-mapped
+ * rather than read into a buffer.
  */
 inline Result<ImageData> load_file(const char* filename) {
-    FILE* fp = fopen(filename, "rb");
-    if (!fp) {
-        return Result<ImageData>::error(EXR_ERROR_IO, "Failed to open file");
+    auto ctx_result = Context::create();
+    if (!ctx_result) {
+        return Result<ImageData>::error(ctx_result.first_error());
     }
 
-    fseek(fp, 0, SEEK_END);
-    size_t size = ftell(fp);
-    fseek(fp, 0, SEEK_SET);
-
-    std::vector<uint8_t> data(size);
-    if (fread(data.data(), 1, size, fp) != size) {
-        fclose(fp);
-        return Result<ImageData>::error(EXR_ERROR_IO, "Failed to read file");
+    auto decoder_result = Decoder::from_file(ctx_result.value, filename);
+    if (!decoder_result) {
+        return Result<ImageData>::error(decoder_result.first_error());
     }
-    fclose(fp);
 
-    return load(data);
+    return detail::load_image(decoder_result.value);
 }
 
 /* ============================================================================